@@ -0,0 +1,85 @@
+/**
+ * Measures the cold start: `require('lame')` (which loads the addon and calls
+ * mpg123_init()), then the first and the next Decoder each decoding the start
+ * of an MP3 file, and the first and the next Encoder each encoding a tenth of
+ * a second of PCM (the first of which calls lame_init_params() for a new
+ * configuration). Every run is a new process; the medians are printed.
+ *
+ *   $ node bench/cold-start.js [runs]
+ */
+
+var path = require('path');
+var fork = require('child_process').fork;
+
+var runs = +process.argv[2] || 30;
+
+function ms (start) {
+  var t = process.hrtime(start);
+  return t[0] * 1e3 + t[1] / 1e6;
+}
+
+function child () {
+  var times = {};
+  var start = process.hrtime();
+  var lame = require('../');
+  times.require = ms(start);
+
+  var mp3 = require('fs').readFileSync(path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3'));
+  var pcm = Buffer.alloc(4410 * 4);
+
+  function decode (name, fn) {
+    var start = process.hrtime();
+    var decoder = new lame.Decoder();
+    decoder.on('end', function () {
+      times[name] = ms(start);
+      fn();
+    });
+    decoder.resume();
+    decoder.end(mp3.slice(0, 4096));
+  }
+
+  function encode (name, fn) {
+    var start = process.hrtime();
+    var encoder = new lame.Encoder({ channels: 2, sampleRate: 44100, bitRate: 128 });
+    encoder.on('end', function () {
+      times[name] = ms(start);
+      fn();
+    });
+    encoder.resume();
+    encoder.end(pcm);
+  }
+
+  decode('first Decoder', function () {
+    decode('next Decoder', function () {
+      encode('first Encoder', function () {
+        encode('next Encoder', function () {
+          process.send(times);
+        });
+      });
+    });
+  });
+}
+
+function median (values) {
+  values = values.slice().sort(function (a, b) { return a - b; });
+  return values[values.length >> 1];
+}
+
+if (process.send) {
+  child();
+} else {
+  var results = [];
+  (function next () {
+    if (results.length == runs) {
+      console.log('medians of %d runs:', runs);
+      Object.keys(results[0]).forEach(function (name) {
+        console.log('  %s %s ms', (name + ':             ').slice(0, 15),
+          median(results.map(function (r) { return r[name]; })).toFixed(3));
+      });
+      return;
+    }
+    fork(__filename).on('message', function (times) {
+      results.push(times);
+    }).on('exit', next);
+  })();
+}
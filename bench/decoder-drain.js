@@ -0,0 +1,102 @@
+
+/**
+ * Compares decoding an MP3 file with `mpg123_feed()` + a `mpg123_read()` loop
+ * (one thread pool round trip per output block) against the fused
+ * `mpg123_feed_and_drain()` call (one round trip per input chunk), with and
+ * without "frames" mode (synthesizing straight into the output Buffer).
+ *
+ *   $ node bench/decoder-drain.js [file.mp3] [chunkBytes] [iterations]
+ */
+
+var fs = require('fs');
+var path = require('path');
+var binding = require('../lib/bindings');
+
+var file = process.argv[2] || path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3');
+var chunkSize = +process.argv[3] || 4096;
+var iterations = +process.argv[4] || 20;
+var mp3 = fs.readFileSync(file);
+
+var MPG123_OK = binding.MPG123_OK;
+var MPG123_NEED_MORE = binding.MPG123_NEED_MORE;
+var MPG123_NEW_FORMAT = binding.MPG123_NEW_FORMAT;
+var safe_buffer = binding.mpg123_safe_buffer();
+
+binding.mpg123_init();
+
+function open () {
+  var mh = binding.mpg123_new(null);
+  binding.mpg123_open_feed(mh);
+  return mh;
+}
+
+// the old `Decoder#_transform()` loop
+function feedRead (mh, chunk, stats, fn) {
+  stats.hops++;
+  binding.mpg123_feed(mh, chunk, chunk.length, function () {
+    read();
+  });
+  function read () {
+    var out = Buffer.allocUnsafe(safe_buffer);
+    stats.hops++;
+    binding.mpg123_read(mh, out, out.length, function (ret, bytes) {
+      stats.bytes += bytes;
+      if (ret == MPG123_OK || ret == MPG123_NEW_FORMAT) return read();
+      fn();
+    });
+  }
+}
+
+function feedAndDrain (frames) {
+  return function (mh, chunk, stats, fn) {
+    stats.hops++;
+    binding.mpg123_feed_and_drain(mh, chunk, chunk.length, function again (ret, pcm) {
+      if (pcm) stats.bytes += pcm.length;
+      if (ret == MPG123_OK) {
+        stats.hops++;
+        return binding.mpg123_feed_and_drain(mh, null, 0, again, frames);
+      }
+      fn();
+    }, frames);
+  };
+}
+
+function run (name, decode, fn) {
+  var stats = { hops: 0, bytes: 0, chunks: 0 };
+  var latency = 0;
+  var n = 0;
+  var start = process.hrtime();
+  (function file () {
+    if (n++ >= iterations) return report();
+    var mh = open();
+    var offset = 0;
+    (function next () {
+      if (offset >= mp3.length) return file();
+      var chunk = mp3.slice(offset, offset + chunkSize);
+      offset += chunkSize;
+      stats.chunks++;
+      var t = process.hrtime();
+      decode(mh, chunk, stats, function () {
+        t = process.hrtime(t);
+        latency += t[0] * 1e3 + t[1] / 1e6;
+        next();
+      });
+    })();
+  })();
+
+  function report () {
+    var t = process.hrtime(start);
+    console.log('%s: %d ms total, %s ms/chunk, %s hops/chunk, %d PCM bytes',
+      name, (t[0] * 1e3 + t[1] / 1e6).toFixed(1),
+      (latency / stats.chunks).toFixed(4),
+      (stats.hops / stats.chunks).toFixed(2), stats.bytes / iterations);
+    fn();
+  }
+}
+
+console.log('decoding %s %d times in %d byte chunks', path.basename(file), iterations, chunkSize);
+run('mpg123_feed + mpg123_read', feedRead, function () {
+  run('mpg123_feed_and_drain', feedAndDrain(false), function () {
+    run('mpg123_feed_and_drain (frames)', feedAndDrain(true), function () {});
+  });
+});
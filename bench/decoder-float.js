@@ -0,0 +1,61 @@
+
+/**
+ * Compares getting float PCM out of a `Decoder` by decoding to 16-bit and
+ * converting every sample to a Float32Array in JS, against having libmpg123
+ * synthesize float samples directly (`encoding: "f32"`) and pushing them as
+ * Float32Array views of the decoded memory (`typedArray: true`).
+ *
+ *   $ node bench/decoder-float.js [file.mp3] [iterations]
+ */
+
+var fs = require('fs');
+var path = require('path');
+var lame = require('../');
+
+var file = process.argv[2] || path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3');
+var iterations = +process.argv[3] || 20;
+var mp3 = fs.readFileSync(file);
+
+function s16ToFloat (b) {
+  var input = new Int16Array(b.buffer, b.byteOffset, b.length / 2);
+  var output = new Float32Array(input.length);
+  for (var i = 0; i < input.length; i++) output[i] = input[i] / 32768;
+  return output;
+}
+
+function decode (opts, convert) {
+  return function (fn) {
+    var decoder = new lame.Decoder(opts);
+    var samples = 0;
+    decoder.on('data', function (pcm) {
+      samples += convert(pcm).length;
+    });
+    decoder.on('end', function () { fn(samples); });
+    decoder.end(mp3);
+  };
+}
+
+function run (name, decodeOnce, fn) {
+  var n = 0;
+  var samples = 0;
+  var start = process.hrtime();
+  (function next () {
+    if (n++ >= iterations) return report();
+    decodeOnce(function (count) {
+      samples = count;
+      next();
+    });
+  })();
+
+  function report () {
+    var t = process.hrtime(start);
+    console.log('%s: %s ms/file, %d samples',
+      name, ((t[0] * 1e3 + t[1] / 1e6) / iterations).toFixed(1), samples);
+    fn();
+  }
+}
+
+console.log('decoding %s %d times to Float32Array', path.basename(file), iterations);
+run('s16 + JS conversion', decode(null, s16ToFloat), function () {
+  run('encoding: "f32", typedArray: true', decode({ encoding: 'f32', typedArray: true }, function (a) { return a; }), function () {});
+});
@@ -0,0 +1,95 @@
+
+/**
+ * Measures how `decodeParallel()` scales with the size of the audio worker
+ * pool, against a single `Decoder` on the same MP3 file. Each pool size runs
+ * in its own child process, since LAME_THREADPOOL_SIZE is read at load time.
+ * The MP3 file is encoded once up front with `encodeParallel()`.
+ *
+ *   $ node bench/decoder-parallel.js [seconds] [maxWorkers]
+ */
+
+var lame = require('../');
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var spawnSync = require('child_process').spawnSync;
+
+var seconds = +process.argv[2] || 3600;
+var maxWorkers = +process.argv[3] || Math.min(16, os.cpus().length);
+var filename = process.argv[4] || path.join(os.tmpdir(), 'lame-bench-' + seconds + 's.mp3');
+var sampleRate = 44100;
+var channels = 2;
+
+// a few sines and some noise, generated once a second and repeated
+function input () {
+  var second = Buffer.alloc(sampleRate * channels * 2);
+  var seed = 1;
+  for (var i = 0; i < sampleRate; i++) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    var noise = seed / 0x7fffffff - 0.5;
+    var t = i / sampleRate;
+    var s = 0.4 * Math.sin(2 * Math.PI * 220 * t) + 0.2 * Math.sin(2 * Math.PI * 3520 * t) + 0.1 * noise;
+    second.writeInt16LE(Math.round(s * 32000), i * 4);
+    second.writeInt16LE(Math.round(-s * 24000), i * 4 + 2);
+  }
+  var pcm = Buffer.alloc(second.length * seconds);
+  for (var j = 0; j < seconds; j++) second.copy(pcm, j * second.length);
+  return pcm;
+}
+
+function elapsed (start) {
+  var t = process.hrtime(start);
+  return t[0] * 1e3 + t[1] / 1e6;
+}
+
+if (process.env.BENCH_CHILD) {
+  var mp3 = fs.readFileSync(filename);
+  var start = process.hrtime();
+  if (process.env.BENCH_CHILD == 'serial') {
+    var decoder = new lame.Decoder();
+    var bytes = 0;
+    decoder.on('data', function (b) { bytes += b.length; });
+    decoder.on('end', function () {
+      process.stdout.write(JSON.stringify({ ms: elapsed(start), bytes: bytes }));
+    });
+    for (var o = 0; o < mp3.length; o += 64 * 1024) decoder.write(mp3.slice(o, o + 64 * 1024));
+    decoder.end();
+  } else {
+    lame.decodeParallel(mp3, {}, function (err, pcm) {
+      if (err) throw err;
+      process.stdout.write(JSON.stringify({ ms: elapsed(start), bytes: pcm.length }));
+    });
+  }
+  return;
+}
+
+function run (mode, workers) {
+  var env = Object.assign({}, process.env, {
+    BENCH_CHILD: mode,
+    LAME_THREADPOOL_SIZE: String(workers)
+  });
+  var child = spawnSync(process.execPath, [ __filename, String(seconds), '0', filename ], { env: env });
+  if (child.status !== 0) throw new Error(child.stderr.toString());
+  return JSON.parse(child.stdout.toString());
+}
+
+function main () {
+  console.log('decoding %d seconds of stereo MP3 (%d cores)', seconds, os.cpus().length);
+  var serial = run('serial', 1);
+  console.log('Decoder: %d ms (%d PCM bytes)', serial.ms.toFixed(0), serial.bytes);
+  for (var workers = 1; workers <= maxWorkers; workers *= 2) {
+    var r = run('parallel', workers);
+    console.log('decodeParallel, %d workers: %d ms, %sx (%d PCM bytes)',
+      workers, r.ms.toFixed(0), (serial.ms / r.ms).toFixed(2), r.bytes);
+  }
+}
+
+if (fs.existsSync(filename)) {
+  main();
+} else {
+  lame.encodeParallel(input(), { channels: channels, bitDepth: 16, sampleRate: sampleRate }, function (err, mp3) {
+    if (err) throw err;
+    fs.writeFileSync(filename, mp3);
+    main();
+  });
+}
@@ -0,0 +1,88 @@
+
+/**
+ * Compares decoding an MP3 file straight to another sample rate, with the
+ * `Decoder`'s "rate" option (libmpg123's NtoM synth, resampling as part of the
+ * synthesis), against decoding it at its own rate and resampling the PCM
+ * afterwards in JS (linear interpolation, the cheapest there is).
+ *
+ *   $ node bench/decoder-rate.js [file.mp3] [rate] [iterations]
+ */
+
+var fs = require('fs');
+var path = require('path');
+var lame = require('../');
+
+var file = process.argv[2] || path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3');
+var rate = +process.argv[3] || 48000;
+var iterations = +process.argv[4] || 10;
+var mp3 = fs.readFileSync(file);
+
+function decode (opts, fn) {
+  var decoder = new lame.Decoder(opts);
+  var format = null;
+  var chunks = [];
+  decoder.on('format', function (f) { format = f; });
+  decoder.on('data', function (b) { chunks.push(b); });
+  decoder.on('end', function () { fn(format, Buffer.concat(chunks)); });
+  decoder.end(mp3);
+}
+
+// interleaved signed 16-bit PCM from `format.sampleRate` to `rate`
+function resample (format, pcm) {
+  var channels = format.channels;
+  var input = new Int16Array(pcm.buffer, pcm.byteOffset, pcm.length / 2);
+  var frames = input.length / channels;
+  var n = Math.floor(frames * rate / format.sampleRate);
+  var output = new Int16Array(n * channels);
+  var step = format.sampleRate / rate;
+  for (var i = 0; i < n; i++) {
+    var x = i * step;
+    var j = x | 0;
+    var f = x - j;
+    var k = Math.min(j + 1, frames - 1);
+    for (var c = 0; c < channels; c++) {
+      var a = input[j * channels + c];
+      output[i * channels + c] = a + (input[k * channels + c] - a) * f;
+    }
+  }
+  return Buffer.from(output.buffer);
+}
+
+function run (name, decodeAt, fn) {
+  var n = 0;
+  var bytes = 0;
+  var start = process.hrtime();
+  (function next () {
+    if (n++ >= iterations) return report();
+    decodeAt(function (format, pcm) {
+      bytes = pcm.length;
+      next();
+    });
+  })();
+
+  function report () {
+    var t = process.hrtime(start);
+    console.log('%s: %s ms/file, %d PCM bytes',
+      name, ((t[0] * 1e3 + t[1] / 1e6) / iterations).toFixed(1), bytes);
+    fn();
+  }
+}
+
+function native (decoder) {
+  return function (fn) {
+    decode({ decoder: decoder, rate: rate }, fn);
+  };
+}
+
+function thenResample (fn) {
+  decode(null, function (format, pcm) {
+    fn(format, resample(format, pcm));
+  });
+}
+
+console.log('decoding %s %d times to %d Hz', path.basename(file), iterations, rate);
+run('rate: ' + rate + ' (' + lame.decoders()[0] + ')', native(null), function () {
+  run('rate: ' + rate + ' (generic)', native('generic'), function () {
+    run('decode + JS resample', thenResample, function () {});
+  });
+});
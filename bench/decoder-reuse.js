@@ -0,0 +1,61 @@
+/**
+ * Measures the time per stream and the memory for decoding many short MP3
+ * streams, a number of them at a time, each with a new Decoder, with and
+ * without `reuse` set. Each mode runs in a process of its own, so that the
+ * resident set sizes compare.
+ *
+ *   $ node bench/decoder-reuse.js [streams] [concurrent] [bytes]
+ */
+
+var fs = require('fs');
+var path = require('path');
+var fork = require('child_process').fork;
+var lame = require('../');
+
+var streams = +process.argv[2] || 5000;
+var concurrent = +process.argv[3] || 500;
+var bytes = +process.argv[4] || 16000;
+var mode = process.argv[5];
+
+var mp3 = fs.readFileSync(path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3'));
+var clip = mp3.slice(0, bytes);
+
+function run (reuse) {
+  var started = 0;
+  var finished = 0;
+  var pcm = 0;
+  var rss = 0;
+  var start = process.hrtime();
+  // room for the handles of all the streams that run at a time
+  lame.Decoder.handles.max = concurrent;
+
+  function next () {
+    if (started == streams) return;
+    started++;
+    var decoder = new lame.Decoder({ reuse: reuse });
+    decoder.on('data', function (b) { pcm += b.length; });
+    decoder.on('end', function () {
+      rss = Math.max(rss, process.memoryUsage().rss);
+      if (++finished < streams) return next();
+      var t = process.hrtime(start);
+      var ms = t[0] * 1e3 + t[1] / 1e6;
+      console.log('%s: %s ms per stream, %d PCM bytes, peak rss %d MB',
+        reuse ? 'reuse' : 'no reuse', (ms / streams).toFixed(3), pcm,
+        Math.round(rss / 1048576));
+      if (reuse) console.log(lame.Decoder.handles.stats());
+    });
+    decoder.end(clip);
+  }
+
+  for (var i = 0; i < concurrent; i++) next();
+}
+
+if (mode) {
+  run('reuse' == mode);
+} else {
+  console.log('decoding %d streams of %d MP3 bytes, %d at a time', streams, bytes, concurrent);
+  var args = [ streams, concurrent, bytes ];
+  fork(__filename, args.concat('new')).on('exit', function () {
+    fork(__filename, args.concat('reuse'));
+  });
+}
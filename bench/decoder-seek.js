@@ -0,0 +1,94 @@
+
+/**
+ * Compares getting the PCM from a point of an MP3 file on by decoding it from
+ * the start and dropping everything before that point, against writing the
+ * start of the file, `seek()`ing with the file's frame index (as from
+ * `Decoder.scan()`) and writing from the byte offset it returns. Then compares
+ * getting that index (and the file's length) by scanning the file against
+ * reading it from a sidecar file (`lame.readIndex()`).
+ *
+ *   $ node bench/decoder-seek.js [file.mp3] [fraction] [iterations]
+ */
+
+var fs = require('fs');
+var path = require('path');
+var lame = require('../');
+
+var file = process.argv[2] || path.resolve(__dirname, '..', 'test', 'fixtures', 'pipershut_lo.mp3');
+var fraction = +process.argv[3] || 0.75;
+var iterations = +process.argv[4] || 20;
+var mp3 = fs.readFileSync(file);
+
+function fromStart (sample, fn) {
+  var decoder = new lame.Decoder();
+  var blockAlign;
+  var skip;
+  var bytes = 0;
+  decoder.on('format', function (f) {
+    blockAlign = f.channels * f.bitDepth / 8;
+    skip = sample * blockAlign;
+  });
+  decoder.on('data', function (pcm) {
+    var n = Math.min(skip, pcm.length);
+    skip -= n;
+    bytes += pcm.length - n;
+  });
+  decoder.on('end', function () { fn(bytes, blockAlign); });
+  decoder.end(mp3);
+}
+
+function seeking (index) {
+  return function (sample, fn) {
+    var decoder = new lame.Decoder({ index: index });
+    var seeked = false;
+    var bytes = 0;
+    decoder.on('data', function (pcm) {
+      if (seeked) bytes += pcm.length;
+    });
+    decoder.on('end', function () { fn(bytes); });
+    decoder.write(mp3.slice(0, index.offsets[0] + 2881), function () {
+      var offset = decoder.seek(sample);
+      seeked = true;
+      decoder.end(mp3.slice(offset));
+    });
+  };
+}
+
+function run (name, decodeFrom, sample, fn) {
+  var n = 0;
+  var start = process.hrtime();
+  (function next () {
+    if (n++ >= iterations) return report();
+    decodeFrom(sample, next);
+  })();
+
+  function report () {
+    var t = process.hrtime(start);
+    console.log('%s: %s ms', name, ((t[0] * 1e3 + t[1] / 1e6) / iterations).toFixed(2));
+    fn();
+  }
+}
+
+lame.Decoder.scan(mp3, function (err, index) {
+  if (err) throw err;
+  fromStart(0, function (bytes, blockAlign) {
+    var sample = Math.floor(bytes / blockAlign * fraction);
+    bench(index, sample);
+  });
+});
+
+function bench (index, sample) {
+  console.log('decoding %s from sample %d, %d times', path.basename(file), sample, iterations);
+  run('decode from the start', fromStart, sample, function () {
+    run('seek() with the index', seeking(index), sample, function () {
+      var sidecar = lame.writeIndex(index);
+      run('Decoder.scan()', function (sample, fn) {
+        lame.Decoder.scan(mp3, function (err, index) { fn(index.samples); });
+      }, 0, function () {
+        run('lame.readIndex() (' + sidecar.length + ' bytes)', function (sample, fn) {
+          fn(lame.readIndex(sidecar).samples);
+        }, 0, function () {});
+      });
+    });
+  });
+}
@@ -0,0 +1,95 @@
+/**
+ * Measures the time for encoding many voice streams (16 kHz mono, 32 kbps)
+ * side by side, a 20 ms chunk of each at a time, with one Encoder per stream
+ * and with one EncoderGroup for all of them.
+ *
+ *   $ node bench/encoder-group.js [streams] [seconds]
+ */
+
+var lame = require('../');
+
+var streams = +process.argv[2] || 64;
+var seconds = +process.argv[3] || 10;
+var opts = { channels: 1, sampleRate: 16000, bitRate: 32, mode: lame.MONO };
+var chunkSamples = opts.sampleRate / 50;
+var rounds = Math.round(seconds * 50);
+
+// a different tone with some noise for every stream, one chunk's worth
+var chunks = [];
+for (var s = 0; s < streams; s++) {
+  var chunk = Buffer.alloc(chunkSamples * 2);
+  for (var i = 0; i < chunkSamples; i++) {
+    var v = Math.sin(2 * Math.PI * (200 + 10 * s) * i / opts.sampleRate) * 12000 +
+      ((i * 7919 + s) % 2000 - 1000);
+    chunk.writeInt16LE(Math.round(v), i * 2);
+  }
+  chunks.push(chunk);
+}
+
+function report (name, start, bytes) {
+  var t = process.hrtime(start);
+  var ms = t[0] * 1e3 + t[1] / 1e6;
+  console.log('%s: %s ms per second of a stream, %d MP3 bytes',
+    name, (ms / seconds / streams).toFixed(3), bytes);
+}
+
+function encoders (fn) {
+  var bytes = 0;
+  var start = process.hrtime();
+  var list = chunks.map(function () {
+    var encoder = new lame.Encoder(opts);
+    encoder.on('data', function (b) { bytes += b.length; });
+    return encoder;
+  });
+
+  (function next (round) {
+    if (round == rounds) {
+      var left = streams;
+      return list.forEach(function (encoder) {
+        encoder.on('end', function () {
+          if (--left) return;
+          report('Encoders', start, bytes);
+          fn();
+        });
+        encoder.end();
+      });
+    }
+    var left = streams;
+    list.forEach(function (encoder, i) {
+      encoder.write(chunks[i], function () {
+        if (--left === 0) next(round + 1);
+      });
+    });
+  })(0);
+}
+
+function group (fn) {
+  var bytes = 0;
+  var start = process.hrtime();
+  var g = new lame.EncoderGroup(opts, streams);
+
+  function count (mp3s) {
+    mp3s.forEach(function (b) { bytes += b.length; });
+  }
+
+  (function next (round) {
+    if (round == rounds) {
+      return g.end(function (err, mp3s) {
+        if (err) throw err;
+        count(mp3s);
+        report('EncoderGroup', start, bytes);
+        fn();
+      });
+    }
+    g.encode(chunks, function (err, mp3s) {
+      if (err) throw err;
+      count(mp3s);
+      next(round + 1);
+    });
+  })(0);
+}
+
+console.log('encoding %d streams of %d seconds of 16 kHz mono PCM, 20 ms at a time', streams, seconds);
+encoders(function () {
+  group(function () {});
+});
@@ -0,0 +1,79 @@
+/**
+ * Measures how `encodeParallel()` scales with the size of the audio worker
+ * pool, against a single `Encoder` on the same input. Each pool size runs in
+ * its own child process, since LAME_THREADPOOL_SIZE is read at load time.
+ *
+ *   $ node bench/encoder-parallel.js [seconds] [maxWorkers]
+ */
+
+var lame = require('../');
+var os = require('os');
+var spawnSync = require('child_process').spawnSync;
+
+var seconds = +process.argv[2] || 3600;
+var maxWorkers = +process.argv[3] || Math.min(16, os.cpus().length);
+var sampleRate = 44100;
+var channels = 2;
+
+// a stereo signal that isn't trivial for the psychoacoustic model:
+// a few sines and some noise, generated once a second and repeated
+function input () {
+  var second = Buffer.alloc(sampleRate * channels * 2);
+  var seed = 1;
+  for (var i = 0; i < sampleRate; i++) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    var noise = seed / 0x7fffffff - 0.5;
+    var t = i / sampleRate;
+    var s = 0.4 * Math.sin(2 * Math.PI * 220 * t) + 0.2 * Math.sin(2 * Math.PI * 3520 * t) + 0.1 * noise;
+    second.writeInt16LE(Math.round(s * 32000), i * 4);
+    second.writeInt16LE(Math.round(-s * 24000), i * 4 + 2);
+  }
+  var pcm = Buffer.alloc(second.length * seconds);
+  for (var j = 0; j < seconds; j++) second.copy(pcm, j * second.length);
+  return pcm;
+}
+
+function elapsed (start) {
+  var t = process.hrtime(start);
+  return t[0] * 1e3 + t[1] / 1e6;
+}
+
+if (process.env.BENCH_CHILD) {
+  var pcm = input();
+  var start = process.hrtime();
+  if (process.env.BENCH_CHILD == 'serial') {
+    var encoder = new lame.Encoder({ channels: channels, bitDepth: 16, sampleRate: sampleRate });
+    var bytes = 0;
+    encoder.on('data', function (b) { bytes += b.length; });
+    encoder.on('end', function () {
+      process.stdout.write(JSON.stringify({ ms: elapsed(start), bytes: bytes }));
+    });
+    for (var o = 0; o < pcm.length; o += 1024 * 1024) encoder.write(pcm.slice(o, o + 1024 * 1024));
+    encoder.end();
+  } else {
+    lame.encodeParallel(pcm, { channels: channels, bitDepth: 16, sampleRate: sampleRate }, function (err, mp3) {
+      if (err) throw err;
+      process.stdout.write(JSON.stringify({ ms: elapsed(start), bytes: mp3.length }));
+    });
+  }
+  return;
+}
+
+function run (mode, workers) {
+  var env = Object.assign({}, process.env, {
+    BENCH_CHILD: mode,
+    LAME_THREADPOOL_SIZE: String(workers)
+  });
+  var child = spawnSync(process.execPath, [ __filename, String(seconds) ], { env: env });
+  if (child.status !== 0) throw new Error(child.stderr.toString());
+  return JSON.parse(child.stdout.toString());
+}
+
+console.log('encoding %d seconds of 16-bit stereo PCM (%d cores)', seconds, os.cpus().length);
+var serial = run('serial', 1);
+console.log('Encoder: %d ms (%d MP3 bytes)', serial.ms.toFixed(0), serial.bytes);
+for (var workers = 1; workers <= maxWorkers; workers *= 2) {
+  var r = run('parallel', workers);
+  console.log('encodeParallel, %d workers: %d ms, %sx (%d MP3 bytes)',
+    workers, r.ms.toFixed(0), (serial.ms / r.ms).toFixed(2), r.bytes);
+}
@@ -0,0 +1,51 @@
+/**
+ * Measures the time per clip for encoding many short clips one after the
+ * other, each with a new Encoder, with and without `reuse` set.
+ *
+ *   $ node bench/encoder-reuse.js [clips] [seconds]
+ */
+
+var lame = require('../');
+
+var clips = +process.argv[2] || 300;
+var seconds = +process.argv[3] || 1.5;
+var sampleRate = 22050;
+
+// a mono 440 Hz sine wave, the same for every clip
+var samples = Math.round(seconds * sampleRate);
+var pcm = Buffer.alloc(samples * 2);
+for (var i = 0; i < samples; i++) {
+  pcm.writeInt16LE(Math.round(Math.sin(2 * Math.PI * 440 * i / sampleRate) * 16000), i * 2);
+}
+
+function run (reuse, fn) {
+  var bytes = 0;
+  var n = 0;
+  var start = process.hrtime();
+
+  (function next () {
+    if (n++ == clips) {
+      var t = process.hrtime(start);
+      var ms = t[0] * 1e3 + t[1] / 1e6;
+      console.log('%s: %s ms per clip, %d MP3 bytes',
+        reuse ? 'reuse' : 'no reuse', (ms / clips).toFixed(3), bytes);
+      return fn();
+    }
+    var encoder = new lame.Encoder({
+      channels: 1,
+      sampleRate: sampleRate,
+      bitRate: 48,
+      reuse: reuse
+    });
+    encoder.on('data', function (b) { bytes += b.length; });
+    encoder.on('end', next);
+    encoder.end(pcm);
+  })();
+}
+
+console.log('encoding %d clips of %d seconds of 16-bit mono PCM', clips, seconds);
+run(false, function () {
+  run(true, function () {
+    console.log(lame.Encoder.handles.stats());
+  });
+});
@@ -0,0 +1,107 @@
+
+/**
+ * Measures Buffer allocations, the bytes they take, the bytes copied and GC
+ * activity per encoded second of audio, with and without the Encoder's
+ * `scratch` mode. Without it every chunk gets a new Buffer of the worst case
+ * MP3 size, and is pushed as a slice of it; with it, lame writes into one
+ * reused Buffer and every chunk is copied out into one of its own size.
+ *
+ *   $ node bench/encoder-scratch.js [seconds] [chunkBytes]
+ */
+
+var lame = require('../');
+var PerformanceObserver = require('perf_hooks').PerformanceObserver;
+
+var seconds = +process.argv[2] || 120;
+var chunkSize = +process.argv[3] || 16384;
+var sampleRate = 44100;
+var channels = 2;
+
+// count every Buffer allocated through `new Buffer()` and `Buffer.from()`
+var RealBuffer = Buffer;
+var allocations = 0;
+var allocated = 0;
+var copied = 0;
+function from (data) {
+  var b = RealBuffer.from.apply(RealBuffer, arguments);
+  allocations++;
+  allocated += b.length;
+  if (RealBuffer.isBuffer(data)) copied += b.length;
+  return b;
+}
+global.Buffer = new Proxy(RealBuffer, {
+  construct: function (target, args) {
+    var b = new target(args[0], args[1], args[2]);
+    allocations++;
+    allocated += b.length;
+    return b;
+  },
+  get: function (target, prop) {
+    return prop === 'from' ? from : target[prop];
+  }
+});
+
+// a stereo 440 Hz sine wave, reused for every chunk
+var pcm = RealBuffer.alloc(chunkSize);
+for (var i = 0; i < chunkSize / 4; i++) {
+  var s = Math.round(Math.sin(2 * Math.PI * 440 * i / sampleRate) * 16000);
+  pcm.writeInt16LE(s, i * 4);
+  pcm.writeInt16LE(s, i * 4 + 2);
+}
+
+var gcs = 0;
+var gcTime = 0;
+var obs = new PerformanceObserver(function (list) {
+  list.getEntries().forEach(function (e) { gcs++; gcTime += e.duration; });
+});
+obs.observe({ entryTypes: [ 'gc' ] });
+
+function run (scratch, fn) {
+  var encoder = new lame.Encoder({
+    channels: channels,
+    bitDepth: 16,
+    sampleRate: sampleRate,
+    scratch: scratch
+  });
+  var total = seconds * sampleRate * channels * 2;
+  var written = 0;
+  var bytes = 0;
+
+  allocations = 0;
+  allocated = 0;
+  copied = 0;
+  gcs = 0;
+  gcTime = 0;
+  var start = process.hrtime();
+
+  encoder.on('data', function (b) { bytes += b.length; });
+  encoder.on('end', function () {
+    // let the GC observer catch up
+    setImmediate(function () {
+      var t = process.hrtime(start);
+      var ms = t[0] * 1e3 + t[1] / 1e6;
+      console.log('%s: %d ms, %d MP3 bytes, %s allocs/s (%s kb/s), %s kb/s copied, ' +
+        '%s GCs/s (%s ms GC)',
+        scratch ? 'scratch' : 'no scratch', ms.toFixed(1), bytes,
+        (allocations / seconds).toFixed(2), (allocated / seconds / 1024).toFixed(1),
+        (copied / seconds / 1024).toFixed(1), (gcs / seconds).toFixed(3),
+        gcTime.toFixed(1));
+      fn();
+    });
+  });
+
+  (function write () {
+    while (written < total) {
+      written += pcm.length;
+      if (!encoder.write(pcm)) return encoder.once('drain', write);
+    }
+    encoder.end();
+  })();
+}
+
+console.log('encoding %d seconds of 16-bit stereo PCM in %d byte chunks', seconds, chunkSize);
+run(false, function () {
+  run(true, function () {
+    obs.disconnect();
+  });
+});
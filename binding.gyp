@@ -4,11 +4,12 @@
       'target_name': 'bindings',
       'sources': [
         'src/bindings.cc',
+        'src/node_pool.cc',
         'src/node_lame.cc',
         'src/node_mpg123.cc'
       ],
-      "include_dirs" : [
-        '<!(node -e "require(\'nan\')")'
+      'defines': [
+        'NAPI_VERSION=6'
       ],
       'dependencies': [
         'deps/lame/libmp3lame.gyp:mp3lame',
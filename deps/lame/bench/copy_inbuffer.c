@@ -0,0 +1,288 @@
+/*
+ *      Regression test and microbenchmark for the input buffer copy
+ *
+ * Checks the copy_inbuffer_short_core, _float_core, _int_core, _s24_core and
+ * _u8_core versions this CPU supports against the C versions on random input
+ * (planar and interleaved, many lengths, with and without a mono downmix),
+ * then encodes a test signal from interleaved 16-bit, planar float and
+ * interleaved 24-bit input at 128 kbps CBR -q 7 with each of them, compares
+ * the MP3 output and prints the time per sample copied and per frame.
+ *
+ *   $ make -C build bench_copy_inbuffer && ./build/Release/bench_copy_inbuffer [seconds]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "lame_intrin.h"
+
+typedef void (*copy_short_fn) (sample_t *, sample_t *, const short *, const short *, int, int,
+                               FLOAT const *);
+typedef void (*copy_float_fn) (sample_t *, sample_t *, const float *, const float *, int, int,
+                               FLOAT const *);
+typedef void (*copy_int_fn) (sample_t *, sample_t *, const int *, const int *, int, int,
+                             FLOAT const *);
+typedef void (*copy_bytes_fn) (sample_t *, sample_t *, const unsigned char *,
+                               const unsigned char *, int, int, FLOAT const *);
+
+struct variant {
+    const char *name;
+    int     supported;
+    copy_short_fn copy_short;
+    copy_float_fn copy_float;
+    copy_int_fn copy_int;
+    copy_bytes_fn copy_s24;
+    copy_bytes_fn copy_u8;
+};
+
+#define CALLS 200
+#define MAX_SAMPLES 4096
+
+static short pcm_s16[2 * MAX_SAMPLES];
+static float pcm_f32[2 * MAX_SAMPLES];
+static int pcm_s32[2 * MAX_SAMPLES];
+static unsigned char pcm_s24[3 * 2 * MAX_SAMPLES + 6];
+static unsigned char pcm_u8[2 * MAX_SAMPLES];
+static int lengths[CALLS];
+static sample_t ib_expected[2][MAX_SAMPLES], ib_result[2][MAX_SAMPLES];
+
+/* identity, scaled, and the mono downmix lame_init_params() sets up */
+static FLOAT const transforms[3][4] = {
+    {1, 0, 0, 1},
+    {0.5f, 0, 0, 1.25f},
+    {0.5f, 0.5f, 0.5f, 0.5f}
+};
+
+
+static lame_global_flags *
+open_encoder(struct variant const *v)
+{
+    lame_global_flags *gfp = lame_init();
+    lame_internal_flags *gfc;
+
+    lame_set_in_samplerate(gfp, 44100);
+    lame_set_num_channels(gfp, 2);
+    lame_set_brate(gfp, 128);
+    lame_set_quality(gfp, 7);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    gfc = gfp->internal_flags;
+    if (v->copy_short) {
+        gfc->copy_inbuffer_short_core = v->copy_short;
+        gfc->copy_inbuffer_float_core = v->copy_float;
+        gfc->copy_inbuffer_int_core = v->copy_int;
+        gfc->copy_inbuffer_s24_core = v->copy_s24;
+        gfc->copy_inbuffer_u8_core = v->copy_u8;
+    }
+    return gfp;
+}
+
+
+/* from interleaved 16-bit pcm, planar float l and r, or interleaved 24-bit s24 */
+static int
+encode(struct variant const *v, short const *pcm, float const *l, float const *r,
+       unsigned char const *s24, int samples, unsigned char *out, int size)
+{
+    lame_global_flags *gfp = open_encoder(v);
+    int     n = pcm ? lame_encode_buffer_interleaved(gfp, (short *) pcm, samples, out, size)
+        : s24 ? lame_encode_buffer_interleaved_s24le(gfp, s24, samples, out, size)
+        : lame_encode_buffer_ieee_float(gfp, l, r, samples, out, size);
+    if (n >= 0)
+        n += lame_encode_flush(gfp, out + n, size - n);
+    lame_close(gfp);
+    return n;
+}
+
+
+/* one call of the C and the v version of copy_inbuffer_<type>_core, from
+   pcm_<type> */
+#define CHECK(fn, pcm, size) \
+    do { \
+        memset(ib_expected, 0, sizeof(ib_expected)); \
+        memset(ib_result, 0, sizeof(ib_result)); \
+        copy_inbuffer_##fn##_core_c(ib_expected[0], ib_expected[1], pcm, \
+                                    pcm + (jump == 1 ? MAX_SAMPLES : 1) * size, n, jump, \
+                                    transforms[t]); \
+        v->copy_##fn(ib_result[0], ib_result[1], pcm, \
+                     pcm + (jump == 1 ? MAX_SAMPLES : 1) * size, n, jump, transforms[t]); \
+        if (memcmp(ib_expected, ib_result, sizeof(ib_expected))) \
+            return 0; \
+    } while (0)
+
+static int
+check(struct variant const *v)
+{
+    int     i, jump, t;
+
+    for (i = 0; i < CALLS; i++) {
+        int const n = lengths[i];
+        for (jump = 1; jump <= 2; jump++) {
+            for (t = 0; t < 3; t++) {
+                CHECK(short, pcm_s16, 1);
+                CHECK(float, pcm_f32, 1);
+                CHECK(int, pcm_s32, 1);
+                CHECK(s24, pcm_s24, 3);
+                CHECK(u8, pcm_u8, 1);
+            }
+        }
+    }
+    return 1;
+}
+
+
+/* best of a few runs over the interleaved 16-bit, planar float and
+   interleaved 24-bit input */
+static double
+time_calls(struct variant const *v)
+{
+    double  best = 0;
+    int     pass, i;
+
+    for (pass = 0; pass < 5; pass++) {
+        clock_t start = clock();
+        double  t;
+
+        for (i = 0; i < CALLS; i++) {
+            v->copy_short(ib_result[0], ib_result[1], pcm_s16, pcm_s16 + 1, MAX_SAMPLES, 2,
+                          transforms[0]);
+            v->copy_float(ib_result[0], ib_result[1], pcm_f32, pcm_f32 + MAX_SAMPLES,
+                          MAX_SAMPLES, 1, transforms[0]);
+            v->copy_s24(ib_result[0], ib_result[1], pcm_s24, pcm_s24 + 3, MAX_SAMPLES, 2,
+                        transforms[0]);
+        }
+        t = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / (3.0 * CALLS * MAX_SAMPLES);
+        if (pass == 0 || t < best)
+            best = t;
+    }
+    return best;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const seconds = argc > 1 ? atoi(argv[1]) : 20;
+    int const samples = seconds * 44100;
+    int const mp3_size_max = samples + samples / 4 + 7200;
+    short  *pcm = malloc(samples * 2 * sizeof(short));
+    float  *pcm_l = malloc(samples * sizeof(float)), *pcm_r = malloc(samples * sizeof(float));
+    unsigned char *pcm24 = malloc(samples * 6);
+    unsigned char *mp3_expected[3], *mp3 = malloc(mp3_size_max);
+    lame_global_flags *gfp;
+    double  c_time = 0;
+    int     i, k, mp3_size[3], failed = 0;
+    struct variant variants[] = {
+        {"C", 1, copy_inbuffer_short_core_c, copy_inbuffer_float_core_c,
+         copy_inbuffer_int_core_c, copy_inbuffer_s24_core_c, copy_inbuffer_u8_core_c},
+#if defined(HAVE_XMMINTRIN_H)
+        {"sse", 0, copy_inbuffer_short_core_sse, copy_inbuffer_float_core_sse,
+         copy_inbuffer_int_core_sse, copy_inbuffer_s24_core_sse, copy_inbuffer_u8_core_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+        {"avx2", 0, copy_inbuffer_short_core_avx2, copy_inbuffer_float_core_avx2,
+         copy_inbuffer_int_core_avx2, copy_inbuffer_s24_core_avx2, copy_inbuffer_u8_core_avx2},
+#endif
+        {"selected", 1, NULL, NULL, NULL, NULL, NULL}
+    };
+    int const count = sizeof(variants) / sizeof(variants[0]);
+
+    /* which versions this CPU has, and which one lame picks */
+    gfp = open_encoder(&variants[count - 1]);
+    for (i = 1; i < count - 1; i++) {
+        if (!strcmp(variants[i].name, "sse"))
+            variants[i].supported = gfp->internal_flags->CPU_features.SSE2;
+        else if (!strcmp(variants[i].name, "avx2"))
+            variants[i].supported = gfp->internal_flags->CPU_features.AVX2;
+    }
+    variants[count - 1].copy_short = gfp->internal_flags->copy_inbuffer_short_core;
+    variants[count - 1].copy_float = gfp->internal_flags->copy_inbuffer_float_core;
+    variants[count - 1].copy_int = gfp->internal_flags->copy_inbuffer_int_core;
+    variants[count - 1].copy_s24 = gfp->internal_flags->copy_inbuffer_s24_core;
+    variants[count - 1].copy_u8 = gfp->internal_flags->copy_inbuffer_u8_core;
+    lame_close(gfp);
+
+    srand(1);
+    for (i = 0; i < 2 * MAX_SAMPLES; i++) {
+        pcm_s16[i] = (short) (rand() % 65536 - 32768);
+        pcm_f32[i] = (float) (rand() / (double) RAND_MAX * 2 - 1);
+        pcm_s32[i] = (int) ((unsigned int) rand() << 16 ^ (unsigned int) rand());
+        pcm_u8[i] = (unsigned char) rand();
+    }
+    for (i = 0; i < (int) sizeof(pcm_s24); i++)
+        pcm_s24[i] = (unsigned char) rand();
+    for (i = 0; i < CALLS; i++)
+        lengths[i] = i < 64 ? i : rand() % MAX_SAMPLES;
+
+    srand(2);
+    for (i = 0; i < samples; i++) {
+        double const t = i / 44100.0;
+        double const x = 6000 * sin(2 * PI * 440 * t) + 3000 * sin(2 * PI * 3150 * t)
+            + (rand() % 3000 - 1500);
+        pcm[2 * i] = (short) x;
+        pcm[2 * i + 1] = (short) (-0.7 * x + (rand() % 2000 - 1000));
+        pcm_l[i] = pcm[2 * i] / 32768.0f;
+        pcm_r[i] = pcm[2 * i + 1] / 32768.0f;
+        for (k = 0; k < 6; k++)
+            pcm24[6 * i + k] = (unsigned char) (k % 3 == 0 ? rand()
+                                                : pcm[2 * i + k / 3] >> (k % 3 - 1) * 8);
+    }
+    for (k = 0; k < 3; k++) {
+        mp3_expected[k] = malloc(mp3_size_max);
+        mp3_size[k] = encode(&variants[0], k == 0 ? pcm : NULL, pcm_l, pcm_r,
+                             k == 2 ? pcm24 : NULL, samples, mp3_expected[k], mp3_size_max);
+    }
+
+    printf("copy_inbuffer_*_core() on %d random calls, and %d seconds at 128 kbps CBR -q 7\n"
+           "(interleaved 16-bit, planar float, interleaved 24-bit)\n", CALLS, seconds);
+    for (i = 0; i < count; i++) {
+        struct variant const *v = &variants[i];
+        double  copy_ns, frame_ns;
+        clock_t start;
+        int     same;
+
+        if (!v->supported) {
+            printf("%-10s not supported by this CPU\n", v->name);
+            continue;
+        }
+        same = check(v);
+        copy_ns = time_calls(v);
+
+        start = clock();
+        for (k = 0; k < 3; k++) {
+            if (encode(v, k == 0 ? pcm : NULL, pcm_l, pcm_r, k == 2 ? pcm24 : NULL, samples,
+                       mp3, mp3_size_max) != mp3_size[k]
+                || memcmp(mp3, mp3_expected[k], mp3_size[k]))
+                same = 0;
+        }
+        frame_ns = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / (3 * samples / 1152.0);
+
+        failed |= !same;
+        if (i == 0)
+            c_time = copy_ns;
+        printf("%-10s copy %6.3f ns/sample  %5.2fx  encode %7.0f ns/frame  %s\n", v->name,
+               copy_ns, c_time / copy_ns, frame_ns, same ? "bit identical" : "DIFFERENT OUTPUT");
+    }
+
+    free(pcm);
+    free(pcm_l);
+    free(pcm_r);
+    free(pcm24);
+    free(mp3);
+    for (k = 0; k < 3; k++)
+        free(mp3_expected[k]);
+    return failed;
+}
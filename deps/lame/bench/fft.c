@@ -0,0 +1,149 @@
+/*
+ *      Regression test and microbenchmark for the FFTs of the psychoacoustic model
+ *
+ * Runs fft_long() and fft_short() with each of the fft_fht versions this CPU
+ * supports, checks that the spectra are bit identical to those of the C
+ * version, and prints the time per granule: one long and one short block
+ * FFT (of three blocks) for each of two channels, as the psychoacoustic
+ * model does.
+ *
+ *   $ make -C build bench_fft && ./build/Release/bench_fft [granules]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "fft.h"
+#include "lame_intrin.h"
+
+typedef void (*fht_fn) (FLOAT *, int);
+
+struct variant {
+    const char *name;
+    int     supported;
+    fht_fn  fht;
+};
+
+#define CHECK_GRANULES 100
+#define SIGNAL_SIZE ((CHECK_GRANULES + 4) * 576)
+
+struct spectra {
+    FLOAT   l[2][BLKSIZE];
+    FLOAT   s[2][3][BLKSIZE_s];
+};
+
+static sample_t signal[2][SIGNAL_SIZE];
+static struct spectra expected[CHECK_GRANULES], result[CHECK_GRANULES];
+
+
+static void
+granule(lame_internal_flags const *gfc, int g, struct spectra *r)
+{
+    sample_t const *bufp[2];
+    int     ch;
+
+    for (ch = 0; ch < 2; ch++)
+        bufp[ch] = &signal[ch][(g % CHECK_GRANULES) * 576];
+    for (ch = 0; ch < 2; ch++) {
+        fft_long(gfc, r->l[ch], ch, bufp);
+        fft_short(gfc, r->s[ch], ch, bufp);
+    }
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int     granules = argc > 1 ? atoi(argv[1]) : 100000;
+    lame_global_flags *gfp = lame_init();
+    lame_internal_flags *gfc;
+    double  c_time = 0;
+    int     i, g, pass, ch, failed = 0;
+    struct variant variants[] = {
+        {"C", 1, fht},
+#if defined(HAVE_XMMINTRIN_H)
+        {"sse", 0, fht_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+        {"avx2", 0, fht_avx2},
+#endif
+        {"selected", 1, NULL}
+    };
+    int const count = sizeof(variants) / sizeof(variants[0]);
+
+    lame_set_in_samplerate(gfp, 44100);
+    lame_set_num_channels(gfp, 2);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        return 1;
+    }
+    gfc = gfp->internal_flags;
+    variants[count - 1].fht = gfc->fft_fht;
+    for (i = 1; i < count - 1; i++) {
+        if (!strcmp(variants[i].name, "sse"))
+            variants[i].supported = gfc->CPU_features.SSE2;
+        else if (!strcmp(variants[i].name, "avx2"))
+            variants[i].supported = gfc->CPU_features.AVX2;
+    }
+
+    /* tones and noise */
+    srand(1);
+    for (i = 0; i < SIGNAL_SIZE; i++) {
+        double const t = i / 44100.0;
+        double const x = 8000 * sin(2 * PI * 440 * t) + 2000 * sin(2 * PI * 7300 * t);
+        for (ch = 0; ch < 2; ch++)
+            signal[ch][i] = (sample_t) ((ch ? -x : x) + (rand() % 4000 - 2000));
+    }
+
+    gfc->fft_fht = fht;
+    for (g = 0; g < CHECK_GRANULES; g++)
+        granule(gfc, g, &expected[g]);
+
+    printf("fft_long() and fft_short(), 2 channels, %d granules\n", granules);
+    for (i = 0; i < count; i++) {
+        struct variant const *v = &variants[i];
+        double  ns = 0;
+        int     same;
+
+        if (!v->supported) {
+            printf("%-10s not supported by this CPU\n", v->name);
+            continue;
+        }
+        gfc->fft_fht = v->fht;
+        memset(result, 0, sizeof(result));
+        for (g = 0; g < CHECK_GRANULES; g++)
+            granule(gfc, g, &result[g]);
+        same = !memcmp(expected, result, sizeof(result));
+        failed |= !same;
+
+        /* best of a few runs, as this is short */
+        for (pass = 0; pass < 5; pass++) {
+            clock_t const start = clock();
+            double  t;
+            for (g = 0; g < granules; g++)
+                granule(gfc, g, &result[g % CHECK_GRANULES]);
+            t = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / granules;
+            if (pass == 0 || t < ns)
+                ns = t;
+        }
+        if (i == 0)
+            c_time = ns;
+        printf("%-10s %8.0f ns/granule  %5.2fx  %s\n", v->name, ns, c_time / ns,
+               same ? "bit identical" : "DIFFERENT OUTPUT");
+    }
+
+    lame_close(gfp);
+    return failed;
+}
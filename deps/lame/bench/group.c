@@ -0,0 +1,254 @@
+/*
+ *      Encoding many streams one by one vs as a group
+ *
+ * Encodes a number of streams of each of a few configurations chunk by
+ * chunk, as a server of many voice streams would, once with
+ * lame_encode_buffer() of each encoder in turn and once with one
+ * lame_encode_buffer_group() call for the chunks of all of them, and prints
+ * the time per second of audio of a stream either way. Every stream must come
+ * out of the group byte for byte as it does on its own (LAME tag frame
+ * included), otherwise it exits with an error. The last configuration mixes
+ * encoders of one and of two granules per frame in one group.
+ *
+ *   $ make -C build bench_group && ./build/Release/bench_group [streams] [seconds] [chunk ms]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+
+struct config {
+    const char *name;
+    int     in_rate;
+    int     out_rate;
+    MPEG_mode mode;
+    int     quality;
+    vbr_mode vbr;
+    int     brate;
+};
+
+static struct config const configs[] = {
+    {"8 kHz mono, 16 kbps CBR", 8000, 8000, MONO, 5, vbr_off, 16},
+    {"16 kHz mono, 32 kbps CBR", 16000, 16000, MONO, 5, vbr_off, 32},
+    {"48 -> 16 kHz mono, 24 kbps ABR", 48000, 16000, MONO, 5, vbr_abr, 24},
+    {"22.05 kHz joint stereo, q 7, VBR", 22050, 22050, JOINT_STEREO, 7, vbr_default, 0},
+    {"32 kHz mono, 48 kbps CBR", 32000, 32000, MONO, 5, vbr_off, 48},
+    {"44.1 kHz stereo, 128 kbps CBR", 44100, 44100, STEREO, 5, vbr_off, 128},
+    {NULL, 0, 0, MONO, 0, vbr_off, 0}, /* every other stream of the two above */
+};
+
+#define CONFIGS ((int) (sizeof(configs) / sizeof(configs[0])))
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static lame_global_flags *
+open_encoder(struct config const *c)
+{
+    lame_global_flags *gfp = lame_init();
+
+    lame_set_in_samplerate(gfp, c->in_rate);
+    lame_set_out_samplerate(gfp, c->out_rate);
+    lame_set_num_channels(gfp, c->mode == MONO ? 1 : 2);
+    lame_set_mode(gfp, c->mode);
+    lame_set_quality(gfp, c->quality);
+    lame_set_VBR(gfp, c->vbr);
+    if (c->vbr == vbr_abr)
+        lame_set_VBR_mean_bitrate_kbps(gfp, c->brate);
+    else if (c->brate)
+        lame_set_brate(gfp, c->brate);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    return gfp;
+}
+
+
+struct stream {
+    struct config const *cf;
+    lame_global_flags *gfp;
+    short  *pcm;             /* interleaved (lame_encode_buffer_interleaved() takes
+                                two channels even for mono) */
+    int     samples;
+    int     pos;
+    unsigned char *mp3;
+    int     size;
+    int     len;
+};
+
+
+static void
+open_streams(struct stream *s, int streams, int c, int seconds)
+{
+    int     i, k;
+
+    for (i = 0; i < streams; i++) {
+        struct config const *cf = configs[c].name ? &configs[c] : &configs[c - 2 + i % 2];
+
+        s[i].cf = cf;
+        s[i].gfp = open_encoder(cf);
+        /* a bit more or less than the seconds, so they don't end together */
+        s[i].samples = cf->in_rate * seconds + (i * 997) % cf->in_rate;
+        s[i].pcm = malloc(s[i].samples * 2 * sizeof(short));
+        s[i].size = s[i].samples * 5 / 4 + 7200;
+        s[i].mp3 = malloc(s[i].size);
+        if (s[i].pcm == NULL || s[i].mp3 == NULL)
+            exit(1);
+        /* a tone that glides, and some noise */
+        srand(i);
+        for (k = 0; k < s[i].samples * 2; k++)
+            s[i].pcm[k] = (short) (8000 * sin(k * (0.01 + 0.002 * i) + 1e-6 * k * k / s[i].samples)
+                                   + (rand() % 2000) - 1000);
+        s[i].pos = 0;
+        s[i].len = 0;
+    }
+}
+
+
+/* the LAME tag frame written over the first frame */
+static void
+close_streams(struct stream *s, int streams)
+{
+    int     i, r;
+
+    for (i = 0; i < streams; i++) {
+        r = lame_encode_flush(s[i].gfp, s[i].mp3 + s[i].len, s[i].size - s[i].len);
+        if (r < 0)
+            exit(1);
+        s[i].len += r;
+        (void) lame_get_lametag_frame(s[i].gfp, s[i].mp3, s[i].size);
+        lame_close(s[i].gfp);
+        free(s[i].pcm);
+    }
+}
+
+
+/* the number of samples of the next chunk of stream i */
+static int
+chunk(struct stream const *s, int chunk_ms)
+{
+    int const n = s->cf->in_rate * chunk_ms / 1000;
+    return s->samples - s->pos < n ? s->samples - s->pos : n;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const streams = argc > 1 ? atoi(argv[1]) : 64;
+    int const seconds = argc > 2 ? atoi(argv[2]) : 5;
+    int const chunk_ms = argc > 3 ? atoi(argv[3]) : 20;
+    struct stream *alone = calloc(streams, sizeof(*alone));
+    struct stream *group = calloc(streams, sizeof(*group));
+    lame_t *gfp = calloc(streams, sizeof(*gfp));
+    short const **pcm = calloc(streams, sizeof(*pcm));
+    unsigned char **mp3 = calloc(streams, sizeof(*mp3));
+    int    *nsamples = calloc(streams, sizeof(int));
+    int    *size = calloc(streams, sizeof(int));
+    int    *bytes = calloc(streams, sizeof(int));
+    int     c, i;
+
+    if (alone == NULL || group == NULL || gfp == NULL || pcm == NULL || mp3 == NULL
+        || nsamples == NULL || size == NULL || bytes == NULL || streams < 1)
+        return 1;
+
+    printf("%-34s %14s %14s\n", "", "one by one", "group");
+    for (c = 0; c < CONFIGS; c++) {
+        double  alone_s = 0, group_s = 0, audio_s = 0, t;
+        int     left;
+
+        open_streams(alone, streams, c, seconds);
+        open_streams(group, streams, c, seconds);
+        for (i = 0; i < streams; i++)
+            audio_s += (double) alone[i].samples / alone[i].cf->in_rate;
+
+        t = now();
+        do {
+            left = 0;
+            for (i = 0; i < streams; i++) {
+                struct stream *s = &alone[i];
+                int const n = chunk(s, chunk_ms);
+                int     r;
+
+                if (n == 0)
+                    continue;
+                r = lame_encode_buffer_interleaved(s->gfp, s->pcm + s->pos * 2, n,
+                                                   s->mp3 + s->len, s->size - s->len);
+                if (r < 0)
+                    return 1;
+                s->len += r;
+                s->pos += n;
+                left = 1;
+            }
+        } while (left);
+        alone_s = now() - t;
+
+        t = now();
+        do {
+            left = 0;
+            for (i = 0; i < streams; i++) {
+                struct stream *s = &group[i];
+
+                gfp[i] = s->gfp;
+                nsamples[i] = chunk(s, chunk_ms);
+                pcm[i] = s->pcm + s->pos * 2;
+                mp3[i] = s->mp3 + s->len;
+                size[i] = s->size - s->len;
+                left |= nsamples[i] > 0;
+            }
+            if (!left)
+                break;
+            if (lame_encode_buffer_interleaved_group(gfp, streams, pcm, nsamples, mp3, size,
+                                                     bytes) < 0) {
+                fprintf(stderr, "lame_encode_buffer_interleaved_group() failed\n");
+                return 1;
+            }
+            for (i = 0; i < streams; i++) {
+                group[i].len += bytes[i];
+                group[i].pos += nsamples[i];
+            }
+        } while (left);
+        group_s = now() - t;
+
+        close_streams(alone, streams);
+        close_streams(group, streams);
+        for (i = 0; i < streams; i++) {
+            if (alone[i].len != group[i].len || memcmp(alone[i].mp3, group[i].mp3, alone[i].len)) {
+                fprintf(stderr, "%s: stream %d differs (%d vs %d bytes)\n",
+                        configs[c].name ? configs[c].name : "mixed", i, alone[i].len,
+                        group[i].len);
+                return 1;
+            }
+            free(alone[i].mp3);
+            free(group[i].mp3);
+        }
+        printf("%-34s %11.1f us %11.1f us\n", configs[c].name ? configs[c].name : "the two above, mixed",
+               alone_s * 1e6 / audio_s, group_s * 1e6 / audio_s);
+    }
+
+    free(alone);
+    free(group);
+    free(gfp);
+    free(pcm);
+    free(mp3);
+    free(nsamples);
+    free(size);
+    free(bytes);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ *      Heap memory per encoder, and what the shared table cache saves
+ *
+ * Opens a number of encoders of each of a few configurations (one at a
+ * time, all kept open), and prints the heap bytes the first encoder of a
+ * configuration took, and the bytes each further one of the same
+ * configuration took: the first one builds the immutable tables (the
+ * psychoacoustic model constants and the resampling filter bank) that the
+ * others share. Also prints the time lame_init_params() took either way.
+ *
+ * The heap size comes from glibc's mallinfo2(), so it is Linux only.
+ *
+ *   $ make -C build bench_memory && ./build/Release/bench_memory [encoders]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "lame.h"
+
+struct config {
+    const char *name;
+    int     in_rate;
+    int     out_rate;
+    MPEG_mode mode;
+    int     quality;
+    vbr_mode vbr;
+};
+
+static struct config const configs[] = {
+    {"44.1 kHz joint stereo, q 5, CBR", 44100, 44100, JOINT_STEREO, 5, vbr_off},
+    {"44.1 kHz joint stereo, q 2, VBR", 44100, 44100, JOINT_STEREO, 2, vbr_default},
+    {"48 -> 44.1 kHz stereo, q 5, CBR", 48000, 44100, STEREO, 5, vbr_off},
+    {"22.05 kHz mono, q 7, ABR", 22050, 22050, MONO, 7, vbr_abr},
+};
+
+#define CONFIGS ((int) (sizeof(configs) / sizeof(configs[0])))
+
+
+static size_t
+heap_bytes(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo mi = mallinfo();
+    return (size_t) mi.uordblks + (size_t) mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+
+static lame_global_flags *
+open_encoder(struct config const *c, double *seconds)
+{
+    lame_global_flags *gfp = lame_init();
+    clock_t start;
+
+    lame_set_in_samplerate(gfp, c->in_rate);
+    lame_set_out_samplerate(gfp, c->out_rate);
+    lame_set_num_channels(gfp, c->mode == MONO ? 1 : 2);
+    lame_set_mode(gfp, c->mode);
+    lame_set_quality(gfp, c->quality);
+    lame_set_VBR(gfp, c->vbr);
+    start = clock();
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    *seconds += (double) (clock() - start) / CLOCKS_PER_SEC;
+    return gfp;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const n = argc > 1 ? atoi(argv[1]) : 16;
+    lame_global_flags **open = calloc(CONFIGS * n, sizeof(*open));
+    int     c, i;
+
+    if (open == NULL || n < 2)
+        return 1;
+    if (heap_bytes() == 0)
+        printf("no heap statistics on this platform\n");
+
+    printf("%-34s %12s %12s %12s %12s\n", "", "first", "each other", "first", "each other");
+    for (c = 0; c < CONFIGS; c++) {
+        double  first_s = 0, rest_s = 0;
+        size_t  before = heap_bytes(), first;
+
+        open[c * n] = open_encoder(&configs[c], &first_s);
+        first = heap_bytes() - before;
+        before = heap_bytes();
+        for (i = 1; i < n; i++)
+            open[c * n + i] = open_encoder(&configs[c], &rest_s);
+        printf("%-34s %10lu B %10lu B %9.1f us %9.1f us\n", configs[c].name,
+               (unsigned long) first, (unsigned long) ((heap_bytes() - before) / (n - 1)),
+               first_s * 1e6, rest_s * 1e6 / (n - 1));
+    }
+
+    for (i = 0; i < CONFIGS * n; i++)
+        lame_close(open[i]);
+    free(open);
+    return 0;
+}
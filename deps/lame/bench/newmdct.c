@@ -0,0 +1,141 @@
+/*
+ *      Microbenchmark for the analysis filterbank and MDCT (mdct_sub48)
+ *
+ * Runs mdct_sub48() with each of the window_subband_core and mdct_long_core
+ * versions this CPU supports, checks that they all give bit identical
+ * output to the C versions, and prints the time per frame.
+ *
+ *   $ make -C build bench_newmdct && ./build/Release/bench_newmdct [frames]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "newmdct.h"
+#include "lame_intrin.h"
+
+typedef void (*window_subband_fn) (const sample_t *, FLOAT *, FLOAT const (*)[16]);
+typedef void (*mdct_long_fn) (FLOAT *, FLOAT const *, FLOAT const *, int const *,
+                              FLOAT const *, FLOAT const *);
+
+struct variant {
+    const char *name;
+    int     supported;
+    window_subband_fn window_subband_core;
+    mdct_long_fn mdct_long_core;
+};
+
+#define INPUT_SIZE 4096
+
+static sample_t input[2][INPUT_SIZE];
+static FLOAT sb_sample[2][2][18][SBLIMIT];
+static FLOAT expected[2][2][576];
+
+
+static void
+run(lame_internal_flags * gfc, struct variant const *v)
+{
+    gfc->window_subband_core = v->window_subband_core;
+    gfc->mdct_long_core = v->mdct_long_core;
+    memcpy(gfc->sv_enc.sb_sample, sb_sample, sizeof(sb_sample));
+    mdct_sub48(gfc, input[0], input[1]);
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int     frames = argc > 1 ? atoi(argv[1]) : 20000;
+    lame_global_flags *gfp = lame_init();
+    lame_internal_flags *gfc;
+    double  c_time = 0;
+    int     i, j, gr, ch, failed = 0;
+    struct variant variants[] = {
+        {"C", 1, window_subband_core_c, mdct_long_core_c},
+#if defined(HAVE_XMMINTRIN_H)
+        {"window_subband sse", 0, window_subband_core_sse, mdct_long_core_c},
+        {"mdct_long sse", 0, window_subband_core_c, mdct_long_core_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+        {"window_subband avx2", 0, window_subband_core_avx2, mdct_long_core_c},
+        {"window_subband avx512", 0, window_subband_core_avx512, mdct_long_core_c},
+        {"mdct_long avx2", 0, window_subband_core_c, mdct_long_core_avx2},
+#endif
+        {"selected", 1, NULL, NULL}
+    };
+    int const count = sizeof(variants) / sizeof(variants[0]);
+
+    lame_set_in_samplerate(gfp, 44100);
+    lame_set_num_channels(gfp, 2);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        return 1;
+    }
+    gfc = gfp->internal_flags;
+    variants[count - 1].window_subband_core = gfc->window_subband_core;
+    variants[count - 1].mdct_long_core = gfc->mdct_long_core;
+    for (i = 1; i < count - 1; i++) {
+        const char *isa = strrchr(variants[i].name, ' ') + 1;
+        if (!strcmp(isa, "sse"))
+            variants[i].supported = gfc->CPU_features.SSE2;
+        else if (!strcmp(isa, "avx2"))
+            variants[i].supported = gfc->CPU_features.AVX2;
+        else if (!strcmp(isa, "avx512"))
+            variants[i].supported = gfc->CPU_features.AVX512;
+    }
+
+    /* noise, and a history of subband samples to go with it */
+    srand(1);
+    for (ch = 0; ch < 2; ch++)
+        for (j = 0; j < INPUT_SIZE; j++)
+            input[ch][j] = (FLOAT) (rand() % 65536 - 32768);
+    for (j = 0; j < (int) (sizeof(sb_sample) / sizeof(FLOAT)); j++)
+        ((FLOAT *) sb_sample)[j] = (FLOAT) (rand() % 65536 - 32768) / 64;
+
+    run(gfc, &variants[0]);
+    for (gr = 0; gr < 2; gr++)
+        for (ch = 0; ch < 2; ch++)
+            memcpy(expected[gr][ch], gfc->l3_side.tt[gr][ch].xr, sizeof(expected[gr][ch]));
+
+    printf("mdct_sub48(), 44.1 kHz stereo, %d frames\n", frames);
+    for (i = 0; i < count; i++) {
+        struct variant const *v = &variants[i];
+        clock_t start;
+        double  ns;
+        int     same = 1;
+
+        if (!v->supported) {
+            printf("%-24s not supported by this CPU\n", v->name);
+            continue;
+        }
+        run(gfc, v);
+        for (gr = 0; gr < 2; gr++)
+            for (ch = 0; ch < 2; ch++)
+                if (memcmp(expected[gr][ch], gfc->l3_side.tt[gr][ch].xr, sizeof(expected[gr][ch])))
+                    same = 0;
+        failed |= !same;
+
+        start = clock();
+        for (j = 0; j < frames; j++)
+            mdct_sub48(gfc, input[0], input[1]);
+        ns = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / frames;
+        if (i == 0)
+            c_time = ns;
+        printf("%-24s %8.0f ns/frame  %5.2fx  %s\n", v->name, ns, c_time / ns,
+               same ? "bit identical" : "DIFFERENT OUTPUT");
+    }
+
+    lame_close(gfp);
+    return failed;
+}
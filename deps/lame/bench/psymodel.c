@@ -0,0 +1,254 @@
+/*
+ *      Regression test and microbenchmark for the psychoacoustic model
+ *
+ * Runs L3psycho_anal_vbr() with each of the psy_*_core versions this CPU
+ * supports, on a test signal with tones, noise and attacks (so that short
+ * blocks are used too), and checks that the masking thresholds, energies,
+ * perceptual entropies and block types are bit identical to those of the C
+ * versions. It also encodes the signal with each version and compares the
+ * MP3 output, and checks the table the vector versions of the masking
+ * addition use instead of the log table against every ratio it applies to.
+ *
+ *   $ make -C build bench_psymodel && ./build/Release/bench_psymodel [granules]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "psymodel.h"
+#include "lame_intrin.h"
+
+typedef void (*spread_fn) (FLOAT *, FLOAT const *, int const (*)[2], int,
+                           FLOAT const *, FLOAT const *, int const *, PsyMaskAdd_t const *);
+typedef void (*ms_thresholds_fn) (const FLOAT (*)[CBANDS], FLOAT (*)[CBANDS],
+                                  const FLOAT *, const FLOAT *, FLOAT, FLOAT, int);
+
+struct variant {
+    const char *name;
+    int     supported;
+    spread_fn spread;
+    ms_thresholds_fn ms_thresholds;
+};
+
+/* everything L3psycho_anal_vbr() returns for one granule */
+struct psy_result {
+    III_psy_ratio ratio[2][2];
+    III_psy_ratio ratio_ms[2][2];
+    FLOAT   pe[2], pe_ms[2], energy[4];
+    int     blocktype[2];
+};
+
+#define CHECK_GRANULES 400
+#define SIGNAL_SIZE ((CHECK_GRANULES + 8) * 576)
+#define MP3_SIZE (SIGNAL_SIZE + SIGNAL_SIZE / 4 + 7200)
+
+static sample_t signal_f[2][SIGNAL_SIZE];
+static short signal_s[2][SIGNAL_SIZE];
+static struct psy_result expected[CHECK_GRANULES], result[CHECK_GRANULES];
+static unsigned char mp3_expected[MP3_SIZE], mp3[MP3_SIZE];
+
+
+static void
+make_signal(void)
+{
+    int     i, ch;
+
+    srand(1);
+    for (i = 0; i < SIGNAL_SIZE; i++) {
+        double const t = i / 44100.0;
+        double  x = 6000 * sin(2 * PI * 440 * t) + 3000 * sin(2 * PI * 3150 * t)
+            + 1500 * sin(2 * PI * 9800 * t * (1 + t));
+        /* a loud click every 0.3 seconds */
+        if (i % 13230 < 300)
+            x += (rand() % 40000 - 20000) * (1 - (i % 13230) / 300.0);
+        for (ch = 0; ch < 2; ch++) {
+            double  y = (ch ? -0.7 : 1) * x + (rand() % 2000 - 1000);
+            if (y > 32767)
+                y = 32767;
+            if (y < -32768)
+                y = -32768;
+            signal_s[ch][i] = (short) y;
+            signal_f[ch][i] = (sample_t) signal_s[ch][i];
+        }
+    }
+}
+
+
+static lame_global_flags *
+open_encoder(struct variant const *v)
+{
+    lame_global_flags *gfp = lame_init();
+    lame_internal_flags *gfc;
+
+    lame_set_in_samplerate(gfp, 44100);
+    lame_set_num_channels(gfp, 2);
+    lame_set_mode(gfp, JOINT_STEREO);
+    lame_set_VBR(gfp, vbr_default);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    gfc = gfp->internal_flags;
+    if (v->spread) {
+        gfc->psy_spread_core = v->spread;
+        gfc->psy_ms_thresholds_core = v->ms_thresholds;
+    }
+    return gfp;
+}
+
+
+static void
+psy_granule(lame_internal_flags * gfc, int g, struct psy_result *r)
+{
+    sample_t const *bufp[2];
+    int     ch;
+
+    for (ch = 0; ch < 2; ch++)
+        bufp[ch] = &signal_f[ch][(g % CHECK_GRANULES) * 576];
+    L3psycho_anal_vbr(gfc, bufp, g & 1, r->ratio, r->ratio_ms, r->pe, r->pe_ms, r->energy,
+                      r->blocktype);
+}
+
+
+static int
+encode(struct variant const *v, unsigned char *out)
+{
+    lame_global_flags *gfp = open_encoder(v);
+    int     n = lame_encode_buffer(gfp, signal_s[0], signal_s[1], SIGNAL_SIZE, out, MP3_SIZE);
+    if (n >= 0)
+        n += lame_encode_flush(gfp, out + n, MP3_SIZE - n);
+    lame_close(gfp);
+    return n;
+}
+
+
+/* the vector masking addition steps through table2 at ratio_i[], the C one
+   takes the (fast) log of the ratio: compare them for every float ratio */
+static int
+check_mask_add_steps(PsyMaskAdd_t const *ma)
+{
+    union {
+        ieee754_float32_t f;
+        int     i;
+    } r, end;
+    int     wrong = 0;
+
+    r.f = 1;
+    end.f = ma->max_i1;
+    for (; r.i < end.i; r.i++) {
+        int const idx = (int) (FAST_LOG10_X(r.f, 16.0f));
+        int     steps = 0, i;
+        for (i = 1; i < (int) dimension_of(ma->ratio_i); i++)
+            steps += ma->ratio_i[i] <= r.f;
+        if (idx != steps && wrong++ == 0)
+            printf("ratio %.9g: table2 index %d, but %d steps\n", r.f, idx, steps);
+    }
+    return wrong;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int     granules = argc > 1 ? atoi(argv[1]) : 4000;
+    lame_global_flags *gfp;
+    double  c_time = 0;
+    int     i, g, pass, mp3_size, failed = 0;
+    int     short_granules = 0;
+    struct variant variants[] = {
+        {"C", 1, psy_spread_core_c, psy_ms_thresholds_core_c},
+#if defined(HAVE_XMMINTRIN_H)
+        {"sse", 0, psy_spread_core_sse, psy_ms_thresholds_core_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+        {"avx2", 0, psy_spread_core_avx2, psy_ms_thresholds_core_avx2},
+#endif
+        {"selected", 1, NULL, NULL}
+    };
+    int const count = sizeof(variants) / sizeof(variants[0]);
+
+    make_signal();
+
+    /* which versions this CPU has, and which one lame picks */
+    gfp = open_encoder(&variants[count - 1]);
+    for (i = 1; i < count - 1; i++) {
+        if (!strcmp(variants[i].name, "sse"))
+            variants[i].supported = gfp->internal_flags->CPU_features.SSE2;
+        else if (!strcmp(variants[i].name, "avx2"))
+            variants[i].supported = gfp->internal_flags->CPU_features.AVX2;
+    }
+    variants[count - 1].spread = gfp->internal_flags->psy_spread_core;
+    variants[count - 1].ms_thresholds = gfp->internal_flags->psy_ms_thresholds_core;
+    if (check_mask_add_steps(&gfp->internal_flags->cd_psy->mask_add)) {
+        printf("masking addition steps DIFFER from the log table\n");
+        failed = 1;
+    }
+    lame_close(gfp);
+
+    gfp = open_encoder(&variants[0]);
+    for (g = 0; g < CHECK_GRANULES; g++) {
+        psy_granule(gfp->internal_flags, g, &expected[g]);
+        short_granules += expected[g].blocktype[0] != NORM_TYPE;
+    }
+    lame_close(gfp);
+    mp3_size = encode(&variants[0], mp3_expected);
+
+    printf("L3psycho_anal_vbr(), 44.1 kHz joint stereo, %d granules (%d of the first %d"
+           " not long blocks)\n", granules, short_granules, CHECK_GRANULES);
+    for (i = 0; i < count; i++) {
+        struct variant const *v = &variants[i];
+        clock_t start;
+        double  ns;
+        int     same = 1;
+
+        if (!v->supported) {
+            printf("%-10s not supported by this CPU\n", v->name);
+            continue;
+        }
+
+        /* thresholds, from a fresh encoder */
+        gfp = open_encoder(v);
+        memset(result, 0, sizeof(result));
+        for (g = 0; g < CHECK_GRANULES; g++)
+            psy_granule(gfp->internal_flags, g, &result[g]);
+        if (memcmp(expected, result, sizeof(result)))
+            same = 0;
+
+        /* best of a few runs, as this is short */
+        ns = 0;
+        for (pass = 0; pass < 5; pass++) {
+            double  t;
+            start = clock();
+            for (g = 0; g < granules; g++)
+                psy_granule(gfp->internal_flags, g, &result[g % CHECK_GRANULES]);
+            t = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / granules;
+            if (pass == 0 || t < ns)
+                ns = t;
+        }
+        lame_close(gfp);
+
+        /* and the whole encoder */
+        if (encode(v, mp3) != mp3_size || memcmp(mp3, mp3_expected, mp3_size))
+            same = 0;
+
+        failed |= !same;
+        if (i == 0)
+            c_time = ns;
+        printf("%-10s %8.0f ns/granule  %5.2fx  %s\n", v->name, ns, c_time / ns,
+               same ? "bit identical" : "DIFFERENT OUTPUT");
+    }
+
+    return failed;
+}
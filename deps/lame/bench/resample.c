@@ -0,0 +1,294 @@
+/*
+ *      Regression test, microbenchmark and THD+N measurement for the resamplers
+ *
+ * For 48 -> 44.1, 44.1 -> 48, 44.1 -> 22.05 and 44.1 -> 16 kHz, resamples
+ * test tones with LAME's original Blackman FIR (resample_quality 0) and the
+ * polyphase filters (1..3), and prints:
+ *  - THD+N of a 1 kHz tone and one at 80% of the lower Nyquist frequency
+ *    (everything that isn't the tone, relative to the tone)
+ *  - the gain at 90% of the lower Nyquist frequency
+ *  - how much of a tone above the output's Nyquist frequency aliases back
+ *  - the time per output sample of the C, SSE and AVX2 resample_core
+ *    versions this CPU supports (the original FIR has no vector version),
+ *    and whether their output is bit identical to the C version's
+ *
+ * It exits with an error when a vector version's output differs, or when a
+ * polyphase filter's gain at 90% of the lower Nyquist frequency is off by
+ * more than MAX_PASSBAND_DB or its THD+N at 1 kHz is above MAX_THD_N_DB.
+ *
+ *   $ make -C build bench_resample && ./build/Release/bench_resample [seconds]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "lame_intrin.h"
+
+typedef void (*resample_fn) (sample_t *, sample_t const *const *, FLOAT const *const *, int,
+                             int);
+
+struct variant {
+    const char *name;
+    int     supported;
+    resample_fn core;
+};
+
+static struct variant variants[] = {
+    {"C", 1, resample_core_c},
+#if defined(HAVE_XMMINTRIN_H)
+    {"sse", 0, resample_core_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+    {"avx2", 0, resample_core_avx2},
+#endif
+};
+
+#define VARIANTS ((int) (sizeof(variants) / sizeof(variants[0])))
+
+/* what the polyphase filters have to meet, about the original FIR's passband
+   and THD+N at 48 <-> 44.1 kHz */
+#define MAX_PASSBAND_DB 0.5
+#define MAX_THD_N_DB (-100.0)
+
+static int const rates[][2] = {
+    {48000, 44100},
+    {44100, 48000},
+    {44100, 22050},
+    {44100, 16000}
+};
+
+
+static lame_global_flags *
+open_resampler(int in, int out, int quality)
+{
+    lame_global_flags *gfp = lame_init();
+
+    lame_set_in_samplerate(gfp, in);
+    lame_set_out_samplerate(gfp, out);
+    lame_set_num_channels(gfp, 1);
+    lame_set_mode(gfp, MONO);
+    lame_set_resample_quality(gfp, quality);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    return gfp;
+}
+
+
+/* the samples of one channel, through fill_buffer() like lame_encode_buffer()
+   does it; returns the number of output samples, and the time it took in
+   *seconds */
+static int
+resample(int in, int out, int quality, resample_fn core, sample_t const *x, int n, sample_t *y,
+         double *seconds)
+{
+    static sample_t mfbuf[2][4096];
+    sample_t *const mf[2] = { mfbuf[0], mfbuf[1] };
+    lame_global_flags *gfp = open_resampler(in, out, quality);
+    lame_internal_flags *gfc = gfp->internal_flags;
+    int const mf_size = gfc->sv_enc.mf_size;
+    int     count = 0;
+    clock_t start;
+
+    if (core)
+        gfc->resample_core = core;
+    start = clock();
+    while (n > 0) {
+        sample_t const *const in_buffer[2] = { x, x };
+        int     n_in, n_out;
+
+        fill_buffer(gfc, mf, in_buffer, n, &n_in, &n_out);
+        memcpy(y + count, &mfbuf[0][mf_size], n_out * sizeof(sample_t));
+        count += n_out;
+        x += n_in;
+        n -= n_in;
+    }
+    if (seconds)
+        *seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    lame_close(gfp);
+    return count;
+}
+
+
+/* least squares fit of a tone of frequency f (in cycles per sample) and DC
+   to y[from ... to - 1]; returns the tone's and the residual's energy */
+static void
+fit_tone(sample_t const *y, int from, int to, double f, double *tone, double *rest)
+{
+    double  cc = 0, cs = 0, c1 = 0, ss = 0, s1 = 0, n = 0, yc = 0, ys = 0, y1 = 0;
+    double  det, a, b, d;
+    int     k;
+
+    for (k = from; k < to; k++) {
+        double const c = cos(2 * PI * f * k), s = sin(2 * PI * f * k);
+        cc += c * c;
+        cs += c * s;
+        c1 += c;
+        ss += s * s;
+        s1 += s;
+        n += 1;
+        yc += y[k] * c;
+        ys += y[k] * s;
+        y1 += y[k];
+    }
+    /* Cramer's rule on the 3x3 normal equations */
+    det = cc * (ss * n - s1 * s1) - cs * (cs * n - s1 * c1) + c1 * (cs * s1 - ss * c1);
+    a = (yc * (ss * n - s1 * s1) - cs * (ys * n - s1 * y1) + c1 * (ys * s1 - ss * y1)) / det;
+    b = (cc * (ys * n - y1 * s1) - yc * (cs * n - s1 * c1) + c1 * (cs * y1 - ys * c1)) / det;
+    d = (cc * (ss * y1 - s1 * ys) - cs * (cs * y1 - s1 * yc) + c1 * (cs * ys - ss * yc)) / det;
+    *tone = *rest = 0;
+    for (k = from; k < to; k++) {
+        double const t = a * cos(2 * PI * f * k) + b * sin(2 * PI * f * k);
+        *tone += t * t;
+        *rest += (y[k] - t - d) * (y[k] - t - d);
+    }
+}
+
+
+static void
+make_tone(sample_t * x, int n, double f)
+{
+    int     k;
+
+    for (k = 0; k < n; k++)
+        x[k] = (sample_t) (16384 * sin(2 * PI * f * k));
+}
+
+
+/* THD+N in dB of a tone at hz */
+static double
+thd_n(int in, int out, int quality, sample_t * x, sample_t * y, int n, double hz)
+{
+    int     count;
+    double  tone, rest;
+
+    make_tone(x, n, hz / in);
+    count = resample(in, out, quality, NULL, x, n, y, NULL);
+    fit_tone(y, 1000, count - 1000, hz / out, &tone, &rest);
+    return 10 * log10(rest / tone);
+}
+
+
+/* gain in dB of a tone at hz, relative to its input level */
+static double
+gain(int in, int out, int quality, sample_t * x, sample_t * y, int n, double hz)
+{
+    int     count, k;
+    double  energy = 0;
+
+    make_tone(x, n, hz / in);
+    count = resample(in, out, quality, NULL, x, n, y, NULL);
+    for (k = 1000; k < count - 1000; k++)
+        energy += (double) y[k] * y[k];
+    return 10 * log10(energy / (count - 2000) / (16384.0 * 16384.0 / 2));
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const seconds = argc > 1 ? atoi(argv[1]) : 10;
+    int const n = seconds * 48000;
+    sample_t *x = malloc(n * sizeof(sample_t));
+    sample_t *y = malloc(2 * n * sizeof(sample_t)), *y_c = malloc(2 * n * sizeof(sample_t));
+    lame_global_flags *gfp;
+    int     r, q, i, k, failed = 0;
+
+    gfp = open_resampler(48000, 44100, 1);
+    for (i = 1; i < VARIANTS; i++) {
+        if (!strcmp(variants[i].name, "sse"))
+            variants[i].supported = gfp->internal_flags->CPU_features.SSE2;
+        else if (!strcmp(variants[i].name, "avx2"))
+            variants[i].supported = gfp->internal_flags->CPU_features.AVX2;
+    }
+    lame_close(gfp);
+
+    printf("%d seconds of mono; THD+N at 1 kHz and 0.8 x the lower Nyquist frequency (N),\n"
+           "gain at 0.9 N, alias level of a tone between the output's and the input's\n"
+           "Nyquist frequency, and ns per output sample of each resample_core version\n",
+           seconds);
+    for (r = 0; r < (int) (sizeof(rates) / sizeof(rates[0])); r++) {
+        int const in = rates[r][0], out = rates[r][1];
+        int const nin = (int) ((double) n * in / 48000);
+        double const nyquist = 0.5 * (in < out ? in : out);
+
+        printf("\n%d -> %d Hz\n", in, out);
+        printf("quality taps rows  THD+N 1k  THD+N 0.8N  gain 0.9N  alias");
+        for (i = 0; i < VARIANTS; i++)
+            printf("  %6s", variants[i].name);
+        printf("\n");
+        for (q = 0; q <= 3; q++) {
+            double  thd_n_1k, passband;
+            int     count = 0;
+
+            gfp = open_resampler(in, out, q);
+            if (q > 0)
+                printf("%7d %4d %4d ", q, gfp->internal_flags->sv_enc.rs_taps,
+                       gfp->internal_flags->sv_enc.rs_rows);
+            else
+                printf("%7d %4d %4s ", q, 32, "-");
+            lame_close(gfp);
+
+            thd_n_1k = thd_n(in, out, q, x, y, nin, 1000);
+            passband = gain(in, out, q, x, y, nin, 0.9 * nyquist);
+            printf(" %7.1f    %7.1f    %7.2f ",
+                   thd_n_1k, thd_n(in, out, q, x, y, nin, 0.8 * nyquist), passband);
+            if (in > out)
+                printf("%7.1f", gain(in, out, q, x, y, nin, 0.25 * (in + out)));
+            else
+                printf("%7s", "-");
+
+            /* white noise, for the timing and bit identity */
+            srand(1);
+            for (k = 0; k < nin; k++)
+                x[k] = (sample_t) (rand() % 32768 - 16384);
+            for (i = 0; i < VARIANTS; i++) {
+                struct variant const *v = &variants[i];
+                double  ns;
+
+                if (!v->supported || (q == 0 && i > 0)) {
+                    printf("  %6s", "-");
+                    continue;
+                }
+                /* best of 3 */
+                for (k = 0; k < 3; k++) {
+                    double  t;
+
+                    count = resample(in, out, q, q ? v->core : NULL, x, nin, i ? y : y_c, &t);
+                    if (k == 0 || t < ns)
+                        ns = t;
+                }
+                ns *= 1e9 / count;
+                if (i > 0 && memcmp(y, y_c, count * sizeof(sample_t))) {
+                    printf("  %6.2f DIFFERENT OUTPUT", ns);
+                    failed = 1;
+                }
+                else
+                    printf("  %6.2f", ns);
+            }
+            if (q > 0 && (fabs(passband) > MAX_PASSBAND_DB || thd_n_1k > MAX_THD_N_DB)) {
+                printf("  OUT OF LIMITS");
+                failed = 1;
+            }
+            printf("\n");
+        }
+    }
+
+    free(x);
+    free(y);
+    free(y_c);
+    return failed;
+}
@@ -0,0 +1,155 @@
+/*
+ *      Encoding short clips with a new encoder each vs one reset encoder
+ *
+ * Encodes a number of short clips of each of a few configurations, once
+ * with lame_init() + lame_init_params() + lame_close() per clip, and once
+ * with one encoder that lame_reset_stream() readies for the next clip, and
+ * prints the time per clip either way. Every clip must come out of the
+ * reset encoder byte for byte as it does from a new one (LAME tag frame
+ * included), otherwise it exits with an error.
+ *
+ *   $ make -C build bench_reuse && ./build/Release/bench_reuse [clips] [ms]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+
+struct config {
+    const char *name;
+    int     in_rate;
+    int     out_rate;
+    MPEG_mode mode;
+    int     quality;
+    vbr_mode vbr;
+    int     resample_quality;
+};
+
+static struct config const configs[] = {
+    {"44.1 kHz joint stereo, q 5, CBR", 44100, 44100, JOINT_STEREO, 5, vbr_off, 2},
+    {"44.1 kHz joint stereo, q 2, VBR", 44100, 44100, JOINT_STEREO, 2, vbr_default, 2},
+    {"48 -> 44.1 kHz stereo, q 5, CBR", 48000, 44100, STEREO, 5, vbr_off, 2},
+    {"48 -> 32 kHz stereo, Blackman, ABR", 48000, 32000, STEREO, 5, vbr_abr, 0},
+    {"22.05 kHz mono, q 7, ABR", 22050, 22050, MONO, 7, vbr_abr, 2},
+    {"24 kHz mono, q 5, VBR", 24000, 24000, MONO, 5, vbr_default, 2},
+};
+
+#define CONFIGS ((int) (sizeof(configs) / sizeof(configs[0])))
+
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static lame_global_flags *
+open_encoder(struct config const *c)
+{
+    lame_global_flags *gfp = lame_init();
+
+    lame_set_in_samplerate(gfp, c->in_rate);
+    lame_set_out_samplerate(gfp, c->out_rate);
+    lame_set_num_channels(gfp, c->mode == MONO ? 1 : 2);
+    lame_set_mode(gfp, c->mode);
+    lame_set_quality(gfp, c->quality);
+    lame_set_VBR(gfp, c->vbr);
+    lame_set_resample_quality(gfp, c->resample_quality);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    return gfp;
+}
+
+
+/* encodes one clip, with the LAME tag frame written over the first frame */
+static int
+encode_clip(lame_global_flags * gfp, short const *pcm, int samples, unsigned char *mp3, int size)
+{
+    int     n = lame_encode_buffer_interleaved(gfp, (short *) pcm, samples, mp3, size);
+    int     r;
+
+    if (n < 0)
+        return n;
+    r = lame_encode_flush(gfp, mp3 + n, size - n);
+    if (r < 0)
+        return r;
+    (void) lame_get_lametag_frame(gfp, mp3, size);
+    return n + r;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const clips = argc > 1 ? atoi(argv[1]) : 50;
+    int const ms = argc > 2 ? atoi(argv[2]) : 2000;
+    int const max_samples = 48000 / 1000 * ms;
+    int const size = max_samples * 5 / 4 + 7200;
+    short  *pcm = malloc(max_samples * 2 * sizeof(*pcm));
+    unsigned char *fresh = malloc(size), *reused = malloc(size);
+    int     c, i, k;
+
+    if (pcm == NULL || fresh == NULL || reused == NULL || clips < 1)
+        return 1;
+
+    printf("%-34s %14s %14s\n", "", "new encoder", "reset");
+    for (c = 0; c < CONFIGS; c++) {
+        struct config const *cf = &configs[c];
+        lame_global_flags *pooled = open_encoder(cf);
+        double  fresh_s = 0, reset_s = 0, t;
+
+        for (i = 0; i < clips; i++) {
+            /* a different clip each time, of two thirds to all of the length:
+               a tone that glides, and some noise */
+            int const samples = cf->in_rate / 1000 * ms * (2 + i % 5 * 0.25) / 3;
+            int     nf, nr;
+
+            srand(i);
+            for (k = 0; k < samples * 2; k++)
+                pcm[k] = (short) (8000 * sin(k * (0.01 + 0.002 * i) + 1e-6 * k * k / samples)
+                                  + (rand() % 2000) - 1000);
+
+            t = now();
+            {
+                lame_global_flags *gfp = open_encoder(cf);
+                nf = encode_clip(gfp, pcm, samples, fresh, size);
+                lame_close(gfp);
+            }
+            fresh_s += now() - t;
+
+            t = now();
+            if (i > 0 && lame_reset_stream(pooled) < 0) {
+                fprintf(stderr, "lame_reset_stream() failed\n");
+                return 1;
+            }
+            nr = encode_clip(pooled, pcm, samples, reused, size);
+            reset_s += now() - t;
+
+            if (nf < 0 || nf != nr || memcmp(fresh, reused, nf) != 0) {
+                fprintf(stderr, "%s: clip %d differs (%d vs %d bytes)\n", cf->name, i, nf, nr);
+                return 1;
+            }
+        }
+        lame_close(pooled);
+        printf("%-34s %11.1f us %11.1f us\n", cf->name,
+               fresh_s * 1e6 / clips, reset_s * 1e6 / clips);
+    }
+
+    free(pcm);
+    free(fresh);
+    free(reused);
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ *      Regression test and microbenchmark for quantization
+ *
+ * Checks the quantize_lines_xrpow_core, quantize_lines_xrpow_01_core and
+ * quantize_pseudohalf_core versions this CPU supports against the C versions
+ * on random input (many lengths), then encodes a test signal at 128 kbps CBR
+ * -q 2 with each of them, compares the MP3 output and prints the time per
+ * call and per frame.
+ *
+ *   $ make -C build bench_takehiro && ./build/Release/bench_takehiro [seconds]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_global_flags.h"
+#include "quantize_pvt.h"
+#include "lame_intrin.h"
+
+typedef void (*quantize_fn) (unsigned int, FLOAT, const FLOAT *, int *);
+
+struct variant {
+    const char *name;
+    int     supported;
+    quantize_fn quantize;
+    quantize_fn quantize_01;
+    quantize_fn pseudohalf;
+};
+
+#define CALLS 2000
+
+static FLOAT xr[CALLS][576];
+static FLOAT istep[CALLS];
+static int ix[CALLS][576];
+static int lengths[CALLS];
+static int ix_expected[576], ix_result[576];
+
+
+static lame_global_flags *
+open_encoder(struct variant const *v)
+{
+    lame_global_flags *gfp = lame_init();
+    lame_internal_flags *gfc;
+
+    lame_set_in_samplerate(gfp, 44100);
+    lame_set_num_channels(gfp, 2);
+    lame_set_brate(gfp, 128);
+    lame_set_quality(gfp, 2);
+    if (lame_init_params(gfp) < 0) {
+        fprintf(stderr, "lame_init_params() failed\n");
+        exit(1);
+    }
+    gfc = gfp->internal_flags;
+    if (v->quantize) {
+        gfc->quantize_lines_xrpow_core = v->quantize;
+        gfc->quantize_lines_xrpow_01_core = v->quantize_01;
+        gfc->quantize_pseudohalf_core = v->pseudohalf;
+    }
+    return gfp;
+}
+
+
+static int
+encode(struct variant const *v, short *pcm, int samples, unsigned char *out, int size)
+{
+    lame_global_flags *gfp = open_encoder(v);
+    int     n = lame_encode_buffer_interleaved(gfp, pcm, samples, out, size);
+    if (n >= 0)
+        n += lame_encode_flush(gfp, out + n, size - n);
+    lame_close(gfp);
+    return n;
+}
+
+
+/* random input: line magnitudes as init_xrpow() makes them, steps as
+   count_bits() uses them, and quantized values for quantize_pseudohalf_core */
+static void
+make_input(void)
+{
+    int     i, j;
+
+    srand(1);
+    for (i = 0; i < CALLS; i++) {
+        int const gain = 100 + rand() % 120;
+        int const max = i % 24 < 16 ? i % 24 : (1 << (i % 24 - 12)) + rand() % 100;
+        istep[i] = pow(2.0, (gain - 210) * -0.1875);
+        lengths[i] = 2 + 2 * (rand() % 288);
+        for (j = 0; j < 576; j++) {
+            double const x = pow(rand() / (double) RAND_MAX, 3) * 8000;
+            xr[i][j] = (FLOAT) (x / istep[i] * (rand() % 4 ? 0.01 : 1));
+            ix[i][j] = max ? (rand() % 3 ? rand() % (max + 1) : rand() % 2) : 0;
+        }
+        /* the largest value must be there */
+        ix[i][rand() % lengths[i]] = max;
+    }
+}
+
+
+static int
+check(struct variant const *v)
+{
+    int     i;
+
+    for (i = 0; i < CALLS; i++) {
+        quantize_lines_xrpow_core_c(lengths[i], istep[i], xr[i], ix_expected);
+        v->quantize(lengths[i], istep[i], xr[i], ix_result);
+        if (memcmp(ix_expected, ix_result, (lengths[i] & ~1) * sizeof(int)))
+            return 0;
+        quantize_lines_xrpow_01_core_c(lengths[i], istep[i], xr[i], ix_expected);
+        v->quantize_01(lengths[i], istep[i], xr[i], ix_result);
+        if (memcmp(ix_expected, ix_result, lengths[i] * sizeof(int)))
+            return 0;
+        memcpy(ix_expected, ix[i], sizeof(ix_expected));
+        memcpy(ix_result, ix[i], sizeof(ix_result));
+        quantize_pseudohalf_core_c(lengths[i], 1 / istep[i], xr[i], ix_expected);
+        v->pseudohalf(lengths[i], 1 / istep[i], xr[i], ix_result);
+        if (memcmp(ix_expected, ix_result, lengths[i] * sizeof(int)))
+            return 0;
+    }
+    return 1;
+}
+
+
+/* best of a few runs, as these are short */
+static void
+time_calls(struct variant const *v, double *quantize_ns)
+{
+    int     pass, i;
+
+    for (pass = 0; pass < 5; pass++) {
+        clock_t start = clock();
+        double  t;
+
+        for (i = 0; i < CALLS; i++)
+            v->quantize(lengths[i], istep[i], xr[i], ix_result);
+        t = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / CALLS;
+        if (pass == 0 || t < *quantize_ns)
+            *quantize_ns = t;
+    }
+}
+
+
+int
+main(int argc, char **argv)
+{
+    int const seconds = argc > 1 ? atoi(argv[1]) : 20;
+    int const samples = seconds * 44100;
+    int const mp3_size_max = samples + samples / 4 + 7200;
+    short  *pcm = malloc(samples * 2 * sizeof(short));
+    unsigned char *mp3_expected = malloc(mp3_size_max), *mp3 = malloc(mp3_size_max);
+    lame_global_flags *gfp;
+    double  c_time = 0;
+    int     i, mp3_size, failed = 0;
+    struct variant variants[] = {
+        {"C", 1, quantize_lines_xrpow_core_c, quantize_lines_xrpow_01_core_c,
+         quantize_pseudohalf_core_c},
+#if defined(HAVE_XMMINTRIN_H)
+        {"sse", 0, quantize_lines_xrpow_core_sse, quantize_lines_xrpow_01_core_sse,
+         quantize_pseudohalf_core_sse},
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+        {"avx2", 0, quantize_lines_xrpow_core_avx2, quantize_lines_xrpow_01_core_avx2,
+         quantize_pseudohalf_core_avx2},
+#endif
+        {"selected", 1, NULL, NULL, NULL}
+    };
+    int const count = sizeof(variants) / sizeof(variants[0]);
+
+    /* which versions this CPU has, and which one lame picks */
+    gfp = open_encoder(&variants[count - 1]);
+    for (i = 1; i < count - 1; i++) {
+        if (!strcmp(variants[i].name, "sse"))
+            variants[i].supported = gfp->internal_flags->CPU_features.SSE2;
+        else if (!strcmp(variants[i].name, "avx2"))
+            variants[i].supported = gfp->internal_flags->CPU_features.AVX2;
+    }
+    variants[count - 1].quantize = gfp->internal_flags->quantize_lines_xrpow_core;
+    variants[count - 1].quantize_01 = gfp->internal_flags->quantize_lines_xrpow_01_core;
+    variants[count - 1].pseudohalf = gfp->internal_flags->quantize_pseudohalf_core;
+    lame_close(gfp);
+
+    make_input();
+    srand(2);
+    for (i = 0; i < samples; i++) {
+        double const t = i / 44100.0;
+        double const x = 6000 * sin(2 * PI * 440 * t) + 3000 * sin(2 * PI * 3150 * t)
+            + 1500 * sin(2 * PI * 9800 * t * (1 + t / seconds)) + (rand() % 3000 - 1500);
+        pcm[2 * i] = (short) x;
+        pcm[2 * i + 1] = (short) (-0.7 * x + (rand() % 2000 - 1000));
+    }
+    mp3_size = encode(&variants[0], pcm, samples, mp3_expected, mp3_size_max);
+
+    printf("quantize_lines_xrpow_core() on %d random calls,\n"
+           "and %d seconds at 128 kbps CBR -q 2\n", CALLS, seconds);
+    for (i = 0; i < count; i++) {
+        struct variant const *v = &variants[i];
+        double  quantize_ns = 0, frame_ns;
+        clock_t start;
+        int     same;
+
+        if (!v->supported) {
+            printf("%-10s not supported by this CPU\n", v->name);
+            continue;
+        }
+        same = check(v);
+        time_calls(v, &quantize_ns);
+
+        start = clock();
+        if (encode(v, pcm, samples, mp3, mp3_size_max) != mp3_size
+            || memcmp(mp3, mp3_expected, mp3_size))
+            same = 0;
+        frame_ns = (double) (clock() - start) / CLOCKS_PER_SEC * 1e9 / (samples / 1152.0);
+
+        failed |= !same;
+        if (i == 0)
+            c_time = frame_ns;
+        printf("%-10s quantize %5.0f ns  encode %7.0f ns/frame"
+               "  %5.2fx  %s\n", v->name, quantize_ns, frame_ns,
+               c_time / frame_ns, same ? "bit identical" : "DIFFERENT OUTPUT");
+    }
+
+    free(pcm);
+    free(mp3);
+    free(mp3_expected);
+    return failed;
+}
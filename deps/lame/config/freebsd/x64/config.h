@@ -73,6 +73,9 @@
 	typedef long double ieee854_float80_t;
 #endif
 
+/* Define to 1 if you have the <immintrin.h> header file. */
+#define HAVE_IMMINTRIN_H 1
+
 /* add int16_t type */
 #define HAVE_INT16_T 1
 #ifndef HAVE_INT16_T
@@ -224,6 +224,18 @@ float CDECL lame_get_scale_right(const lame_global_flags *);
 int CDECL lame_set_out_samplerate(lame_global_flags *, int);
 int CDECL lame_get_out_samplerate(const lame_global_flags *);
 
+/*
+  filter used to resample when the output sample rate differs from the
+  input's.  The polyphase filters grow with the downsampling ratio, and all
+  of them are flat to 0.5 dB up to 0.9 x the Nyquist frequency.  default = 0
+  0 = Blackman windowed sinc, 32 taps (LAME's original resampler)
+  1 = polyphase Kaiser windowed sinc, 40 taps (fastest)
+  2 = polyphase, 48 taps
+  3 = polyphase, 96 taps (best)
+*/
+int CDECL lame_set_resample_quality(lame_global_flags *, int);
+int CDECL lame_get_resample_quality(const lame_global_flags *);
+
 
 /********************************************************************
  *  general control parameters
@@ -400,6 +412,15 @@ int CDECL lame_get_strict_ISO(const lame_global_flags *);
 int CDECL lame_set_disable_reservoir(lame_global_flags *, int);
 int CDECL lame_get_disable_reservoir(const lame_global_flags *);
 
+/*
+  empty the bit reservoir at the end of frame n (counting from 0, not
+  including the Xing/LAME tag frame), so that frame n+1 does not depend on
+  any earlier frame.  Used to cut a stream into independently encoded
+  segments.  default = -1 (never)
+*/
+int CDECL lame_set_reservoir_barrier(lame_global_flags *, int);
+int CDECL lame_get_reservoir_barrier(const lame_global_flags *);
+
 /* select a different "best quantization" function. default=0  */
 int CDECL lame_set_quant_comp(lame_global_flags *, int);
 int CDECL lame_get_quant_comp(const lame_global_flags *);
@@ -578,6 +599,17 @@ int CDECL lame_get_encoder_delay(const lame_global_flags *);
 */
 int CDECL lame_get_encoder_padding(const lame_global_flags *);
 
+/*
+  bytes of the read-only tables (the psychoacoustic model constants, and the
+  resampling filters) that the encoder shares with the others of the same
+  configuration, rather than holding its own copy of. 0 before
+  lame_init_params().
+*/
+size_t CDECL lame_get_table_bytes(const lame_global_flags *);
+
+/* the number of shared tables of all the encoders, and their total size */
+void CDECL lame_get_table_cache_stats(int *tables, size_t *bytes);
+
 /* size of MPEG frame */
 int CDECL lame_get_framesize(const lame_global_flags *);
 
@@ -837,6 +869,103 @@ int CDECL lame_encode_buffer_int(
         const int           mp3buf_size ); /* number of valid octets in this
                                               stream                        */
 
+/* as lame_encode_buffer_int, but for interleaved int's */
+int CDECL lame_encode_buffer_interleaved_int(
+        lame_t          gfp,
+        const int       pcm[],             /* PCM data for left and right
+                                              channel, interleaved          */
+        const int       nsamples,
+        unsigned char * mp3buf,
+        const int       mp3buf_size);
+
+/* as lame_encode_buffer, but for packed 24 bit little endian samples
+ * (3 bytes each), +/- 2^23 for full scale
+ */
+int CDECL lame_encode_buffer_s24le(
+        lame_t          gfp,
+        const unsigned char pcm_l [],      /* PCM data for left channel     */
+        const unsigned char pcm_r [],      /* PCM data for right channel    */
+        const int       nsamples,
+        unsigned char * mp3buf,
+        const int       mp3buf_size);
+
+int CDECL lame_encode_buffer_interleaved_s24le(
+        lame_t          gfp,
+        const unsigned char pcm[],         /* PCM data for left and right
+                                              channel, interleaved          */
+        const int       nsamples,
+        unsigned char * mp3buf,
+        const int       mp3buf_size);
+
+/* as lame_encode_buffer, but for unsigned 8 bit samples, 128 is silence */
+int CDECL lame_encode_buffer_u8(
+        lame_t          gfp,
+        const unsigned char pcm_l [],      /* PCM data for left channel     */
+        const unsigned char pcm_r [],      /* PCM data for right channel    */
+        const int       nsamples,
+        unsigned char * mp3buf,
+        const int       mp3buf_size);
+
+int CDECL lame_encode_buffer_interleaved_u8(
+        lame_t          gfp,
+        const unsigned char pcm[],         /* PCM data for left and right
+                                              channel, interleaved          */
+        const int       nsamples,
+        unsigned char * mp3buf,
+        const int       mp3buf_size);
+
+/*
+ * OPTIONAL:
+ * lame_encode_buffer() of n encoders at once, each with its own input and
+ * output buffer: nsamples[i] samples of pcm_l[i] and pcm_r[i] go to gfp[i],
+ * which writes mp3bytes[i] bytes to mp3buf[i] (of mp3buf_size[i] bytes).
+ * Meant for many streams of the same settings, e.g. voice: the polyphase
+ * filterbank and the long block FFT of the encoders that have a frame to
+ * encode then run side by side, with one channel in each SIMD lane. The
+ * output of each encoder is the same as from lame_encode_buffer().
+ * Returns 0, or the first error code of one of the encoders, after which
+ * the output of the rest is undefined.
+ */
+int CDECL lame_encode_buffer_group(
+        lame_t const          gfp[],
+        int                   n,           /* number of encoders            */
+        const short int*const pcm_l[],
+        const short int*const pcm_r[],
+        const int             nsamples[],
+        unsigned char*const   mp3buf[],
+        const int             mp3buf_size[],
+        int                   mp3bytes[]);
+
+/* as lame_encode_buffer_group, but for interleaved samples */
+int CDECL lame_encode_buffer_interleaved_group(
+        lame_t const          gfp[],
+        int                   n,
+        const short int*const pcm[],
+        const int             nsamples[],
+        unsigned char*const   mp3buf[],
+        const int             mp3buf_size[],
+        int                   mp3bytes[]);
+
+/* as lame_encode_buffer_group, but for floats as lame_encode_buffer_ieee_float */
+int CDECL lame_encode_buffer_ieee_float_group(
+        lame_t const          gfp[],
+        int                   n,
+        const float*const     pcm_l[],
+        const float*const     pcm_r[],
+        const int             nsamples[],
+        unsigned char*const   mp3buf[],
+        const int             mp3buf_size[],
+        int                   mp3bytes[]);
+
+int CDECL lame_encode_buffer_interleaved_ieee_float_group(
+        lame_t const          gfp[],
+        int                   n,
+        const float*const     pcm[],
+        const int             nsamples[],
+        unsigned char*const   mp3buf[],
+        const int             mp3buf_size[],
+        int                   mp3bytes[]);
+
 
 
 
@@ -890,6 +1019,16 @@ int CDECL lame_encode_flush_nogap(
 int CDECL lame_init_bitstream(
         lame_global_flags *  gfp);    /* global context handle                 */
 
+/*
+ * OPTIONAL:
+ * Resets the encoder after lame_encode_flush() to the state that
+ * lame_init_params() left it in, so that it encodes another stream with the
+ * same settings exactly as a new encoder would, without being closed and set
+ * up again. Writes the id3v2 and Xing headers like lame_init_bitstream().
+ */
+int CDECL lame_reset_stream(
+        lame_global_flags *  gfp);    /* global context handle                 */
+
 
 
 /*
@@ -970,6 +1109,18 @@ void CDECL lame_mp3_tags_fid(lame_global_flags *, FILE* fid);
 size_t CDECL lame_get_lametag_frame(
         const lame_global_flags *, unsigned char* buffer, size_t size);
 
+/*
+ * OPTIONAL:
+ * lame_rescan_lametag rebuilds the frame count, seek table and music CRC
+ * of the LAME-tag from the complete mp3 audio stream in 'buffer' (without
+ * any id3 tags or the tag frame).  Use it before lame_get_lametag_frame
+ * when the stream was pieced together from several encoders with the same
+ * settings, see lame_set_reservoir_barrier.
+ * Returns the number of frames, or -1 on error.
+ */
+int CDECL lame_rescan_lametag(
+        lame_global_flags *, const unsigned char* buffer, size_t size);
+
 /*
  * REQUIRED:
  * final call to free all remaining buffers
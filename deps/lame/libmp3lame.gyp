@@ -61,14 +61,45 @@
 
   'targets': [
 
+    # calculates the constant quantizer and log tables at build time
+    {
+      'target_name': 'lame_calctables',
+      'type': 'executable',
+      'toolsets': [ 'host' ],
+      'sources': [ 'libmp3lame/calctables.c' ],
+      'conditions': [
+        ['OS!="win"', { 'libraries': [ '-lm' ] }],
+      ],
+    },
+
     # liblamevectorroutines
     {
       'target_name': 'lamevectorroutines',
       'product_prefix': 'lib',
       'type': 'static_library',
       'sources': [
-        'libmp3lame/vector/xmm_quantize_sub.c'
+        'libmp3lame/vector/xmm_quantize_sub.c',
+        'libmp3lame/vector/xmm_newmdct.c',
+        'libmp3lame/vector/avx_newmdct.c',
+        'libmp3lame/vector/xmm_psymodel.c',
+        'libmp3lame/vector/avx_psymodel.c',
+        'libmp3lame/vector/xmm_fft.c',
+        'libmp3lame/vector/avx_fft.c',
+        'libmp3lame/vector/xmm_takehiro.c',
+        'libmp3lame/vector/avx_takehiro.c',
+        'libmp3lame/vector/xmm_lame.c',
+        'libmp3lame/vector/avx_lame.c',
+        'libmp3lame/vector/xmm_resample.c',
+        'libmp3lame/vector/avx_resample.c',
+        'libmp3lame/vector/xmm_group.c',
+        'libmp3lame/vector/avx_group.c'
       ],
+      # the vector routines must round exactly like the C ones, so no fused
+      # multiply-adds (AVX-512 has them even without -mfma)
+      'cflags': [ '-ffp-contract=off' ],
+      'xcode_settings': {
+        'OTHER_CFLAGS': [ '-ffp-contract=off' ],
+      },
     },
 
     # libmp3lame
@@ -91,6 +122,7 @@
         'libmp3lame/quantize_pvt.c',
         'libmp3lame/reservoir.c',
         'libmp3lame/set_get.c',
+        'libmp3lame/table_cache.c',
         'libmp3lame/tables.c',
         'libmp3lame/takehiro.c',
         'libmp3lame/util.c',
@@ -99,7 +131,28 @@
       ],
       'dependencies': [
         'lamevectorroutines',
+        'lame_calctables#host',
+      ],
+      'actions': [
+        # one action per header: gyp runs an action of several outputs on every
+        # make, through a stamp that is never written
+        {
+          'action_name': 'calctables_quantize_tables',
+          'inputs': [ '<(PRODUCT_DIR)/lame_calctables<(EXECUTABLE_SUFFIX)' ],
+          'outputs': [ '<(SHARED_INTERMEDIATE_DIR)/lame/quantize_tables.h' ],
+          'action': [ '<(PRODUCT_DIR)/lame_calctables<(EXECUTABLE_SUFFIX)', '<(SHARED_INTERMEDIATE_DIR)/lame', 'quantize_tables.h' ],
+          'message': 'Calculating the LAME tables (quantize_tables.h)',
+        },
+        {
+          'action_name': 'calctables_log_table',
+          'inputs': [ '<(PRODUCT_DIR)/lame_calctables<(EXECUTABLE_SUFFIX)' ],
+          'outputs': [ '<(SHARED_INTERMEDIATE_DIR)/lame/log_table.h' ],
+          'action': [ '<(PRODUCT_DIR)/lame_calctables<(EXECUTABLE_SUFFIX)', '<(SHARED_INTERMEDIATE_DIR)/lame', 'log_table.h' ],
+          'message': 'Calculating the LAME tables (log_table.h)',
+        },
       ],
+      # the tables calctables writes
+      'include_dirs': [ '<(SHARED_INTERMEDIATE_DIR)/lame' ],
       'direct_dependent_settings': {
         'include_dirs': [
           'include',
@@ -118,5 +171,75 @@
       'dependencies': [ 'mp3lame' ],
       'sources': [ 'test.c' ]
     },
+
+    # microbenchmark for the analysis filterbank and MDCT vector routines
+    {
+      'target_name': 'bench_newmdct',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/newmdct.c' ]
+    },
+
+    # regression test and microbenchmark for the psychoacoustic model vector routines
+    {
+      'target_name': 'bench_psymodel',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/psymodel.c' ]
+    },
+
+    # regression test and microbenchmark for the FFT vector routines
+    {
+      'target_name': 'bench_fft',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/fft.c' ]
+    },
+
+    # regression test and microbenchmark for the quantization and bit counting vector routines
+    {
+      'target_name': 'bench_takehiro',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/takehiro.c' ]
+    },
+
+    # regression test and microbenchmark for the input buffer copy vector routines
+    {
+      'target_name': 'bench_copy_inbuffer',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/copy_inbuffer.c' ]
+    },
+
+    # regression test, microbenchmark and THD+N measurement for the resamplers
+    {
+      'target_name': 'bench_resample',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/resample.c' ]
+    },
+
+    # heap bytes and setup time per encoder, with the shared table cache
+    {
+      'target_name': 'bench_memory',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/memory.c' ]
+    },
+
+    # regression test and time per clip for encoders reset with lame_reset_stream()
+    {
+      'target_name': 'bench_reuse',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/reuse.c' ]
+    },
+    {
+      'target_name': 'bench_group',
+      'type': 'executable',
+      'dependencies': [ 'mp3lame' ],
+      'sources': [ 'bench/group.c' ]
+    },
   ]
 }
@@ -896,6 +896,83 @@ skipId3v2(FILE * fpStream)
 
 
 
+/*
+ * lame_rescan_lametag: rebuilds the seek table, stream size and music CRC
+ * that lame_get_lametag_frame() reports, from the complete stream of audio
+ * frames in "mp3buf" (no tags).  The frames must have been encoded with the
+ * same settings as "gfp", e.g. segments of one stream that were encoded in
+ * parallel and joined together.  The encoder delay and padding of "gfp" are
+ * kept as they are.
+ *
+ * Returns the number of frames found, or -1 if "mp3buf" is not a stream of
+ * layer III frames (or "gfp" doesn't write a tag).
+ */
+int
+lame_rescan_lametag(lame_global_flags * gfp, const unsigned char *mp3buf, size_t size)
+{
+    lame_internal_flags *gfc;
+    VBR_seek_info_t *v;
+    size_t  pos = 0;
+
+    if (!is_lame_global_flags_valid(gfp)) {
+        return -1;
+    }
+    gfc = gfp->internal_flags;
+    if (!is_lame_internal_flags_valid(gfc)) {
+        return -1;
+    }
+    if (gfc->cfg.write_lame_tag == 0 || gfc->VBR_seek_table.bag == NULL) {
+        return -1;
+    }
+    v = &gfc->VBR_seek_table;
+    v->nVbrNumFrames = 0;
+    v->nBytesWritten = 0;
+    v->sum = 0;
+    v->seen = 0;
+    v->want = 1;
+    v->pos = 0;
+    gfc->nMusicCRC = 0;
+
+    while (pos + 4 <= size) {
+        unsigned char const *h = mp3buf + pos;
+        int     version, kbps, samplerate, length;
+
+        /* 11 sync bits, layer III */
+        if (h[0] != 0xff || (h[1] & 0xe6) != 0xe2) {
+            return -1;
+        }
+        switch ((h[1] >> 3) & 3) {
+        case 3:
+            version = 1;
+            break;      /* MPEG 1 */
+        case 2:
+            version = 0;
+            break;      /* MPEG 2 */
+        case 0:
+            version = 2;
+            break;      /* MPEG 2.5 */
+        default:
+            return -1;
+        }
+        kbps = bitrate_table[version][h[2] >> 4];
+        samplerate = samplerate_table[version][(h[2] >> 2) & 3];
+        if (kbps <= 0 || samplerate <= 0) {
+            return -1;  /* free format or invalid */
+        }
+        length = (version == 1 ? 144000 : 72000) * kbps / samplerate + ((h[2] >> 1) & 1);
+        if (pos + length > size) {
+            return -1;
+        }
+
+        addVbr(v, kbps);
+        v->nBytesWritten += length;
+        UpdateMusicCRC(&gfc->nMusicCRC, h, length);
+        pos += length;
+    }
+    return pos == size ? (int) v->nVbrNumFrames : -1;
+}
+
+
 size_t
 lame_get_lametag_frame(lame_global_flags const *gfp, unsigned char *buffer, size_t size)
 {
@@ -1095,14 +1095,23 @@ copy_buffer(lame_internal_flags * gfc, unsigned char *buffer, int size, int mp3d
 
 void
 init_bit_stream_w(lame_internal_flags * gfc)
+{
+    gfc->bs.buf = (unsigned char *) malloc(BUFFER_SIZE);
+    gfc->bs.buf_size = BUFFER_SIZE;
+    reset_bit_stream_w(gfc);
+}
+
+/* empties the bit stream buffer and the queue of frame headers, for a new
+   stream with the same buffer */
+void
+reset_bit_stream_w(lame_internal_flags * gfc)
 {
     EncStateVar_t *const esv = &gfc->sv_enc;
 
+    memset(esv->header, 0, sizeof(esv->header));
     esv->h_ptr = esv->w_ptr = 0;
     esv->header[esv->h_ptr].write_timing = 0;
 
-    gfc->bs.buf = (unsigned char *) malloc(BUFFER_SIZE);
-    gfc->bs.buf_size = BUFFER_SIZE;
     gfc->bs.buf_byte_idx = -1;
     gfc->bs.buf_bit_idx = 0;
     gfc->bs.totbit = 0;
@@ -32,6 +32,7 @@ void    add_dummy_byte(lame_internal_flags * gfc, unsigned char val, unsigned in
 int     copy_buffer(lame_internal_flags * gfc, unsigned char *buffer, int buffer_size,
                     int update_crc);
 void    init_bit_stream_w(lame_internal_flags * gfc);
+void    reset_bit_stream_w(lame_internal_flags * gfc);
 void    CRC_writeheader(lame_internal_flags const *gfc, char *buffer);
 int     compute_flushbits(const lame_internal_flags * gfp, int *nbytes);
 
@@ -0,0 +1,187 @@
+/*
+ *      calculates the constant quantizer and log tables at build time
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Writes quantize_tables.h (pow43, adj43asm or adj43, ipow20 and pow20,
+ * which iteration_init() otherwise recalculates for every encoder) and
+ * log_table.h (the table of fast_log2(), which init_log_table() otherwise
+ * calculates once per process) into the directory given, or only the headers
+ * named after it (the gyp build has one action, and so one exact output, per
+ * header). A library built with RUNTIME_TABLES calculates them as before.
+ *
+ * The maths is the same, down to which steps round to float, as FLOAT is
+ * float (see machine.h). Every value is printed with 17 significant digits,
+ * which reads back as the same double and so as the same float.
+ *
+ *   $ calctables <directory> [header...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* as in quantize_pvt.h */
+#define IXMAX_VAL 8206
+#define PRECALC_SIZE (IXMAX_VAL+2)
+#define Q_MAX (256+1)
+#define Q_MAX2 116
+
+/* as in util.c */
+#define LOG2_SIZE       (512)
+
+typedef float FLOAT;
+
+static const char *dir;
+
+static FILE *
+open_header(const char *name, const char *what)
+{
+    char    path[4096];
+    FILE   *f;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "calctables: cannot write %s\n", path);
+        exit(1);
+    }
+    fprintf(f, "/*\n *      %s: %s\n *\n *      generated by calctables.c at build time, do not edit\n */\n",
+            name, what);
+    return f;
+}
+
+static void
+close_header(FILE *f)
+{
+    if (fclose(f) != 0) {
+        fprintf(stderr, "calctables: write error\n");
+        exit(1);
+    }
+}
+
+/* "decl" is what goes before the " =", like "FLOAT   pow43[PRECALC_SIZE]" */
+static void
+table(FILE *f, const char *decl, const FLOAT *v, int n)
+{
+    int     i;
+
+    fprintf(f, "\n%s = {\n", decl);
+    for (i = 0; i < n; i++) {
+        fprintf(f, "%s", i % 4 ? " " : "    ");
+        /* "-0" would read back as +0 */
+        if (v[i] == 0)
+            fprintf(f, "%s", signbit(v[i]) ? "-0.0" : "0.0");
+        else
+            fprintf(f, "%.17g", (double) v[i]);
+        fprintf(f, "%s", i + 1 == n ? "\n" : (i % 4 == 3 ? ",\n" : ","));
+    }
+    fprintf(f, "};\n");
+}
+
+/* iteration_init() */
+static void
+quantize_tables(void)
+{
+    static FLOAT pow20[Q_MAX + Q_MAX2 + 1];
+    static FLOAT ipow20[Q_MAX];
+    static FLOAT pow43[PRECALC_SIZE];
+    static FLOAT adj43asm[PRECALC_SIZE];
+    static FLOAT adj43[PRECALC_SIZE];
+    FILE   *f = open_header("quantize_tables.h", "the tables of the quantizer");
+    int     i;
+
+    pow43[0] = 0.0;
+    for (i = 1; i < PRECALC_SIZE; i++)
+        pow43[i] = pow((FLOAT) i, 4.0 / 3.0);
+
+    adj43asm[0] = 0.0;
+    for (i = 1; i < PRECALC_SIZE; i++)
+        adj43asm[i] = i - 0.5 - pow(0.5 * (pow43[i - 1] + pow43[i]), 0.75);
+
+    for (i = 0; i < PRECALC_SIZE - 1; i++)
+        adj43[i] = (i + 1) - pow(0.5 * (pow43[i] + pow43[i + 1]), 0.75);
+    adj43[i] = 0.5;
+
+    for (i = 0; i < Q_MAX; i++)
+        ipow20[i] = pow(2.0, (double) (i - 210) * -0.1875);
+    for (i = 0; i <= Q_MAX + Q_MAX2; i++)
+        pow20[i] = pow(2.0, (double) (i - 210 - Q_MAX2) * 0.25);
+
+    table(f, "FLOAT   pow20[Q_MAX + Q_MAX2 + 1]", pow20, Q_MAX + Q_MAX2 + 1);
+    table(f, "FLOAT   ipow20[Q_MAX]", ipow20, Q_MAX);
+    table(f, "FLOAT   pow43[PRECALC_SIZE]", pow43, PRECALC_SIZE);
+    fprintf(f, "\n#ifdef TAKEHIRO_IEEE754_HACK\n");
+    table(f, "FLOAT   adj43asm[PRECALC_SIZE]", adj43asm, PRECALC_SIZE);
+    fprintf(f, "#else\n");
+    table(f, "FLOAT   adj43[PRECALC_SIZE]", adj43, PRECALC_SIZE);
+    fprintf(f, "#endif\n");
+    close_header(f);
+}
+
+/* init_log_table() */
+static void
+log_table(void)
+{
+    static FLOAT log_table[LOG2_SIZE + 1];
+    FILE   *f = open_header("log_table.h", "the table of fast_log2()");
+    int     j;
+
+    for (j = 0; j < LOG2_SIZE + 1; j++)
+        log_table[j] = log(1.0f + j / (FLOAT) LOG2_SIZE) / log(2.0f);
+
+    table(f, "static ieee754_float32_t log_table[LOG2_SIZE + 1]", log_table, LOG2_SIZE + 1);
+    close_header(f);
+}
+
+static const struct {
+    const char *name;
+    void    (*write) (void);
+} headers[] = {
+    {"quantize_tables.h", quantize_tables},
+    {"log_table.h", log_table}
+};
+
+#define HEADERS ((int) (sizeof(headers) / sizeof(headers[0])))
+
+int
+main(int argc, char **argv)
+{
+    int     i, h;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: calctables <directory> [header...]\n");
+        return 1;
+    }
+    dir = argv[1];
+    if (argc == 2) {
+        for (h = 0; h < HEADERS; h++)
+            headers[h].write();
+        return 0;
+    }
+    for (i = 2; i < argc; i++) {
+        for (h = 0; h < HEADERS && strcmp(argv[i], headers[h].name) != 0; h++);
+        if (h == HEADERS) {
+            fprintf(stderr, "calctables: no such header: %s\n", argv[i]);
+            return 1;
+        }
+        headers[h].write();
+    }
+    return 0;
+}
@@ -60,7 +60,10 @@ static const FLOAT costab[TRI_SIZE * 2] = {
     9.999811752826011e-01, 6.135884649154475e-03
 };
 
-static void
+/* c1, s1, c2 and s2 of each stage of fht(), for the vector versions */
+FLOAT   fht_twiddle[4][BLKSIZE / 4];
+
+void
 fht(FLOAT * fz, int n)
 {
     const FLOAT *tri = costab;
@@ -288,6 +291,56 @@ fft_long(lame_internal_flags const *const gfc,
     /* BLKSIZE/2 because of 3DNow! ASM routine */
 }
 
+/* fft_long() of the granules of the next frame of gfc->group_lanes channels
+   at once, whose mfbuf[ch] are interleaved in xs: wsamp[j] gets the spectra
+   of channel j for the mode_gr granules, as GroupAnalysis_t has them. "work"
+   holds BLKSIZE * group_lanes floats */
+void
+fft_long_group(lame_internal_flags const *const gfc, FLOAT const *xs, int mode_gr,
+               FLOAT * const *wsamp, FLOAT * work)
+{
+    int const lanes = gfc->group_lanes;
+    FLOAT  *out[MAX_GROUP_LANES];
+    int     gr, j;
+
+    for (gr = 0; gr < mode_gr; gr++) {
+        /* the buffer lame_encode_mp3_frame() gives the psychoacoustic model */
+        gfc->fft_long_group_core(work, xs + (576 + gr * 576 - FFTOFFSET) * lanes, window,
+                                 rv_tbl);
+        for (j = 0; j < lanes; j++)
+            out[j] = wsamp[j] + gr * BLKSIZE;
+        gfc->group_deinterleave(out, work, BLKSIZE);
+    }
+}
+
+/* the twiddle factors of stage kx (2, 8, 32, 128) go to kx + 1..2 kx - 1,
+   computed just as fht() does */
+static void
+init_fht_twiddle(void)
+{
+    const FLOAT *tri = costab;
+    int     i, kx;
+
+    for (kx = 2; kx < BLKSIZE / 4; kx <<= 2) {
+        FLOAT   s1, c1;
+        c1 = tri[0];
+        s1 = tri[1];
+        for (i = 1; i < kx; i++) {
+            FLOAT   c2, s2;
+            c2 = 1 - (2 * s1) * s1;
+            s2 = (2 * s1) * c1;
+            fht_twiddle[0][kx + i] = c1;
+            fht_twiddle[1][kx + i] = s1;
+            fht_twiddle[2][kx + i] = c2;
+            fht_twiddle[3][kx + i] = s2;
+            c2 = c1;
+            c1 = c2 * tri[0] - s1 * tri[1];
+            s1 = c2 * tri[1] + s1 * tri[0];
+        }
+        tri += 2;
+    }
+}
+
 #ifdef HAVE_NASM
 extern void fht_3DN(FLOAT * fz, int n);
 extern void fht_SSE(FLOAT * fz, int n);
@@ -308,6 +361,8 @@ init_fft(lame_internal_flags * const gfc)
     for (i = 0; i < BLKSIZE_s / 2; i++)
         window_s[i] = 0.5 * (1.0 - cos(2.0 * PI * (i + 0.5) / BLKSIZE_s));
 
+    init_fht_twiddle();
+
     gfc->fft_fht = fht;
 #ifdef HAVE_NASM
     if (gfc->CPU_features.AMD_3DNow) {
@@ -320,10 +375,13 @@ init_fft(lame_internal_flags * const gfc)
         gfc->fft_fht = fht;
     }
 #else
-#ifdef HAVE_XMMINTRIN_H
-#ifdef MIN_ARCH_SSE
-    gfc->fft_fht = fht_SSE2;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2)
+        gfc->fft_fht = fht_sse;
 #endif
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2)
+        gfc->fft_fht = fht_avx2;
 #endif
 #endif
 }
@@ -28,8 +28,16 @@ void    fft_long(lame_internal_flags const *const gfc, FLOAT x_real[BLKSIZE],
 void    fft_short(lame_internal_flags const *const gfc, FLOAT x_real[3][BLKSIZE_s],
                   int chn, const sample_t *const data[2]);
 
+void    fft_long_group(lame_internal_flags const *const gfc, FLOAT const *xs, int mode_gr,
+                       FLOAT * const *wsamp, FLOAT * work);
+
 void    init_fft(lame_internal_flags * const gfc);
 
+/* the C version of gfc->fft_fht */
+void    fht(FLOAT * fz, int n);
+
+extern FLOAT fht_twiddle[4][BLKSIZE / 4];
+
 #endif
 
 /* End of fft.h */
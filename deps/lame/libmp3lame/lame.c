@@ -42,10 +42,13 @@
 #include "quantize_pvt.h"
 #include "set_get.h"
 #include "quantize.h"
+#include "newmdct.h"
+#include "fft.h"
 #include "psymodel.h"
 #include "version.h"
 #include "VbrTag.h"
 #include "tables.h"
+#include "vector/lame_intrin.h"
 
 
 #if defined(__FreeBSD__) && !defined(__alpha__)
@@ -63,6 +66,9 @@
 
 #define LAME_DEFAULT_QUALITY 3
 
+static void init_copy_inbuffer(lame_internal_flags * gfc);
+static void init_group(lame_internal_flags * gfc);
+
 
 
 int
@@ -572,11 +578,17 @@ lame_init_params(lame_global_flags * gfp)
     if (gfp->asm_optimizations.sse) {
         gfc->CPU_features.SSE = has_SSE();
         gfc->CPU_features.SSE2 = has_SSE2();
+        gfc->CPU_features.AVX2 = has_AVX2();
+        gfc->CPU_features.AVX512 = has_AVX512();
     }
     else {
         gfc->CPU_features.SSE = 0;
         gfc->CPU_features.SSE2 = 0;
+        gfc->CPU_features.AVX2 = 0;
+        gfc->CPU_features.AVX512 = 0;
     }
+    init_copy_inbuffer(gfc);
+    init_group(gfc);
 
 
     if (NULL == gfc->ATH)
@@ -823,10 +835,12 @@ lame_init_params(lame_global_flags * gfp)
 #endif
 
     cfg->disable_reservoir = gfp->disable_reservoir;
+    cfg->reservoir_barrier = gfp->reservoir_barrier;
     cfg->lowpassfreq = gfp->lowpassfreq;
     cfg->highpassfreq = gfp->highpassfreq;
     cfg->samplerate_in = gfp->samplerate_in;
     cfg->samplerate_out = gfp->samplerate_out;
+    cfg->resample_quality = gfp->resample_quality;
     cfg->mode_gr = cfg->samplerate_out <= 24000 ? 1 : 2; /* Number of granules per frame */
     gfc->ov_enc.encoder_delay = ENCDELAY;
 
@@ -1298,7 +1312,10 @@ lame_init_params(lame_global_flags * gfp)
     (void) lame_init_bitstream(gfp);
 
     iteration_init(gfc);
+    mdct_sub48_init(gfc);
     (void) psymodel_init(gfp);
+    if (init_resample(gfc) < 0)
+        return -2;
 
     cfg->buffer_constraint = get_max_frame_buffer_size_by_constraint(cfg, gfp->strict_ISO);
     return 0;
@@ -1352,11 +1369,7 @@ lame_print_config(const lame_global_flags * gfp)
 # endif
 #endif
         if (gfc->CPU_features.MMX) {
-#ifdef MMX_choose_table
-            concatSep(text, ", ", "MMX (ASM used)");
-#else
             concatSep(text, ", ", "MMX");
-#endif
         }
         if (gfc->CPU_features.AMD_3DNow) {
             concatSep(text, ", ", (fft_asm_used == 1) ? "3DNow! (ASM used)" : "3DNow!");
@@ -1371,6 +1384,12 @@ lame_print_config(const lame_global_flags * gfp)
         if (gfc->CPU_features.SSE2) {
             concatSep(text, ", ", (fft_asm_used == 3) ? "SSE2 (ASM used)" : "SSE2");
         }
+        if (gfc->CPU_features.AVX2) {
+            concatSep(text, ", ", "AVX2");
+        }
+        if (gfc->CPU_features.AVX512) {
+            concatSep(text, ", ", "AVX-512");
+        }
         MSGF(gfc, "CPU features: %s\n", text);
     }
 
@@ -1381,6 +1400,11 @@ lame_print_config(const lame_global_flags * gfp)
     if (isResamplingNecessary(cfg)) {
         MSGF(gfc, "Resampling:  input %g kHz  output %g kHz\n",
              1.e-3 * in_samplerate, 1.e-3 * out_samplerate);
+        if (cfg->resample_quality == 0)
+            MSGF(gfc, "Using Blackman windowed sinc resampling filter\n");
+        else
+            MSGF(gfc, "Using polyphase resampling filter, %d taps, %d phases\n",
+                 gfc->sv_enc.rs_taps, gfc->sv_enc.rs_rows);
     }
 
     if (cfg->highpass2 > 0.)
@@ -1671,6 +1695,137 @@ calcNeeded(SessionConfig_t const * cfg)
 }
 
 
+/* the state of a lame_encode_buffer_sample_t() call for one encoder, which
+   lame_encode_buffer_group() has for each of its encoders */
+typedef struct {
+    lame_internal_flags *gfc;
+    sample_t *in_buffer[2];  /* the samples left to encode... */
+    int     nsamples;        /* ...and how many */
+    unsigned char *mp3buf;   /* pointer to current location in buffer */
+    int     mp3buf_size;     /* size of original mp3 output buffer */
+    int     mp3size;         /* size of data written to buffer so far */
+} encode_call_t;
+
+
+static int
+encode_call_begin(encode_call_t * ec, lame_internal_flags * gfc, int nsamples,
+                  unsigned char *mp3buf, const int mp3buf_size)
+{
+    int     mp3out;
+
+    if (gfc->class_id != LAME_ID)
+        return -3;
+
+    ec->gfc = gfc;
+    ec->in_buffer[0] = gfc->sv_enc.in_buffer_0;
+    ec->in_buffer[1] = gfc->sv_enc.in_buffer_1;
+    ec->nsamples = nsamples;
+    ec->mp3buf = mp3buf;
+    ec->mp3buf_size = mp3buf_size;
+    ec->mp3size = 0;
+
+    if (nsamples == 0)
+        return 0;
+
+    /* copy out any tags that may have been written into bitstream */
+    mp3out = copy_buffer(gfc, mp3buf, mp3buf_size, 0);
+    if (mp3out < 0)
+        return mp3out;  /* not enough buffer space */
+    ec->mp3buf += mp3out;
+    ec->mp3size += mp3out;
+    return 0;
+}
+
+
+/* copies in the next samples: returns 1 if a frame is to be encoded then */
+static int
+encode_call_fill(encode_call_t * ec)
+{
+    lame_internal_flags *const gfc = ec->gfc;
+    SessionConfig_t const *const cfg = &gfc->cfg;
+    EncStateVar_t *const esv = &gfc->sv_enc;
+    sample_t *const mfbuf[2] = { esv->mfbuf[0], esv->mfbuf[1] };
+    sample_t const *in_buffer_ptr[2];
+    int     n_in = 0;    /* number of input samples processed with fill_buffer */
+    int     n_out = 0;   /* number of samples output with fill_buffer */
+    /* n_in <> n_out if we are resampling */
+
+    in_buffer_ptr[0] = ec->in_buffer[0];
+    in_buffer_ptr[1] = ec->in_buffer[1];
+    /* copy in new samples into mfbuf, with resampling */
+    fill_buffer(gfc, mfbuf, &in_buffer_ptr[0], ec->nsamples, &n_in, &n_out);
+
+    /* compute ReplayGain of resampled input if requested */
+    if (cfg->findReplayGain && !cfg->decode_on_the_fly)
+        if (AnalyzeSamples
+            (gfc->sv_rpg.rgdata, &mfbuf[0][esv->mf_size], &mfbuf[1][esv->mf_size], n_out,
+             cfg->channels_out) == GAIN_ANALYSIS_ERROR)
+            return -6;
+
+
+
+    /* update in_buffer counters */
+    ec->nsamples -= n_in;
+    ec->in_buffer[0] += n_in;
+    if (cfg->channels_out == 2)
+        ec->in_buffer[1] += n_in;
+
+    /* update mfbuf[] counters */
+    esv->mf_size += n_out;
+    assert(esv->mf_size <= MFSIZE);
+    
+    /* lame_encode_flush may have set gfc->mf_sample_to_encode to 0
+     * so we have to reinitialize it here when that happened.
+     */
+    if (esv->mf_samples_to_encode < 1) {
+        esv->mf_samples_to_encode = ENCDELAY + POSTDELAY;
+    }        
+    esv->mf_samples_to_encode += n_out;
+
+    return esv->mf_size >= calcNeeded(cfg);
+}
+
+
+/* encodes the frame at the start of mfbuf[] */
+static int
+encode_call_frame(encode_call_t * ec)
+{
+    lame_internal_flags *const gfc = ec->gfc;
+    SessionConfig_t const *const cfg = &gfc->cfg;
+    EncStateVar_t *const esv = &gfc->sv_enc;
+    int const pcm_samples_per_frame = 576 * cfg->mode_gr;
+    int     ret, i, ch;
+
+    /* encode the frame.  */
+    /* mp3buf              = pointer to current location in buffer */
+    /* mp3buf_size         = size of original mp3 output buffer */
+    /*                     = 0 if we should not worry about the */
+    /*                       buffer size because calling program is  */
+    /*                       to lazy to compute it */
+    /* mp3size             = size of data written to buffer so far */
+    /* mp3buf_size-mp3size = amount of space avalable  */
+
+    int     buf_size = ec->mp3buf_size - ec->mp3size;
+    if (ec->mp3buf_size == 0)
+        buf_size = 0;
+
+    ret = lame_encode_mp3_frame(gfc, esv->mfbuf[0], esv->mfbuf[1], ec->mp3buf, buf_size);
+
+    if (ret < 0)
+        return ret;
+    ec->mp3buf += ret;
+    ec->mp3size += ret;
+
+    /* shift out old samples */
+    esv->mf_size -= pcm_samples_per_frame;
+    esv->mf_samples_to_encode -= pcm_samples_per_frame;
+    for (ch = 0; ch < cfg->channels_out; ch++)
+        for (i = 0; i < esv->mf_size; i++)
+            esv->mfbuf[ch][i] = esv->mfbuf[ch][i + pcm_samples_per_frame];
+    return 0;
+}
+
+
 /*
  * THE MAIN LAME ENCODING INTERFACE
  * mt 3/00
@@ -1695,106 +1850,160 @@ static int
 lame_encode_buffer_sample_t(lame_internal_flags * gfc,
                             int nsamples, unsigned char *mp3buf, const int mp3buf_size)
 {
-    SessionConfig_t const *const cfg = &gfc->cfg;
-    EncStateVar_t *const esv = &gfc->sv_enc;
-    int     pcm_samples_per_frame = 576 * cfg->mode_gr;
-    int     mp3size = 0, ret, i, ch, mf_needed;
-    int     mp3out;
-    sample_t *mfbuf[2];
-    sample_t *in_buffer[2];
-
-    if (gfc->class_id != LAME_ID)
-        return -3;
-
-    if (nsamples == 0)
-        return 0;
-
-    /* copy out any tags that may have been written into bitstream */
-    mp3out = copy_buffer(gfc, mp3buf, mp3buf_size, 0);
-    if (mp3out < 0)
-        return mp3out;  /* not enough buffer space */
-    mp3buf += mp3out;
-    mp3size += mp3out;
+    encode_call_t ec;
+    int     ret;
 
-    in_buffer[0] = esv->in_buffer_0;
-    in_buffer[1] = esv->in_buffer_1;
+    ret = encode_call_begin(&ec, gfc, nsamples, mp3buf, mp3buf_size);
+    if (ret < 0)
+        return ret;
 
-    mf_needed = calcNeeded(cfg);
+    while (ec.nsamples > 0) {
+        ret = encode_call_fill(&ec);
+        if (ret > 0)
+            ret = encode_call_frame(&ec);
+        if (ret < 0)
+            return ret;
+    }
+    assert(ec.nsamples == 0);
 
-    mfbuf[0] = esv->mfbuf[0];
-    mfbuf[1] = esv->mfbuf[1];
-
-    while (nsamples > 0) {
-        sample_t const *in_buffer_ptr[2];
-        int     n_in = 0;    /* number of input samples processed with fill_buffer */
-        int     n_out = 0;   /* number of samples output with fill_buffer */
-        /* n_in <> n_out if we are resampling */
-
-        in_buffer_ptr[0] = in_buffer[0];
-        in_buffer_ptr[1] = in_buffer[1];
-        /* copy in new samples into mfbuf, with resampling */
-        fill_buffer(gfc, mfbuf, &in_buffer_ptr[0], nsamples, &n_in, &n_out);
-
-        /* compute ReplayGain of resampled input if requested */
-        if (cfg->findReplayGain && !cfg->decode_on_the_fly)
-            if (AnalyzeSamples
-                (gfc->sv_rpg.rgdata, &mfbuf[0][esv->mf_size], &mfbuf[1][esv->mf_size], n_out,
-                 cfg->channels_out) == GAIN_ANALYSIS_ERROR)
-                return -6;
-
-
-
-        /* update in_buffer counters */
-        nsamples -= n_in;
-        in_buffer[0] += n_in;
-        if (cfg->channels_out == 2)
-            in_buffer[1] += n_in;
-
-        /* update mfbuf[] counters */
-        esv->mf_size += n_out;
-        assert(esv->mf_size <= MFSIZE);
-        
-        /* lame_encode_flush may have set gfc->mf_sample_to_encode to 0
-         * so we have to reinitialize it here when that happened.
-         */
-        if (esv->mf_samples_to_encode < 1) {
-            esv->mf_samples_to_encode = ENCDELAY + POSTDELAY;
-        }        
-        esv->mf_samples_to_encode += n_out;
+    return ec.mp3size;
+}
 
 
-        if (esv->mf_size >= mf_needed) {
-            /* encode the frame.  */
-            /* mp3buf              = pointer to current location in buffer */
-            /* mp3buf_size         = size of original mp3 output buffer */
-            /*                     = 0 if we should not worry about the */
-            /*                       buffer size because calling program is  */
-            /*                       to lazy to compute it */
-            /* mp3size             = size of data written to buffer so far */
-            /* mp3buf_size-mp3size = amount of space avalable  */
+/* window_subband() and fft_long() of the next frame of the encoders of a
+ * lame_encode_buffer_group() call that have one ("due"), group_lanes channels
+ * of the same number of granules at a time, whichever encoder they are of.
+ * The rest of a group_lanes that is less than half full is left to the
+ * encoders themselves. "scratch" holds GROUP_SCRATCH floats */
+#define GROUP_SCRATCH ((MFSIZE + BLKSIZE + 18 * SBLIMIT) * MAX_GROUP_LANES \
+                       + 2 * (18 * SBLIMIT + BLKSIZE))
 
-            int     buf_size = mp3buf_size - mp3size;
-            if (mp3buf_size == 0)
-                buf_size = 0;
+static void
+group_analysis(encode_call_t const *ec, int const *due, int n, FLOAT * scratch)
+{
+    int const lanes = ec[0].gfc->group_lanes;
+    FLOAT  *const xs = scratch;
+    FLOAT  *const work = xs + MFSIZE * lanes;
+    FLOAT  *const spare_sb = work + (BLKSIZE + 18 * SBLIMIT) * lanes;
+    FLOAT  *const spare_wsamp = spare_sb + 2 * 18 * SBLIMIT;
+    int     mode_gr;
+
+    for (mode_gr = 1; mode_gr <= 2; mode_gr++) {
+        sample_t const *x[MAX_GROUP_LANES];
+        FLOAT  *sb[MAX_GROUP_LANES], *wsamp[MAX_GROUP_LANES];
+        int    *ready[MAX_GROUP_LANES];
+        int     count = 0, i = 0, ch = 0, j, mf_needed = 0;
+
+        for (;;) {
+            /* the next channel */
+            for (; i < n; i++, ch = 0) {
+                lame_internal_flags *const gfc = ec[i].gfc;
+                if (!due[i] || gfc->cfg.mode_gr != mode_gr || !gfc->lame_encode_frame_init)
+                    continue;
+                if (ch < gfc->cfg.channels_out) {
+                    if (gfc->group == NULL)
+                        gfc->group = calloc(1, sizeof(GroupAnalysis_t));
+                    if (gfc->group == NULL)
+                        continue;
+                    break;
+                }
+            }
+            if (i < n) {
+                lame_internal_flags *const gfc = ec[i].gfc;
+                x[count] = gfc->sv_enc.mfbuf[ch];
+                sb[count] = gfc->group->sb_sample[ch][0][0];
+                wsamp[count] = gfc->group->wsamp_L[ch][0];
+                ready[count] = &gfc->group->ready[ch];
+                mf_needed = calcNeeded(&gfc->cfg);
+                count++;
+                ch++;
+                if (count < lanes)
+                    continue;
+            }
+            else if (count * 2 < lanes) {
+                break;
+            }
 
-            ret = lame_encode_mp3_frame(gfc, mfbuf[0], mfbuf[1], mp3buf, buf_size);
+            /* the unused lanes of the last ones repeat a channel */
+            for (j = count; j < lanes; j++) {
+                x[j] = x[0];
+                sb[j] = spare_sb;
+                wsamp[j] = spare_wsamp;
+            }
+            ec[0].gfc->group_interleave(xs, x, mf_needed);
+            mdct_sub48_group(ec[0].gfc, xs, mode_gr, sb, work);
+            fft_long_group(ec[0].gfc, xs, mode_gr, wsamp, work);
+            for (j = 0; j < count; j++)
+                *ready[j] = 1;
+            if (i == n)
+                break;
+            count = 0;
+        }
+    }
+}
 
-            if (ret < 0)
-                return ret;
-            mp3buf += ret;
-            mp3size += ret;
 
-            /* shift out old samples */
-            esv->mf_size -= pcm_samples_per_frame;
-            esv->mf_samples_to_encode -= pcm_samples_per_frame;
-            for (ch = 0; ch < cfg->channels_out; ch++)
-                for (i = 0; i < esv->mf_size; i++)
-                    mfbuf[ch][i] = mfbuf[ch][i + pcm_samples_per_frame];
-        }
+/* lame_encode_buffer_sample_t() of n encoders at once, in lock step: each
+   copies in its next samples, then the ones that have a frame to encode
+   then do the analysis of it together, and then encode it */
+static int
+lame_encode_group_sample_t(lame_internal_flags * const *gfc, int n, int const *nsamples,
+                           unsigned char *const *mp3buf, int const *mp3buf_size,
+                           int *mp3bytes)
+{
+    encode_call_t *ec;
+    int    *due;
+    FLOAT  *scratch = NULL;
+    int     ret = 0, left, i;
+
+    ec = calloc(n, sizeof(encode_call_t));
+    due = calloc(n, sizeof(int));
+    if (ec == NULL || due == NULL) {
+        ret = -2;
+        goto done;
+    }
+    for (i = 0; i < n && ret == 0; i++) {
+        ret = encode_call_begin(&ec[i], gfc[i], nsamples[i], mp3buf[i], mp3buf_size[i]);
+        if (gfc[i]->group_lanes != gfc[0]->group_lanes)
+            ret = -3;
     }
-    assert(nsamples == 0);
+    if (ret < 0)
+        goto done;
+    if (n > 1 && gfc[0]->group_lanes > 0)
+        scratch = malloc(GROUP_SCRATCH * sizeof(FLOAT));
+
+    do {
+        left = 0;
+        for (i = 0; i < n; i++) {
+            due[i] = 0;
+            if (ec[i].nsamples > 0) {
+                ret = encode_call_fill(&ec[i]);
+                if (ret < 0)
+                    goto done;
+                due[i] = ret;
+                left |= ec[i].nsamples > 0;
+            }
+        }
+        if (scratch)
+            group_analysis(ec, due, n, scratch);
+        for (i = 0; i < n; i++) {
+            if (due[i]) {
+                ret = encode_call_frame(&ec[i]);
+                if (gfc[i]->group)
+                    gfc[i]->group->ready[0] = gfc[i]->group->ready[1] = 0;
+                if (ret < 0)
+                    goto done;
+            }
+        }
+    } while (left);
 
-    return mp3size;
+    for (i = 0; i < n; i++)
+        mp3bytes[i] = ec[i].mp3size;
+  done:
+    free(scratch);
+    free(due);
+    free(ec);
+    return ret;
 }
 
 enum PCMSampleType 
@@ -1803,57 +2012,156 @@ enum PCMSampleType
 ,   pcm_long_type
 ,   pcm_float_type
 ,   pcm_double_type
+,   pcm_s24_type
+,   pcm_u8_type
 };
 
+/* make a copy of input buffer, changing type to sample_t, and apply the
+   user defined re-scaling m = { m[0][0], m[0][1], m[1][0], m[1][1] }.
+   A sample is SAMPLE(p) of SIZE elements of type T */
+#define COPY_AND_TRANSFORM_AS(T, SIZE, SAMPLE) \
+{ \
+    T const *bl = l, *br = r; \
+    int     i; \
+    for (i = 0; i < n; i++) { \
+        sample_t const xl = SAMPLE(bl); \
+        sample_t const xr = SAMPLE(br); \
+        sample_t const u = xl * m[0] + xr * m[1]; \
+        sample_t const v = xl * m[2] + xr * m[3]; \
+        ib0[i] = u; \
+        ib1[i] = v; \
+        bl += jump * SIZE; \
+        br += jump * SIZE; \
+    } \
+}
+#define COPY_AND_TRANSFORM(T) COPY_AND_TRANSFORM_AS(T, 1, *)
+
+void
+copy_inbuffer_short_core_c(sample_t * ib0, sample_t * ib1, const short *l, const short *r,
+                           int n, int jump, FLOAT const *m)
+{
+    COPY_AND_TRANSFORM(short int);
+}
+
+void
+copy_inbuffer_float_core_c(sample_t * ib0, sample_t * ib1, const float *l, const float *r,
+                           int n, int jump, FLOAT const *m)
+{
+    COPY_AND_TRANSFORM(float);
+}
+
+void
+copy_inbuffer_int_core_c(sample_t * ib0, sample_t * ib1, const int *l, const int *r,
+                         int n, int jump, FLOAT const *m)
+{
+    COPY_AND_TRANSFORM(int);
+}
+
+void
+copy_inbuffer_s24_core_c(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                         const unsigned char *r, int n, int jump, FLOAT const *m)
+{
+    COPY_AND_TRANSFORM_AS(unsigned char, 3, PCM_S24LE);
+}
+
+void
+copy_inbuffer_u8_core_c(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                        const unsigned char *r, int n, int jump, FLOAT const *m)
+{
+    COPY_AND_TRANSFORM_AS(unsigned char, 1, PCM_U8);
+}
+
+static void
+init_copy_inbuffer(lame_internal_flags * gfc)
+{
+    gfc->copy_inbuffer_short_core = copy_inbuffer_short_core_c;
+    gfc->copy_inbuffer_float_core = copy_inbuffer_float_core_c;
+    gfc->copy_inbuffer_int_core = copy_inbuffer_int_core_c;
+    gfc->copy_inbuffer_s24_core = copy_inbuffer_s24_core_c;
+    gfc->copy_inbuffer_u8_core = copy_inbuffer_u8_core_c;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2) {
+        gfc->copy_inbuffer_short_core = copy_inbuffer_short_core_sse;
+        gfc->copy_inbuffer_float_core = copy_inbuffer_float_core_sse;
+        gfc->copy_inbuffer_int_core = copy_inbuffer_int_core_sse;
+        gfc->copy_inbuffer_s24_core = copy_inbuffer_s24_core_sse;
+        gfc->copy_inbuffer_u8_core = copy_inbuffer_u8_core_sse;
+    }
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2) {
+        gfc->copy_inbuffer_short_core = copy_inbuffer_short_core_avx2;
+        gfc->copy_inbuffer_float_core = copy_inbuffer_float_core_avx2;
+        gfc->copy_inbuffer_int_core = copy_inbuffer_int_core_avx2;
+        gfc->copy_inbuffer_s24_core = copy_inbuffer_s24_core_avx2;
+        gfc->copy_inbuffer_u8_core = copy_inbuffer_u8_core_avx2;
+    }
+#endif
+#endif
+}
+
+static void
+init_group(lame_internal_flags * gfc)
+{
+    gfc->group_lanes = 0;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2) {
+        gfc->group_lanes = 4;
+        gfc->group_interleave = group_interleave_sse;
+        gfc->group_deinterleave = group_deinterleave_sse;
+        gfc->window_subband_group_core = window_subband_group_core_sse;
+        gfc->fft_long_group_core = fft_long_group_core_sse;
+    }
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2) {
+        gfc->group_lanes = 8;
+        gfc->group_interleave = group_interleave_avx2;
+        gfc->group_deinterleave = group_deinterleave_avx2;
+        gfc->window_subband_group_core = window_subband_group_core_avx2;
+        gfc->fft_long_group_core = fft_long_group_core_avx2;
+    }
+#endif
+#endif
+}
+
 static void
 lame_copy_inbuffer(lame_internal_flags* gfc, 
-                   void const* l, void const* r, int nsamples,
+                   void const* l, void const* r, int n,
                    enum PCMSampleType pcm_type, int jump, FLOAT s)
 {
     SessionConfig_t const *const cfg = &gfc->cfg;
     EncStateVar_t *const esv = &gfc->sv_enc;
     sample_t* ib0 = esv->in_buffer_0;
     sample_t* ib1 = esv->in_buffer_1;
-    FLOAT   m[2][2];
+    FLOAT   m[4];
 
     /* Apply user defined re-scaling */
-    m[0][0] = s * cfg->pcm_transform[0][0];
-    m[0][1] = s * cfg->pcm_transform[0][1];
-    m[1][0] = s * cfg->pcm_transform[1][0];
-    m[1][1] = s * cfg->pcm_transform[1][1];
+    m[0] = s * cfg->pcm_transform[0][0];
+    m[1] = s * cfg->pcm_transform[0][1];
+    m[2] = s * cfg->pcm_transform[1][0];
+    m[3] = s * cfg->pcm_transform[1][1];
 
-    /* make a copy of input buffer, changing type to sample_t */
-#define COPY_AND_TRANSFORM(T) \
-{ \
-    T const *bl = l, *br = r; \
-    int     i; \
-    for (i = 0; i < nsamples; i++) { \
-        sample_t const xl = *bl; \
-        sample_t const xr = *br; \
-        sample_t const u = xl * m[0][0] + xr * m[0][1]; \
-        sample_t const v = xl * m[1][0] + xr * m[1][1]; \
-        ib0[i] = u; \
-        ib1[i] = v; \
-        bl += jump; \
-        br += jump; \
-    } \
-}
     switch ( pcm_type ) {
     case pcm_short_type: 
-        COPY_AND_TRANSFORM(short int);
+        gfc->copy_inbuffer_short_core(ib0, ib1, l, r, n, jump, m);
         break;
     case pcm_int_type:
-        COPY_AND_TRANSFORM(int);
+        gfc->copy_inbuffer_int_core(ib0, ib1, l, r, n, jump, m);
         break;
     case pcm_long_type:
         COPY_AND_TRANSFORM(long int);
         break;
     case pcm_float_type:
-        COPY_AND_TRANSFORM(float);
+        gfc->copy_inbuffer_float_core(ib0, ib1, l, r, n, jump, m);
         break;
     case pcm_double_type:
         COPY_AND_TRANSFORM(double);
         break;
+    case pcm_s24_type:
+        gfc->copy_inbuffer_s24_core(ib0, ib1, l, r, n, jump, m);
+        break;
+    case pcm_u8_type:
+        gfc->copy_inbuffer_u8_core(ib0, ib1, l, r, n, jump, m);
+        break;
     }
 }
 
@@ -1953,6 +2261,106 @@ lame_encode_buffer_interleaved_ieee_double(lame_t gfp,
 }
 
 
+/* lame_encode_buffer_template() of n encoders at once; a buffer_r of NULL
+   means that the samples of each are interleaved in its buffer_l */
+static int
+lame_encode_group_template(lame_t const gfp[], int n,
+                           void const *const buffer_l[], void const *const buffer_r[],
+                           const int nsamples[], unsigned char *const mp3buf[],
+                           const int mp3buf_size[], int mp3bytes[],
+                           enum PCMSampleType pcm_type, FLOAT norm)
+{
+    lame_internal_flags **gfc;
+    int    *ns;
+    size_t const size = pcm_type == pcm_short_type ? sizeof(short) : sizeof(float);
+    int     aa = buffer_r == NULL ? 2 : 1;
+    int     ret, i;
+
+    if (n <= 0)
+        return 0;
+    gfc = calloc(n, sizeof(*gfc));
+    ns = calloc(n, sizeof(int));
+    if (gfc == NULL || ns == NULL) {
+        free(gfc);
+        free(ns);
+        return -2;
+    }
+    for (i = 0; i < n; i++) {
+        void const *l = buffer_l[i];
+        void const *r = buffer_r == NULL ? (char const *) l + size : buffer_r[i];
+
+        mp3bytes[i] = 0;
+        if (!is_lame_global_flags_valid(gfp[i]) ||
+            !is_lame_internal_flags_valid(gfp[i]->internal_flags)) {
+            ret = -3;
+            goto done;
+        }
+        gfc[i] = gfp[i]->internal_flags;
+        if (nsamples[i] == 0 || l == 0 || (gfc[i]->cfg.channels_in > 1 && r == 0))
+            continue;
+        if (update_inbuffer_size(gfc[i], nsamples[i]) != 0) {
+            ret = -2;
+            goto done;
+        }
+        /* make a copy of input buffer, changing type to sample_t */
+        lame_copy_inbuffer(gfc[i], l, gfc[i]->cfg.channels_in > 1 ? r : l, nsamples[i],
+                           pcm_type, aa, norm);
+        ns[i] = nsamples[i];
+    }
+    ret = lame_encode_group_sample_t(gfc, n, ns, mp3buf, mp3buf_size, mp3bytes);
+  done:
+    free(ns);
+    free(gfc);
+    return ret;
+}
+
+int
+lame_encode_buffer_group(lame_t const gfp[], int n,
+                         const short int *const pcm_l[], const short int *const pcm_r[],
+                         const int nsamples[], unsigned char *const mp3buf[],
+                         const int mp3buf_size[], int mp3bytes[])
+{
+    return lame_encode_group_template(gfp, n, (void const *const *) pcm_l,
+                                      (void const *const *) pcm_r, nsamples, mp3buf,
+                                      mp3buf_size, mp3bytes, pcm_short_type, 1.0);
+}
+
+
+int
+lame_encode_buffer_interleaved_group(lame_t const gfp[], int n, const short int *const pcm[],
+                                     const int nsamples[], unsigned char *const mp3buf[],
+                                     const int mp3buf_size[], int mp3bytes[])
+{
+    return lame_encode_group_template(gfp, n, (void const *const *) pcm, NULL, nsamples,
+                                      mp3buf, mp3buf_size, mp3bytes, pcm_short_type, 1.0);
+}
+
+
+int
+lame_encode_buffer_ieee_float_group(lame_t const gfp[], int n,
+                                    const float *const pcm_l[], const float *const pcm_r[],
+                                    const int nsamples[], unsigned char *const mp3buf[],
+                                    const int mp3buf_size[], int mp3bytes[])
+{
+    /* input is assumed to be normalized to +/- 1.0 for full scale */
+    return lame_encode_group_template(gfp, n, (void const *const *) pcm_l,
+                                      (void const *const *) pcm_r, nsamples, mp3buf,
+                                      mp3buf_size, mp3bytes, pcm_float_type, 32767.0);
+}
+
+
+int
+lame_encode_buffer_interleaved_ieee_float_group(lame_t const gfp[], int n,
+                                                const float *const pcm[], const int nsamples[],
+                                                unsigned char *const mp3buf[],
+                                                const int mp3buf_size[], int mp3bytes[])
+{
+    /* input is assumed to be normalized to +/- 1.0 for full scale */
+    return lame_encode_group_template(gfp, n, (void const *const *) pcm, NULL, nsamples,
+                                      mp3buf, mp3buf_size, mp3bytes, pcm_float_type, 32767.0);
+}
+
+
 int
 lame_encode_buffer_int(lame_global_flags * gfp,
                        const int pcm_l[], const int pcm_r[], const int nsamples,
@@ -1964,6 +2372,57 @@ lame_encode_buffer_int(lame_global_flags * gfp,
 }
 
 
+int
+lame_encode_buffer_interleaved_int(lame_t gfp,
+                                   const int pcm[], const int nsamples,
+                                   unsigned char *mp3buf, const int mp3buf_size)
+{
+    /* input is assumed to be normalized to +/- MAX_INT for full scale */
+    FLOAT const norm = (1.0 / (1L << (8 * sizeof(int) - 16)));
+    return lame_encode_buffer_template(gfp, pcm, pcm+1, nsamples, mp3buf, mp3buf_size, pcm_int_type, 2, norm);
+}
+
+
+int
+lame_encode_buffer_s24le(lame_t gfp,
+                         const unsigned char pcm_l[], const unsigned char pcm_r[], const int nsamples,
+                         unsigned char *mp3buf, const int mp3buf_size)
+{
+    /* input is packed 3 byte little endian, +/- 2^23 for full scale */
+    return lame_encode_buffer_template(gfp, pcm_l, pcm_r, nsamples, mp3buf, mp3buf_size, pcm_s24_type, 1, 1.0 / 256);
+}
+
+
+int
+lame_encode_buffer_interleaved_s24le(lame_t gfp,
+                                     const unsigned char pcm[], const int nsamples,
+                                     unsigned char *mp3buf, const int mp3buf_size)
+{
+    /* input is packed 3 byte little endian, +/- 2^23 for full scale */
+    return lame_encode_buffer_template(gfp, pcm, pcm+3, nsamples, mp3buf, mp3buf_size, pcm_s24_type, 2, 1.0 / 256);
+}
+
+
+int
+lame_encode_buffer_u8(lame_t gfp,
+                      const unsigned char pcm_l[], const unsigned char pcm_r[], const int nsamples,
+                      unsigned char *mp3buf, const int mp3buf_size)
+{
+    /* input is unsigned, 128 +/- 128 for full scale */
+    return lame_encode_buffer_template(gfp, pcm_l, pcm_r, nsamples, mp3buf, mp3buf_size, pcm_u8_type, 1, 256.0);
+}
+
+
+int
+lame_encode_buffer_interleaved_u8(lame_t gfp,
+                                  const unsigned char pcm[], const int nsamples,
+                                  unsigned char *mp3buf, const int mp3buf_size)
+{
+    /* input is unsigned, 128 +/- 128 for full scale */
+    return lame_encode_buffer_template(gfp, pcm, pcm+1, nsamples, mp3buf, mp3buf_size, pcm_u8_type, 2, 256.0);
+}
+
+
 int
 lame_encode_buffer_long2(lame_global_flags * gfp,
                          const long pcm_l[],  const long pcm_r[], const int nsamples,
@@ -2056,6 +2515,84 @@ lame_init_bitstream(lame_global_flags * gfp)
 }
 
 
+/* puts an encoder back into the state lame_init_params() left it in, after
+   lame_encode_flush() (or _nogap()), so that it can encode another stream of the same
+   configuration without being closed and set up again: the stream state
+   (sample buffers, MDCT and psychoacoustic model history, bit reservoir,
+   resampler, ReplayGain analysis, VBR seek table) is reset, the tables and
+   buffers are kept */
+int
+lame_reset_stream(lame_global_flags * gfp)
+{
+    lame_internal_flags *gfc;
+    SessionConfig_t const *cfg;
+    EncStateVar_t *esv;
+    int     i;
+
+    if (!is_lame_global_flags_valid(gfp)) {
+        return -3;
+    }
+    gfc = gfp->internal_flags;
+    if (!is_lame_internal_flags_valid(gfc)) {
+        return -3;
+    }
+    cfg = &gfc->cfg;
+    esv = &gfc->sv_enc;
+
+    /* encoder.c, newmdct.c: the input and its analysis */
+    gfc->lame_encode_frame_init = 0;
+    memset(&gfc->l3_side, 0, sizeof(gfc->l3_side));
+    memset(esv->sb_sample, 0, sizeof(esv->sb_sample));
+    memset(esv->mfbuf, 0, sizeof(esv->mfbuf));
+    esv->mf_samples_to_encode = ENCDELAY + POSTDELAY;
+    esv->mf_size = ENCDELAY - MDCTDELAY;
+    for (i = 0; i < 19; i++)
+        esv->pefirbuf[i] = 700 * cfg->mode_gr * cfg->channels_out;
+    reset_resample(gfc);
+    psymodel_reset(gfc);
+
+    /* quantize.c */
+    gfc->sv_qnt.OldValue[0] = gfc->sv_qnt.OldValue[1] = 180;
+    gfc->sv_qnt.CurrentStep[0] = gfc->sv_qnt.CurrentStep[1] = 4;
+    gfc->sv_qnt.masking_lower = 1;
+    memset(gfc->sv_qnt.pseudohalf, 0, sizeof(gfc->sv_qnt.pseudohalf));
+
+    /* bitstream.c, reservoir.c: frame padding and the bit reservoir */
+    esv->slot_lag = esv->frac_SpF;
+    esv->ancillary_flag = 0;
+    esv->ResvSize = 0;
+    esv->ResvMax = 0;
+    if (cfg->vbr != vbr_off)
+        gfc->ov_enc.bitrate_index = 1;
+    gfc->ov_enc.padding = 0;
+    gfc->ov_enc.mode_ext = 0;
+    gfc->ov_enc.encoder_padding = 0;
+    reset_bit_stream_w(gfc);
+
+    /* ReplayGain and the peak sample */
+    gfc->ov_rpg.RadioGain = 0;
+    gfc->ov_rpg.noclipGainChange = 0;
+    gfc->ov_rpg.noclipScale = -1.0;
+    if (cfg->findReplayGain) {
+        if (InitGainAnalysis(gfc->sv_rpg.rgdata, cfg->samplerate_out) == INIT_GAIN_ANALYSIS_ERROR)
+            return -6;
+    }
+#ifdef DECODE_ON_THE_FLY
+    if (gfc->hip) {
+        hip_decode_exit(gfc->hip);
+        gfc->hip = hip_decode_init();
+        hip_set_errorf(gfc->hip, gfp->report.errorf);
+        hip_set_debugf(gfc->hip, gfp->report.debugf);
+        hip_set_msgf(gfc->hip, gfp->report.msgf);
+    }
+#endif
+    gfc->nMusicCRC = 0;
+
+    /* frame counters, id3v2 tag and the VBR tag frame and seek table */
+    return lame_init_bitstream(gfp);
+}
+
+
 /*****************************************************************/
 /* flush internal PCM sample buffers, then mp3 buffers           */
 /* then write id3 v1 tags into bitstream.                        */
@@ -2105,8 +2642,8 @@ lame_encode_flush(lame_global_flags * gfp, unsigned char *mp3buffer, int mp3buff
     is_resampling_necessary = isResamplingNecessary(cfg);
     if (is_resampling_necessary) {
         resample_ratio = (double)cfg->samplerate_in / (double)cfg->samplerate_out;
-        /* delay due to resampling; needs to be fixed, if resampling code gets changed */
-        samples_to_encode += 16. / resample_ratio;
+        /* delay due to resampling */
+        samples_to_encode += resample_delay(gfc) / resample_ratio;
     }
     end_padding = pcm_samples_per_frame - (samples_to_encode % pcm_samples_per_frame);
     if (end_padding < 576)
@@ -2331,6 +2868,8 @@ lame_init_old(lame_global_flags * gfp)
     gfp->num_samples = MAX_U_32_NUM;
 
     gfp->write_lame_tag = 1;
+    gfp->reservoir_barrier = -1;
+    gfp->resample_quality = 0;
     gfp->quality = -1;
     gfp->short_blocks = short_block_not_set;
     gfp->subblock_gain = -1;
@@ -35,6 +35,7 @@ struct lame_global_struct {
                                 default: LAME picks best value
                                 at least not used for MP3 decoding:
                                 Remember 44.1 kHz MP3s and AC97           */
+    int     resample_quality; /* resampling filter, 0..3. default=2          */
     float   scale;           /* scale input by this amount before encoding
                                 at least not used for MP3 decoding          */
     float   scale_left;      /* scale input of channel 0 (left) by this
@@ -89,6 +90,7 @@ struct lame_global_struct {
     int     strict_ISO;      /* enforce ISO spec as much as possible   */
 
     int     disable_reservoir; /* use bit reservoir?                     */
+    int     reservoir_barrier; /* frame that drains the reservoir, or -1 */
 
     /* quantization/noise shaping */
     int     quant_comp;
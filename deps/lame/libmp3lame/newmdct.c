@@ -35,6 +35,7 @@
 #include "encoder.h"
 #include "util.h"
 #include "newmdct.h"
+#include "lame_intrin.h"
 
 
 
@@ -426,81 +427,79 @@ static const int order[] = {
 };
 
 
-/* returns sum_j=0^31 a[j]*cos(PI*j*(k+1/2)/32), 0<=k<32 */
-inline static void
-window_subband(const sample_t * x1, FLOAT a[SBLIMIT])
-{
-    int     i;
-    FLOAT const *wp = enwindow + 10;
+/* enwindow[] rearranged for window_subband_core(): w[m][j] is wp[m - 10] of
+ * iteration j (one column per iteration, the 16th column is zero) */
+static FLOAT enwindow_lanes[18][16];
+
 
+/* the first 15 iterations of window_subband(), which only differ in the
+ * samples and weights they use. a[30] and a[31] are left to the caller */
+void
+window_subband_core_c(const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16])
+{
+    int     j;
     const sample_t *x2 = &x1[238 - 14 - 286];
 
-    for (i = -15; i < 0; i++) {
-        FLOAT   w, s, t;
-
-        w = wp[-10];
-        s = x2[-224] * w;
-        t = x1[224] * w;
-        w = wp[-9];
-        s += x2[-160] * w;
-        t += x1[160] * w;
-        w = wp[-8];
-        s += x2[-96] * w;
-        t += x1[96] * w;
-        w = wp[-7];
-        s += x2[-32] * w;
-        t += x1[32] * w;
-        w = wp[-6];
-        s += x2[32] * w;
-        t += x1[-32] * w;
-        w = wp[-5];
-        s += x2[96] * w;
-        t += x1[-96] * w;
-        w = wp[-4];
-        s += x2[160] * w;
-        t += x1[-160] * w;
-        w = wp[-3];
-        s += x2[224] * w;
-        t += x1[-224] * w;
-
-        w = wp[-2];
-        s += x1[-256] * w;
-        t -= x2[256] * w;
-        w = wp[-1];
-        s += x1[-192] * w;
-        t -= x2[192] * w;
-        w = wp[0];
-        s += x1[-128] * w;
-        t -= x2[128] * w;
-        w = wp[1];
-        s += x1[-64] * w;
-        t -= x2[64] * w;
-        w = wp[2];
-        s += x1[0] * w;
-        t -= x2[0] * w;
-        w = wp[3];
-        s += x1[64] * w;
-        t -= x2[-64] * w;
-        w = wp[4];
-        s += x1[128] * w;
-        t -= x2[-128] * w;
-        w = wp[5];
-        s += x1[192] * w;
-        t -= x2[-192] * w;
+    for (j = 0; j < 15; j++) {
+        FLOAT   s, t;
+
+        s = x2[-224] * w[0][j];
+        t = x1[224] * w[0][j];
+        s += x2[-160] * w[1][j];
+        t += x1[160] * w[1][j];
+        s += x2[-96] * w[2][j];
+        t += x1[96] * w[2][j];
+        s += x2[-32] * w[3][j];
+        t += x1[32] * w[3][j];
+        s += x2[32] * w[4][j];
+        t += x1[-32] * w[4][j];
+        s += x2[96] * w[5][j];
+        t += x1[-96] * w[5][j];
+        s += x2[160] * w[6][j];
+        t += x1[-160] * w[6][j];
+        s += x2[224] * w[7][j];
+        t += x1[-224] * w[7][j];
+
+        s += x1[-256] * w[8][j];
+        t -= x2[256] * w[8][j];
+        s += x1[-192] * w[9][j];
+        t -= x2[192] * w[9][j];
+        s += x1[-128] * w[10][j];
+        t -= x2[128] * w[10][j];
+        s += x1[-64] * w[11][j];
+        t -= x2[64] * w[11][j];
+        s += x1[0] * w[12][j];
+        t -= x2[0] * w[12][j];
+        s += x1[64] * w[13][j];
+        t -= x2[-64] * w[13][j];
+        s += x1[128] * w[14][j];
+        t -= x2[-128] * w[14][j];
+        s += x1[192] * w[15][j];
+        t -= x2[-192] * w[15][j];
 
         /*
          * this multiplyer could be removed, but it needs more 256 FLOAT data.
          * thinking about the data cache performance, I think we should not
          * use such a huge table. tt 2000/Oct/25
          */
-        s *= wp[6];
-        w = t - s;
-        a[30 + i * 2] = t + s;
-        a[31 + i * 2] = wp[7] * w;
-        wp += 18;
+        s *= w[16][j];
+        a[2 * j] = t + s;
+        a[2 * j + 1] = w[17][j] * (t - s);
         x1--;
         x2++;
     }
+}
+
+
+/* returns sum_j=0^31 a[j]*cos(PI*j*(k+1/2)/32), 0<=k<32 */
+inline static void
+window_subband(lame_internal_flags const *gfc, const sample_t * x1, FLOAT a[SBLIMIT])
+{
+    FLOAT const *wp = enwindow + 10 + 15 * 18;
+
+    gfc->window_subband_core(x1, a, enwindow_lanes);
+    x1 -= 15;
+
     {
         FLOAT   s, t, u, v;
         t = x1[-16] * wp[-10];
@@ -941,6 +940,121 @@ mdct_long(FLOAT * out, FLOAT const *in)
 }
 
 
+/* windowing and mdct_long() of the eight bands order[0..7], all long blocks
+ * with the window "w" (ws is the short block window, which holds the other
+ * constants) */
+void
+mdct_long_core_c(FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                 int const *order, FLOAT const *w, FLOAT const *ws)
+{
+    FLOAT const *const tantab = ws + 3;
+    int     band, k;
+
+    for (band = 0; band < 8; band++, out += 18) {
+        FLOAT const *const band0 = sb0 + order[band];
+        FLOAT const *const band1 = sb1 + order[band];
+        FLOAT   work[18];
+        for (k = -NL / 4; k < 0; k++) {
+            FLOAT   a, b;
+            a = w[k + 27] * band1[(k + 9) * 32]
+                + w[k + 36] * band1[(8 - k) * 32];
+            b = w[k + 9] * band0[(k + 9) * 32]
+                - w[k + 18] * band0[(8 - k) * 32];
+            work[k + 9] = a - b * tantab[k + 9];
+            work[k + 18] = a * tantab[k + 9] + b;
+        }
+        mdct_long(out, work);
+    }
+}
+
+
+/* whether bands band..band+7 are all unfiltered long blocks of one type */
+static int
+mdct_long_group(EncStateVar_t const *esv, gr_info const *gi, int band)
+{
+    int     k;
+    if (gi->block_type == SHORT_TYPE || (gi->mixed_block_flag && band < 2))
+        return 0;
+    for (k = band; k < band + 8; k++) {
+        if (esv->amp_filter[k] < 1.0)
+            return 0;
+    }
+    return 1;
+}
+
+
+/* the window_subband() part of mdct_sub48() for the next frame of
+ * gfc->group_lanes channels at once, whose mfbuf[ch] are interleaved in xs:
+ * sb[j] gets the subband samples of channel j for the mode_gr granules, as
+ * GroupAnalysis_t has them. "work" holds 18 * SBLIMIT * group_lanes floats */
+void
+mdct_sub48_group(lame_internal_flags const *gfc, FLOAT const *xs, int mode_gr,
+                 FLOAT * const *sb, FLOAT * work)
+{
+    int const lanes = gfc->group_lanes;
+    FLOAT const *const wp = enwindow + 10 + 15 * 18;
+    FLOAT const *wk = xs + 286 * lanes;
+    FLOAT  *out[MAX_GROUP_LANES];
+    int     gr, k, band, j;
+
+    for (gr = 0; gr < mode_gr; gr++) {
+        FLOAT  *samp = work;
+        for (k = 0; k < 18 / 2; k++) {
+            gfc->window_subband_group_core(wk, samp, wp, enwindow_lanes);
+            gfc->window_subband_group_core(wk + 32 * lanes, samp + 32 * lanes, wp,
+                                           enwindow_lanes);
+            samp += 64 * lanes;
+            wk += 64 * lanes;
+            /*
+             * Compensate for inversion in the analysis filter
+             */
+            for (band = 1; band < 32; band += 2) {
+                for (j = 0; j < lanes; j++)
+                    samp[(band - 32) * lanes + j] *= -1;
+            }
+        }
+        for (j = 0; j < lanes; j++)
+            out[j] = sb[j] + gr * 18 * SBLIMIT;
+        gfc->group_deinterleave(out, work, 18 * SBLIMIT);
+    }
+}
+
+
+void
+mdct_sub48_init(lame_internal_flags * gfc)
+{
+    static int init = 0;
+    int     j, m;
+
+    if (!init) {
+        for (m = 0; m < 18; m++) {
+            for (j = 0; j < 15; j++)
+                enwindow_lanes[m][j] = enwindow[j * 18 + m];
+            enwindow_lanes[m][15] = 0;
+        }
+    }
+    init = 1;
+
+    gfc->window_subband_core = window_subband_core_c;
+    gfc->mdct_long_core = mdct_long_core_c;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2) {
+        gfc->window_subband_core = window_subband_core_sse;
+        gfc->mdct_long_core = mdct_long_core_sse;
+    }
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2) {
+        gfc->window_subband_core = window_subband_core_avx2;
+        gfc->mdct_long_core = mdct_long_core_avx2;
+    }
+    if (gfc->CPU_features.AVX512) {
+        gfc->window_subband_core = window_subband_core_avx512;
+    }
+#endif
+#endif
+}
+
+
 void
 mdct_sub48(lame_internal_flags * gfc, const sample_t * w0, const sample_t * w1)
 {
@@ -957,17 +1071,25 @@ mdct_sub48(lame_internal_flags * gfc, const sample_t * w0, const sample_t * w1)
             gr_info *const gi = &(gfc->l3_side.tt[gr][ch]);
             FLOAT  *mdct_enc = gi->xr;
             FLOAT  *samp = esv->sb_sample[ch][1 - gr][0];
+            int     core_end = 0;
 
-            for (k = 0; k < 18 / 2; k++) {
-                window_subband(wk, samp);
-                window_subband(wk + 32, samp + 32);
-                samp += 64;
-                wk += 64;
-                /*
-                 * Compensate for inversion in the analysis filter
-                 */
-                for (band = 1; band < 32; band += 2) {
-                    samp[band - 32] *= -1;
+            if (gfc->group && gfc->group->ready[ch]) {
+                /* lame_encode_buffer_group() did this already */
+                memcpy(samp, gfc->group->sb_sample[ch][gr], 18 * SBLIMIT * sizeof(FLOAT));
+                wk += 576;
+            }
+            else {
+                for (k = 0; k < 18 / 2; k++) {
+                    window_subband(gfc, wk, samp);
+                    window_subband(gfc, wk + 32, samp + 32);
+                    samp += 64;
+                    wk += 64;
+                    /*
+                     * Compensate for inversion in the analysis filter
+                     */
+                    for (band = 1; band < 32; band += 2) {
+                        samp[band - 32] *= -1;
+                    }
                 }
             }
 
@@ -981,7 +1103,16 @@ mdct_sub48(lame_internal_flags * gfc, const sample_t * w0, const sample_t * w1)
                 FLOAT  *const band1 = esv->sb_sample[ch][1 - gr][0] + order[band];
                 if (gi->mixed_block_flag && band < 2)
                     type = 0;
-                if (esv->amp_filter[band] < 1e-12) {
+                if ((band & 7) == 0 && mdct_long_group(esv, gi, band)) {
+                    gfc->mdct_long_core(mdct_enc, esv->sb_sample[ch][gr][0],
+                                        esv->sb_sample[ch][1 - gr][0], order + band,
+                                        win[type], win[SHORT_TYPE]);
+                    core_end = band + 8;
+                }
+                if (band < core_end) {
+                    /* already done by mdct_long_core */
+                }
+                else if (esv->amp_filter[band] < 1e-12) {
                     memset(mdct_enc, 0, 18 * sizeof(FLOAT));
                 }
                 else {
@@ -22,6 +22,14 @@
 #ifndef LAME_NEWMDCT_H
 #define LAME_NEWMDCT_H
 
+void    mdct_sub48_init(lame_internal_flags * gfc);
 void    mdct_sub48(lame_internal_flags * gfc, const sample_t * w0, const sample_t * w1);
+void    mdct_sub48_group(lame_internal_flags const *gfc, FLOAT const *xs, int mode_gr,
+                         FLOAT * const *sb, FLOAT * work);
+
+/* plain C versions of gfc->window_subband_core and gfc->mdct_long_core */
+void    window_subband_core_c(const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16]);
+void    mdct_long_core_c(FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                         int const *order, FLOAT const *w, FLOAT const *ws);
 
 #endif /* LAME_NEWMDCT_H */
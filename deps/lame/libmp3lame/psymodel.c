@@ -152,6 +152,8 @@ blocktype_d[2]        block type to use for previous granule
 #include "lame_global_flags.h"
 #include "fft.h"
 #include "lame-analysis.h"
+#include "lame_intrin.h"
+#include "table_cache.h"
 
 
 #define NSFIRLEN 21
@@ -279,6 +281,14 @@ mask_add_delta(int i)
 }
 
 
+static const FLOAT table2[] = {
+    1.33352 * 1.33352, 1.35879 * 1.35879, 1.38454 * 1.38454, 1.39497 * 1.39497,
+    1.40548 * 1.40548, 1.3537 * 1.3537, 1.30382 * 1.30382, 1.22321 * 1.22321,
+    1.14758 * 1.14758,
+    1
+};
+
+
 static void
 init_mask_add_max_values(void)
 {
@@ -288,19 +298,53 @@ init_mask_add_max_values(void)
 }
 
 
+/* index into table2 for a ratio below ma_max_i1 */
+inline static int
+mask_add_index(FLOAT ratio)
+{
+    return (int) (FAST_LOG10_X(ratio, 16.0f));
+}
+
+
+/* the vector versions of vbrpsy_mask_add() can't look up the log table,
+   so they get the ratios at which the table2 index steps up instead.
+   Positive floats sort like their bit patterns, which are searched here */
+static void
+init_mask_add_consts(PsyMaskAdd_t * ma)
+{
+    int     i;
+
+    STATIC_ASSERT_EQUAL_DIMENSION(table2, ma->table2);
+    ma->max_i1 = ma_max_i1;
+    ma->max_i2 = ma_max_i2;
+    for (i = 0; i < (int) dimension_of(table2); i++)
+        ma->table2[i] = table2[i];
+    ma->ratio_i[0] = 1;
+    for (i = 1; i < (int) dimension_of(table2); i++) {
+        union {
+            ieee754_float32_t f;
+            int     i;
+        } lo, hi, mid;
+        lo.f = 1;
+        hi.f = ma_max_i1;
+        while (lo.i < hi.i) {
+            mid.i = lo.i + (hi.i - lo.i) / 2;
+            if (mask_add_index(mid.f) >= i)
+                hi.i = mid.i;
+            else
+                lo.i = mid.i + 1;
+        }
+        ma->ratio_i[i] = lo.f;
+    }
+}
+
+
 
 
 /* addition of simultaneous masking   Naoki Shibata 2000/7 */
 inline static FLOAT
 vbrpsy_mask_add(FLOAT m1, FLOAT m2, int b, int delta)
 {
-    static const FLOAT table2[] = {
-        1.33352 * 1.33352, 1.35879 * 1.35879, 1.38454 * 1.38454, 1.39497 * 1.39497,
-        1.40548 * 1.40548, 1.3537 * 1.3537, 1.30382 * 1.30382, 1.22321 * 1.22321,
-        1.14758 * 1.14758,
-        1
-    };
-
     FLOAT   ratio;
 
     if (m1 < 0) {
@@ -327,7 +371,7 @@ vbrpsy_mask_add(FLOAT m1, FLOAT m2, int b, int delta)
             return m1 + m2;
         }
         else {
-            int     i = (int) (FAST_LOG10_X(ratio, 16.0f));
+            int     i = mask_add_index(ratio);
             return (m1 + m2) * table2[i];
         }
     }
@@ -580,6 +624,61 @@ calc_energy(PsyConst_CB2SB_t const *l, FLOAT const *fftenergy, FLOAT * eb, FLOAT
 }
 
 
+/* convolve the partitioned energy with the spreading function,
+   without the final avg_mask factor */
+void
+psy_spread_core_c(FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2], int npart,
+                  FLOAT const *eb, FLOAT const *tab_idx, int const *delta,
+                  PsyMaskAdd_t const *ma)
+{
+    int     b, k = 0;
+
+    (void) ma;
+    for (b = 0; b < npart; b++) {
+        int     kk = s3ind[b][0];
+        int const last = s3ind[b][1];
+        FLOAT   x, e;
+
+        e = s3[k] * eb[kk] * tab_idx[kk];
+        ++k, ++kk;
+        while (kk <= last) {
+            x = s3[k] * eb[kk] * tab_idx[kk];
+            e = vbrpsy_mask_add(e, x, kk - b, delta[b]);
+            ++k, ++kk;
+        }
+        ecb[b] = e;
+    }
+}
+
+
+/* spreading function and average masking of each partition */
+static void
+vbrpsy_spread(lame_internal_flags const *gfc, PsyConst_CB2SB_t const *gd, FLOAT const *eb,
+              unsigned char const *mask_idx, FLOAT * ecb, FLOAT * avg_mask)
+{
+    FLOAT   tab_idx[CBANDS];
+    int     delta[CBANDS], dd_sum[CBANDS + 1];
+    int     b;
+
+    dd_sum[0] = 0;
+    for (b = 0; b < gd->npart; b++) {
+        tab_idx[b] = tab[mask_idx[b]];
+        delta[b] = mask_add_delta(mask_idx[b]);
+        dd_sum[b + 1] = dd_sum[b] + mask_idx[b];
+    }
+    gfc->psy_spread_core(ecb, gd->s3, gd->s3ind, gd->npart, eb, tab_idx, delta,
+                         &gfc->cd_psy->mask_add);
+    for (b = 0; b < gd->npart; b++) {
+        int const first = gd->s3ind[b][0];
+        int const last = gd->s3ind[b][1];
+        int const dd_n = last - first + 1;
+        int const dd = (1 + 2 * (dd_sum[last + 1] - dd_sum[first])) / (2 * dd_n);
+        avg_mask[b] = tab[dd] * 0.5f;
+        ecb[b] *= avg_mask[b];
+    }
+}
+
+
 static void
 calc_mask_index_l(lame_internal_flags const *gfc, FLOAT const *max,
                   FLOAT const *avg, unsigned char *mask_idx)
@@ -662,7 +761,13 @@ vbrpsy_compute_fft_l(lame_internal_flags * gfc, const sample_t * const buffer[2]
     int     j;
 
     if (chn < 2) {
-        fft_long(gfc, *wsamp_l, chn, buffer);
+        if (gfc->group && gfc->group->ready[chn]) {
+            /* lame_encode_buffer_group() did this already */
+            memcpy(*wsamp_l, gfc->group->wsamp_L[chn][gr_out], sizeof(*wsamp_l));
+        }
+        else {
+            fft_long(gfc, *wsamp_l, chn, buffer);
+        }
     }
     else if (chn == 2) {
         FLOAT const sqrt2_half = SQRT2 * 0.5f;
@@ -1034,7 +1139,7 @@ vbrpsy_compute_masking_s(lame_internal_flags * gfc, const FLOAT(*fftenergy_s)[HB
 {
     PsyStateVar_t *const psv = &gfc->sv_psy;
     PsyConst_CB2SB_t const *const gds = &gfc->cd_psy->s;
-    FLOAT   max[CBANDS], avg[CBANDS];
+    FLOAT   max[CBANDS], avg[CBANDS], ecb_b[CBANDS], avg_mask_b[CBANDS];
     int     i, j, b;
     unsigned char mask_idx_s[CBANDS];
 
@@ -1060,28 +1165,12 @@ vbrpsy_compute_masking_s(lame_internal_flags * gfc, const FLOAT(*fftenergy_s)[HB
     assert(b == gds->npart);
     assert(j == 129);
     vbrpsy_calc_mask_index_s(gfc, max, avg, mask_idx_s);
-    for (j = b = 0; b < gds->npart; b++) {
-        int     kk = gds->s3ind[b][0];
-        int const last = gds->s3ind[b][1];
-        int const delta = mask_add_delta(mask_idx_s[b]);
-        int     dd, dd_n;
-        FLOAT   x, ecb, avg_mask;
+    vbrpsy_spread(gfc, gds, eb, mask_idx_s, ecb_b, avg_mask_b);
+    for (b = 0; b < gds->npart; b++) {
+        FLOAT   x;
+        FLOAT const ecb = ecb_b[b];
+        FLOAT const avg_mask = avg_mask_b[b];
         FLOAT const masking_lower = gds->masking_lower[b] * gfc->sv_qnt.masking_lower;
-
-        dd = mask_idx_s[kk];
-        dd_n = 1;
-        ecb = gds->s3[j] * eb[kk] * tab[mask_idx_s[kk]];
-        ++j, ++kk;
-        while (kk <= last) {
-            dd += mask_idx_s[kk];
-            dd_n += 1;
-            x = gds->s3[j] * eb[kk] * tab[mask_idx_s[kk]];
-            ecb = vbrpsy_mask_add(ecb, x, kk - b, delta);
-            ++j, ++kk;
-        }
-        dd = (1 + 2 * dd) / (2 * dd_n);
-        avg_mask = tab[dd] * 0.5f;
-        ecb *= avg_mask;
 #if 0                   /* we can do PRE ECHO control now here, or do it later */
         if (psv->blocktype_old[chn & 0x01] == SHORT_TYPE) {
             /* limit calculated threshold by even older granule */
@@ -1137,9 +1226,9 @@ vbrpsy_compute_masking_l(lame_internal_flags * gfc, const FLOAT fftenergy[HBLKSI
 {
     PsyStateVar_t *const psv = &gfc->sv_psy;
     PsyConst_CB2SB_t const *const gdl = &gfc->cd_psy->l;
-    FLOAT   max[CBANDS], avg[CBANDS];
+    FLOAT   max[CBANDS], avg[CBANDS], ecb_b[CBANDS], avg_mask_b[CBANDS];
     unsigned char mask_idx_l[CBANDS + 2];
-    int     k, b;
+    int     b;
 
  /*********************************************************************
     *    Calculate the energy and the tonality of each partition.
@@ -1151,38 +1240,12 @@ vbrpsy_compute_masking_l(lame_internal_flags * gfc, const FLOAT fftenergy[HBLKSI
     *      convolve the partitioned energy and unpredictability
     *      with the spreading function, s3_l[b][k]
  ********************************************************************/
-    k = 0;
+    vbrpsy_spread(gfc, gdl, eb_l, mask_idx_l, ecb_b, avg_mask_b);
     for (b = 0; b < gdl->npart; b++) {
-        FLOAT   x, ecb, avg_mask, t;
+        FLOAT   x;
+        FLOAT const ecb = ecb_b[b];
+        FLOAT const avg_mask = avg_mask_b[b];
         FLOAT const masking_lower = gdl->masking_lower[b] * gfc->sv_qnt.masking_lower;
-        /* convolve the partitioned energy with the spreading function */
-        int     kk = gdl->s3ind[b][0];
-        int const last = gdl->s3ind[b][1];
-        int const delta = mask_add_delta(mask_idx_l[b]);
-        int     dd = 0, dd_n = 0;
-
-        dd = mask_idx_l[kk];
-        dd_n += 1;
-        ecb = gdl->s3[k] * eb_l[kk] * tab[mask_idx_l[kk]];
-        ++k, ++kk;
-        while (kk <= last) {
-            dd += mask_idx_l[kk];
-            dd_n += 1;
-            x = gdl->s3[k] * eb_l[kk] * tab[mask_idx_l[kk]];
-            t = vbrpsy_mask_add(ecb, x, kk - b, delta);
-#if 0
-            ecb += eb_l[kk];
-            if (ecb > t) {
-                ecb = t;
-            }
-#else
-            ecb = t;
-#endif
-            ++k, ++kk;
-        }
-        dd = (1 + 2 * dd) / (2 * dd_n);
-        avg_mask = tab[dd] * 0.5f;
-        ecb *= avg_mask;
 
         /****   long block pre-echo control   ****/
         /* dont use long block pre-echo control if previous granule was 
@@ -1323,10 +1386,10 @@ vbrpsy_apply_block_type(PsyStateVar_t * psv, int nch, int const *uselongblock, i
  * compute M/S thresholds from Johnston & Ferreira 1992 ICASSP paper
  ***************************************************************/
 
-static void
-vbrpsy_compute_MS_thresholds(const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
-                             const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS], FLOAT athlower,
-                             FLOAT msfix, int n)
+void
+psy_ms_thresholds_core_c(const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                         const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS], FLOAT athlower,
+                         FLOAT msfix, int n)
 {
     FLOAT const msfix2 = msfix * 2.f;
     FLOAT   rside, rmid;
@@ -1457,8 +1520,8 @@ L3psycho_anal_vbr(lame_internal_flags * gfc,
         }
         if (cfg->mode == JOINT_STEREO) {
             if ((uselongblock[0] + uselongblock[1]) == 2) {
-                vbrpsy_compute_MS_thresholds(const_eb, thr, gdl->mld_cb, gfc->ATH->cb_l,
-                                             ath_factor, cfg->msfix, gdl->npart);
+                gfc->psy_ms_thresholds_core(const_eb, thr, gdl->mld_cb, gfc->ATH->cb_l,
+                                            ath_factor, cfg->msfix, gdl->npart);
             }
         }
         /* TODO: apply adaptive ATH masking here ?? */
@@ -1486,8 +1549,8 @@ L3psycho_anal_vbr(lame_internal_flags * gfc,
             }
             if (cfg->mode == JOINT_STEREO) {
                 if ((uselongblock[0] + uselongblock[1]) == 0) {
-                    vbrpsy_compute_MS_thresholds(const_eb, thr, gds->mld_cb, gfc->ATH->cb_s,
-                                                 ath_factor, cfg->msfix, gds->npart);
+                    gfc->psy_ms_thresholds_core(const_eb, thr, gds->mld_cb, gfc->ATH->cb_s,
+                                                ath_factor, cfg->msfix, gds->npart);
                 }
             }
             /* TODO: apply adaptive ATH masking here ?? */
@@ -1864,14 +1927,70 @@ init_s3_values(FLOAT ** p, int (*s3ind)[2], int npart,
     return 0;
 }
 
-int
-psymodel_init(lame_global_flags const *gfp)
+static void
+init_psy_cores(lame_internal_flags * gfc)
 {
-    lame_internal_flags *const gfc = gfp->internal_flags;
-    SessionConfig_t *const cfg = &gfc->cfg;
-    PsyStateVar_t *const psv = &gfc->sv_psy;
+    gfc->psy_spread_core = psy_spread_core_c;
+    gfc->psy_ms_thresholds_core = psy_ms_thresholds_core_c;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2) {
+        gfc->psy_spread_core = psy_spread_core_sse;
+        gfc->psy_ms_thresholds_core = psy_ms_thresholds_core_sse;
+    }
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2) {
+        gfc->psy_spread_core = psy_spread_core_avx2;
+        gfc->psy_ms_thresholds_core = psy_ms_thresholds_core_avx2;
+    }
+#endif
+#endif
+}
+
+
+/* what the psychoacoustic model constants are computed from */
+typedef struct {
+    int     samplerate_out;  /* and the scalefactor bands of that */
+    int     ATHtype;
+    FLOAT   ATHcurve;
+    FLOAT   minval;
+    int     experimentalZ;
+    float   attackthre;
+    float   attackthre_s;
+    int     VBR_q;
+    float   VBR_q_frac;
+} psy_tables_key_t;
+
+/* the psychoacoustic model constants, shared by the encoders of a
+   configuration, and the partitioned ATH that each copies into its own */
+typedef struct {
+    PsyConst_t cd;
+    FLOAT   ath_cb_l[CBANDS];
+    FLOAT   ath_cb_s[CBANDS];
+    FLOAT   ath_eql_w[BLKSIZE / 2];
+} psy_tables_t;
+
+
+static void
+psy_tables_free(void *table)
+{
+    psy_tables_t *const t = table;
+    if (t->cd.l.s3)
+        free(t->cd.l.s3);
+    if (t->cd.s.s3)
+        free(t->cd.s.s3);
+    free(t);
+}
+
+
+static void *
+psy_tables_build(void const *key, void *arg, size_t * bytes)
+{
+    lame_global_flags const *const gfp = arg;
+    lame_internal_flags const *const gfc = gfp->internal_flags;
+    SessionConfig_t const *const cfg = &gfc->cfg;
+    psy_tables_t *t;
     PsyConst_t *gd;
-    int     i, j, b, sb, k;
+    int     i, j, b, k;
     FLOAT   bvl_a = 13, bvl_b = 24;
     FLOAT   snr_l_a = 0, snr_l_b = 0;
     FLOAT   snr_s_a = -8.25, snr_s_b = -4.5;
@@ -1884,45 +2003,16 @@ psymodel_init(lame_global_flags const *gfp)
     FLOAT   xav = 10, xbv = 12;
     FLOAT const minval_low = (0.f - cfg->minval);
 
-    if (gfc->cd_psy != 0) {
-        return 0;
-    }
+    (void) key;
     memset(norm, 0, sizeof(norm));
 
-    gd = calloc(1, sizeof(PsyConst_t));
-    gfc->cd_psy = gd;
+    t = calloc(1, sizeof(psy_tables_t));
+    if (t == NULL)
+        return NULL;
+    gd = &t->cd;
 
     gd->force_short_block_calc = gfp->experimentalZ;
 
-    psv->blocktype_old[0] = psv->blocktype_old[1] = NORM_TYPE; /* the vbr header is long blocks */
-
-    for (i = 0; i < 4; ++i) {
-        for (j = 0; j < CBANDS; ++j) {
-            psv->nb_l1[i][j] = 1e20;
-            psv->nb_l2[i][j] = 1e20;
-            psv->nb_s1[i][j] = psv->nb_s2[i][j] = 1.0;
-        }
-        for (sb = 0; sb < SBMAX_l; sb++) {
-            psv->en[i].l[sb] = 1e20;
-            psv->thm[i].l[sb] = 1e20;
-        }
-        for (j = 0; j < 3; ++j) {
-            for (sb = 0; sb < SBMAX_s; sb++) {
-                psv->en[i].s[sb][j] = 1e20;
-                psv->thm[i].s[sb][j] = 1e20;
-            }
-            psv->last_attacks[i] = 0;
-        }
-        for (j = 0; j < 9; j++)
-            psv->last_en_subshort[i][j] = 10.;
-    }
-
-
-    /* init. for loudness approx. -jd 2001 mar 27 */
-    psv->loudness_sq_save[0] = psv->loudness_sq_save[1] = 0.0;
-
-
-
     /*************************************************************************
      * now compute the psychoacoustic model specific constants
      ************************************************************************/
@@ -1940,9 +2030,10 @@ psymodel_init(lame_global_flags const *gfp)
         }
         norm[i] = pow(10.0, snr / 10.0);
     }
-    i = init_s3_values(&gd->l.s3, gd->l.s3ind, gd->l.npart, bval, bval_width, norm);
-    if (i)
-        return i;
+    if (init_s3_values(&gd->l.s3, gd->l.s3ind, gd->l.npart, bval, bval_width, norm)) {
+        psy_tables_free(t);
+        return NULL;
+    }
 
     /* compute long block specific values, ATH and MINVAL */
     j = 0;
@@ -1961,7 +2052,7 @@ psymodel_init(lame_global_flags const *gfp)
             if (x > level)
                 x = level;
         }
-        gfc->ATH->cb_l[i] = x;
+        t->ath_cb_l[i] = x;
 
         /* MINVAL.
            For low freq, the strength of the masking is limited by minval
@@ -2014,7 +2105,7 @@ psymodel_init(lame_global_flags const *gfp)
             if (x > level)
                 x = level;
         }
-        gfc->ATH->cb_s[i] = x;
+        t->ath_cb_s[i] = x;
 
         /* MINVAL.
            For low freq, the strength of the masking is limited by minval
@@ -2039,42 +2130,22 @@ psymodel_init(lame_global_flags const *gfp)
         gd->s.minval[i] = pow(10.0, x / 10) * gd->s.numlines[i];
     }
 
-    i = init_s3_values(&gd->s.s3, gd->s.s3ind, gd->s.npart, bval, bval_width, norm);
-    if (i)
-        return i;
+    if (init_s3_values(&gd->s.s3, gd->s.s3ind, gd->s.npart, bval, bval_width, norm)) {
+        psy_tables_free(t);
+        return NULL;
+    }
 
-
-    init_mask_add_max_values();
-    init_fft(gfc);
+    init_mask_add_consts(&gd->mask_add);
 
     /* setup temporal masking */
     gd->decay = exp(-1.0 * LOG10 / (temporalmask_sustain_sec * sfreq / 192.0));
 
-    {
-        FLOAT   msfix;
-        msfix = NS_MSFIX;
-        if (cfg->use_safe_joint_stereo)
-            msfix = 1.0;
-        if (fabs(cfg->msfix) > 0.0)
-            msfix = cfg->msfix;
-        cfg->msfix = msfix;
-
-        /* spread only from npart_l bands.  Normally, we use the spreading
-         * function to convolve from npart_l down to npart_l bands 
-         */
-        for (b = 0; b < gd->l.npart; b++)
-            if (gd->l.s3ind[b][1] > gd->l.npart - 1)
-                gd->l.s3ind[b][1] = gd->l.npart - 1;
-    }
-
-    /*  prepare for ATH auto adjustment:
-     *  we want to decrease the ATH by 12 dB per second
+    /* spread only from npart_l bands.  Normally, we use the spreading
+     * function to convolve from npart_l down to npart_l bands 
      */
-#define  frame_duration (576. * cfg->mode_gr / sfreq)
-    gfc->ATH->decay = pow(10., -12. / 10. * frame_duration);
-    gfc->ATH->adjust_factor = 0.01; /* minimum, for leading low loudness */
-    gfc->ATH->adjust_limit = 1.0; /* on lead, allow adjust up to maximum */
-#undef  frame_duration
+    for (b = 0; b < gd->l.npart; b++)
+        if (gd->l.s3ind[b][1] > gd->l.npart - 1)
+            gd->l.s3ind[b][1] = gd->l.npart - 1;
 
     assert(gd->l.bo[SBMAX_l - 1] <= gd->l.npart);
     assert(gd->s.bo[SBMAX_s - 1] <= gd->s.npart);
@@ -2089,12 +2160,12 @@ psymodel_init(lame_global_flags const *gfp)
             /* convert ATH dB to relative power (not dB) */
             /*  to determine eql_w */
             freq += freq_inc;
-            gfc->ATH->eql_w[i] = 1. / pow(10, ATHformula(cfg, freq) / 10);
-            eql_balance += gfc->ATH->eql_w[i];
+            t->ath_eql_w[i] = 1. / pow(10, ATHformula(cfg, freq) / 10);
+            eql_balance += t->ath_eql_w[i];
         }
         eql_balance = 1.0 / eql_balance;
         for (i = BLKSIZE / 2; --i >= 0;) { /* scale weights */
-            gfc->ATH->eql_w[i] *= eql_balance;
+            t->ath_eql_w[i] *= eql_balance;
         }
     }
     {
@@ -2153,5 +2224,114 @@ psymodel_init(lame_global_flags const *gfp)
     }
     memcpy(&gd->l_to_s, &gd->l, sizeof(gd->l_to_s));
     init_numline(&gd->l_to_s, sfreq, BLKSIZE, 192, SBMAX_s, gfc->scalefac_band.s);
+
+    /* the s3 arrays are the l_to_s ones too */
+    *bytes = sizeof(psy_tables_t);
+    for (b = 0; b < gd->l.npart; b++)
+        *bytes += (gd->l.s3ind[b][1] - gd->l.s3ind[b][0] + 1) * sizeof(FLOAT);
+    for (b = 0; b < gd->s.npart; b++)
+        *bytes += (gd->s.s3ind[b][1] - gd->s.s3ind[b][0] + 1) * sizeof(FLOAT);
+    return t;
+}
+
+
+/* the psychoacoustic model's state at the start of a stream: the masking and
+   energy history of the previous granules, and the ATH auto adjustment */
+void
+psymodel_reset(lame_internal_flags * gfc)
+{
+    PsyStateVar_t *const psv = &gfc->sv_psy;
+    int     i, j, sb;
+
+    memset(psv, 0, sizeof(*psv));
+    memset(&gfc->ov_psy, 0, sizeof(gfc->ov_psy));
+
+    psv->blocktype_old[0] = psv->blocktype_old[1] = NORM_TYPE; /* the vbr header is long blocks */
+
+    for (i = 0; i < 4; ++i) {
+        for (j = 0; j < CBANDS; ++j) {
+            psv->nb_l1[i][j] = 1e20;
+            psv->nb_l2[i][j] = 1e20;
+            psv->nb_s1[i][j] = psv->nb_s2[i][j] = 1.0;
+        }
+        for (sb = 0; sb < SBMAX_l; sb++) {
+            psv->en[i].l[sb] = 1e20;
+            psv->thm[i].l[sb] = 1e20;
+        }
+        for (j = 0; j < 3; ++j) {
+            for (sb = 0; sb < SBMAX_s; sb++) {
+                psv->en[i].s[sb][j] = 1e20;
+                psv->thm[i].s[sb][j] = 1e20;
+            }
+            psv->last_attacks[i] = 0;
+        }
+        for (j = 0; j < 9; j++)
+            psv->last_en_subshort[i][j] = 10.;
+    }
+
+    /* init. for loudness approx. -jd 2001 mar 27 */
+    psv->loudness_sq_save[0] = psv->loudness_sq_save[1] = 0.0;
+
+    gfc->ATH->adjust_factor = 0.01; /* minimum, for leading low loudness */
+    gfc->ATH->adjust_limit = 1.0; /* on lead, allow adjust up to maximum */
+}
+
+
+int
+psymodel_init(lame_global_flags const *gfp)
+{
+    lame_internal_flags *const gfc = gfp->internal_flags;
+    SessionConfig_t *const cfg = &gfc->cfg;
+    psy_tables_key_t key;
+    psy_tables_t const *t;
+    FLOAT const sfreq = cfg->samplerate_out;
+
+    if (gfc->cd_psy != 0) {
+        return 0;
+    }
+
+    psymodel_reset(gfc);
+
+    /* the constants, from the encoders of the same configuration if any */
+    init_mask_add_max_values();
+    memset(&key, 0, sizeof(key));
+    key.samplerate_out = cfg->samplerate_out;
+    key.ATHtype = cfg->ATHtype;
+    key.ATHcurve = cfg->ATHcurve;
+    key.minval = cfg->minval;
+    key.experimentalZ = gfp->experimentalZ;
+    key.attackthre = gfp->attackthre;
+    key.attackthre_s = gfp->attackthre_s;
+    key.VBR_q = gfp->VBR_q;
+    key.VBR_q_frac = gfp->VBR_q_frac;
+    t = table_cache_acquire(&key, sizeof(key), psy_tables_build, psy_tables_free, (void *) gfp);
+    if (t == NULL)
+        return -1;
+    gfc->cd_psy = &t->cd;
+    memcpy(gfc->ATH->cb_l, t->ath_cb_l, sizeof(t->ath_cb_l));
+    memcpy(gfc->ATH->cb_s, t->ath_cb_s, sizeof(t->ath_cb_s));
+    if (cfg->ATHtype != -1)
+        memcpy(gfc->ATH->eql_w, t->ath_eql_w, sizeof(t->ath_eql_w));
+
+    init_fft(gfc);
+    init_psy_cores(gfc);
+
+    {
+        FLOAT   msfix;
+        msfix = NS_MSFIX;
+        if (cfg->use_safe_joint_stereo)
+            msfix = 1.0;
+        if (fabs(cfg->msfix) > 0.0)
+            msfix = cfg->msfix;
+        cfg->msfix = msfix;
+    }
+
+    /*  prepare for ATH auto adjustment:
+     *  we want to decrease the ATH by 12 dB per second
+     */
+#define  frame_duration (576. * cfg->mode_gr / sfreq)
+    gfc->ATH->decay = pow(10., -12. / 10. * frame_duration);
+#undef  frame_duration
+
     return 0;
 }
@@ -37,6 +37,16 @@ int     L3psycho_anal_vbr(lame_internal_flags * gfc,
 
 
 int     psymodel_init(lame_global_flags const* gfp);
+void    psymodel_reset(lame_internal_flags * gfc);
+
+/* C versions of the routines behind gfc->psy_*_core */
+void    psy_spread_core_c(FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2], int npart,
+                          FLOAT const *eb, FLOAT const *tab_idx, int const *delta,
+                          PsyMaskAdd_t const *ma);
+
+void    psy_ms_thresholds_core_c(const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                                 const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS],
+                                 FLOAT athlower, FLOAT msfix, int n);
 
 
 #define rpelev 2
@@ -168,6 +168,7 @@ const scalefac_struct sfBandIndex[9] = {
 
 
 
+#ifdef RUNTIME_TABLES
 FLOAT   pow20[Q_MAX + Q_MAX2 + 1];
 FLOAT   ipow20[Q_MAX];
 FLOAT   pow43[PRECALC_SIZE];
@@ -177,6 +178,10 @@ FLOAT   adj43asm[PRECALC_SIZE];
 #else
 FLOAT   adj43[PRECALC_SIZE];
 #endif
+#else
+/* calculated at build time by calctables.c */
+#include "quantize_tables.h"
+#endif
 
 /* 
 compute the ATH for each scalefactor band 
@@ -347,6 +352,7 @@ iteration_init(lame_internal_flags * gfc)
         l3_side->main_data_begin = 0;
         compute_ath(gfc);
 
+#ifdef RUNTIME_TABLES
         pow43[0] = 0.0;
         for (i = 1; i < PRECALC_SIZE; i++)
             pow43[i] = pow((FLOAT) i, 4.0 / 3.0);
@@ -364,6 +370,7 @@ iteration_init(lame_internal_flags * gfc)
             ipow20[i] = pow(2.0, (double) (i - 210) * -0.1875);
         for (i = 0; i <= Q_MAX + Q_MAX2; i++)
             pow20[i] = pow(2.0, (double) (i - 210 - Q_MAX2) * 0.25);
+#endif
 
         huffman_init(gfc);
         init_xrpow_core_init(gfc);
@@ -119,6 +119,14 @@ int     scale_bitcount(const lame_internal_flags * gfc, gr_info * cod_info);
 
 void    huffman_init(lame_internal_flags * const gfc);
 
+/* the C versions of gfc->quantize_lines_xrpow_core, _01_core,
+   quantize_pseudohalf_core and choose_table */
+void    quantize_lines_xrpow_core_c(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix);
+void    quantize_lines_xrpow_01_core_c(unsigned int l, FLOAT istep, const FLOAT * xr,
+                                       int *ix);
+void    quantize_pseudohalf_core_c(unsigned int l, FLOAT roundfac, const FLOAT * xr, int *ix);
+int     choose_table_c(const int *ix, const int *const end, int *const s);
+
 void    init_xrpow_core_init(lame_internal_flags * const gfc);
 
 FLOAT   athAdjust(FLOAT a, FLOAT x, FLOAT athFloor, float ATHfixpoint);
@@ -145,6 +145,9 @@ ResvFrameBegin(lame_internal_flags * gfc, int *mean_bits)
         esv->ResvMax = resvLimit;
     if (esv->ResvMax < 0 || cfg->disable_reservoir)
         esv->ResvMax = 0;
+    /* the next frame must not borrow any bits from this one */
+    if (gfc->ov_enc.frame_number == cfg->reservoir_barrier)
+        esv->ResvMax = 0;
     
     fullFrameBits = meanBits * cfg->mode_gr + Min(esv->ResvSize, esv->ResvMax);
 
@@ -34,6 +34,7 @@
 
 #include "set_get.h"
 #include "lame_global_flags.h"
+#include "table_cache.h"
 
 /*
  * input stream description
@@ -208,6 +209,35 @@ lame_get_out_samplerate(const lame_global_flags * gfp)
     return 0;
 }
 
+/* resampling filter, used when the output sample rate differs from the input's */
+int
+lame_set_resample_quality(lame_global_flags * gfp, int resample_quality)
+{
+    if (is_lame_global_flags_valid(gfp)) {
+        /*
+         * default = 0
+         * 0: Blackman windowed sinc, 32 taps (LAME's original resampler)
+         * 1: polyphase Kaiser windowed sinc, 40 taps (fastest)
+         * 2: polyphase, 48 taps
+         * 3: polyphase, 96 taps (best)
+         */
+        if (0 > resample_quality || 3 < resample_quality)
+            return -1;
+        gfp->resample_quality = resample_quality;
+        return 0;
+    }
+    return -1;
+}
+
+int
+lame_get_resample_quality(const lame_global_flags * gfp)
+{
+    if (is_lame_global_flags_valid(gfp)) {
+        return gfp->resample_quality;
+    }
+    return 0;
+}
+
 
 
 
@@ -958,6 +988,30 @@ lame_get_disable_reservoir(const lame_global_flags * gfp)
     return 0;
 }
 
+/* Empty the bit reservoir at the end of the given frame, so that the frame
+   after it has main_data_begin == 0 and decodes without any earlier frame. */
+int
+lame_set_reservoir_barrier(lame_global_flags * gfp, int reservoir_barrier)
+{
+    if (is_lame_global_flags_valid(gfp)) {
+        /* default = -1 (none) */
+        if (-1 > reservoir_barrier)
+            return -1;
+        gfp->reservoir_barrier = reservoir_barrier;
+        return 0;
+    }
+    return -1;
+}
+
+int
+lame_get_reservoir_barrier(const lame_global_flags * gfp)
+{
+    if (is_lame_global_flags_valid(gfp)) {
+        return gfp->reservoir_barrier;
+    }
+    return -1;
+}
+
 
 
 
@@ -1998,6 +2052,27 @@ lame_get_encoder_padding(const lame_global_flags * gfp)
 }
 
 
+/* bytes of the tables shared with the encoders of the same configuration */
+size_t
+lame_get_table_bytes(const lame_global_flags * gfp)
+{
+    if (is_lame_global_flags_valid(gfp)) {
+        lame_internal_flags const *const gfc = gfp->internal_flags;
+        if (is_lame_internal_flags_valid(gfc)) {
+            return table_cache_bytes(gfc->cd_psy) + table_cache_bytes(gfc->sv_enc.rs_bank);
+        }
+    }
+    return 0;
+}
+
+/* the shared tables of all the encoders of the process */
+void
+lame_get_table_cache_stats(int *tables, size_t * bytes)
+{
+    table_cache_stats(tables, bytes);
+}
+
+
 /* Size of MPEG frame. */
 int
 lame_get_framesize(const lame_global_flags * gfp)
@@ -0,0 +1,171 @@
+/*
+ *      process-wide cache of the immutable encoder tables
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Some of what lame_init_params() computes depends on nothing but the
+ * configuration: the psychoacoustic model constants (partitions, spreading
+ * functions, ATH and minimum masking per partition) and the polyphase
+ * resampler's filter bank. Encoders of the same configuration get to share
+ * one read-only copy of those, reference counted, rather than each building
+ * and holding its own.
+ *
+ * Every table is keyed by exactly the inputs it is computed from, so two
+ * encoders only share a table when they would have built identical ones.
+ * There are only ever a few configurations in use, so the cache is a list.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+#include "table_cache.h"
+
+#if defined(_WIN32)
+static SRWLOCK cache_lock = SRWLOCK_INIT;
+# define LOCK()   AcquireSRWLockExclusive(&cache_lock)
+# define UNLOCK() ReleaseSRWLockExclusive(&cache_lock)
+#else
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+# define LOCK()   pthread_mutex_lock(&cache_lock)
+# define UNLOCK() pthread_mutex_unlock(&cache_lock)
+#endif
+
+typedef struct table_entry {
+    struct table_entry *next;
+    table_build_t build;     /* tells the kinds of table apart */
+    table_free_t destroy;
+    void   *table;
+    size_t  bytes;
+    int     refs;
+    size_t  key_size;
+    /* followed by the key */
+} table_entry_t;
+
+static table_entry_t *entries = NULL;
+
+
+void   *
+table_cache_acquire(void const *key, size_t key_size, table_build_t build,
+                    table_free_t destroy, void *arg)
+{
+    table_entry_t *e;
+    void   *table = NULL;
+
+    LOCK();
+    for (e = entries; e != NULL; e = e->next) {
+        if (e->build == build && e->key_size == key_size && memcmp(e + 1, key, key_size) == 0) {
+            e->refs++;
+            table = e->table;
+            break;
+        }
+    }
+    if (table == NULL) {
+        e = malloc(sizeof(table_entry_t) + key_size);
+        if (e != NULL) {
+            e->table = build(key, arg, &e->bytes);
+            if (e->table != NULL) {
+                e->build = build;
+                e->destroy = destroy;
+                e->refs = 1;
+                e->key_size = key_size;
+                memcpy(e + 1, key, key_size);
+                e->next = entries;
+                entries = e;
+                table = e->table;
+            }
+            else
+                free(e);
+        }
+    }
+    UNLOCK();
+    return table;
+}
+
+
+void
+table_cache_release(void const *table)
+{
+    table_entry_t **p, *e = NULL;
+
+    if (table == NULL)
+        return;
+    LOCK();
+    for (p = &entries; *p != NULL; p = &(*p)->next) {
+        if ((*p)->table == table) {
+            if (--(*p)->refs == 0) {
+                e = *p;
+                *p = e->next;
+            }
+            break;
+        }
+    }
+    UNLOCK();
+    if (e != NULL) {
+        e->destroy(e->table);
+        free(e);
+    }
+}
+
+
+void
+table_cache_stats(int *tables, size_t * bytes)
+{
+    table_entry_t *e;
+    int     n = 0;
+    size_t  size = 0;
+
+    LOCK();
+    for (e = entries; e != NULL; e = e->next) {
+        n++;
+        size += e->bytes;
+    }
+    UNLOCK();
+    if (tables)
+        *tables = n;
+    if (bytes)
+        *bytes = size;
+}
+
+
+size_t
+table_cache_bytes(void const *table)
+{
+    table_entry_t *e;
+    size_t  size = 0;
+
+    if (table == NULL)
+        return 0;
+    LOCK();
+    for (e = entries; e != NULL; e = e->next) {
+        if (e->table == table) {
+            size = e->bytes;
+            break;
+        }
+    }
+    UNLOCK();
+    return size;
+}
@@ -0,0 +1,41 @@
+/*
+ *	process-wide cache of the immutable encoder tables include file
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef LAME_TABLE_CACHE_H
+#define LAME_TABLE_CACHE_H
+
+/* builds the table for a key, and sets *bytes to its size; NULL on failure */
+typedef void *(*table_build_t) (void const *key, void *arg, size_t * bytes);
+typedef void (*table_free_t) (void *table);
+
+/* the table for the key from the cache, built (under the cache lock) if no
+   encoder has it yet; encoders only ever read it */
+void   *table_cache_acquire(void const *key, size_t key_size, table_build_t build,
+                            table_free_t destroy, void *arg);
+
+/* one encoder less using the table, freed with the last one */
+void    table_cache_release(void const *table);
+
+/* the number of cached tables and their total size */
+void    table_cache_stats(int *tables, size_t * bytes);
+
+/* the size of a table from the cache, 0 for NULL */
+size_t  table_cache_bytes(void const *table);
+
+#endif /* LAME_TABLE_CACHE_H */
@@ -33,6 +33,7 @@
 #include "util.h"
 #include "quantize_pvt.h"
 #include "tables.h"
+#include "vector/lame_intrin.h"
 
 
 static const struct {
@@ -110,8 +111,8 @@ static const struct {
 
 
 
-static void
-quantize_lines_xrpow_01(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
+void
+quantize_lines_xrpow_01_core_c(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
 {
     const FLOAT compareval0 = (1.0f - 0.4054f) / istep;
     unsigned int i;
@@ -130,6 +131,18 @@ quantize_lines_xrpow_01(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
 
 
 
+void
+quantize_pseudohalf_core_c(unsigned int l, FLOAT roundfac, const FLOAT * xr, int *ix)
+{
+    unsigned int k;
+
+    for (k = 0; k < l; ++k) {
+        ix[k] = (xr[k] >= roundfac) ? ix[k] : 0;
+    }
+}
+
+
+
 #ifdef TAKEHIRO_IEEE754_HACK
 
 typedef union {
@@ -140,9 +153,8 @@ typedef union {
 #define MAGIC_FLOAT (65536*(128))
 #define MAGIC_INT 0x4b000000
 
-
-static void
-quantize_lines_xrpow(unsigned int l, FLOAT istep, const FLOAT * xp, int *pi)
+void
+quantize_lines_xrpow_core_c(unsigned int l, FLOAT istep, const FLOAT * xp, int *pi)
 {
     fi_union *fi;
     unsigned int remaining;
@@ -219,8 +231,8 @@ quantize_lines_xrpow(unsigned int l, FLOAT istep, const FLOAT * xp, int *pi)
 #define ROUNDFAC 0.4054
 
 
-static void
-quantize_lines_xrpow(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
+void
+quantize_lines_xrpow_core_c(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
 {
     unsigned int remaining;
 
@@ -279,8 +291,8 @@ quantize_lines_xrpow(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
  *********************************************************************/
 
 static void
-quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_info,
-               calc_noise_data const *prev_noise)
+quantize_xrpow(lame_internal_flags const *const gfc, const FLOAT * xp, int *pi, FLOAT istep,
+               gr_info const *const cod_info, calc_noise_data const *prev_noise)
 {
     /* quantize on xr^(3/4) instead of xr */
     int     sfb;
@@ -324,11 +336,11 @@ quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_
             /* do not recompute this part,
                but compute accumulated lines */
             if (accumulate) {
-                quantize_lines_xrpow(accumulate, istep, acc_xp, acc_iData);
+                gfc->quantize_lines_xrpow_core(accumulate, istep, acc_xp, acc_iData);
                 accumulate = 0;
             }
             if (accumulate01) {
-                quantize_lines_xrpow_01(accumulate01, istep, acc_xp, acc_iData);
+                gfc->quantize_lines_xrpow_01_core(accumulate01, istep, acc_xp, acc_iData);
                 accumulate01 = 0;
             }
         }
@@ -363,7 +375,7 @@ quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_
                 prev_noise->step[sfb] > 0 && step >= prev_noise->step[sfb]) {
 
                 if (accumulate) {
-                    quantize_lines_xrpow(accumulate, istep, acc_xp, acc_iData);
+                    gfc->quantize_lines_xrpow_core(accumulate, istep, acc_xp, acc_iData);
                     accumulate = 0;
                     acc_iData = iData;
                     acc_xp = xp;
@@ -372,7 +384,7 @@ quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_
             }
             else {
                 if (accumulate01) {
-                    quantize_lines_xrpow_01(accumulate01, istep, acc_xp, acc_iData);
+                    gfc->quantize_lines_xrpow_01_core(accumulate01, istep, acc_xp, acc_iData);
                     accumulate01 = 0;
                     acc_iData = iData;
                     acc_xp = xp;
@@ -385,11 +397,11 @@ quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_
                  *  may happen due to "prev_data_use" optimization 
                  */
                 if (accumulate01) {
-                    quantize_lines_xrpow_01(accumulate01, istep, acc_xp, acc_iData);
+                    gfc->quantize_lines_xrpow_01_core(accumulate01, istep, acc_xp, acc_iData);
                     accumulate01 = 0;
                 }
                 if (accumulate) {
-                    quantize_lines_xrpow(accumulate, istep, acc_xp, acc_iData);
+                    gfc->quantize_lines_xrpow_core(accumulate, istep, acc_xp, acc_iData);
                     accumulate = 0;
                 }
 
@@ -403,11 +415,11 @@ quantize_xrpow(const FLOAT * xp, int *pi, FLOAT istep, gr_info const *const cod_
         }
     }
     if (accumulate) {   /*last data part */
-        quantize_lines_xrpow(accumulate, istep, acc_xp, acc_iData);
+        gfc->quantize_lines_xrpow_core(accumulate, istep, acc_xp, acc_iData);
         accumulate = 0;
     }
     if (accumulate01) { /*last data part */
-        quantize_lines_xrpow_01(accumulate01, istep, acc_xp, acc_iData);
+        gfc->quantize_lines_xrpow_01_core(accumulate01, istep, acc_xp, acc_iData);
         accumulate01 = 0;
     }
 
@@ -615,8 +627,8 @@ static count_fnc count_fncs[] =
 , &count_bit_noESC_from3
 };
 
-static int
-choose_table_nonMMX(const int *ix, const int *const end, int *const _s)
+int
+choose_table_c(const int *ix, const int *const end, int *const _s)
 {
     unsigned int* s = (unsigned int*)_s;
     unsigned int  max;
@@ -776,7 +788,7 @@ count_bits(lame_internal_flags const *const gfc,
     if (gi->xrpow_max > w)
         return LARGE_BITS;
 
-    quantize_xrpow(xr, ix, IPOW20(gi->global_gain), gi, prev_noise);
+    quantize_xrpow(gfc, xr, ix, IPOW20(gi->global_gain), gi, prev_noise);
 
     if (gfc->sv_qnt.substep_shaping & 2) {
         int     sfb, j = 0;
@@ -790,10 +802,8 @@ count_bits(lame_internal_flags const *const gfc,
                 j += width;
             }
             else {
-                int     k;
-                for (k = j, j += width; k < j; ++k) {
-                    ix[k] = (xr[k] >= roundfac) ? ix[k] : 0;
-                }
+                gfc->quantize_pseudohalf_core(width, roundfac, xr + j, ix + j);
+                j += width;
             }
         }
     }
@@ -1327,20 +1337,28 @@ scale_bitcount(const lame_internal_flags * gfc, gr_info * cod_info)
 }
 
 
-#ifdef MMX_choose_table
-extern int choose_table_MMX(const int *ix, const int *const end, int *const s);
-#endif
-
 void
 huffman_init(lame_internal_flags * const gfc)
 {
     int     i;
 
-    gfc->choose_table = choose_table_nonMMX;
+    gfc->choose_table = choose_table_c;
+    gfc->quantize_lines_xrpow_core = quantize_lines_xrpow_core_c;
+    gfc->quantize_lines_xrpow_01_core = quantize_lines_xrpow_01_core_c;
+    gfc->quantize_pseudohalf_core = quantize_pseudohalf_core_c;
 
-#ifdef MMX_choose_table
-    if (gfc->CPU_features.MMX) {
-        gfc->choose_table = choose_table_MMX;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2) {
+        gfc->quantize_lines_xrpow_core = quantize_lines_xrpow_core_sse;
+        gfc->quantize_lines_xrpow_01_core = quantize_lines_xrpow_01_core_sse;
+        gfc->quantize_pseudohalf_core = quantize_pseudohalf_core_sse;
+    }
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2) {
+        gfc->quantize_lines_xrpow_core = quantize_lines_xrpow_core_avx2;
+        gfc->quantize_lines_xrpow_01_core = quantize_lines_xrpow_01_core_avx2;
+        gfc->quantize_pseudohalf_core = quantize_pseudohalf_core_avx2;
     }
 #endif
 
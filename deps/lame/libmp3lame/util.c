@@ -31,6 +31,8 @@
 #include "encoder.h"
 #include "util.h"
 #include "tables.h"
+#include "vector/lame_intrin.h"
+#include "table_cache.h"
 
 #define PRECOMPUTE
 #if defined(__FreeBSD__) && !defined(__alpha__)
@@ -92,15 +94,8 @@ static void
 free_global_data(lame_internal_flags * gfc)
 {
     if (gfc && gfc->cd_psy) {
-        if (gfc->cd_psy->l.s3) {
-            /* XXX allocated in psymodel_init() */
-            free(gfc->cd_psy->l.s3);
-        }
-        if (gfc->cd_psy->s.s3) {
-            /* XXX allocated in psymodel_init() */
-            free(gfc->cd_psy->s.s3);
-        }
-        free(gfc->cd_psy);
+        /* XXX shared with the encoders of the same configuration, see psymodel_init() */
+        table_cache_release(gfc->cd_psy);
         gfc->cd_psy = 0;
     }
 }
@@ -125,6 +120,14 @@ freegfc(lame_internal_flags * const gfc)
         free(gfc->sv_enc.inbuf_old[1]);
         gfc->sv_enc.inbuf_old[1] = NULL;
     }
+    table_cache_release(gfc->sv_enc.rs_bank);
+    gfc->sv_enc.rs_bank = NULL;
+    if (gfc->sv_enc.rs_hist[0]) {
+        free(gfc->sv_enc.rs_hist[0]);
+        gfc->sv_enc.rs_hist[0] = NULL;
+        gfc->sv_enc.rs_hist[1] = NULL;
+        gfc->sv_enc.rs_edge = NULL;
+    }
 
     if (gfc->bs.buf != NULL) {
         free(gfc->bs.buf);
@@ -148,6 +151,9 @@ freegfc(lame_internal_flags * const gfc)
     if (gfc->sv_enc.in_buffer_1) {
         free(gfc->sv_enc.in_buffer_1);
     }
+    if (gfc->group) {
+        free(gfc->group);
+    }
     free_id3tag(gfc);
 
 #ifdef DECODE_ON_THE_FLY
@@ -648,6 +654,314 @@ fill_buffer_resample(lame_internal_flags * gfc,
     return k;           /* return the number samples created at the new samplerate */
 }
 
+/* polyphase resampling: a Kaiser windowed sinc, precomputed for every
+ * output time between two input samples
+ *
+ * The output sample at input time c + f (0 <= f < 1) is the inner product of
+ * the rs_taps input samples c - rs_taps/2 + 1 ... c + rs_taps/2 with the
+ * filter for phase f.  When samplerate_out / gcd(samplerate_out,
+ * samplerate_in) is small (44.1 <-> 48 kHz: 147 or 160) every phase has its
+ * own filter and the output times are exact, otherwise the phase is rounded
+ * to the nearest of RS_MAX_ROWS + 1 filters.
+ */
+
+#define RS_MAX_ROWS 1024
+#define RS_MAX_TAPS 512
+#define RS_BATCH 64
+
+/* filter length (when not downsampling), -6 dB point as a fraction of the
+   lower Nyquist frequency, and Kaiser window beta, for resample_quality 1..3.
+   Every level is within 0.5 dB up to 0.9 x the Nyquist frequency, like the
+   Blackman filter, and has a THD+N of -100 dB or better at 1 kHz; the longer
+   filters reject more of what lies between the two Nyquist frequencies. */
+static const struct {
+    int     taps;
+    double  rolloff;
+    double  beta;
+} rs_quality[4] = {
+    {0, 0, 0},
+    {40, 0.98, 10.0},
+    {48, 0.97, 11.0},
+    {96, 0.97, 13.0}
+};
+
+/* zeroth order modified Bessel function of the first kind */
+static double
+bessel_i0(double x)
+{
+    double  sum = 1, term = 1;
+    int     k;
+
+    for (k = 1; k < 64 && term > 1e-12 * sum; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static int
+resample_taps(SessionConfig_t const *cfg)
+{
+    int const in = cfg->samplerate_in, out = cfg->samplerate_out;
+    int     taps = rs_quality[cfg->resample_quality].taps;
+
+    /* the transition band is as wide relative to the output's Nyquist
+       frequency when downsampling */
+    if (in > out)
+        taps = (int) ceil((double) taps * in / out);
+    taps = (taps + 7) & ~7;
+    return Min(taps, RS_MAX_TAPS);
+}
+
+/* input samples needed past an output sample's time, see lame_encode_flush() */
+int
+resample_delay(lame_internal_flags const *gfc)
+{
+    if (gfc->cfg.resample_quality == 0)
+        return 16;
+    return gfc->sv_enc.rs_taps / 2;
+}
+
+void
+resample_core_c(sample_t * out, sample_t const *const *x, FLOAT const *const *h, int n,
+                int taps)
+{
+    int     k, i, j;
+
+    /* 8 partial sums, added up in the same order as the vector versions */
+    for (k = 0; k < n; k++) {
+        sample_t const *const xk = x[k];
+        FLOAT const *const hk = h[k];
+        FLOAT   s[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        for (i = 0; i < taps; i += 8)
+            for (j = 0; j < 8; j++)
+                s[j] += xk[i + j] * hk[i + j];
+        out[k] = ((s[0] + s[4]) + (s[2] + s[6])) + ((s[1] + s[5]) + (s[3] + s[7]));
+    }
+}
+
+/* what a filter bank is computed from */
+typedef struct {
+    int     samplerate_in;
+    int     samplerate_out;
+    int     resample_quality;
+} resample_bank_key_t;
+
+static void
+resample_bank_free(void *table)
+{
+    resample_bank_t *const rb = table;
+    free_aligned(&rb->coef);
+    free(rb);
+}
+
+static void *
+resample_bank_build(void const *key, void *arg, size_t * bytes)
+{
+    SessionConfig_t const *const cfg = arg;
+    int const g = gcd(cfg->samplerate_out, cfg->samplerate_in);
+    int const phases = cfg->samplerate_out / g;
+    int const step = cfg->samplerate_in / g;
+    int const taps = resample_taps(cfg);
+    int const rows = phases <= RS_MAX_ROWS ? phases : RS_MAX_ROWS + 1;
+    resample_bank_t *rb;
+    double  fc, i0_beta;
+    FLOAT  *bank;
+    int     r, i;
+
+    (void) key;
+    rb = calloc(1, sizeof(resample_bank_t));
+    if (rb == NULL)
+        return NULL;
+    malloc_aligned(&rb->coef, rows * taps * sizeof(FLOAT), 32);
+    if (rb->coef.aligned == NULL) {
+        free(rb);
+        return NULL;
+    }
+    *bytes = sizeof(resample_bank_t) + rows * taps * sizeof(FLOAT);
+
+    /* cutoff relative to the input's Nyquist frequency */
+    fc = rs_quality[cfg->resample_quality].rolloff * Min(1., (double) phases / step);
+    i0_beta = bessel_i0(rs_quality[cfg->resample_quality].beta);
+    bank = rb->coef.aligned;
+    for (r = 0; r < rows; r++) {
+        double const f = rows == phases ? (double) r / phases : (double) r / (rows - 1);
+        double  sum = 0;
+
+        for (i = 0; i < taps; i++) {
+            double const t = f + taps / 2 - 1 - i; /* from the input sample to the output */
+            double const u = t / (taps / 2);
+            double  v = 0;
+
+            if (fabs(u) < 1) {
+                double const w =
+                    bessel_i0(rs_quality[cfg->resample_quality].beta * sqrt(1 - u * u)) / i0_beta;
+                v = fabs(t) < 1e-9 ? fc : fc * sin(PI * fc * t) / (PI * fc * t);
+                v *= w;
+            }
+            bank[r * taps + i] = v;
+            sum += v;
+        }
+        /* unity gain at DC */
+        for (i = 0; i < taps; i++)
+            bank[r * taps + i] /= sum;
+    }
+    return rb;
+}
+
+/* called by lame_init_params() */
+int
+init_resample(lame_internal_flags * gfc)
+{
+    SessionConfig_t const *const cfg = &gfc->cfg;
+    EncStateVar_t *const esv = &gfc->sv_enc;
+    int const g = gcd(cfg->samplerate_out, cfg->samplerate_in);
+    int const phases = cfg->samplerate_out / g;
+    int const step = cfg->samplerate_in / g;
+    resample_bank_key_t key;
+    int     taps, rows, i;
+
+    gfc->resample_core = resample_core_c;
+#if defined(HAVE_XMMINTRIN_H)
+    if (gfc->CPU_features.SSE2)
+        gfc->resample_core = resample_core_sse;
+#endif
+#if defined(HAVE_IMMINTRIN_H)
+    if (gfc->CPU_features.AVX2)
+        gfc->resample_core = resample_core_avx2;
+#endif
+
+    table_cache_release(esv->rs_bank);
+    esv->rs_bank = NULL;
+    if (esv->rs_hist[0]) {
+        free(esv->rs_hist[0]);
+        esv->rs_hist[0] = esv->rs_hist[1] = esv->rs_edge = NULL;
+    }
+    esv->rs_taps = 0;
+    if (cfg->resample_quality == 0 || !isResamplingNecessary(cfg))
+        return 0;
+
+    /* the filter bank, from the encoders of the same rates and quality if any */
+    memset(&key, 0, sizeof(key));
+    key.samplerate_in = cfg->samplerate_in;
+    key.samplerate_out = cfg->samplerate_out;
+    key.resample_quality = cfg->resample_quality;
+    esv->rs_bank = table_cache_acquire(&key, sizeof(key), resample_bank_build,
+                                       resample_bank_free, (void *) cfg);
+
+    taps = resample_taps(cfg);
+    rows = phases <= RS_MAX_ROWS ? phases : RS_MAX_ROWS + 1;
+    esv->rs_hist[0] = calloc(4 * taps, sizeof(sample_t));
+    if (esv->rs_bank == NULL || esv->rs_hist[0] == NULL)
+        return -2;
+    esv->rs_hist[1] = esv->rs_hist[0] + taps;
+    esv->rs_edge = esv->rs_hist[1] + taps;
+
+    esv->rs_taps = taps;
+    esv->rs_phases = phases;
+    esv->rs_rows = rows;
+    esv->rs_step = step / phases;
+    esv->rs_step_frac = step % phases;
+    for (i = 0; i < 2; i++) {
+        /* the first output is at the first input sample */
+        esv->rs_center[i] = taps;
+        esv->rs_phase[i] = 0;
+    }
+    return 0;
+}
+
+/* the resampler's state at the start of a stream: no input history, and the
+   first output at the first input sample */
+void
+reset_resample(lame_internal_flags * gfc)
+{
+    SessionConfig_t const *const cfg = &gfc->cfg;
+    EncStateVar_t *const esv = &gfc->sv_enc;
+    int     i;
+
+    if (gfc->fill_buffer_resample_init) {
+        /* same filter length as in fill_buffer_resample() */
+        double const resample_ratio = (double)cfg->samplerate_in / (double)cfg->samplerate_out;
+        int const intratio = (fabs(resample_ratio - floor(.5 + resample_ratio)) < .0001);
+        int const blacksize = 31 + intratio + 1;
+
+        for (i = 0; i < 2; i++) {
+            memset(esv->inbuf_old[i], 0, blacksize * sizeof(esv->inbuf_old[0][0]));
+            esv->itime[i] = 0;
+        }
+    }
+    if (esv->rs_hist[0] != NULL) {
+        memset(esv->rs_hist[0], 0, 4 * esv->rs_taps * sizeof(sample_t));
+        for (i = 0; i < 2; i++) {
+            esv->rs_center[i] = esv->rs_taps;
+            esv->rs_phase[i] = 0;
+        }
+    }
+}
+
+static int
+fill_buffer_polyphase(lame_internal_flags * gfc,
+                      sample_t * outbuf,
+                      int desired_len, sample_t const *inbuf, int len, int *num_used, int ch)
+{
+    EncStateVar_t *const esv = &gfc->sv_enc;
+    int const taps = esv->rs_taps;
+    int const phases = esv->rs_phases;
+    int const rows = esv->rs_rows;
+    FLOAT const *const bank = esv->rs_bank->coef.aligned;
+    sample_t *const hist = esv->rs_hist[ch];
+    sample_t *const edge = esv->rs_edge;
+    sample_t const *x[RS_BATCH];
+    FLOAT const *h[RS_BATCH];
+    int     center = esv->rs_center[ch];
+    int     phase = esv->rs_phase[ch];
+    int     k = 0, n = 0, used, i;
+
+    /* the inputs are numbered from hist[0]: hist holds taps of them, and
+       outputs whose filter starts there read this copy instead */
+    memcpy(edge, hist, taps * sizeof(sample_t));
+    for (i = 0; i < taps; i++)
+        edge[taps + i] = i < len ? inbuf[i] : 0;
+
+    while (k + n < desired_len) {
+        int const first = center - taps / 2 + 1;
+        int const row = rows == phases ? phase : (phase * (rows - 1) + phases / 2) / phases;
+
+        /* check if we need more input data */
+        if (first > len)
+            break;
+        x[n] = first < taps ? edge + first : inbuf + first - taps;
+        h[n] = bank + row * taps;
+        if (++n == RS_BATCH) {
+            gfc->resample_core(outbuf + k, x, h, n, taps);
+            k += n;
+            n = 0;
+        }
+        center += esv->rs_step;
+        phase += esv->rs_step_frac;
+        if (phase >= phases) {
+            phase -= phases;
+            center++;
+        }
+    }
+    gfc->resample_core(outbuf + k, x, h, n, taps);
+    k += n;
+
+    /* all the input the next output doesn't need ahead of its time */
+    used = Min(len, center - taps / 2);
+    esv->rs_center[ch] = center - used;
+    esv->rs_phase[ch] = phase;
+    *num_used = used;
+
+    /* keep the last taps inputs */
+    if (used >= taps)
+        memcpy(hist, inbuf + used - taps, taps * sizeof(sample_t));
+    else
+        memcpy(hist, edge + used, taps * sizeof(sample_t));
+    return k;
+}
+
 int
 isResamplingNecessary(SessionConfig_t const* cfg)
 {
@@ -673,9 +987,12 @@ fill_buffer(lame_internal_flags * gfc,
     /* copy in new samples into mfbuf, with resampling if necessary */
     if (isResamplingNecessary(cfg)) {
         do {
-            nout =
-                fill_buffer_resample(gfc, &mfbuf[ch][mf_size],
-                                     framesize, in_buffer[ch], nsamples, n_in, ch);
+            if (cfg->resample_quality == 0)
+                nout = fill_buffer_resample(gfc, &mfbuf[ch][mf_size],
+                                            framesize, in_buffer[ch], nsamples, n_in, ch);
+            else
+                nout = fill_buffer_polyphase(gfc, &mfbuf[ch][mf_size],
+                                             framesize, in_buffer[ch], nsamples, n_in, ch);
         } while (++ch < nch);
         *n_out = nout;
     }
@@ -766,6 +1083,13 @@ lame_errorf(const lame_internal_flags* gfc, const char *format, ...)
  *
  ***********************************************************************/
 
+/* SSE and SSE2 on 32-bit x86, and AVX2 and AVX-512 (which also need OS
+ * support for the wider registers), are only detected with the cpuid
+ * builtins of gcc and clang */
+#if defined( HAVE_XMMINTRIN_H ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_CPU_SUPPORTS
+#endif
+
 #ifdef HAVE_NASM
 extern int has_MMX_nasm(void);
 extern int has_3DNow_nasm(void);
@@ -799,8 +1123,11 @@ has_SSE(void)
 #ifdef HAVE_NASM
     return has_SSE_nasm();
 #else
-#if defined( _M_X64 ) || defined( MIN_ARCH_SSE )
-    return 1;
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( MIN_ARCH_SSE )
+    return 1;           /* in the baseline of the build */
+#elif defined( HAVE_CPU_SUPPORTS )
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse") != 0;
 #else
     return 0;           /* don't know, assume not */
 #endif
@@ -813,11 +1140,36 @@ has_SSE2(void)
 #ifdef HAVE_NASM
     return has_SSE2_nasm();
 #else
-#if defined( _M_X64 ) || defined( MIN_ARCH_SSE )
-    return 1;
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( MIN_ARCH_SSE )
+    return 1;           /* in the baseline of the build */
+#elif defined( HAVE_CPU_SUPPORTS )
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#else
+    return 0;           /* don't know, assume not */
+#endif
+#endif
+}
+
+int
+has_AVX2(void)
+{
+#ifdef HAVE_CPU_SUPPORTS
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
 #else
     return 0;           /* don't know, assume not */
 #endif
+}
+
+int
+has_AVX512(void)
+{
+#ifdef HAVE_CPU_SUPPORTS
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") != 0;
+#else
+    return 0;           /* don't know, assume not */
 #endif
 }
 
@@ -949,6 +1301,7 @@ disable_FPE(void)
 #define LOG2_SIZE       (512)
 #define LOG2_SIZE_L2    (9)
 
+#ifdef RUNTIME_TABLES
 static ieee754_float32_t log_table[LOG2_SIZE + 1];
 
 
@@ -968,6 +1321,17 @@ init_log_table(void)
     }
     init = 1;
 }
+#else
+/* calculated at build time by calctables.c */
+#include "log_table.h"
+
+
+
+void
+init_log_table(void)
+{
+}
+#endif
 
 
 
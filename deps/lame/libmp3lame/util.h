@@ -127,6 +127,12 @@ extern  "C" {
         void   *pointer;     /* to use with malloc/free */
     } aligned_pointer_t;
 
+    /* the polyphase resampler's filter bank, shared by the encoders of the
+       same rates and quality, see init_resample() */
+    typedef struct resample_bank {
+        aligned_pointer_t coef;
+    } resample_bank_t;
+
     void    malloc_aligned(aligned_pointer_t * ptr, unsigned int size, unsigned int bytes);
     void    free_aligned(aligned_pointer_t * ptr);
 
@@ -207,6 +213,18 @@ extern  "C" {
     } PsyConst_CB2SB_t;
 
 
+    /**
+     *  constants of the masking addition in the spreading function,
+     *  for the vector versions of it
+     */
+    typedef struct {
+        FLOAT   max_i1;      /* near partitions: ratios from here on just add up */
+        FLOAT   max_i2;      /* far partitions: ratios below here add up */
+        FLOAT   table2[10];  /* gain of a near sum, indexed by 16 * log10(ratio) */
+        FLOAT   ratio_i[10]; /* smallest ratio with table2 index >= i */
+    } PsyMaskAdd_t;
+
+
     /**
      *  global data constants
      */
@@ -217,6 +235,7 @@ extern  "C" {
         FLOAT   attack_threshold[4];
         FLOAT   decay;
         int     force_short_block_calc;
+        PsyMaskAdd_t mask_add;
     } PsyConst_t;
 
 
@@ -259,6 +278,18 @@ extern  "C" {
         sample_t *inbuf_old[2];
         sample_t *blackfilt[2 * BPC + 1];
 
+        /* the polyphase resampler (resample_quality > 0) */
+        resample_bank_t const *rs_bank; /* rs_rows filters of rs_taps coefficients, shared */
+        sample_t *rs_hist[2]; /* the last rs_taps input samples of each channel */
+        sample_t *rs_edge;   /* rs_hist[ch] followed by the first rs_taps new samples */
+        int     rs_taps;     /* filter length, a multiple of 8 */
+        int     rs_phases;   /* output times between two input samples */
+        int     rs_rows;     /* rs_phases, or RS_MAX_ROWS + 1 if that's too many */
+        int     rs_step;     /* input samples from one output sample to the next */
+        int     rs_step_frac; /* ... and the fraction, in 1/rs_phases */
+        int     rs_center[2]; /* next output time, in input samples from rs_hist[ch][0] */
+        int     rs_phase[2]; /* ... and the fraction, in 1/rs_phases */
+
         FLOAT   pefirbuf[19];
         
         /* used for padding */
@@ -304,6 +335,15 @@ extern  "C" {
     } EncStateVar_t;
 
 
+    /* the analysis lame_encode_buffer_group() did for the next frame of an
+       encoder, at the same time as for the other encoders of the group */
+    typedef struct {
+        FLOAT   sb_sample[2][2][18][SBLIMIT]; /* [ch][gr], window_subband() output */
+        FLOAT   wsamp_L[2][2][BLKSIZE]; /* [ch][gr], fft_long() output */
+        int     ready[2];    /* per channel: whether the above are for the next frame */
+    } GroupAnalysis_t;
+
+
     typedef struct {
         /* simple statistics */
         int     bitrate_channelmode_hist[16][4 + 1];
@@ -388,6 +428,7 @@ extern  "C" {
         int     highpassfreq;
         int     samplerate_in; /* input_samp_rate in Hz. default=44.1 kHz     */
         int     samplerate_out; /* output_samp_rate. */
+        int     resample_quality; /* 0 = Blackman FIR, 1..3 = polyphase, fast..best */
         int     channels_in; /* number of channels in the input data stream (PCM or decoded PCM) */
         int     channels_out; /* number of channels in the output data stream (not used for decoding) */
         int     mode_gr;     /* granules per frame */
@@ -413,6 +454,7 @@ extern  "C" {
         int     decode_on_the_fly; /* decode on the fly? default=0                */
         int     analysis;
         int     disable_reservoir;
+        int     reservoir_barrier; /* frame that drains the reservoir, or -1 */
         int     buffer_constraint;  /* enforce ISO spec as much as possible   */
         int     free_format;
         int     write_lame_tag; /* add Xing VBR tag?                           */
@@ -520,7 +562,9 @@ extern  "C" {
             unsigned int AMD_3DNow:1; /* K6-2, K6-III, Athlon      */
             unsigned int SSE:1; /* Pentium III, Pentium 4    */
             unsigned int SSE2:1; /* Pentium 4, K8             */
-            unsigned int _unused:28;
+            unsigned int AVX2:1; /* Haswell, Zen              */
+            unsigned int AVX512:1; /* Skylake-X, Zen 4        */
+            unsigned int _unused:26;
         } CPU_features;
 
 
@@ -528,7 +572,10 @@ extern  "C" {
 
         ATH_t  *ATH;         /* all ATH related stuff */
 
-        PsyConst_t *cd_psy;
+        PsyConst_t const *cd_psy; /* shared, see psymodel_init() */
+
+        /* allocated by the first lame_encode_buffer_group() call */
+        GroupAnalysis_t *group;
 
         /* used by the frame analyzer */
         plotting_data *pinfo;
@@ -538,10 +585,60 @@ extern  "C" {
 
         /* functions to replace with CPU feature optimized versions in takehiro.c */
         int     (*choose_table) (const int *ix, const int *const end, int *const s);
+        void    (*quantize_lines_xrpow_core) (unsigned int l, FLOAT istep, const FLOAT * xr,
+                                              int *ix);
+        void    (*quantize_lines_xrpow_01_core) (unsigned int l, FLOAT istep,
+                                                 const FLOAT * xr, int *ix);
+        void    (*quantize_pseudohalf_core) (unsigned int l, FLOAT roundfac,
+                                             const FLOAT * xr, int *ix);
         void    (*fft_fht) (FLOAT *, int);
         void    (*init_xrpow_core) (gr_info * const cod_info, FLOAT xrpow[576], int upper,
                                     FLOAT * sum);
 
+        /* functions to replace with CPU feature optimized versions in newmdct.c */
+        void    (*window_subband_core) (const sample_t * x1, FLOAT a[SBLIMIT],
+                                        FLOAT const (*w)[16]);
+        void    (*mdct_long_core) (FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                                   int const *order, FLOAT const *w, FLOAT const *ws);
+
+        /* functions to replace with CPU feature optimized versions in psymodel.c */
+        void    (*psy_spread_core) (FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2],
+                                    int npart, FLOAT const *eb, FLOAT const *tab_idx,
+                                    int const *delta, PsyMaskAdd_t const *ma);
+        void    (*psy_ms_thresholds_core) (const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                                           const FLOAT cb_mld[CBANDS],
+                                           const FLOAT ath_cb[CBANDS], FLOAT athlower,
+                                           FLOAT msfix, int n);
+
+        /* functions to replace with CPU feature optimized versions in lame.c */
+        void    (*copy_inbuffer_short_core) (sample_t * ib0, sample_t * ib1, const short *l,
+                                             const short *r, int n, int jump, FLOAT const *m);
+        void    (*copy_inbuffer_float_core) (sample_t * ib0, sample_t * ib1, const float *l,
+                                             const float *r, int n, int jump, FLOAT const *m);
+        void    (*copy_inbuffer_int_core) (sample_t * ib0, sample_t * ib1, const int *l,
+                                           const int *r, int n, int jump, FLOAT const *m);
+        void    (*copy_inbuffer_s24_core) (sample_t * ib0, sample_t * ib1,
+                                           const unsigned char *l, const unsigned char *r,
+                                           int n, int jump, FLOAT const *m);
+        void    (*copy_inbuffer_u8_core) (sample_t * ib0, sample_t * ib1,
+                                          const unsigned char *l, const unsigned char *r,
+                                          int n, int jump, FLOAT const *m);
+
+        /* the cross-stream versions for lame_encode_buffer_group(), which do
+           group_lanes channels at once (none if group_lanes is 0) */
+#define MAX_GROUP_LANES 8
+        int     group_lanes;
+        void    (*group_interleave) (FLOAT * xs, sample_t const *const *x, int n);
+        void    (*group_deinterleave) (FLOAT * const *x, FLOAT const *xs, int n);
+        void    (*window_subband_group_core) (FLOAT const *x1, FLOAT * out, FLOAT const *wp,
+                                              FLOAT const (*w)[16]);
+        void    (*fft_long_group_core) (FLOAT * x, FLOAT const *xs, FLOAT const *window,
+                                        unsigned char const *rv_tbl);
+
+        /* functions to replace with CPU feature optimized versions in util.c */
+        void    (*resample_core) (sample_t * out, sample_t const *const *x,
+                                  FLOAT const *const *h, int n, int taps);
+
         lame_report_function report_msg;
         lame_report_function report_dbg;
         lame_report_function report_err;
@@ -574,11 +671,35 @@ extern  "C" {
     extern ieee754_float32_t fast_log2(ieee754_float32_t x);
 
     int     isResamplingNecessary(SessionConfig_t const* cfg);
+    int     init_resample(lame_internal_flags * gfc);
+    void    reset_resample(lame_internal_flags * gfc);
+    int     resample_delay(lame_internal_flags const * gfc);
 
     void    fill_buffer(lame_internal_flags * gfc,
                         sample_t *const mfbuf[2],
                         sample_t const *const in_buffer[2], int nsamples, int *n_in, int *n_out);
 
+/* the C versions of gfc->copy_inbuffer_*_core */
+    void    copy_inbuffer_short_core_c(sample_t * ib0, sample_t * ib1, const short *l,
+                                       const short *r, int n, int jump, FLOAT const *m);
+    void    copy_inbuffer_float_core_c(sample_t * ib0, sample_t * ib1, const float *l,
+                                       const float *r, int n, int jump, FLOAT const *m);
+    void    copy_inbuffer_int_core_c(sample_t * ib0, sample_t * ib1, const int *l,
+                                     const int *r, int n, int jump, FLOAT const *m);
+    void    copy_inbuffer_s24_core_c(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                                     const unsigned char *r, int n, int jump, FLOAT const *m);
+    void    copy_inbuffer_u8_core_c(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                                    const unsigned char *r, int n, int jump, FLOAT const *m);
+
+/* the C version of gfc->resample_core */
+    void    resample_core_c(sample_t * out, sample_t const *const *x, FLOAT const *const *h,
+                            int n, int taps);
+
+/* one packed 24 bit little endian sample, and one unsigned 8 bit sample */
+#define PCM_S24LE(p)    ((int) ((unsigned int) (p)[0] << 8 | (unsigned int) (p)[1] << 16 \
+                                | (unsigned int) (p)[2] << 24) >> 8)
+#define PCM_U8(p)       (*(p) - 128)
+
 /* same as lame_decode1 (look in lame.h), but returns
    unclipped raw floating-point samples. It is declared
    here, not in lame.h, because it returns LAME's
@@ -592,6 +713,8 @@ extern  "C" {
     extern int has_3DNow(void);
     extern int has_SSE(void);
     extern int has_SSE2(void);
+    extern int has_AVX2(void);
+    extern int has_AVX512(void);
 
 
 
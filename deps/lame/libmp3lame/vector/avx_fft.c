@@ -0,0 +1,118 @@
+/*
+ * Fast Hartley transform, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "fft.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(). This file is compiled with -ffp-contract=off,
+ * like the other vector routines */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+/* 4 lanes, for the twiddle factors the 8 lane loop leaves */
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_avx2_4
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VLOADR(p)       avx2_loadr4(p)
+#define VSTORE(p, v)    _mm_storeu_ps(p, v)
+#define VSTORER(p, v)   avx2_storer4(p, v)
+#define VADD(x, y)      _mm_add_ps(x, y)
+#define VSUB(x, y)      _mm_sub_ps(x, y)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VNO_FHT
+
+static inline AVX2_TARGET __m128
+avx2_loadr4(const float *p)
+{
+    return _mm_permute_ps(_mm_loadu_ps(p - 3), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+static inline AVX2_TARGET void
+avx2_storer4(float *p, __m128 v)
+{
+    _mm_storeu_ps(p - 3, _mm_permute_ps(v, _MM_SHUFFLE(0, 1, 2, 3)));
+}
+
+#include "fft_vec.h"
+
+#undef VEC
+#undef LANES
+#undef VNAME
+#undef VLOAD
+#undef VLOADR
+#undef VSTORE
+#undef VSTORER
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VNO_FHT
+
+
+/* 8 lanes */
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VHALF(name)     name##_avx2_4
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VLOADR(p)       avx2_loadr(p)
+#define VSTORE(p, v)    _mm256_storeu_ps(p, v)
+#define VSTORER(p, v)   avx2_storer(p, v)
+#define VADD(x, y)      _mm256_add_ps(x, y)
+#define VSUB(x, y)      _mm256_sub_ps(x, y)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+
+static inline AVX2_TARGET __m256
+avx2_loadr(const float *p)
+{
+    return _mm256_permutevar8x32_ps(_mm256_loadu_ps(p - 7),
+                                    _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+static inline AVX2_TARGET void
+avx2_storer(float *p, __m256 v)
+{
+    __m256i const reverse = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    _mm256_storeu_ps(p - 7, _mm256_permutevar8x32_ps(v, reverse));
+}
+
+#include "fft_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
@@ -0,0 +1,107 @@
+/*
+ * Cross-stream analysis filterbank and FFT, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "fft.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(). This file is compiled with -ffp-contract=off,
+ * like the other vector routines */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VSTORE(p, v)    _mm256_storeu_ps(p, v)
+#define VSET1(x)        _mm256_set1_ps(x)
+#define VADD(x, y)      _mm256_add_ps(x, y)
+#define VSUB(x, y)      _mm256_sub_ps(x, y)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+#define VTRANSPOSE(r)   avx2_transpose(r)
+#define VSQRT2(x)       avx2_sqrt2(x, _mm256_setzero_ps(), 0)
+#define VSQRT2SUB(x, y) avx2_sqrt2(x, y, 1)
+
+static inline AVX2_TARGET void
+avx2_transpose(__m256 r[8])
+{
+    __m256 const t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 const t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 const t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 const t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 const t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 const t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 const t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 const t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 const u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 const u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 const u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 const u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 const u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 const u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 const u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 const u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    /* the unpacks and shuffles work within each 128 bit half */
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+/* SQRT2 * x (less y if "sub"), in double */
+static inline AVX2_TARGET __m256
+avx2_sqrt2(__m256 x, __m256 y, int sub)
+{
+    __m256d const c = _mm256_set1_pd(SQRT2);
+    __m256d lo = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), c);
+    __m256d hi = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), c);
+    if (sub) {
+        lo = _mm256_sub_pd(lo, _mm256_cvtps_pd(_mm256_castps256_ps128(y)));
+        hi = _mm256_sub_pd(hi, _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)));
+    }
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)),
+                                _mm256_cvtpd_ps(hi), 1);
+}
+
+#include "group_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
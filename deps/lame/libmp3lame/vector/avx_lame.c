@@ -0,0 +1,96 @@
+/*
+ * Input buffer copy, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(). This file is compiled with -ffp-contract=off,
+ * like the other vector routines */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VSTORE(p, v)    _mm256_storeu_ps(p, v)
+#define VSET1(x)        _mm256_set1_ps(x)
+#define VADD(x, y)      _mm256_add_ps(x, y)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+#define VCVT(x)         _mm256_cvtepi32_ps(x)
+#define VSPLIT(a, b, l, r) do { \
+        __m256 const a_ = (a), b_ = (b); \
+        l = avx2_fix_order(_mm256_shuffle_ps(a_, b_, _MM_SHUFFLE(2, 0, 2, 0))); \
+        r = avx2_fix_order(_mm256_shuffle_ps(a_, b_, _MM_SHUFFLE(3, 1, 3, 1))); \
+    } while (0)
+#define VLOADS16(p)     _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32( \
+                            _mm_loadu_si128((__m128i const *) (p))))
+#define VLOADS16_2(p, l, r) do { \
+        __m256i const x_ = _mm256_loadu_si256((__m256i const *) (p)); \
+        l = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(x_, 16), 16)); \
+        r = _mm256_cvtepi32_ps(_mm256_srai_epi32(x_, 16)); \
+    } while (0)
+#define VILOADS32(p)    _mm256_loadu_si256((__m256i const *) (p))
+#define VILOADS24(p)    avx2_load_s24(p)
+#define VILOADU8(p)     _mm256_sub_epi32(_mm256_cvtepu8_epi32( \
+                            _mm_loadl_epi64((__m128i const *) (p))), _mm256_set1_epi32(128))
+#define VS24_SLACK      2
+
+/* the in-lane shuffles leave a0 a2 b0 b2 a4 a6 b4 b6 */
+static inline AVX2_TARGET __m256
+avx2_fix_order(__m256 v)
+{
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                  _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+/* 4 samples from the first 12 bytes of each 16 byte lane, to the top 24
+   bits of the ints, then sign extended */
+static inline AVX2_TARGET __m256i
+avx2_load_s24(const unsigned char *p)
+{
+    __m256i const shuf = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                          -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    __m256i const x = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((__m128i const *) p)),
+        _mm_loadu_si128((__m128i const *) (p + 12)), 1);
+    return _mm256_srai_epi32(_mm256_shuffle_epi8(x, shuf), 8);
+}
+
+#include "lame_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
@@ -0,0 +1,153 @@
+/*
+ * MP3 window subband and mdct, AVX2 and AVX-512 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2() or has_AVX512(), so the rest of the library
+ * is built for the baseline instruction set. This file is compiled with
+ * -ffp-contract=off: AVX-512 has fused multiply-adds of its own, and the
+ * products and sums must stay separately rounded */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+# define AVX512_TARGET  __attribute__((target("avx512f")))
+#else
+# define AVX2_TARGET
+# define AVX512_TARGET
+#endif
+
+
+/* AVX2, 8 lanes */
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VLOADR(p)       avx2_loadr(p)
+#define VSET1(x)        _mm256_set1_ps(x)
+#define VADD(x, y)      _mm256_add_ps(x, y)
+#define VSUB(x, y)      _mm256_sub_ps(x, y)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+#define VSTORE(p, v)    _mm256_storeu_ps(p, v)
+#define VSTORE2(p, u, v) avx2_store2(p, u, v)
+#define VGATHER(p, o)   avx2_gather(p, o)
+
+static inline AVX2_TARGET __m256
+avx2_loadr(const float *p)
+{
+    return _mm256_permutevar8x32_ps(_mm256_loadu_ps(p - 7),
+                                    _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+static inline AVX2_TARGET void
+avx2_store2(float *p, __m256 u, __m256 v)
+{
+    /* the unpacks work within each 128 bit half */
+    __m256 const lo = _mm256_unpacklo_ps(u, v);
+    __m256 const hi = _mm256_unpackhi_ps(u, v);
+    _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(p + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+static inline AVX2_TARGET __m128
+avx2_gather_half(const float *p, int const *o)
+{
+    __m128 const lo = _mm_loadl_pi(_mm_setzero_ps(), (__m64 const *) (p + o[0]));
+    return _mm_loadh_pi(lo, (__m64 const *) (p + o[2]));
+}
+
+static inline AVX2_TARGET __m256
+avx2_gather(const float *p, int const *o)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(avx2_gather_half(p, o)),
+                                avx2_gather_half(p, o + 4), 1);
+}
+
+#include "newmdct_vec.h"
+
+#undef VEC
+#undef LANES
+#undef VNAME
+#undef VTARGET
+#undef VLOAD
+#undef VLOADR
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VSTORE
+#undef VSTORE2
+#undef VGATHER
+
+
+/* AVX-512, 16 lanes. There are only ever 8 bands of the same block type in a
+ * row, so the mdct uses the AVX2 version */
+
+#define VEC             __m512
+#define LANES           16
+#define VNAME(name)     name##_avx512
+#define VTARGET         AVX512_TARGET
+#define VLOAD(p)        _mm512_loadu_ps(p)
+#define VLOADR(p)       avx512_loadr(p)
+#define VSET1(x)        _mm512_set1_ps(x)
+#define VADD(x, y)      _mm512_add_ps(x, y)
+#define VSUB(x, y)      _mm512_sub_ps(x, y)
+#define VMUL(x, y)      _mm512_mul_ps(x, y)
+#define VSTORE(p, v)    _mm512_storeu_ps(p, v)
+#define VSTORE2(p, u, v) avx512_store2(p, u, v)
+#define VNO_MDCT
+
+static inline AVX512_TARGET __m512
+avx512_loadr(const float *p)
+{
+    return _mm512_permutexvar_ps(_mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                                  8, 9, 10, 11, 12, 13, 14, 15),
+                                 _mm512_loadu_ps(p - 15));
+}
+
+static inline AVX512_TARGET void
+avx512_store2(float *p, __m512 u, __m512 v)
+{
+    /* the unpacks work within each 128 bit quarter: put them back in order */
+    __m512 const lo = _mm512_unpacklo_ps(u, v);
+    __m512 const hi = _mm512_unpackhi_ps(u, v);
+    __m512 const a = _mm512_shuffle_f32x4(lo, hi, _MM_SHUFFLE(1, 0, 1, 0));
+    __m512 const b = _mm512_shuffle_f32x4(lo, hi, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm512_storeu_ps(p, _mm512_shuffle_f32x4(a, a, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm512_storeu_ps(p + 16, _mm512_shuffle_f32x4(b, b, _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+#include "newmdct_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
@@ -0,0 +1,76 @@
+/*
+ * psychoacoustic model, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(), so the rest of the library is built for the
+ * baseline instruction set. This file is compiled with -ffp-contract=off, so
+ * that products and sums stay separately rounded */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+
+/* AVX2, 8 lanes */
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VSTORE(p, v)    _mm256_storeu_ps(p, v)
+#define VSET1(x)        _mm256_set1_ps(x)
+#define VIVEC           __m256i
+#define VILOAD(p)       _mm256_loadu_si256((__m256i const *) (p))
+#define VISET1(x)       _mm256_set1_epi32(x)
+#define VIADD(x, y)     _mm256_add_epi32(x, y)
+#define VIMASK(m, x)    _mm256_and_si256(_mm256_castps_si256(m), x)
+#define VGATHERI(p, o)  _mm256_i32gather_ps(p, o, 4)
+#define VADD(x, y)      _mm256_add_ps(x, y)
+#define VSUB(x, y)      _mm256_sub_ps(x, y)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+#define VDIV(x, y)      _mm256_div_ps(x, y)
+#define VMIN(x, y)      _mm256_min_ps(x, y)
+#define VMAX(x, y)      _mm256_max_ps(x, y)
+#define VCMPLT(x, y)    _mm256_cmp_ps(x, y, _CMP_LT_OQ)
+#define VCMPLE(x, y)    _mm256_cmp_ps(x, y, _CMP_LE_OQ)
+#define VAND(m, x)      _mm256_and_ps(m, x)
+#define VANDNOT(m, x)   _mm256_andnot_ps(m, x)
+#define VBLEND(a, b, m) _mm256_blendv_ps(a, b, m)
+
+#include "psymodel_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
@@ -0,0 +1,82 @@
+/*
+ * Polyphase resampler inner products, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(). This file is compiled with -ffp-contract=off,
+ * like the other vector routines */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+/* the sums of the 8 partial sums, in the order of resample_core_c() */
+static inline AVX2_TARGET float
+avx2_sum8(__m256 s)
+{
+    __m128 const v = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    __m128 const t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+void AVX2_TARGET
+resample_core_avx2(sample_t * out, sample_t const *const *x, FLOAT const *const *h, int n,
+                   int taps)
+{
+    int     k, i;
+
+    /* two outputs at a time, for two independent dependency chains */
+    for (k = 0; k + 2 <= n; k += 2) {
+        sample_t const *const x0 = x[k], *const x1 = x[k + 1];
+        FLOAT const *const h0 = h[k], *const h1 = h[k + 1];
+        __m256  s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+
+        for (i = 0; i < taps; i += 8) {
+            s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(x0 + i), _mm256_load_ps(h0 + i)));
+            s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(x1 + i), _mm256_load_ps(h1 + i)));
+        }
+        out[k] = avx2_sum8(s0);
+        out[k + 1] = avx2_sum8(s1);
+    }
+    if (k < n) {
+        __m256  s = _mm256_setzero_ps();
+
+        for (i = 0; i < taps; i += 8)
+            s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_loadu_ps(x[k] + i), _mm256_load_ps(h[k] + i)));
+        out[k] = avx2_sum8(s);
+    }
+}
+
+#endif	/* HAVE_IMMINTRIN_H */
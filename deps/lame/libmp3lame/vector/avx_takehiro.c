@@ -0,0 +1,97 @@
+/*
+ * MP3 quantization, AVX2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "quantize_pvt.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_IMMINTRIN_H
+
+#include <immintrin.h>
+
+/* only called after has_AVX2(). This file is compiled with -ffp-contract=off,
+ * like the other vector routines */
+#ifdef __GNUC__
+# define AVX2_TARGET    __attribute__((target("avx2")))
+#else
+# define AVX2_TARGET
+#endif
+
+#define VEC             __m256
+#define LANES           8
+#define VNAME(name)     name##_avx2
+#define VTARGET         AVX2_TARGET
+#define VLOAD(p)        _mm256_loadu_ps(p)
+#define VSET1(x)        _mm256_set1_ps(x)
+#define VMUL(x, y)      _mm256_mul_ps(x, y)
+#define VILOAD(p)       _mm256_loadu_si256((__m256i const *) (p))
+#define VISTORE(p, v)   _mm256_storeu_si256((__m256i *) (p), v)
+#define VQUANTIZE(x)    avx2_quantize(x)
+#define VQUANTIZE01(x, c) _mm256_andnot_si256(_mm256_castps_si256( \
+                            _mm256_cmp_ps(x, c, _CMP_LT_OQ)), _mm256_set1_epi32(1))
+#define VCMPGE(a, b)    _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ))
+#define VIAND(a, b)     _mm256_and_si256(a, b)
+
+/* as in takehiro.c */
+#ifdef TAKEHIRO_IEEE754_HACK
+#define MAGIC_FLOAT (65536*(128))
+#define MAGIC_INT 0x4b000000
+#endif
+
+static inline AVX2_TARGET __m256
+avx2_combine(__m128 lo, __m128 hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+static inline AVX2_TARGET __m256i
+avx2_quantize(__m256 x)
+{
+#ifdef TAKEHIRO_IEEE754_HACK
+    __m256d const magic = _mm256_set1_pd(MAGIC_FLOAT);
+    __m256i const magic_int = _mm256_set1_epi32(MAGIC_INT);
+    __m256d lo = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), magic);
+    __m256d hi = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), magic);
+    __m256  r = avx2_combine(_mm256_cvtpd_ps(lo), _mm256_cvtpd_ps(hi));
+    __m256  adj = _mm256_i32gather_ps(adj43asm, _mm256_sub_epi32(_mm256_castps_si256(r),
+                                                                 magic_int), 4);
+
+    lo = _mm256_add_pd(lo, _mm256_cvtps_pd(_mm256_castps256_ps128(adj)));
+    hi = _mm256_add_pd(hi, _mm256_cvtps_pd(_mm256_extractf128_ps(adj, 1)));
+    r = avx2_combine(_mm256_cvtpd_ps(lo), _mm256_cvtpd_ps(hi));
+    return _mm256_sub_epi32(_mm256_castps_si256(r), magic_int);
+#else
+    __m256 const adj = _mm256_i32gather_ps(adj43, _mm256_cvttps_epi32(x), 4);
+    return _mm256_cvttps_epi32(_mm256_add_ps(x, adj));
+#endif
+}
+
+#include "takehiro_vec.h"
+
+#endif	/* HAVE_IMMINTRIN_H */
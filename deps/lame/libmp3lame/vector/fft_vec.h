@@ -0,0 +1,185 @@
+/*
+ *      Fast Hartley transform, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of fht() for one vector size, included by xmm_fft.c and avx_fft.c
+ * after defining:
+ *
+ *   VEC           the vector type, with LANES floats
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p)      lane j is p[j]
+ *   VLOADR(p)     lane j is p[-j]
+ *   VSTORE(p, v)  p[j] is lane j
+ *   VSTORER(p, v) p[-j] is lane j
+ *   VADD, VSUB, VMUL
+ *   VHALF(name)   optional: the name of the same routines with LANES / 2
+ *                 lanes, for the twiddle factors that are left
+ *   VNO_FHT       only define the butterflies, not fht() itself
+ *
+ * Within a stage, the butterflies of twiddle factors i and i + 1 touch
+ * neighbouring elements (fi runs up, gi down), so one lane does the
+ * butterflies of one i. The twiddle factors are those fht() computes, from
+ * fht_twiddle[], and every lane does the same float operations as fht(), so
+ * the results are bit identical. This must not be compiled with FMA
+ * contraction.
+ */
+
+
+/* the butterflies of twiddle factors t..t + LANES - 1 of a stage, fi and gi
+   at those of the first block */
+static inline VTARGET void
+VNAME(fht_butterflies) (FLOAT * fi, FLOAT * gi, FLOAT const *fn, int t,
+                        int k1, int k2, int k3, int k4)
+{
+    VEC const c1 = VLOAD(&fht_twiddle[0][t]);
+    VEC const s1 = VLOAD(&fht_twiddle[1][t]);
+    VEC const c2 = VLOAD(&fht_twiddle[2][t]);
+    VEC const s2 = VLOAD(&fht_twiddle[3][t]);
+    do {
+        VEC     a, b, g0, f0, f1, g1, f2, g2, f3, g3;
+        VEC const fi0 = VLOAD(fi), fi1 = VLOAD(fi + k1);
+        VEC const fi2 = VLOAD(fi + k2), fi3 = VLOAD(fi + k3);
+        VEC const gi0 = VLOADR(gi), gi1 = VLOADR(gi + k1);
+        VEC const gi2 = VLOADR(gi + k2), gi3 = VLOADR(gi + k3);
+        b = VSUB(VMUL(s2, fi1), VMUL(c2, gi1));
+        a = VADD(VMUL(c2, fi1), VMUL(s2, gi1));
+        f1 = VSUB(fi0, a);
+        f0 = VADD(fi0, a);
+        g1 = VSUB(gi0, b);
+        g0 = VADD(gi0, b);
+        b = VSUB(VMUL(s2, fi3), VMUL(c2, gi3));
+        a = VADD(VMUL(c2, fi3), VMUL(s2, gi3));
+        f3 = VSUB(fi2, a);
+        f2 = VADD(fi2, a);
+        g3 = VSUB(gi2, b);
+        g2 = VADD(gi2, b);
+        b = VSUB(VMUL(s1, f2), VMUL(c1, g3));
+        a = VADD(VMUL(c1, f2), VMUL(s1, g3));
+        VSTORE(fi + k2, VSUB(f0, a));
+        VSTORE(fi, VADD(f0, a));
+        VSTORER(gi + k3, VSUB(g1, b));
+        VSTORER(gi + k1, VADD(g1, b));
+        b = VSUB(VMUL(c1, g2), VMUL(s1, f3));
+        a = VADD(VMUL(s1, g2), VMUL(c1, f3));
+        VSTORER(gi + k2, VSUB(g0, a));
+        VSTORER(gi, VADD(g0, a));
+        VSTORE(fi + k3, VSUB(f1, b));
+        VSTORE(fi + k1, VADD(f1, b));
+        gi += k4;
+        fi += k4;
+    } while (fi < fn);
+}
+
+
+#ifndef VNO_FHT
+
+/* fht(), LANES twiddle factors at a time */
+VTARGET void
+VNAME(fht) (FLOAT * fz, int n)
+{
+    int     k4;
+    FLOAT  *fi, *gi;
+    FLOAT const *fn;
+
+    n <<= 1;            /* to get BLKSIZE, because of 3DNow! ASM routine */
+    fn = fz + n;
+    k4 = 4;
+    do {
+        int     i, k1, k2, k3, kx;
+        kx = k4 >> 1;
+        k1 = k4;
+        k2 = k4 << 1;
+        k3 = k2 + k1;
+        k4 = k2 << 1;
+        fi = fz;
+        gi = fi + kx;
+        do {
+            FLOAT   f0, f1, f2, f3;
+            f1 = fi[0] - fi[k1];
+            f0 = fi[0] + fi[k1];
+            f3 = fi[k2] - fi[k3];
+            f2 = fi[k2] + fi[k3];
+            fi[k2] = f0 - f2;
+            fi[0] = f0 + f2;
+            fi[k3] = f1 - f3;
+            fi[k1] = f1 + f3;
+            f1 = gi[0] - gi[k1];
+            f0 = gi[0] + gi[k1];
+            f3 = SQRT2 * gi[k3];
+            f2 = SQRT2 * gi[k2];
+            gi[k2] = f0 - f2;
+            gi[0] = f0 + f2;
+            gi[k3] = f1 - f3;
+            gi[k1] = f1 + f3;
+            gi += k4;
+            fi += k4;
+        } while (fi < fn);
+
+        for (i = 1; i + LANES <= kx; i += LANES)
+            VNAME(fht_butterflies) (fz + i, fz + k1 - i, fn, kx + i, k1, k2, k3, k4);
+#ifdef VHALF
+        if (i + LANES / 2 <= kx) {
+            VHALF(fht_butterflies) (fz + i, fz + k1 - i, fn, kx + i, k1, k2, k3, k4);
+            i += LANES / 2;
+        }
+#endif
+
+        /* and the ones that are left, one at a time */
+        for (; i < kx; i++) {
+            FLOAT const c1 = fht_twiddle[0][kx + i];
+            FLOAT const s1 = fht_twiddle[1][kx + i];
+            FLOAT const c2 = fht_twiddle[2][kx + i];
+            FLOAT const s2 = fht_twiddle[3][kx + i];
+            fi = fz + i;
+            gi = fz + k1 - i;
+            do {
+                FLOAT   a, b, g0, f0, f1, g1, f2, g2, f3, g3;
+                b = s2 * fi[k1] - c2 * gi[k1];
+                a = c2 * fi[k1] + s2 * gi[k1];
+                f1 = fi[0] - a;
+                f0 = fi[0] + a;
+                g1 = gi[0] - b;
+                g0 = gi[0] + b;
+                b = s2 * fi[k3] - c2 * gi[k3];
+                a = c2 * fi[k3] + s2 * gi[k3];
+                f3 = fi[k2] - a;
+                f2 = fi[k2] + a;
+                g3 = gi[k2] - b;
+                g2 = gi[k2] + b;
+                b = s1 * f2 - c1 * g3;
+                a = c1 * f2 + s1 * g3;
+                fi[k2] = f0 - a;
+                fi[0] = f0 + a;
+                gi[k3] = g1 - b;
+                gi[k1] = g1 + b;
+                b = c1 * g2 - s1 * f3;
+                a = s1 * g2 + c1 * f3;
+                gi[k2] = g0 - a;
+                gi[0] = g0 + a;
+                fi[k3] = f1 - b;
+                fi[k1] = f1 + b;
+                gi += k4;
+                fi += k4;
+            } while (fi < fn);
+        }
+    } while (k4 < n);
+}
+
+#endif /* VNO_FHT */
@@ -0,0 +1,582 @@
+/*
+ *      Cross-stream analysis filterbank and FFT, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of the routines of lame_encode_buffer_group() for one vector size,
+ * included by xmm_group.c and avx_group.c after defining:
+ *
+ *   VEC           the vector type, with LANES floats
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p), VSTORE(p, v), VSET1(x), VADD, VSUB, VMUL
+ *   VTRANSPOSE(r) transposes the LANES x LANES matrix of the rows r[]
+ *   VSQRT2(x)     SQRT2 * x, rounded to float from double as C does
+ *   VSQRT2SUB(x, y)  SQRT2 * x - y, likewise
+ *
+ * Unlike the other vector routines, which split the work of one channel
+ * among the lanes, each lane here is one channel of another encoder: the
+ * samples are interleaved, with sample i of lane j at xs[i * LANES + j], and
+ * every lane does the whole of window_subband() or fft_long() for its
+ * channel. That is, the same float operations in the same order as the C
+ * versions, including the ones that C does in double because SQRT2 is a
+ * double, so the results are bit identical. This must not be compiled with
+ * FMA contraction.
+ */
+
+
+/* xs gets the n samples of each of the LANES channels x[], interleaved */
+VTARGET void
+VNAME(group_interleave) (FLOAT * xs, sample_t const *const *x, int n)
+{
+    int     i, j;
+
+    for (i = 0; i < n; i += LANES) {
+        VEC     r[LANES];
+        for (j = 0; j < LANES; j++)
+            r[j] = VLOAD(x[j] + i);
+        VTRANSPOSE(r);
+        for (j = 0; j < LANES; j++)
+            VSTORE(xs + (i + j) * LANES, r[j]);
+    }
+}
+
+
+/* and back: x[] get their n samples of xs */
+VTARGET void
+VNAME(group_deinterleave) (FLOAT * const *x, FLOAT const *xs, int n)
+{
+    int     i, j;
+
+    for (i = 0; i < n; i += LANES) {
+        VEC     r[LANES];
+        for (j = 0; j < LANES; j++)
+            r[j] = VLOAD(xs + (i + j) * LANES);
+        VTRANSPOSE(r);
+        for (j = 0; j < LANES; j++)
+            VSTORE(x[j] + i, r[j]);
+    }
+}
+
+
+#define X(k)            VLOAD(x1 + (k) * LANES)
+#define WP(k)           VSET1(wp[k])
+#define VNEG(x)         VMUL(x, VSET1(-1.0f))
+
+/* window_subband() of LANES channels: x1 is where each one's x1 is, a gets
+ * the 32 subband samples of each, interleaved. wp and w are window_subband()'s
+ * and window_subband_core()'s windows */
+VTARGET void
+VNAME(window_subband_group_core) (FLOAT const *x1, FLOAT * out, FLOAT const *wp,
+                                  FLOAT const (*w)[16])
+{
+    FLOAT const *x2 = x1 + (238 - 14 - 286) * LANES;
+    VEC     a[SBLIMIT];
+    int     j;
+
+    /* window_subband_core_c() */
+    for (j = 0; j < 15; j++) {
+        VEC     s, t;
+
+#define STEP(m, o2, o1) \
+        s = VADD(s, VMUL(VLOAD(x2 + (o2) * LANES), VSET1(w[m][j]))); \
+        t = VADD(t, VMUL(X(o1), VSET1(w[m][j])))
+#define STEP_REV(m, o1, o2) \
+        s = VADD(s, VMUL(X(o1), VSET1(w[m][j]))); \
+        t = VSUB(t, VMUL(VLOAD(x2 + (o2) * LANES), VSET1(w[m][j])))
+
+        s = VMUL(VLOAD(x2 + (-224) * LANES), VSET1(w[0][j]));
+        t = VMUL(X(224), VSET1(w[0][j]));
+        STEP(1, -160, 160);
+        STEP(2, -96, 96);
+        STEP(3, -32, 32);
+        STEP(4, 32, -32);
+        STEP(5, 96, -96);
+        STEP(6, 160, -160);
+        STEP(7, 224, -224);
+
+        STEP_REV(8, -256, 256);
+        STEP_REV(9, -192, 192);
+        STEP_REV(10, -128, 128);
+        STEP_REV(11, -64, 64);
+        STEP_REV(12, 0, 0);
+        STEP_REV(13, 64, -64);
+        STEP_REV(14, 128, -128);
+        STEP_REV(15, 192, -192);
+#undef STEP
+#undef STEP_REV
+
+        s = VMUL(s, VSET1(w[16][j]));
+        a[2 * j] = VADD(t, s);
+        a[2 * j + 1] = VMUL(VSET1(w[17][j]), VSUB(t, s));
+        x1 -= LANES;
+        x2 += LANES;
+    }
+
+    /* the rest of window_subband(), line by line */
+    {
+        VEC     s, t, u, v;
+        t = VMUL(X(-16), WP(-10));
+        s = VMUL(X(-32), WP(-2));
+        t = VADD(t, VMUL(VSUB(X(-48), X(16)), WP(-9)));
+        s = VADD(s, VMUL(X(-96), WP(-1)));
+        t = VADD(t, VMUL(VADD(X(-80), X(48)), WP(-8)));
+        s = VADD(s, VMUL(X(-160), WP(0)));
+        t = VADD(t, VMUL(VSUB(X(-112), X(80)), WP(-7)));
+        s = VADD(s, VMUL(X(-224), WP(1)));
+        t = VADD(t, VMUL(VADD(X(-144), X(112)), WP(-6)));
+        s = VSUB(s, VMUL(X(32), WP(2)));
+        t = VADD(t, VMUL(VSUB(X(-176), X(144)), WP(-5)));
+        s = VSUB(s, VMUL(X(96), WP(3)));
+        t = VADD(t, VMUL(VADD(X(-208), X(176)), WP(-4)));
+        s = VSUB(s, VMUL(X(160), WP(4)));
+        t = VADD(t, VMUL(VSUB(X(-240), X(208)), WP(-3)));
+        s = VSUB(s, X(224));
+
+        u = VSUB(s, t);
+        v = VADD(s, t);
+
+        t = a[14];
+        s = VSUB(a[15], t);
+
+        a[31] = VADD(v, t);
+        a[30] = VADD(u, s);
+        a[15] = VSUB(u, s);
+        a[14] = VSUB(v, t);
+    }
+    {
+        VEC     xr;
+        xr = VSUB(a[28], a[0]);
+        a[0] = VADD(a[0], a[28]);
+        a[28] = VMUL(xr, WP(-2 * 18 + 7));
+        xr = VSUB(a[29], a[1]);
+        a[1] = VADD(a[1], a[29]);
+        a[29] = VMUL(xr, WP(-2 * 18 + 7));
+
+        xr = VSUB(a[26], a[2]);
+        a[2] = VADD(a[2], a[26]);
+        a[26] = VMUL(xr, WP(-4 * 18 + 7));
+        xr = VSUB(a[27], a[3]);
+        a[3] = VADD(a[3], a[27]);
+        a[27] = VMUL(xr, WP(-4 * 18 + 7));
+
+        xr = VSUB(a[24], a[4]);
+        a[4] = VADD(a[4], a[24]);
+        a[24] = VMUL(xr, WP(-6 * 18 + 7));
+        xr = VSUB(a[25], a[5]);
+        a[5] = VADD(a[5], a[25]);
+        a[25] = VMUL(xr, WP(-6 * 18 + 7));
+
+        xr = VSUB(a[22], a[6]);
+        a[6] = VADD(a[6], a[22]);
+        a[22] = VSQRT2(xr);
+        xr = VSUB(a[23], a[7]);
+        a[7] = VADD(a[7], a[23]);
+        a[23] = VSQRT2SUB(xr, a[7]);
+        a[7] = VSUB(a[7], a[6]);
+        a[22] = VSUB(a[22], a[7]);
+        a[23] = VSUB(a[23], a[22]);
+
+        xr = a[6];
+        a[6] = VSUB(a[31], xr);
+        a[31] = VADD(a[31], xr);
+        xr = a[7];
+        a[7] = VSUB(a[30], xr);
+        a[30] = VADD(a[30], xr);
+        xr = a[22];
+        a[22] = VSUB(a[15], xr);
+        a[15] = VADD(a[15], xr);
+        xr = a[23];
+        a[23] = VSUB(a[14], xr);
+        a[14] = VADD(a[14], xr);
+
+        xr = VSUB(a[20], a[8]);
+        a[8] = VADD(a[8], a[20]);
+        a[20] = VMUL(xr, WP(-10 * 18 + 7));
+        xr = VSUB(a[21], a[9]);
+        a[9] = VADD(a[9], a[21]);
+        a[21] = VMUL(xr, WP(-10 * 18 + 7));
+
+        xr = VSUB(a[18], a[10]);
+        a[10] = VADD(a[10], a[18]);
+        a[18] = VMUL(xr, WP(-12 * 18 + 7));
+        xr = VSUB(a[19], a[11]);
+        a[11] = VADD(a[11], a[19]);
+        a[19] = VMUL(xr, WP(-12 * 18 + 7));
+
+        xr = VSUB(a[16], a[12]);
+        a[12] = VADD(a[12], a[16]);
+        a[16] = VMUL(xr, WP(-14 * 18 + 7));
+        xr = VSUB(a[17], a[13]);
+        a[13] = VADD(a[13], a[17]);
+        a[17] = VMUL(xr, WP(-14 * 18 + 7));
+
+        xr = VSUB(a[24], a[20]);
+        a[20] = VADD(a[20], a[24]);
+        a[24] = VMUL(xr, WP(-12 * 18 + 7));
+        xr = VSUB(a[25], a[21]);
+        a[21] = VADD(a[21], a[25]);
+        a[25] = VMUL(xr, WP(-12 * 18 + 7));
+
+        xr = VSUB(a[4], a[8]);
+        a[4] = VADD(a[4], a[8]);
+        a[8] = VMUL(xr, WP(-12 * 18 + 7));
+        xr = VSUB(a[5], a[9]);
+        a[5] = VADD(a[5], a[9]);
+        a[9] = VMUL(xr, WP(-12 * 18 + 7));
+
+        xr = VSUB(a[0], a[12]);
+        a[0] = VADD(a[0], a[12]);
+        a[12] = VMUL(xr, WP(-4 * 18 + 7));
+        xr = VSUB(a[1], a[13]);
+        a[1] = VADD(a[1], a[13]);
+        a[13] = VMUL(xr, WP(-4 * 18 + 7));
+        xr = VSUB(a[16], a[28]);
+        a[16] = VADD(a[16], a[28]);
+        a[28] = VMUL(xr, WP(-4 * 18 + 7));
+        xr = VSUB(a[29], a[17]);
+        a[17] = VADD(a[17], a[29]);
+        a[29] = VMUL(xr, WP(-4 * 18 + 7));
+
+        xr = VSQRT2(VSUB(a[2], a[10]));
+        a[2] = VADD(a[2], a[10]);
+        a[10] = xr;
+        xr = VSQRT2(VSUB(a[3], a[11]));
+        a[3] = VADD(a[3], a[11]);
+        a[11] = xr;
+        xr = VSQRT2(VSUB(a[26], a[18]));
+        a[18] = VADD(a[18], a[26]);
+        a[26] = VSUB(xr, a[18]);
+        xr = VSQRT2(VSUB(a[27], a[19]));
+        a[19] = VADD(a[19], a[27]);
+        a[27] = VSUB(xr, a[19]);
+
+        xr = a[2];
+        a[19] = VSUB(a[19], a[3]);
+        a[3] = VSUB(a[3], xr);
+        a[2] = VSUB(a[31], xr);
+        a[31] = VADD(a[31], xr);
+        xr = a[3];
+        a[11] = VSUB(a[11], a[19]);
+        a[18] = VSUB(a[18], xr);
+        a[3] = VSUB(a[30], xr);
+        a[30] = VADD(a[30], xr);
+        xr = a[18];
+        a[27] = VSUB(a[27], a[11]);
+        a[19] = VSUB(a[19], xr);
+        a[18] = VSUB(a[15], xr);
+        a[15] = VADD(a[15], xr);
+
+        xr = a[19];
+        a[10] = VSUB(a[10], xr);
+        a[19] = VSUB(a[14], xr);
+        a[14] = VADD(a[14], xr);
+        xr = a[10];
+        a[11] = VSUB(a[11], xr);
+        a[10] = VSUB(a[23], xr);
+        a[23] = VADD(a[23], xr);
+        xr = a[11];
+        a[26] = VSUB(a[26], xr);
+        a[11] = VSUB(a[22], xr);
+        a[22] = VADD(a[22], xr);
+        xr = a[26];
+        a[27] = VSUB(a[27], xr);
+        a[26] = VSUB(a[7], xr);
+        a[7] = VADD(a[7], xr);
+
+        xr = a[27];
+        a[27] = VSUB(a[6], xr);
+        a[6] = VADD(a[6], xr);
+
+        xr = VSQRT2(VSUB(a[0], a[4]));
+        a[0] = VADD(a[0], a[4]);
+        a[4] = xr;
+        xr = VSQRT2(VSUB(a[1], a[5]));
+        a[1] = VADD(a[1], a[5]);
+        a[5] = xr;
+        xr = VSQRT2(VSUB(a[16], a[20]));
+        a[16] = VADD(a[16], a[20]);
+        a[20] = xr;
+        xr = VSQRT2(VSUB(a[17], a[21]));
+        a[17] = VADD(a[17], a[21]);
+        a[21] = xr;
+
+        xr = VNEG(VSQRT2(VSUB(a[8], a[12])));
+        a[8] = VADD(a[8], a[12]);
+        a[12] = VSUB(xr, a[8]);
+        xr = VNEG(VSQRT2(VSUB(a[9], a[13])));
+        a[9] = VADD(a[9], a[13]);
+        a[13] = VSUB(xr, a[9]);
+        xr = VNEG(VSQRT2(VSUB(a[25], a[29])));
+        a[25] = VADD(a[25], a[29]);
+        a[29] = VSUB(xr, a[25]);
+        xr = VNEG(VSQRT2(VADD(a[24], a[28])));
+        a[24] = VSUB(a[24], a[28]);
+        a[28] = VSUB(xr, a[24]);
+
+        xr = VSUB(a[24], a[16]);
+        a[24] = xr;
+        xr = VSUB(a[20], xr);
+        a[20] = xr;
+        xr = VSUB(a[28], xr);
+        a[28] = xr;
+
+        xr = VSUB(a[25], a[17]);
+        a[25] = xr;
+        xr = VSUB(a[21], xr);
+        a[21] = xr;
+        xr = VSUB(a[29], xr);
+        a[29] = xr;
+
+        xr = VSUB(a[17], a[1]);
+        a[17] = xr;
+        xr = VSUB(a[9], xr);
+        a[9] = xr;
+        xr = VSUB(a[25], xr);
+        a[25] = xr;
+        xr = VSUB(a[5], xr);
+        a[5] = xr;
+        xr = VSUB(a[21], xr);
+        a[21] = xr;
+        xr = VSUB(a[13], xr);
+        a[13] = xr;
+        xr = VSUB(a[29], xr);
+        a[29] = xr;
+
+        xr = VSUB(a[1], a[0]);
+        a[1] = xr;
+        xr = VSUB(a[16], xr);
+        a[16] = xr;
+        xr = VSUB(a[17], xr);
+        a[17] = xr;
+        xr = VSUB(a[8], xr);
+        a[8] = xr;
+        xr = VSUB(a[9], xr);
+        a[9] = xr;
+        xr = VSUB(a[24], xr);
+        a[24] = xr;
+        xr = VSUB(a[25], xr);
+        a[25] = xr;
+        xr = VSUB(a[4], xr);
+        a[4] = xr;
+        xr = VSUB(a[5], xr);
+        a[5] = xr;
+        xr = VSUB(a[20], xr);
+        a[20] = xr;
+        xr = VSUB(a[21], xr);
+        a[21] = xr;
+        xr = VSUB(a[12], xr);
+        a[12] = xr;
+        xr = VSUB(a[13], xr);
+        a[13] = xr;
+        xr = VSUB(a[28], xr);
+        a[28] = xr;
+        xr = VSUB(a[29], xr);
+        a[29] = xr;
+
+        xr = a[0];
+        a[0] = VADD(a[0], a[31]);
+        a[31] = VSUB(a[31], xr);
+        xr = a[1];
+        a[1] = VADD(a[1], a[30]);
+        a[30] = VSUB(a[30], xr);
+        xr = a[16];
+        a[16] = VADD(a[16], a[15]);
+        a[15] = VSUB(a[15], xr);
+        xr = a[17];
+        a[17] = VADD(a[17], a[14]);
+        a[14] = VSUB(a[14], xr);
+        xr = a[8];
+        a[8] = VADD(a[8], a[23]);
+        a[23] = VSUB(a[23], xr);
+        xr = a[9];
+        a[9] = VADD(a[9], a[22]);
+        a[22] = VSUB(a[22], xr);
+        xr = a[24];
+        a[24] = VADD(a[24], a[7]);
+        a[7] = VSUB(a[7], xr);
+        xr = a[25];
+        a[25] = VADD(a[25], a[6]);
+        a[6] = VSUB(a[6], xr);
+        xr = a[4];
+        a[4] = VADD(a[4], a[27]);
+        a[27] = VSUB(a[27], xr);
+        xr = a[5];
+        a[5] = VADD(a[5], a[26]);
+        a[26] = VSUB(a[26], xr);
+        xr = a[20];
+        a[20] = VADD(a[20], a[11]);
+        a[11] = VSUB(a[11], xr);
+        xr = a[21];
+        a[21] = VADD(a[21], a[10]);
+        a[10] = VSUB(a[10], xr);
+        xr = a[12];
+        a[12] = VADD(a[12], a[19]);
+        a[19] = VSUB(a[19], xr);
+        xr = a[13];
+        a[13] = VADD(a[13], a[18]);
+        a[18] = VSUB(a[18], xr);
+        xr = a[28];
+        a[28] = VADD(a[28], a[3]);
+        a[3] = VSUB(a[3], xr);
+        xr = a[29];
+        a[29] = VADD(a[29], a[2]);
+        a[2] = VSUB(a[2], xr);
+    }
+
+    for (j = 0; j < SBLIMIT; j++)
+        VSTORE(out + j * LANES, a[j]);
+}
+
+#undef X
+#undef WP
+#undef VNEG
+
+
+#define XS(k)           VLOAD(xs + (k) * LANES)
+#define F(p, k)         VLOAD((p) + (k) * LANES)
+#define FSTORE(p, k, v) VSTORE((p) + (k) * LANES, v)
+
+/* fht() of LANES interleaved channels */
+static VTARGET void
+VNAME(fht_group) (FLOAT * fz)
+{
+    FLOAT const *const fn = fz + BLKSIZE * LANES;
+    int     k4 = 4;
+
+    do {
+        FLOAT  *fi, *gi;
+        int     i, k1, k2, k3, kx;
+        kx = k4 >> 1;
+        k1 = k4;
+        k2 = k4 << 1;
+        k3 = k2 + k1;
+        k4 = k2 << 1;
+        fi = fz;
+        gi = fi + kx * LANES;
+        do {
+            VEC     f0, f1, f2, f3;
+            f1 = VSUB(F(fi, 0), F(fi, k1));
+            f0 = VADD(F(fi, 0), F(fi, k1));
+            f3 = VSUB(F(fi, k2), F(fi, k3));
+            f2 = VADD(F(fi, k2), F(fi, k3));
+            FSTORE(fi, k2, VSUB(f0, f2));
+            FSTORE(fi, 0, VADD(f0, f2));
+            FSTORE(fi, k3, VSUB(f1, f3));
+            FSTORE(fi, k1, VADD(f1, f3));
+            f1 = VSUB(F(gi, 0), F(gi, k1));
+            f0 = VADD(F(gi, 0), F(gi, k1));
+            f3 = VSQRT2(F(gi, k3));
+            f2 = VSQRT2(F(gi, k2));
+            FSTORE(gi, k2, VSUB(f0, f2));
+            FSTORE(gi, 0, VADD(f0, f2));
+            FSTORE(gi, k3, VSUB(f1, f3));
+            FSTORE(gi, k1, VADD(f1, f3));
+            gi += k4 * LANES;
+            fi += k4 * LANES;
+        } while (fi < fn);
+        for (i = 1; i < kx; i++) {
+            VEC const c1 = VSET1(fht_twiddle[0][kx + i]);
+            VEC const s1 = VSET1(fht_twiddle[1][kx + i]);
+            VEC const c2 = VSET1(fht_twiddle[2][kx + i]);
+            VEC const s2 = VSET1(fht_twiddle[3][kx + i]);
+            fi = fz + i * LANES;
+            gi = fz + (k1 - i) * LANES;
+            do {
+                VEC     a, b, g0, f0, f1, g1, f2, g2, f3, g3;
+                b = VSUB(VMUL(s2, F(fi, k1)), VMUL(c2, F(gi, k1)));
+                a = VADD(VMUL(c2, F(fi, k1)), VMUL(s2, F(gi, k1)));
+                f1 = VSUB(F(fi, 0), a);
+                f0 = VADD(F(fi, 0), a);
+                g1 = VSUB(F(gi, 0), b);
+                g0 = VADD(F(gi, 0), b);
+                b = VSUB(VMUL(s2, F(fi, k3)), VMUL(c2, F(gi, k3)));
+                a = VADD(VMUL(c2, F(fi, k3)), VMUL(s2, F(gi, k3)));
+                f3 = VSUB(F(fi, k2), a);
+                f2 = VADD(F(fi, k2), a);
+                g3 = VSUB(F(gi, k2), b);
+                g2 = VADD(F(gi, k2), b);
+                b = VSUB(VMUL(s1, f2), VMUL(c1, g3));
+                a = VADD(VMUL(c1, f2), VMUL(s1, g3));
+                FSTORE(fi, k2, VSUB(f0, a));
+                FSTORE(fi, 0, VADD(f0, a));
+                FSTORE(gi, k3, VSUB(g1, b));
+                FSTORE(gi, k1, VADD(g1, b));
+                b = VSUB(VMUL(c1, g2), VMUL(s1, f3));
+                a = VADD(VMUL(s1, g2), VMUL(c1, f3));
+                FSTORE(gi, k2, VSUB(g0, a));
+                FSTORE(gi, 0, VADD(g0, a));
+                FSTORE(fi, k3, VSUB(f1, b));
+                FSTORE(fi, k1, VADD(f1, b));
+                gi += k4 * LANES;
+                fi += k4 * LANES;
+            } while (fi < fn);
+        }
+    } while (k4 < BLKSIZE);
+}
+
+
+/* fft_long() of LANES channels: xs is where each one's buffer[chn] is, x
+ * gets the spectra, interleaved. window and rv_tbl are fft_long()'s */
+VTARGET void
+VNAME(fft_long_group_core) (FLOAT * x, FLOAT const *xs, FLOAT const *window,
+                            unsigned char const *rv_tbl)
+{
+    int     jj = BLKSIZE / 8 - 1;
+    x += BLKSIZE / 2 * LANES;
+
+    do {
+        VEC     f0, f1, f2, f3, w;
+        int const i = rv_tbl[jj];
+
+        f0 = VMUL(VSET1(window[i]), XS(i));
+        w = VMUL(VSET1(window[i + 0x200]), XS(i + 0x200));
+        f1 = VSUB(f0, w);
+        f0 = VADD(f0, w);
+        f2 = VMUL(VSET1(window[i + 0x100]), XS(i + 0x100));
+        w = VMUL(VSET1(window[i + 0x300]), XS(i + 0x300));
+        f3 = VSUB(f2, w);
+        f2 = VADD(f2, w);
+
+        x -= 4 * LANES;
+        FSTORE(x, 0, VADD(f0, f2));
+        FSTORE(x, 2, VSUB(f0, f2));
+        FSTORE(x, 1, VADD(f1, f3));
+        FSTORE(x, 3, VSUB(f1, f3));
+
+        f0 = VMUL(VSET1(window[i + 0x001]), XS(i + 0x001));
+        w = VMUL(VSET1(window[i + 0x201]), XS(i + 0x201));
+        f1 = VSUB(f0, w);
+        f0 = VADD(f0, w);
+        f2 = VMUL(VSET1(window[i + 0x101]), XS(i + 0x101));
+        w = VMUL(VSET1(window[i + 0x301]), XS(i + 0x301));
+        f3 = VSUB(f2, w);
+        f2 = VADD(f2, w);
+
+        FSTORE(x, BLKSIZE / 2 + 0, VADD(f0, f2));
+        FSTORE(x, BLKSIZE / 2 + 2, VSUB(f0, f2));
+        FSTORE(x, BLKSIZE / 2 + 1, VADD(f1, f3));
+        FSTORE(x, BLKSIZE / 2 + 3, VSUB(f1, f3));
+    } while (--jj >= 0);
+
+    VNAME(fht_group) (x);
+}
+
+#undef XS
+#undef F
+#undef FSTORE
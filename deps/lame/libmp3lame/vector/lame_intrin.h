@@ -24,10 +24,155 @@
 #define LAME_INTRIN_H
 
 
+/* the xmm_*.c routines are only called after has_SSE2() (init_xrpow_core_sse
+ * after has_SSE()), so a build whose baseline is 32-bit x86 without SSE2
+ * compiles just them for it, as the avx_*.c ones are for AVX2 */
+#if defined(__GNUC__) && !defined(__SSE2__)
+# define SSE_TARGET     __attribute__((target("sse")))
+# define SSE2_TARGET    __attribute__((target("sse2")))
+#else
+# define SSE_TARGET
+# define SSE2_TARGET
+#endif
+
 void
 init_xrpow_core_sse(gr_info * const cod_info, FLOAT xrpow[576], int upper, FLOAT * sum);
 
 void
-fht_SSE2(FLOAT* , int);
+fht_sse(FLOAT * fz, int n);
+
+void
+fht_avx2(FLOAT * fz, int n);
+
+void
+window_subband_core_sse(const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16]);
+
+void
+mdct_long_core_sse(FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                   int const *order, FLOAT const *w, FLOAT const *ws);
+
+void
+window_subband_core_avx2(const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16]);
+
+void
+mdct_long_core_avx2(FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                    int const *order, FLOAT const *w, FLOAT const *ws);
+
+void
+window_subband_core_avx512(const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16]);
+
+void
+psy_spread_core_sse(FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2], int npart,
+                    FLOAT const *eb, FLOAT const *tab_idx, int const *delta,
+                    PsyMaskAdd_t const *ma);
+
+void
+psy_ms_thresholds_core_sse(const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                           const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS],
+                           FLOAT athlower, FLOAT msfix, int n);
+
+void
+psy_spread_core_avx2(FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2], int npart,
+                     FLOAT const *eb, FLOAT const *tab_idx, int const *delta,
+                     PsyMaskAdd_t const *ma);
+
+void
+psy_ms_thresholds_core_avx2(const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                            const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS],
+                            FLOAT athlower, FLOAT msfix, int n);
+
+void
+quantize_lines_xrpow_core_sse(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix);
+
+void
+quantize_lines_xrpow_01_core_sse(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix);
+
+void
+quantize_pseudohalf_core_sse(unsigned int l, FLOAT roundfac, const FLOAT * xr, int *ix);
+
+void
+quantize_lines_xrpow_core_avx2(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix);
+
+void
+quantize_lines_xrpow_01_core_avx2(unsigned int l, FLOAT istep, const FLOAT * xr, int *ix);
+
+void
+quantize_pseudohalf_core_avx2(unsigned int l, FLOAT roundfac, const FLOAT * xr, int *ix);
+
+void
+copy_inbuffer_short_core_sse(sample_t * ib0, sample_t * ib1, const short *l, const short *r,
+                             int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_float_core_sse(sample_t * ib0, sample_t * ib1, const float *l, const float *r,
+                             int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_short_core_avx2(sample_t * ib0, sample_t * ib1, const short *l, const short *r,
+                              int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_float_core_avx2(sample_t * ib0, sample_t * ib1, const float *l, const float *r,
+                              int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_int_core_sse(sample_t * ib0, sample_t * ib1, const int *l, const int *r,
+                           int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_s24_core_sse(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                           const unsigned char *r, int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_u8_core_sse(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                          const unsigned char *r, int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_int_core_avx2(sample_t * ib0, sample_t * ib1, const int *l, const int *r,
+                            int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_s24_core_avx2(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                            const unsigned char *r, int n, int jump, FLOAT const *m);
+
+void
+copy_inbuffer_u8_core_avx2(sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                           const unsigned char *r, int n, int jump, FLOAT const *m);
+
+void
+resample_core_sse(sample_t * out, sample_t const *const *x, FLOAT const *const *h, int n,
+                  int taps);
+
+void
+resample_core_avx2(sample_t * out, sample_t const *const *x, FLOAT const *const *h, int n,
+                   int taps);
+
+void
+group_interleave_sse(FLOAT * xs, sample_t const *const *x, int n);
+
+void
+group_deinterleave_sse(FLOAT * const *x, FLOAT const *xs, int n);
+
+void
+window_subband_group_core_sse(FLOAT const *x1, FLOAT * out, FLOAT const *wp,
+                              FLOAT const (*w)[16]);
+
+void
+fft_long_group_core_sse(FLOAT * x, FLOAT const *xs, FLOAT const *window,
+                        unsigned char const *rv_tbl);
+
+void
+group_interleave_avx2(FLOAT * xs, sample_t const *const *x, int n);
+
+void
+group_deinterleave_avx2(FLOAT * const *x, FLOAT const *xs, int n);
+
+void
+window_subband_group_core_avx2(FLOAT const *x1, FLOAT * out, FLOAT const *wp,
+                               FLOAT const (*w)[16]);
+
+void
+fft_long_group_core_avx2(FLOAT * x, FLOAT const *xs, FLOAT const *window,
+                         unsigned char const *rv_tbl);
 
 #endif
@@ -0,0 +1,162 @@
+/*
+ *      Input buffer copy, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of the copy_inbuffer_*_core() functions for one vector size,
+ * included by xmm_lame.c and avx_lame.c after defining:
+ *
+ *   VEC           the float vector type, with LANES lanes
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p), VSTORE(p, v), VSET1(x), VADD, VMUL
+ *   VCVT(x)       the int vector x, as floats
+ *   VSPLIT(a, b, l, r)  the 2 * LANES interleaved pairs in a and b, split
+ *                 into l and r
+ *   VLOADS16(p)         LANES shorts, as floats
+ *   VLOADS16_2(p, l, r) LANES interleaved pairs of shorts, split into l and r
+ *   VILOADS32(p), VILOADS24(p), VILOADU8(p)  LANES ints, packed 24 bit little
+ *                 endian ints or unsigned bytes (less 128), as an int vector
+ *   VS24_SLACK    the number of samples VILOADS24() reads past its LANES
+ *
+ * Only the planar (jump 1) and the interleaved (jump 2, r right after l)
+ * layouts are vectorized, anything else takes the C loop. The samples are
+ * exactly those of the C versions in lame.c: the same conversions, products
+ * and sums, in the same order (this file is compiled without fused
+ * multiply-adds).
+ */
+
+
+#define COPY_INBUFFER_STORE \
+    VSTORE(ib0 + i, VADD(VMUL(xl, m0), VMUL(xr, m1))); \
+    VSTORE(ib1 + i, VADD(VMUL(xl, m2), VMUL(xr, m3)))
+
+/* the samples are SIZE elements of l and r apart (times jump), and
+   VLOADS() reads SLACK samples too many */
+#define COPY_INBUFFER_LOOP(VLOADS, SIZE, SLACK) \
+    if (jump == 1) { \
+        for (; i + LANES + SLACK <= n; i += LANES) { \
+            xl = VCVT(VLOADS(l + i * SIZE)); \
+            xr = VCVT(VLOADS(r + i * SIZE)); \
+            COPY_INBUFFER_STORE; \
+        } \
+    } \
+    else if (jump == 2 && r == l + SIZE) { \
+        for (; i + LANES + SLACK <= n; i += LANES) { \
+            VSPLIT(VCVT(VLOADS(l + 2 * i * SIZE)), \
+                   VCVT(VLOADS(l + (2 * i + LANES) * SIZE)), xl, xr); \
+            COPY_INBUFFER_STORE; \
+        } \
+    }
+
+#define COPY_INBUFFER_TAIL(SIZE, SAMPLE) \
+    for (; i < n; i++) { \
+        sample_t const xl = SAMPLE(l + i * jump * SIZE); \
+        sample_t const xr = SAMPLE(r + i * jump * SIZE); \
+        ib0[i] = xl * m[0] + xr * m[1]; \
+        ib1[i] = xl * m[2] + xr * m[3]; \
+    }
+
+#define COPY_INBUFFER_SETUP \
+    VEC const m0 = VSET1(m[0]), m1 = VSET1(m[1]), m2 = VSET1(m[2]), m3 = VSET1(m[3]); \
+    VEC     xl, xr; \
+    int     i = 0
+
+
+VTARGET void
+VNAME(copy_inbuffer_short_core) (sample_t * ib0, sample_t * ib1, const short *l,
+                                 const short *r, int n, int jump, FLOAT const *m)
+{
+    COPY_INBUFFER_SETUP;
+
+    if (jump == 1) {
+        for (; i + LANES <= n; i += LANES) {
+            xl = VLOADS16(l + i);
+            xr = VLOADS16(r + i);
+            COPY_INBUFFER_STORE;
+        }
+    }
+    else if (jump == 2 && r == l + 1) {
+        for (; i + LANES <= n; i += LANES) {
+            VLOADS16_2(l + 2 * i, xl, xr);
+            COPY_INBUFFER_STORE;
+        }
+    }
+    COPY_INBUFFER_TAIL(1, *)
+}
+
+
+VTARGET void
+VNAME(copy_inbuffer_float_core) (sample_t * ib0, sample_t * ib1, const float *l,
+                                 const float *r, int n, int jump, FLOAT const *m)
+{
+    COPY_INBUFFER_SETUP;
+
+    if (jump == 1) {
+        for (; i + LANES <= n; i += LANES) {
+            xl = VLOAD(l + i);
+            xr = VLOAD(r + i);
+            COPY_INBUFFER_STORE;
+        }
+    }
+    else if (jump == 2 && r == l + 1) {
+        for (; i + LANES <= n; i += LANES) {
+            VSPLIT(VLOAD(l + 2 * i), VLOAD(l + 2 * i + LANES), xl, xr);
+            COPY_INBUFFER_STORE;
+        }
+    }
+    COPY_INBUFFER_TAIL(1, *)
+}
+
+
+VTARGET void
+VNAME(copy_inbuffer_int_core) (sample_t * ib0, sample_t * ib1, const int *l,
+                               const int *r, int n, int jump, FLOAT const *m)
+{
+    COPY_INBUFFER_SETUP;
+
+    COPY_INBUFFER_LOOP(VILOADS32, 1, 0)
+    COPY_INBUFFER_TAIL(1, *)
+}
+
+
+VTARGET void
+VNAME(copy_inbuffer_s24_core) (sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                               const unsigned char *r, int n, int jump, FLOAT const *m)
+{
+    COPY_INBUFFER_SETUP;
+
+    COPY_INBUFFER_LOOP(VILOADS24, 3, VS24_SLACK)
+    COPY_INBUFFER_TAIL(3, PCM_S24LE)
+}
+
+
+VTARGET void
+VNAME(copy_inbuffer_u8_core) (sample_t * ib0, sample_t * ib1, const unsigned char *l,
+                              const unsigned char *r, int n, int jump, FLOAT const *m)
+{
+    COPY_INBUFFER_SETUP;
+
+    COPY_INBUFFER_LOOP(VILOADU8, 1, 0)
+    COPY_INBUFFER_TAIL(1, PCM_U8)
+}
+
+#undef COPY_INBUFFER_STORE
+#undef COPY_INBUFFER_LOOP
+#undef COPY_INBUFFER_TAIL
+#undef COPY_INBUFFER_SETUP
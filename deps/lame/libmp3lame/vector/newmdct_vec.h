@@ -0,0 +1,214 @@
+/*
+ *      MP3 window subband and mdct, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of window_subband_core() and mdct_long_core() for one vector size,
+ * included by xmm_newmdct.c and avx_newmdct.c after defining:
+ *
+ *   VEC           the vector type, with LANES floats
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p)      lane j is p[j]
+ *   VLOADR(p)     lane j is p[-j]
+ *   VSET1(x)      all lanes are x
+ *   VADD, VSUB, VMUL
+ *   VSTORE(p, v)
+ *   VSTORE2(p, u, v)  p[2 j] is lane j of u, p[2 j + 1] lane j of v
+ *   VGATHER(p, o) lane j is p[o[j]], where o[2 i + 1] == o[2 i] + 1
+ *
+ * Every lane does exactly the same float operations in the same order as the
+ * C version does for one iteration (or band), so the results are bit
+ * identical. This must not be compiled with FMA contraction.
+ */
+
+
+/* iterations j..j + LANES - 1 of window_subband_core_c() at once. The 16th
+ * lane has zero weights and writes a[30] and a[31], which the caller sets
+ * afterwards anyway */
+VTARGET void
+VNAME(window_subband_core) (const sample_t * x1, FLOAT a[SBLIMIT], FLOAT const (*w)[16])
+{
+    const sample_t *x2 = &x1[238 - 14 - 286];
+    int     j;
+
+    for (j = 0; j < 16; j += LANES) {
+        VEC     s, t, wv;
+
+        /* s gets x2 at increasing, t x1 at decreasing addresses */
+#define STEP_ST(m, o2, o1) \
+        wv = VLOAD(&w[m][j]); \
+        s = VADD(s, VMUL(VLOAD(&x2[(o2) + j]), wv)); \
+        t = VADD(t, VMUL(VLOADR(&x1[(o1) - j]), wv))
+        /* and then the other way around */
+#define STEP_TS(m, o1, o2) \
+        wv = VLOAD(&w[m][j]); \
+        s = VADD(s, VMUL(VLOADR(&x1[(o1) - j]), wv)); \
+        t = VSUB(t, VMUL(VLOAD(&x2[(o2) + j]), wv))
+
+        wv = VLOAD(&w[0][j]);
+        s = VMUL(VLOAD(&x2[-224 + j]), wv);
+        t = VMUL(VLOADR(&x1[224 - j]), wv);
+        STEP_ST(1, -160, 160);
+        STEP_ST(2, -96, 96);
+        STEP_ST(3, -32, 32);
+        STEP_ST(4, 32, -32);
+        STEP_ST(5, 96, -96);
+        STEP_ST(6, 160, -160);
+        STEP_ST(7, 224, -224);
+
+        STEP_TS(8, -256, 256);
+        STEP_TS(9, -192, 192);
+        STEP_TS(10, -128, 128);
+        STEP_TS(11, -64, 64);
+        STEP_TS(12, 0, 0);
+        STEP_TS(13, 64, -64);
+        STEP_TS(14, 128, -128);
+        STEP_TS(15, 192, -192);
+#undef STEP_ST
+#undef STEP_TS
+
+        s = VMUL(s, VLOAD(&w[16][j]));
+        VSTORE2(&a[2 * j], VADD(t, s), VMUL(VLOAD(&w[17][j]), VSUB(t, s)));
+    }
+}
+
+
+#ifndef VNO_MDCT
+
+/* mdct_long_core_c(), with one band per lane */
+VTARGET void
+VNAME(mdct_long_core) (FLOAT * out, FLOAT const *sb0, FLOAT const *sb1,
+                       int const *order, FLOAT const *w, FLOAT const *ws)
+{
+    FLOAT const *const tantab = ws + 3;
+    FLOAT const *const cx = ws + 12;
+    int     h, i, j, k;
+
+    for (h = 0; h < 8; h += LANES) {
+        VEC     in[18], o[18];
+        FLOAT   res[18][LANES];
+
+        for (k = -9; k < 0; k++) {
+            VEC     x, y, tt;
+            x = VADD(VMUL(VSET1(w[k + 27]), VGATHER(sb1 + (k + 9) * 32, order + h)),
+                     VMUL(VSET1(w[k + 36]), VGATHER(sb1 + (8 - k) * 32, order + h)));
+            y = VSUB(VMUL(VSET1(w[k + 9]), VGATHER(sb0 + (k + 9) * 32, order + h)),
+                     VMUL(VSET1(w[k + 18]), VGATHER(sb0 + (8 - k) * 32, order + h)));
+            tt = VSET1(tantab[k + 9]);
+            in[k + 9] = VSUB(x, VMUL(y, tt));
+            in[k + 18] = VADD(VMUL(x, tt), y);
+        }
+
+        /* mdct_long(), where -p * c + q is written as q - p * c */
+        {
+            VEC     tc1, tc2, tc3, tc4, ts5, ts6, ts7, ts8, p, q, ct, st;
+
+            tc1 = VSUB(in[17], in[9]);
+            tc3 = VSUB(in[15], in[11]);
+            tc4 = VSUB(in[14], in[12]);
+            ts5 = VADD(in[0], in[8]);
+            ts6 = VADD(in[1], in[7]);
+            ts7 = VADD(in[2], in[6]);
+            ts8 = VADD(in[3], in[5]);
+
+            p = VSUB(VADD(ts5, ts7), ts8);
+            q = VSUB(ts6, in[4]);
+            o[17] = VSUB(p, q);
+            st = VADD(VMUL(p, VSET1(cx[7])), q);
+            ct = VMUL(VSUB(VSUB(tc1, tc3), tc4), VSET1(cx[6]));
+            o[5] = VADD(ct, st);
+            o[6] = VSUB(ct, st);
+
+            tc2 = VMUL(VSUB(in[16], in[10]), VSET1(cx[6]));
+            ts6 = VADD(VMUL(ts6, VSET1(cx[7])), in[4]);
+            ct = VADD(VADD(VADD(VMUL(tc1, VSET1(cx[0])), tc2), VMUL(tc3, VSET1(cx[1]))),
+                      VMUL(tc4, VSET1(cx[2])));
+            st = VADD(VSUB(VSUB(ts6, VMUL(ts5, VSET1(cx[4]))), VMUL(ts7, VSET1(cx[5]))),
+                      VMUL(ts8, VSET1(cx[3])));
+            o[1] = VADD(ct, st);
+            o[2] = VSUB(ct, st);
+
+            ct = VADD(VSUB(VSUB(VMUL(tc1, VSET1(cx[1])), tc2), VMUL(tc3, VSET1(cx[2]))),
+                      VMUL(tc4, VSET1(cx[0])));
+            st = VADD(VSUB(VSUB(ts6, VMUL(ts5, VSET1(cx[5]))), VMUL(ts7, VSET1(cx[3]))),
+                      VMUL(ts8, VSET1(cx[4])));
+            o[9] = VADD(ct, st);
+            o[10] = VSUB(ct, st);
+
+            ct = VSUB(VADD(VSUB(VMUL(tc1, VSET1(cx[2])), tc2), VMUL(tc3, VSET1(cx[0]))),
+                      VMUL(tc4, VSET1(cx[1])));
+            st = VSUB(VADD(VSUB(VMUL(ts5, VSET1(cx[3])), ts6), VMUL(ts7, VSET1(cx[4]))),
+                      VMUL(ts8, VSET1(cx[5])));
+            o[13] = VADD(ct, st);
+            o[14] = VSUB(ct, st);
+        }
+        {
+            VEC     ts1, ts2, ts3, ts4, tc5, tc6, tc7, tc8, p, q, ct, st;
+
+            ts1 = VSUB(in[8], in[0]);
+            ts3 = VSUB(in[6], in[2]);
+            ts4 = VSUB(in[5], in[3]);
+            tc5 = VADD(in[17], in[9]);
+            tc6 = VADD(in[16], in[10]);
+            tc7 = VADD(in[15], in[11]);
+            tc8 = VADD(in[14], in[12]);
+
+            p = VADD(VADD(tc5, tc7), tc8);
+            q = VADD(tc6, in[13]);
+            o[0] = VADD(p, q);
+            ct = VSUB(VMUL(p, VSET1(cx[7])), q);
+            st = VMUL(VADD(VSUB(ts1, ts3), ts4), VSET1(cx[6]));
+            o[11] = VADD(ct, st);
+            o[12] = VSUB(ct, st);
+
+            ts2 = VMUL(VSUB(in[7], in[1]), VSET1(cx[6]));
+            tc6 = VSUB(in[13], VMUL(tc6, VSET1(cx[7])));
+            ct = VADD(VADD(VSUB(VMUL(tc5, VSET1(cx[3])), tc6), VMUL(tc7, VSET1(cx[4]))),
+                      VMUL(tc8, VSET1(cx[5])));
+            st = VADD(VADD(VADD(VMUL(ts1, VSET1(cx[2])), ts2), VMUL(ts3, VSET1(cx[0]))),
+                      VMUL(ts4, VSET1(cx[1])));
+            o[3] = VADD(ct, st);
+            o[4] = VSUB(ct, st);
+
+            ct = VSUB(VSUB(VSUB(tc6, VMUL(tc5, VSET1(cx[5]))), VMUL(tc7, VSET1(cx[3]))),
+                      VMUL(tc8, VSET1(cx[4])));
+            st = VSUB(VSUB(VADD(VMUL(ts1, VSET1(cx[1])), ts2), VMUL(ts3, VSET1(cx[2]))),
+                      VMUL(ts4, VSET1(cx[0])));
+            o[7] = VADD(ct, st);
+            o[8] = VSUB(ct, st);
+
+            ct = VSUB(VSUB(VSUB(tc6, VMUL(tc5, VSET1(cx[4]))), VMUL(tc7, VSET1(cx[5]))),
+                      VMUL(tc8, VSET1(cx[3])));
+            st = VSUB(VADD(VSUB(VMUL(ts1, VSET1(cx[0])), ts2), VMUL(ts3, VSET1(cx[1]))),
+                      VMUL(ts4, VSET1(cx[2])));
+            o[15] = VADD(ct, st);
+            o[16] = VSUB(ct, st);
+        }
+
+        /* transpose back to 18 coefficients per band */
+        for (i = 0; i < 18; i++)
+            VSTORE(res[i], o[i]);
+        for (j = 0; j < LANES; j++) {
+            for (i = 0; i < 18; i++)
+                out[(h + j) * 18 + i] = res[i][j];
+        }
+    }
+}
+
+#endif /* VNO_MDCT */
@@ -0,0 +1,212 @@
+/*
+ *      psychoacoustic model, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of psy_spread_core() and psy_ms_thresholds_core() for one vector
+ * size, included by xmm_psymodel.c and avx_psymodel.c after defining:
+ *
+ *   VEC           the vector type, with LANES floats
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p), VSTORE(p, v), VSET1(x)
+ *   VIVEC         a vector of LANES ints, with VILOAD(p), VISET1(x), VIADD
+ *   VIMASK(m, x)  int vector x where float mask m, else 0
+ *   VGATHERI(p, o)  lane j is p[o[j]], for an int vector o
+ *   VADD, VSUB, VMUL, VDIV
+ *   VMIN(a, b)    a < b ? a : b, like Min()
+ *   VMAX(a, b)    a > b ? a : b, like Max()
+ *   VCMPLT(a, b), VCMPLE(a, b)  all ones where true, ordered compares
+ *   VAND(m, x)    x where m, else 0
+ *   VANDNOT(m, x) x where not m, else 0
+ *   VBLEND(a, b, m)  b where m, else a
+ *
+ * The spreading function runs one partition per lane, and as partitions
+ * cover different ranges, lanes that are done keep their value. Every lane
+ * does the same float operations as the C version does for its partition, so
+ * the results are bit identical.
+ */
+
+
+/* vbrpsy_mask_add() for a vector of partitions: m1 and m2 are the masking
+   so far and the next one, dist is |kk - b| */
+static inline VTARGET VEC
+VNAME(mask_add) (VEC m1, VEC m2, VEC dist, VEC delta, PsyMaskAdd_t const *ma)
+{
+    VEC const zero = VSET1(0);
+    VEC     sum, gt, hi, lo, ratio, f, near, far, r;
+    int     i;
+
+    m1 = VANDNOT(VCMPLT(m1, zero), m1);
+    m2 = VANDNOT(VCMPLT(m2, zero), m2);
+    sum = VADD(m1, m2);
+
+    /* where m1 or m2 is 0 this divides by 0, but those lanes are replaced
+       at the end */
+    gt = VCMPLT(m1, m2);
+    hi = VBLEND(m1, m2, gt);
+    lo = VBLEND(m2, m1, gt);
+    ratio = VDIV(hi, lo);
+
+    f = VSET1(ma->table2[0]);
+    for (i = 1; i < (int) dimension_of(ma->table2); i++)
+        f = VBLEND(f, VSET1(ma->table2[i]), VCMPLE(VSET1(ma->ratio_i[i]), ratio));
+    near = VBLEND(VMUL(sum, f), sum, VCMPLE(VSET1(ma->max_i1), ratio));
+    far = VBLEND(hi, sum, VCMPLT(ratio, VSET1(ma->max_i2)));
+    r = VBLEND(far, near, VCMPLE(dist, delta));
+
+    r = VBLEND(r, m1, VCMPLE(m2, zero));
+    return VBLEND(r, m2, VCMPLE(m1, zero));
+}
+
+
+/* psy_spread_core_c(), with one partition per lane. Each step of a group of
+   partitions depends on the one before, so all groups take their steps side
+   by side */
+VTARGET void
+VNAME(psy_spread_core) (FLOAT * ecb, FLOAT const *s3, int const (*s3ind)[2], int npart,
+                        FLOAT const *eb, FLOAT const *tab_idx, int const *delta,
+                        PsyMaskAdd_t const *ma)
+{
+    VEC     e[CBANDS / LANES], stepv[CBANDS / LANES], bv[CBANDS / LANES];
+    VEC     kkv[CBANDS / LANES], deltav[CBANDS / LANES];
+    VIVEC   s3v[CBANDS / LANES], kkiv[CBANDS / LANES];
+    int     longest[CBANDS / LANES];
+    int const groups = (npart + LANES - 1) / LANES;
+    int     b, g, i, l, k = 0, most = 0;
+
+    assert(npart <= CBANDS);
+    for (g = 0; g < groups; g++) {
+        int     s3_first[LANES], kk_first[LANES];
+        FLOAT   steps[LANES], b_f[LANES], kk_f[LANES], delta_f[LANES];
+
+        b = g * LANES;
+        longest[g] = 0;
+        for (l = 0; l < LANES; l++) {
+            int const used = b + l < npart;
+            int const p = used ? b + l : b;
+            int const len = s3ind[p][1] - s3ind[p][0];
+            s3_first[l] = used ? k : 0;
+            kk_first[l] = s3ind[p][0];
+            steps[l] = (FLOAT) (used ? len : 0);
+            b_f[l] = (FLOAT) p;
+            kk_f[l] = (FLOAT) s3ind[p][0];
+            delta_f[l] = (FLOAT) delta[p];
+            if (used) {
+                k += len + 1;
+                if (longest[g] < len)
+                    longest[g] = len;
+            }
+        }
+        if (most < longest[g])
+            most = longest[g];
+        stepv[g] = VLOAD(steps);
+        bv[g] = VLOAD(b_f);
+        kkv[g] = VLOAD(kk_f);
+        deltav[g] = VLOAD(delta_f);
+        s3v[g] = VILOAD(s3_first);
+        kkiv[g] = VILOAD(kk_first);
+        e[g] = VMUL(VMUL(VGATHERI(s3, s3v[g]), VGATHERI(eb, kkiv[g])),
+                    VGATHERI(tab_idx, kkiv[g]));
+    }
+    for (i = 1; i <= most; i++) {
+        VEC const iv = VSET1((FLOAT) i);
+        VIVEC const ii = VISET1(i);
+        for (g = 0; g < groups; g++) {
+            if (i <= longest[g]) {
+                VEC const active = VCMPLE(iv, stepv[g]);
+                /* lanes that are done read their first element again */
+                VIVEC const t = VIMASK(active, ii);
+                VIVEC const o_kk = VIADD(kkiv[g], t);
+                VEC const x = VMUL(VMUL(VGATHERI(s3, VIADD(s3v[g], t)), VGATHERI(eb, o_kk)),
+                                   VGATHERI(tab_idx, o_kk));
+                VEC const kk = VADD(kkv[g], iv);
+                VEC const dist = VMAX(VSUB(kk, bv[g]), VSUB(bv[g], kk));
+                VEC const r = VNAME(mask_add) (e[g], x, dist, deltav[g], ma);
+                e[g] = VBLEND(e[g], r, active);
+            }
+        }
+    }
+    for (g = 0; g < groups; g++) {
+        FLOAT   res[LANES];
+
+        b = g * LANES;
+        VSTORE(res, e[g]);
+        for (l = 0; l < LANES && b + l < npart; l++)
+            ecb[b + l] = res[l];
+    }
+}
+
+
+/* psy_ms_thresholds_core_c(). All the arrays have CBANDS entries, so the
+   last vector reads past n but only stores up to n */
+VTARGET void
+VNAME(psy_ms_thresholds_core) (const FLOAT eb[4][CBANDS], FLOAT thr[4][CBANDS],
+                               const FLOAT cb_mld[CBANDS], const FLOAT ath_cb[CBANDS],
+                               FLOAT athlower, FLOAT msfix, int n)
+{
+    FLOAT const msfix2 = msfix * 2.f;
+    int     b, l;
+
+    for (b = 0; b < n; b += LANES) {
+        VEC const ebM = VLOAD(&eb[2][b]);
+        VEC const ebS = VLOAD(&eb[3][b]);
+        VEC const thmL = VLOAD(&thr[0][b]);
+        VEC const thmR = VLOAD(&thr[1][b]);
+        VEC     thmM = VLOAD(&thr[2][b]);
+        VEC     thmS = VLOAD(&thr[3][b]);
+        VEC const mld = VLOAD(&cb_mld[b]);
+        VEC const c158 = VSET1(1.58f);
+        VEC     fix, rmid, rside;
+
+        /* use this fix if L & R masking differs by 2db or less */
+        fix = VAND(VCMPLE(thmL, VMUL(c158, thmR)), VCMPLE(thmR, VMUL(c158, thmL)));
+        rmid = VBLEND(thmM, VMAX(thmM, VMIN(thmS, VMUL(mld, ebS))), fix);
+        rside = VBLEND(thmS, VMAX(thmS, VMIN(thmM, VMUL(mld, ebM))), fix);
+        if (msfix > 0.f) {
+            VEC const ath = VMUL(VLOAD(&ath_cb[b]), VSET1(athlower));
+            VEC const thmLR = VMIN(VMAX(thmL, ath), VMAX(thmR, ath));
+            VEC const lr2 = VMUL(thmLR, VSET1(msfix2));
+            VEC     thmMS, f, scale;
+            thmM = VMAX(rmid, ath);
+            thmS = VMAX(rside, ath);
+            thmMS = VADD(thmM, thmS);
+            scale = VAND(VCMPLT(VSET1(0), thmMS), VCMPLT(lr2, thmMS));
+            f = VDIV(lr2, thmMS);
+            thmM = VBLEND(thmM, VMUL(thmM, f), scale);
+            thmS = VBLEND(thmS, VMUL(thmS, f), scale);
+            rmid = VMIN(thmM, rmid);
+            rside = VMIN(thmS, rside);
+        }
+        rmid = VBLEND(rmid, ebM, VCMPLT(ebM, rmid));
+        rside = VBLEND(rside, ebS, VCMPLT(ebS, rside));
+        if (b + LANES <= n) {
+            VSTORE(&thr[2][b], rmid);
+            VSTORE(&thr[3][b], rside);
+        }
+        else {
+            FLOAT   res_m[LANES], res_s[LANES];
+            VSTORE(res_m, rmid);
+            VSTORE(res_s, rside);
+            for (l = 0; b + l < n; l++) {
+                thr[2][b + l] = res_m[l];
+                thr[3][b + l] = res_s[l];
+            }
+        }
+    }
+}
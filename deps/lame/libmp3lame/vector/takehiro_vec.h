@@ -0,0 +1,105 @@
+/*
+ *      MP3 quantization, vector routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Body of quantize_lines_xrpow_core(), quantize_lines_xrpow_01_core() and
+ * quantize_pseudohalf_core() for one vector size,
+ * included by xmm_takehiro.c and avx_takehiro.c after defining:
+ *
+ *   VEC           the float vector type, with LANES lanes
+ *   VNAME(name)   the function name for this instruction set
+ *   VTARGET       function attributes (the target instruction set)
+ *   VLOAD(p), VSET1(x), VMUL
+ *   VILOAD(p), VISTORE(p, v)  int vector load and store
+ *   VQUANTIZE(x)  the quantized values of x, as quantize_line() gives
+ *   VQUANTIZE01(x, c)  0 where c > x, else 1
+ *   VCMPGE(a, b)  all ones where a >= b, as an int vector; VIAND
+ *   MAGIC_FLOAT, MAGIC_INT  as in takehiro.c, with TAKEHIRO_IEEE754_HACK
+ *
+ * The quantized values are exactly those of the C versions in takehiro.c.
+ */
+
+
+/* one line of quantize_lines_xrpow_core_c(), x = xr * istep */
+static inline int
+quantize_line(FLOAT x)
+{
+#ifdef TAKEHIRO_IEEE754_HACK
+    union {
+        float   f;
+        int     i;
+    } fi;
+    double  x0 = x;
+
+    x0 += MAGIC_FLOAT;
+    fi.f = x0;
+    fi.f = x0 + adj43asm[fi.i - MAGIC_INT];
+    return fi.i - MAGIC_INT;
+#else
+    int const rx = (int) x;
+
+    x += adj43[rx];
+    return (int) x;
+#endif
+}
+
+
+VTARGET void
+VNAME(quantize_lines_xrpow_core) (unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
+{
+    VEC const step = VSET1(istep);
+    unsigned int i;
+
+    assert(l > 0);
+    l &= ~1u;           /* the C version quantizes pairs of lines */
+    for (i = 0; i + LANES <= l; i += LANES)
+        VISTORE(ix + i, VQUANTIZE(VMUL(VLOAD(xr + i), step)));
+    for (; i < l; i++)
+        ix[i] = quantize_line(xr[i] * istep);
+}
+
+
+VTARGET void
+VNAME(quantize_lines_xrpow_01_core) (unsigned int l, FLOAT istep, const FLOAT * xr, int *ix)
+{
+    const FLOAT compareval0 = (1.0f - 0.4054f) / istep;
+    VEC const c = VSET1(compareval0);
+    unsigned int i;
+
+    assert(l > 0);
+    assert(l % 2 == 0);
+    for (i = 0; i + LANES <= l; i += LANES)
+        VISTORE(ix + i, VQUANTIZE01(VLOAD(xr + i), c));
+    for (; i < l; i++)
+        ix[i] = (compareval0 > xr[i]) ? 0 : 1;
+}
+
+
+/* without the branch, which mispredicts on about every other line */
+VTARGET void
+VNAME(quantize_pseudohalf_core) (unsigned int l, FLOAT roundfac, const FLOAT * xr, int *ix)
+{
+    VEC const r = VSET1(roundfac);
+    unsigned int k;
+
+    for (k = 0; k + LANES <= l; k += LANES)
+        VISTORE(ix + k, VIAND(VILOAD(ix + k), VCMPGE(VLOAD(xr + k), r)));
+    for (; k < l; ++k)
+        ix[k] = (xr[k] >= roundfac) ? ix[k] : 0;
+}
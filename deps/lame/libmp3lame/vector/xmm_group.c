@@ -0,0 +1,68 @@
+/*
+ * Cross-stream analysis filterbank and FFT, SSE2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "fft.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <emmintrin.h>
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_sse
+#define VTARGET         SSE2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VSTORE(p, v)    _mm_storeu_ps(p, v)
+#define VSET1(x)        _mm_set1_ps(x)
+#define VADD(x, y)      _mm_add_ps(x, y)
+#define VSUB(x, y)      _mm_sub_ps(x, y)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VTRANSPOSE(r)   _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3])
+#define VSQRT2(x)       xmm_sqrt2(x, _mm_setzero_ps(), 0)
+#define VSQRT2SUB(x, y) xmm_sqrt2(x, y, 1)
+
+/* SQRT2 * x (less y if "sub"), in double */
+static inline SSE2_TARGET __m128
+xmm_sqrt2(__m128 x, __m128 y, int sub)
+{
+    __m128d const c = _mm_set1_pd(SQRT2);
+    __m128d lo = _mm_mul_pd(_mm_cvtps_pd(x), c);
+    __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), c);
+    if (sub) {
+        lo = _mm_sub_pd(lo, _mm_cvtps_pd(y));
+        hi = _mm_sub_pd(hi, _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+    }
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+#include "group_vec.h"
+
+#endif	/* HAVE_XMMINTRIN_H */
@@ -0,0 +1,96 @@
+/*
+ * Input buffer copy, SSE2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <string.h>
+#include <emmintrin.h>
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_sse
+#define VTARGET         SSE2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VSTORE(p, v)    _mm_storeu_ps(p, v)
+#define VSET1(x)        _mm_set1_ps(x)
+#define VADD(x, y)      _mm_add_ps(x, y)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VCVT(x)         _mm_cvtepi32_ps(x)
+#define VSPLIT(a, b, l, r) do { \
+        __m128 const a_ = (a), b_ = (b); \
+        l = _mm_shuffle_ps(a_, b_, _MM_SHUFFLE(2, 0, 2, 0)); \
+        r = _mm_shuffle_ps(a_, b_, _MM_SHUFFLE(3, 1, 3, 1)); \
+    } while (0)
+#define VLOADS16(p)     xmm_load_s16(p)
+#define VLOADS16_2(p, l, r) do { \
+        __m128i const x_ = _mm_loadu_si128((__m128i const *) (p)); \
+        l = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(x_, 16), 16)); \
+        r = _mm_cvtepi32_ps(_mm_srai_epi32(x_, 16)); \
+    } while (0)
+#define VILOADS32(p)    _mm_loadu_si128((__m128i const *) (p))
+#define VILOADS24(p)    xmm_load_s24(p)
+#define VILOADU8(p)     xmm_load_u8(p)
+#define VS24_SLACK      2
+
+/* SSE2 has no sign extension: the shorts go to the top halves and back */
+static inline SSE2_TARGET __m128
+xmm_load_s16(const short *p)
+{
+    __m128i const x = _mm_loadl_epi64((__m128i const *) p);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+}
+
+/* nor byte shuffles: the 4 samples in the first 12 of the 16 bytes read are
+   shifted to the bottom of their own vectors, gathered and sign extended */
+static inline SSE2_TARGET __m128i
+xmm_load_s24(const unsigned char *p)
+{
+    __m128i const x = _mm_loadu_si128((__m128i const *) p);
+    __m128i const a = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+    __m128i const b = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+    return _mm_srai_epi32(_mm_slli_epi32(_mm_unpacklo_epi64(a, b), 8), 8);
+}
+
+static inline SSE2_TARGET __m128i
+xmm_load_u8(const unsigned char *p)
+{
+    __m128i const zero = _mm_setzero_si128();
+    int     x;
+
+    memcpy(&x, p, sizeof(x));
+    return _mm_sub_epi32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(x), zero), zero),
+                         _mm_set1_epi32(128));
+}
+
+#include "lame_vec.h"
+
+#endif	/* HAVE_XMMINTRIN_H */
@@ -0,0 +1,74 @@
+/*
+ * MP3 window subband and mdct, SSE intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <xmmintrin.h>
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_sse
+#define VTARGET         SSE2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VLOADR(p)       xmm_loadr(p)
+#define VSET1(x)        _mm_set1_ps(x)
+#define VADD(x, y)      _mm_add_ps(x, y)
+#define VSUB(x, y)      _mm_sub_ps(x, y)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VSTORE(p, v)    _mm_storeu_ps(p, v)
+#define VSTORE2(p, u, v) xmm_store2(p, u, v)
+#define VGATHER(p, o)   xmm_gather(p, o)
+
+static inline SSE2_TARGET __m128
+xmm_loadr(const float *p)
+{
+    __m128 const v = _mm_loadu_ps(p - 3);
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+static inline SSE2_TARGET void
+xmm_store2(float *p, __m128 u, __m128 v)
+{
+    _mm_storeu_ps(p, _mm_unpacklo_ps(u, v));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(u, v));
+}
+
+static inline SSE2_TARGET __m128
+xmm_gather(const float *p, int const *o)
+{
+    __m128 const lo = _mm_loadl_pi(_mm_setzero_ps(), (__m64 const *) (p + o[0]));
+    return _mm_loadh_pi(lo, (__m64 const *) (p + o[2]));
+}
+
+#include "newmdct_vec.h"
+
+#endif	/* HAVE_XMMINTRIN_H */
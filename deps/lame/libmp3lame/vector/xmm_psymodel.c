@@ -0,0 +1,73 @@
+/*
+ * psychoacoustic model, SSE intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <emmintrin.h>
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_sse
+#define VTARGET         SSE2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VSTORE(p, v)    _mm_storeu_ps(p, v)
+#define VSET1(x)        _mm_set1_ps(x)
+#define VIVEC           __m128i
+#define VILOAD(p)       _mm_loadu_si128((__m128i const *) (p))
+#define VISET1(x)       _mm_set1_epi32(x)
+#define VIADD(x, y)     _mm_add_epi32(x, y)
+#define VIMASK(m, x)    _mm_and_si128(_mm_castps_si128(m), x)
+#define VGATHERI(p, o)  xmm_gatheri(p, o)
+#define VADD(x, y)      _mm_add_ps(x, y)
+#define VSUB(x, y)      _mm_sub_ps(x, y)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VDIV(x, y)      _mm_div_ps(x, y)
+#define VMIN(x, y)      _mm_min_ps(x, y)
+#define VMAX(x, y)      _mm_max_ps(x, y)
+#define VCMPLT(x, y)    _mm_cmplt_ps(x, y)
+#define VCMPLE(x, y)    _mm_cmple_ps(x, y)
+#define VAND(m, x)      _mm_and_ps(m, x)
+#define VANDNOT(m, x)   _mm_andnot_ps(m, x)
+#define VBLEND(a, b, m) _mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a))
+
+/* there is no gather before AVX2 */
+static inline SSE2_TARGET __m128
+xmm_gatheri(const float *p, __m128i o)
+{
+    int     i[4];
+    _mm_storeu_si128((__m128i *) i, o);
+    return _mm_setr_ps(p[i[0]], p[i[1]], p[i[2]], p[i[3]]);
+}
+
+#include "psymodel_vec.h"
+
+#endif	/* HAVE_XMMINTRIN_H */
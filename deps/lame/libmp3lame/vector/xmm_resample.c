@@ -0,0 +1,65 @@
+/*
+ * Polyphase resampler inner products, SSE intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <xmmintrin.h>
+
+/* the sums of the 8 partial sums, in the order of resample_core_c() */
+static inline SSE2_TARGET float
+xmm_sum8(__m128 a, __m128 b)
+{
+    __m128 const v = _mm_add_ps(a, b);
+    __m128 const t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+SSE2_TARGET void
+resample_core_sse(sample_t * out, sample_t const *const *x, FLOAT const *const *h, int n,
+                  int taps)
+{
+    int     k, i;
+
+    for (k = 0; k < n; k++) {
+        sample_t const *const xk = x[k];
+        FLOAT const *const hk = h[k];
+        __m128  a = _mm_setzero_ps(), b = _mm_setzero_ps();
+
+        for (i = 0; i < taps; i += 8) {
+            a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(xk + i), _mm_load_ps(hk + i)));
+            b = _mm_add_ps(b, _mm_mul_ps(_mm_loadu_ps(xk + i + 4), _mm_load_ps(hk + i + 4)));
+        }
+        out[k] = xmm_sum8(a, b);
+    }
+}
+
+#endif	/* HAVE_XMMINTRIN_H */
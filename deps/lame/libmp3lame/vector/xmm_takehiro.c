@@ -0,0 +1,89 @@
+/*
+ * MP3 quantization, SSE2 intrinsics functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.     See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "lame.h"
+#include "machine.h"
+#include "encoder.h"
+#include "util.h"
+#include "quantize_pvt.h"
+#include "lame_intrin.h"
+
+
+
+#ifdef HAVE_XMMINTRIN_H
+
+#include <emmintrin.h>
+
+#define VEC             __m128
+#define LANES           4
+#define VNAME(name)     name##_sse
+#define VTARGET         SSE2_TARGET
+#define VLOAD(p)        _mm_loadu_ps(p)
+#define VSET1(x)        _mm_set1_ps(x)
+#define VMUL(x, y)      _mm_mul_ps(x, y)
+#define VILOAD(p)       _mm_loadu_si128((__m128i const *) (p))
+#define VISTORE(p, v)   _mm_storeu_si128((__m128i *) (p), v)
+#define VQUANTIZE(x)    xmm_quantize(x)
+#define VQUANTIZE01(x, c) \
+    _mm_andnot_si128(_mm_castps_si128(_mm_cmplt_ps(x, c)), _mm_set1_epi32(1))
+#define VCMPGE(a, b)    _mm_castps_si128(_mm_cmpge_ps(a, b))
+#define VIAND(a, b)     _mm_and_si128(a, b)
+
+/* as in takehiro.c */
+#ifdef TAKEHIRO_IEEE754_HACK
+#define MAGIC_FLOAT (65536*(128))
+#define MAGIC_INT 0x4b000000
+#endif
+
+/* SSE2 has no gather: the table lookups are scalar */
+static inline SSE2_TARGET __m128i
+xmm_quantize(__m128 x)
+{
+    int     idx[4];
+#ifdef TAKEHIRO_IEEE754_HACK
+    __m128d const magic = _mm_set1_pd(MAGIC_FLOAT);
+    __m128i const magic_int = _mm_set1_epi32(MAGIC_INT);
+    __m128d lo = _mm_add_pd(_mm_cvtps_pd(x), magic);
+    __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), magic);
+    __m128  r = _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+    __m128  adj;
+
+    _mm_storeu_si128((__m128i *) idx, _mm_sub_epi32(_mm_castps_si128(r), magic_int));
+    adj = _mm_setr_ps(adj43asm[idx[0]], adj43asm[idx[1]], adj43asm[idx[2]], adj43asm[idx[3]]);
+    lo = _mm_add_pd(lo, _mm_cvtps_pd(adj));
+    hi = _mm_add_pd(hi, _mm_cvtps_pd(_mm_movehl_ps(adj, adj)));
+    r = _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+    return _mm_sub_epi32(_mm_castps_si128(r), magic_int);
+#else
+    __m128  adj;
+
+    _mm_storeu_si128((__m128i *) idx, _mm_cvttps_epi32(x));
+    adj = _mm_setr_ps(adj43[idx[0]], adj43[idx[1]], adj43[idx[2]], adj43[idx[3]]);
+    return _mm_cvttps_epi32(_mm_add_ps(x, adj));
+#endif
+}
+
+#include "takehiro_vec.h"
+
+#endif	/* HAVE_XMMINTRIN_H */
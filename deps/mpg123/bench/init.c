@@ -0,0 +1,110 @@
+/*
+	bench/init.c: the cold start of libmpg123
+
+	Prints the time mpg123_init() takes (once per process, so run it a few times), then
+	for a number of streams the time mpg123_new() with the Decoder's setup takes, and the
+	time decoding the first frame of a stream takes (which sets up the decoder and its
+	tables for the format) against the second frame.
+
+	  $ make -C build bench_init && ./build/Release/bench_init [file.mp3] [streams]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mpg123.h"
+
+static unsigned char *read_file(const char *path, size_t *size)
+{
+	FILE *f = fopen(path, "rb");
+	unsigned char *data;
+	long n;
+
+	if(f == NULL || fseek(f, 0, SEEK_END) || (n = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET))
+	{
+		fprintf(stderr, "cannot read %s\n", path);
+		exit(1);
+	}
+	data = malloc(n);
+	if(fread(data, 1, n, f) != (size_t)n) exit(1);
+	fclose(f);
+	*size = n;
+	return data;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The next frame, past the format change that the first one brings. */
+static int decode_frame(mpg123_handle *mh)
+{
+	off_t num;
+	unsigned char *audio;
+	size_t bytes;
+	int err;
+
+	do err = mpg123_decode_frame(mh, &num, &audio, &bytes);
+	while(err == MPG123_NEW_FORMAT);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : "test/fixtures/pipershut_lo.mp3";
+	int streams = argc > 2 ? atoi(argv[2]) : 1000;
+	size_t size;
+	unsigned char *mp3 = read_file(path, &size);
+	double init_s, new_s = 0, first_s = 0, next_s = 0, t;
+	int i;
+
+	t = now();
+	if(mpg123_init() != MPG123_OK) return 1;
+	init_s = now() - t;
+
+	for(i=0; i<streams; i++)
+	{
+		mpg123_handle *mh;
+		const long *rates;
+		size_t rate_count, r;
+		int err = MPG123_OK;
+
+		t = now();
+		mh = mpg123_new(NULL, &err);
+		if(mh == NULL) return 1;
+		mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|MPG123_GAPLESS, 0);
+		mpg123_format_none(mh);
+		mpg123_rates(&rates, &rate_count);
+		for(r=0; r<rate_count; r++)
+		mpg123_format(mh, rates[r], MPG123_MONO|MPG123_STEREO, MPG123_ENC_SIGNED_16);
+		if(mpg123_open_feed(mh) != MPG123_OK) return 1;
+		new_s += now() - t;
+
+		if(mpg123_feed(mh, mp3, size < 16384 ? size : 16384) != MPG123_OK) return 1;
+		t = now();
+		err = decode_frame(mh);
+		first_s += now() - t;
+		t = now();
+		err |= decode_frame(mh);
+		next_s += now() - t;
+		if(err != MPG123_OK)
+		{
+			fprintf(stderr, "decoding failed\n");
+			return 1;
+		}
+		mpg123_delete(mh);
+	}
+
+	printf("mpg123_init()  %8.1f us\n", init_s * 1e6);
+	printf("mpg123_new()   %8.1f us\n", new_s * 1e6 / streams);
+	printf("first frame    %8.1f us\n", first_s * 1e6 / streams);
+	printf("second frame   %8.1f us\n", next_s * 1e6 / streams);
+
+	mpg123_exit();
+	free(mp3);
+	return 0;
+}
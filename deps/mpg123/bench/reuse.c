@@ -0,0 +1,159 @@
+/*
+	bench/reuse.c: memory of an idle decoder handle, and decoding with a new vs a reopened one
+
+	Decodes an MP3 file (or the first bytes of it, as a short clip) a number of times, once
+	with mpg123_new() + mpg123_delete() per stream and once with one handle that
+	mpg123_open_feed() readies for the next stream (it mpg123_close()s the last one), and
+	prints the time per stream either way. Every stream must come out of the reopened
+	handle byte for byte as it does from a new one, otherwise it exits with an error.
+
+	Then it keeps a number of handles that have each decoded the file and been reopened,
+	as a handle pool keeps them, and prints the heap they take up each (glibc's mallinfo2()).
+
+	  $ make -C build bench_decoder_reuse && ./build/Release/bench_decoder_reuse [file.mp3] [streams] [bytes]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+
+#include "mpg123.h"
+
+#define HANDLES 100
+
+static unsigned char *read_file(const char *path, size_t *size)
+{
+	FILE *f = fopen(path, "rb");
+	unsigned char *data;
+	long n;
+
+	if(f == NULL || fseek(f, 0, SEEK_END) || (n = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET))
+	{
+		fprintf(stderr, "cannot read %s\n", path);
+		exit(1);
+	}
+	data = malloc(n);
+	if(fread(data, 1, n, f) != (size_t)n) exit(1);
+	fclose(f);
+	*size = n;
+	return data;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* A handle set up as the Decoder sets one up: gapless, 16bit at the rates of the file. */
+static mpg123_handle *open_handle(void)
+{
+	int err = MPG123_OK;
+	mpg123_handle *mh = mpg123_new(NULL, &err);
+	const long *rates;
+	size_t rate_count, i;
+
+	if(mh == NULL)
+	{
+		fprintf(stderr, "mpg123_new() failed: %i\n", err);
+		exit(1);
+	}
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET|MPG123_GAPLESS, 0);
+	mpg123_format_none(mh);
+	mpg123_rates(&rates, &rate_count);
+	for(i=0; i<rate_count; i++)
+	mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, MPG123_ENC_SIGNED_16);
+	if(mpg123_open_feed(mh) != MPG123_OK)
+	{
+		fprintf(stderr, "mpg123_open_feed() failed\n");
+		exit(1);
+	}
+	return mh;
+}
+
+/* One stream, in one feed, into "out"; returns the number of bytes. */
+static long decode(mpg123_handle *mh, const unsigned char *mp3, size_t size, unsigned char *out, size_t capacity)
+{
+	size_t bytes = 0;
+	int err;
+
+	if(mpg123_feed(mh, mp3, size) != MPG123_OK) return -1;
+	do
+	{
+		size_t got = 0;
+		err = mpg123_read(mh, out + bytes, capacity - bytes, &got);
+		bytes += got;
+	} while((err == MPG123_OK || err == MPG123_NEW_FORMAT) && bytes < capacity);
+	return err == MPG123_NEED_MORE || err == MPG123_DONE ? (long)bytes : -1;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : "test/fixtures/pipershut_lo.mp3";
+	int streams = argc > 2 ? atoi(argv[2]) : 200;
+	size_t size, clip;
+	unsigned char *mp3 = read_file(path, &size);
+	size_t const capacity = 64 << 20;
+	unsigned char *fresh = malloc(capacity), *reused = malloc(capacity);
+	mpg123_handle *pooled, *idle[HANDLES];
+	double fresh_s = 0, reopen_s = 0, t;
+	size_t heap;
+	int i;
+
+	clip = argc > 3 ? (size_t)atol(argv[3]) : size;
+	if(clip > size) clip = size;
+	if(fresh == NULL || reused == NULL || streams < 1) return 1;
+
+	mpg123_init();
+	pooled = open_handle();
+	for(i=0; i<streams; i++)
+	{
+		long nf, nr;
+
+		t = now();
+		{
+			mpg123_handle *mh = open_handle();
+			nf = decode(mh, mp3, clip, fresh, capacity);
+			mpg123_delete(mh);
+		}
+		fresh_s += now() - t;
+
+		t = now();
+		if(i > 0 && mpg123_open_feed(pooled) != MPG123_OK)
+		{
+			fprintf(stderr, "mpg123_open_feed() failed\n");
+			return 1;
+		}
+		nr = decode(pooled, mp3, clip, reused, capacity);
+		reopen_s += now() - t;
+
+		if(nf < 0 || nf != nr || memcmp(fresh, reused, nf) != 0)
+		{
+			fprintf(stderr, "stream %i differs (%li vs %li bytes)\n", i, nf, nr);
+			return 1;
+		}
+	}
+	mpg123_delete(pooled);
+	printf("%lu of %lu bytes, %i streams\n", (unsigned long)clip, (unsigned long)size, streams);
+	printf("  new handle  %10.1f us/stream\n", fresh_s * 1e6 / streams);
+	printf("  reopened    %10.1f us/stream\n", reopen_s * 1e6 / streams);
+
+	heap = mallinfo2().uordblks;
+	for(i=0; i<HANDLES; i++)
+	{
+		idle[i] = open_handle();
+		if(decode(idle[i], mp3, clip, fresh, capacity) < 0 || mpg123_open_feed(idle[i]) != MPG123_OK)
+		return 1;
+	}
+	printf("  idle handle %10lu bytes of heap\n", (unsigned long)((mallinfo2().uordblks - heap) / HANDLES));
+	for(i=0; i<HANDLES; i++) mpg123_delete(idle[i]);
+
+	mpg123_exit();
+	free(fresh);
+	free(reused);
+	free(mp3);
+	return 0;
+}
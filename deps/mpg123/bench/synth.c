@@ -0,0 +1,205 @@
+/*
+	bench/synth.c: regression test and benchmark for the decoders (synth and dct64 variants)
+
+	Decodes an MP3 file to signed 16bit, float and signed 32bit with every decoder this
+	build has and this CPU supports, compares the output to that of the generic decoder,
+	and prints the decoding time per frame. Given a rate, it decodes to that rate with
+	MPG123_FORCE_RATE, which makes the NtoM synths do the resampling.
+
+	The decoders sum the synthesis window in different orders, so their output may differ
+	from the generic one in the last bit; a difference beyond the tolerances below fails.
+
+	  $ make -C build bench_synth && ./build/Release/bench_synth [file.mp3] [passes] [rate]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "mpg123.h"
+
+struct output
+{
+	unsigned char *data;
+	size_t bytes;
+	off_t frames;
+};
+
+/*
+	The tolerances: the x86-64 assembler decoder rounds to 16bit its own way (on a
+	differently scaled window) and can be off by a few steps, the others truncate as
+	the generic one does.
+*/
+static const struct
+{
+	const char *name;
+	int encoding;
+	double step; /* one 16bit step in the units of the encoding */
+	double tolerance; /* in 16bit steps */
+} encodings[] =
+{
+	{ "s16", MPG123_ENC_SIGNED_16, 1.0,            4.0 }
+,	{ "f32", MPG123_ENC_FLOAT_32,  1.0/32768,      0.01 }
+,	{ "s32", MPG123_ENC_SIGNED_32, 65536.0,        0.01 }
+};
+
+/* The MPG123_FORCE_RATE, or 0 for the rates of the file. */
+static long force_rate = 0;
+
+static unsigned char *read_file(const char *path, size_t *size)
+{
+	FILE *f = fopen(path, "rb");
+	unsigned char *data;
+	long n;
+
+	if(f == NULL || fseek(f, 0, SEEK_END) || (n = ftell(f)) <= 0 || fseek(f, 0, SEEK_SET))
+	{
+		fprintf(stderr, "cannot read %s\n", path);
+		exit(1);
+	}
+	data = malloc(n);
+	if(fread(data, 1, n, f) != (size_t)n) exit(1);
+	fclose(f);
+	*size = n;
+	return data;
+}
+
+/* Whole file, in one feed, to the one encoding. */
+static int decode(const char *decoder, int encoding, const unsigned char *mp3, size_t size, struct output *out)
+{
+	mpg123_handle *mh;
+	const long *rates;
+	size_t rate_count, i, capacity = 1 << 20;
+	int err = MPG123_OK;
+
+	mh = mpg123_new(decoder, &err);
+	if(mh == NULL) return err;
+	mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_QUIET, 0);
+	mpg123_format_none(mh);
+	if(force_rate)
+	{
+		mpg123_param(mh, MPG123_FORCE_RATE, force_rate, 0);
+		mpg123_format(mh, force_rate, MPG123_MONO|MPG123_STEREO, encoding);
+	}
+	else
+	{
+		mpg123_rates(&rates, &rate_count);
+		for(i=0; i<rate_count; i++)
+		mpg123_format(mh, rates[i], MPG123_MONO|MPG123_STEREO, encoding);
+	}
+	if(mpg123_open_feed(mh) != MPG123_OK || mpg123_feed(mh, mp3, size) != MPG123_OK)
+	{
+		mpg123_delete(mh);
+		return MPG123_ERR;
+	}
+
+	out->bytes = 0;
+	out->data = realloc(out->data, capacity);
+	do
+	{
+		size_t got = 0;
+		if(capacity - out->bytes < 65536) out->data = realloc(out->data, capacity *= 2);
+		err = mpg123_read(mh, out->data + out->bytes, capacity - out->bytes, &got);
+		out->bytes += got;
+	} while(err == MPG123_OK || err == MPG123_NEW_FORMAT);
+	out->frames = mpg123_tellframe(mh);
+	mpg123_delete(mh);
+	return err == MPG123_NEED_MORE || err == MPG123_DONE ? MPG123_OK : err;
+}
+
+/* The largest difference, in 16bit steps. */
+static double difference(int e, const struct output *a, const struct output *b)
+{
+	double max = 0;
+	size_t i, n = a->bytes / 4;
+
+	if(a->bytes != b->bytes) return HUGE_VAL;
+	if(encodings[e].encoding == MPG123_ENC_SIGNED_16)
+	{
+		const short *x = (const short *) a->data, *y = (const short *) b->data;
+		for(i=0; i<a->bytes/2; i++)
+		if(fabs((double)x[i] - y[i]) > max) max = fabs((double)x[i] - y[i]);
+	}
+	else if(encodings[e].encoding == MPG123_ENC_FLOAT_32)
+	{
+		const float *x = (const float *) a->data, *y = (const float *) b->data;
+		for(i=0; i<n; i++)
+		if(fabs((double)x[i] - y[i]) > max) max = fabs((double)x[i] - y[i]);
+	}
+	else
+	{
+		const int *x = (const int *) a->data, *y = (const int *) b->data;
+		for(i=0; i<n; i++)
+		if(fabs((double)x[i] - y[i]) > max) max = fabs((double)x[i] - y[i]);
+	}
+	return max / encodings[e].step;
+}
+
+/* Best of the passes, or a negative time if decoding failed. */
+static double bench(const char *decoder, int e, const unsigned char *mp3, size_t size, struct output *out, int passes)
+{
+	double ns = 0;
+	int pass;
+
+	for(pass=0; pass<passes; pass++)
+	{
+		clock_t const start = clock();
+		double t;
+		if(decode(decoder, encodings[e].encoding, mp3, size, out) != MPG123_OK || out->frames <= 0)
+		return -1;
+		t = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / out->frames;
+		if(pass == 0 || t < ns) ns = t;
+	}
+	return ns;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : "test/fixtures/pipershut_lo.mp3";
+	int passes = argc > 2 ? atoi(argv[2]) : 5;
+	size_t size, e;
+	unsigned char *mp3 = read_file(path, &size);
+	struct output expected = { NULL, 0, 0 }, result = { NULL, 0, 0 };
+	int failed = 0;
+
+	if(argc > 3) force_rate = atol(argv[3]);
+	mpg123_init();
+	for(e=0; e<sizeof(encodings)/sizeof(encodings[0]); e++)
+	{
+		const char **d;
+		double const generic_ns = bench("generic", e, mp3, size, &expected, passes);
+
+		if(generic_ns < 0)
+		{
+			fprintf(stderr, "generic decoder failed\n");
+			return 1;
+		}
+		if(force_rate) printf("%s at %li Hz, %li frames\n", encodings[e].name, force_rate, (long)expected.frames);
+		else printf("%s, %li frames\n", encodings[e].name, (long)expected.frames);
+		printf("  %-10s %8.0f ns/frame\n", "generic", generic_ns);
+		for(d = mpg123_supported_decoders(); *d != NULL; d++)
+		{
+			double ns, diff;
+
+			if(!strcmp(*d, "generic")) continue;
+			ns = bench(*d, e, mp3, size, &result, passes);
+			if(ns < 0)
+			{
+				printf("  %-10s decoding FAILED\n", *d);
+				failed = 1;
+				continue;
+			}
+			diff = difference(e, &expected, &result);
+			failed |= diff > encodings[e].tolerance;
+			printf("  %-10s %8.0f ns/frame  %5.2fx  max difference %g (16bit steps)%s\n", *d, ns
+			,	generic_ns / ns, diff, diff > encodings[e].tolerance ? "  TOO LARGE" : "");
+		}
+	}
+	mpg123_exit();
+	free(expected.data);
+	free(result.data);
+	free(mp3);
+	return failed;
+}
@@ -832,6 +832,9 @@ enum mpg123_state
 	,MPG123_BUFFERFILL   /**< Get fill of internal (feed) input buffer as integer byte count returned as long and as double. An error is returned on integer overflow while converting to (signed) long, but the returned floating point value shold still be fine. */
 	,MPG123_FRANKENSTEIN /**< Stream consists of carelessly stitched together files. Seeking may yield unexpected results (also with MPG123_ACCURATE, it may be confused). */
 	,MPG123_FRESH_DECODER /**< Decoder structure has been updated, possibly indicating changed stream (integer value, 0 if false, 1 if true). Flag is cleared after retrieval. */
+	,MPG123_ENC_DELAY = 5 /**< Encoder delay read from the LAME tag, in samples (integer, -1 if not known). */
+	,MPG123_ENC_PADDING  /**< Encoder padding read from the LAME tag, in samples (integer, -1 if not known). */
+	,MPG123_DEC_DELAY    /**< Decoder delay that gapless decoding cuts off on top of the encoder delay (integer, -1 if not known). */
 };
 
 /** Get various current decoder/stream state information.
@@ -765,6 +765,9 @@ enum mpg123_state
 	 MPG123_ACCURATE = 1 /**< Query if positons are currently accurate (integer value, 0 if false, 1 if true) */
 	,MPG123_BUFFERFILL   /**< Get fill of internal (feed) input buffer as integer byte count returned as long and as double. An error is returned on integer overflow while converting to (signed) long, but the returned floating point value shold still be fine. */
 	,MPG123_FRANKENSTEIN /**< Stream consists of carelessly stitched together files (the leading one featuring gapless info).  */
+	,MPG123_ENC_DELAY = 5 /**< Encoder delay read from the LAME tag, in samples (integer, -1 if not known). */
+	,MPG123_ENC_PADDING  /**< Encoder padding read from the LAME tag, in samples (integer, -1 if not known). */
+	,MPG123_DEC_DELAY    /**< Decoder delay that gapless decoding cuts off on top of the encoder delay (integer, -1 if not known). */
 };
 
 /** Get various current decoder/stream state information.
@@ -46,19 +46,59 @@
   },
 
   'targets': [
+    # calculates the constant tables of the floating-point decoders at build time
+    {
+      'target_name': 'mpg123_calctables',
+      'type': 'executable',
+      'toolsets': [ 'host' ],
+      'sources': [ 'src/libmpg123/calctables.c' ],
+      'conditions': [
+        ['OS!="win"', { 'libraries': [ '-lm' ] }],
+      ],
+    },
+
     {
       'target_name': 'mpg123',
       'product_prefix': 'lib',
       'type': 'static_library',
+      'dependencies': [ 'mpg123_calctables#host' ],
+      'actions': [
+        # one action per header: gyp runs an action of several outputs on every
+        # make, through a stamp that is never written
+        {
+          'action_name': 'calctables_l3_float_tables',
+          'inputs': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)' ],
+          'outputs': [ '<(SHARED_INTERMEDIATE_DIR)/mpg123/l3_float_tables.h' ],
+          'action': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)', '<(SHARED_INTERMEDIATE_DIR)/mpg123', 'l3_float_tables.h' ],
+          'message': 'Calculating the mpg123 tables (l3_float_tables.h)',
+        },
+        {
+          'action_name': 'calctables_l12_float_tables',
+          'inputs': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)' ],
+          'outputs': [ '<(SHARED_INTERMEDIATE_DIR)/mpg123/l12_float_tables.h' ],
+          'action': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)', '<(SHARED_INTERMEDIATE_DIR)/mpg123', 'l12_float_tables.h' ],
+          'message': 'Calculating the mpg123 tables (l12_float_tables.h)',
+        },
+        {
+          'action_name': 'calctables_dct64_float_tables',
+          'inputs': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)' ],
+          'outputs': [ '<(SHARED_INTERMEDIATE_DIR)/mpg123/dct64_float_tables.h' ],
+          'action': [ '<(PRODUCT_DIR)/mpg123_calctables<(EXECUTABLE_SUFFIX)', '<(SHARED_INTERMEDIATE_DIR)/mpg123', 'dct64_float_tables.h' ],
+          'message': 'Calculating the mpg123 tables (dct64_float_tables.h)',
+        },
+      ],
       'variables': {
         'conditions': [
           # "mpg123_cpu" is the cpu optimization to use
           # Windows uses "i386_fpu" even on x64 to avoid compiling .S asm files
           # (I don't think the 64-bit ASM files are compatible with `ml`/`ml64`...)
+          # "x86" and "x86-64" build all the decoders of the arch, and libmpg123
+          # picks the fastest one the CPU has at runtime; pass -Dmpg123_cpu=i386_fpu
+          # to build just the one
           ['OS=="win"', { 'mpg123_cpu%': 'i386_fpu' },
           { 'conditions': [
             ['target_arch=="arm"', { 'mpg123_cpu%': 'arm_nofpu' }],
-            ['target_arch=="ia32"', { 'mpg123_cpu%': 'i386_fpu' }],
+            ['target_arch=="ia32"', { 'mpg123_cpu%': 'x86' }],
             ['target_arch=="x87"', { 'mpg123_cpu%': 'i386_fpu' }],
             ['target_arch=="x64"', { 'mpg123_cpu%': 'x86-64' }],
           ]}],
@@ -92,6 +132,8 @@
         'src/libmpg123',
         # platform and arch-specific headers
         'config/<(OS)/<(target_arch)',
+        # the tables calctables writes
+        '<(SHARED_INTERMEDIATE_DIR)/mpg123',
       ],
       'defines': [
         'PIC',
@@ -128,12 +170,67 @@
             'src/libmpg123/dct64_i386.c',
           ],
         }],
+        # x86 is a multi-decoder build, like configure's --with-cpu=x86: the
+        # i386, i586, MMX, 3DNow!, 3DNow!Ext and SSE assembler decoders, the AVX2
+        # one and the generic C ones, chosen at runtime (getcpuflags) or by name
+        ['mpg123_cpu=="x86"', {
+          'defines': [
+            'OPT_MULTI',
+            'OPT_GENERIC',
+            'OPT_GENERIC_DITHER',
+            'OPT_I386',
+            'OPT_I586',
+            'OPT_I586_DITHER',
+            'OPT_MMX',
+            'OPT_3DNOW',
+            'OPT_3DNOWEXT',
+            'OPT_SSE',
+            'OPT_AVX',
+            'REAL_IS_FLOAT',
+          ],
+          'sources': [
+            'src/libmpg123/getcpuflags.S',
+            'src/libmpg123/synth_s32.c',
+            'src/libmpg123/synth_real.c',
+            'src/libmpg123/dither.c',
+            'src/libmpg123/dct64_i386.c',
+            'src/libmpg123/synth_i586.S',
+            'src/libmpg123/synth_i586_dither.S',
+            'src/libmpg123/dct64_mmx.S',
+            'src/libmpg123/tabinit_mmx.S',
+            'src/libmpg123/synth_mmx.S',
+            'src/libmpg123/dct64_3dnow.S',
+            'src/libmpg123/dct36_3dnow.S',
+            'src/libmpg123/equalizer_3dnow.S',
+            'src/libmpg123/synth_3dnow.S',
+            'src/libmpg123/dct64_3dnowext.S',
+            'src/libmpg123/dct36_3dnowext.S',
+            'src/libmpg123/synth_3dnowext.S',
+            'src/libmpg123/dct64_sse.S',
+            'src/libmpg123/dct64_sse_float.S',
+            'src/libmpg123/synth_sse.S',
+            'src/libmpg123/synth_sse_float.S',
+            'src/libmpg123/synth_sse_s32.S',
+            'src/libmpg123/synth_stereo_sse_float.S',
+            'src/libmpg123/synth_stereo_sse_s32.S',
+            'src/libmpg123/dct64_avx.c',
+            'src/libmpg123/synth_avx.c',
+          ],
+        }],
+        # x86-64 is a multi-decoder build too: the SSE assembler decoder, the
+        # AVX2 one and the generic C one
         ['mpg123_cpu=="x86-64"', {
           'defines': [
+            'OPT_MULTI',
+            'OPT_GENERIC',
             'OPT_X86_64',
+            'OPT_AVX',
             'REAL_IS_FLOAT',
           ],
           'sources': [
+            'src/libmpg123/getcpuflags_x86_64.S',
+            'src/libmpg123/dct64_avx.c',
+            'src/libmpg123/synth_avx.c',
             'src/libmpg123/dct64_x86_64.S',
             'src/libmpg123/dct64_x86_64_float.S',
             'src/libmpg123/synth_s32.c',
@@ -236,6 +333,30 @@
       'type': 'executable',
       'dependencies': [ 'output' ],
       'sources': [ 'test_output.c' ]
+    },
+
+    # regression test and benchmark for the synth and dct64 decoders
+    {
+      'target_name': 'bench_synth',
+      'type': 'executable',
+      'dependencies': [ 'mpg123' ],
+      'sources': [ 'bench/synth.c' ]
+    },
+
+    # memory of an idle (pooled) handle, and new vs reopened handles per stream
+    {
+      'target_name': 'bench_decoder_reuse',
+      'type': 'executable',
+      'dependencies': [ 'mpg123' ],
+      'sources': [ 'bench/reuse.c' ]
+    },
+
+    # cold start: mpg123_init(), mpg123_new() and the first frame of a stream
+    {
+      'target_name': 'bench_init',
+      'type': 'executable',
+      'dependencies': [ 'mpg123' ],
+      'sources': [ 'bench/init.c' ]
     }
   ]
 }
@@ -0,0 +1,328 @@
+/*
+	calctables.c: calculate the constant tables of the floating-point decoders at build time
+
+	copyright 2008-2026 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+
+	Writes l12_float_tables.h, l3_float_tables.h and dct64_float_tables.h into the directory
+	given (or only the headers named after it, as the gyp build has one action per header), with the tables that init_layer12_table(), init_layer3(), init_layer3_gainpow2()
+	and prepare_decode_tables() calculate when the library is built with RUNTIME_TABLES. The
+	values come out of the same double precision maths and are printed with 17 significant
+	digits, which the compiler reads back as the same double, so the tables have exactly the
+	values that the run time calculation gives (both convert to real the same way).
+
+	  $ calctables <directory> [header...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+# define M_PI		3.14159265358979323846
+#endif
+#ifndef M_SQRT2
+# define M_SQRT2	1.41421356237309504880
+#endif
+
+static const char *dir;
+
+static FILE *open_header(const char *name, const char *what)
+{
+	char path[4096];
+	FILE *f;
+	char guard[64];
+	size_t i;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	f = fopen(path, "w");
+	if(f == NULL)
+	{
+		fprintf(stderr, "calctables: cannot write %s\n", path);
+		exit(1);
+	}
+	for(i=0; name[i] && i < sizeof(guard)-1; i++)
+	guard[i] = name[i] == '.' ? '_' : (name[i] >= 'a' && name[i] <= 'z' ? name[i]-'a'+'A' : name[i]);
+	guard[i] = 0;
+	fprintf(f, "/*\n\t%s: %s\n\n\tgenerated by calctables.c at build time, do not edit\n*/\n\n", name, what);
+	fprintf(f, "#ifndef MPG123_%s\n#define MPG123_%s\n", guard, guard);
+	return f;
+}
+
+static void close_header(FILE *f)
+{
+	fprintf(f, "\n#endif\n");
+	if(fclose(f) != 0)
+	{
+		fprintf(stderr, "calctables: write error\n");
+		exit(1);
+	}
+}
+
+/* A double as C source that reads back as the same double (also -0.0, which "-0" is not). */
+static void value(FILE *f, double v)
+{
+	if(v == 0.0) fprintf(f, "%s", signbit(v) ? "-0.0" : "0.0");
+	else fprintf(f, "%.17g", v);
+}
+
+/* The values of one row, four to a line. */
+static void values(FILE *f, const double *v, size_t n, const char *indent)
+{
+	size_t i;
+	for(i=0; i<n; i++)
+	{
+		fprintf(f, "%s", i % 4 ? " " : indent);
+		value(f, v[i]);
+		fprintf(f, "%s", i+1 == n ? "\n" : (i % 4 == 3 ? ",\n" : ","));
+	}
+}
+
+/* "decl" is what goes before the " =", like "static const real ALIGNED(16) ispow[8207]". */
+static void table(FILE *f, const char *decl, const double *v, size_t n)
+{
+	fprintf(f, "\n%s =\n{\n", decl);
+	values(f, v, n, "\t");
+	fprintf(f, "};\n");
+}
+
+static void table2(FILE *f, const char *decl, const double *v, size_t rows, size_t n)
+{
+	size_t r;
+	fprintf(f, "\n%s =\n{\n", decl);
+	for(r=0; r<rows; r++)
+	{
+		fprintf(f, "\t{\n");
+		values(f, v + r*n, n, "\t\t");
+		fprintf(f, "\t}%s\n", r+1 == rows ? "" : ",");
+	}
+	fprintf(f, "};\n");
+}
+
+static void scalar(FILE *f, const char *decl, double v)
+{
+	fprintf(f, "\n%s = ", decl);
+	value(f, v);
+	fprintf(f, ";\n");
+}
+
+/* init_layer12_table(), with the 0.0 that init_layer12_stuff() puts after each row */
+static void layer12(void)
+{
+	static const double mulmul[27] =
+	{
+		0.0 , -2.0/3.0 , 2.0/3.0 ,
+		2.0/7.0 , 2.0/15.0 , 2.0/31.0, 2.0/63.0 , 2.0/127.0 , 2.0/255.0 ,
+		2.0/511.0 , 2.0/1023.0 , 2.0/2047.0 , 2.0/4095.0 , 2.0/8191.0 ,
+		2.0/16383.0 , 2.0/32767.0 , 2.0/65535.0 ,
+		-4.0/5.0 , -2.0/5.0 , 2.0/5.0, 4.0/5.0 ,
+		-8.0/9.0 , -4.0/9.0 , -2.0/9.0 , 2.0/9.0 , 4.0/9.0 , 8.0/9.0
+	};
+	static double layer12_table[27][64];
+	int i,j,m;
+	FILE *f = open_header("l12_float_tables.h", "Layer1/2 constant tables for floating-point decoders");
+
+	for(m=0; m<27; m++)
+	{
+		for(j=3,i=0;i<63;i++,j--)
+		layer12_table[m][i] = mulmul[m] * pow(2.0,(double) j / 3.0);
+		layer12_table[m][63] = 0.0;
+	}
+	table2(f, "static const real ALIGNED(32) layer12_table[27][64]", layer12_table[0], 27, 64);
+	close_header(f);
+}
+
+/* init_layer3() and init_layer3_gainpow2() */
+static void layer3(void)
+{
+	static double ispow[8207];
+	static double aa_ca[8],aa_cs[8];
+	static double win[4][36];
+	static double win1[4][36];
+	static double COS9[9];
+	static double COS6_1,COS6_2;
+	static double tfcos36[9];
+	static double tfcos12[3];
+	static double cos9[3],cos18[3];
+	static double tan1_1[16],tan2_1[16],tan1_2[16],tan2_2[16];
+	static double pow1_1[2][16],pow2_1[2][16],pow1_2[2][16],pow2_2[2][16];
+	static double gainpow2[256+118+4];
+	int i,j;
+	FILE *f = open_header("l3_float_tables.h", "Layer3 constant tables for floating-point decoders");
+
+	for(i=0;i<8207;i++)
+	ispow[i] = pow((double)i,(double)4.0/3.0);
+
+	for(i=0;i<8;i++)
+	{
+		const double Ci[8] = {-0.6,-0.535,-0.33,-0.185,-0.095,-0.041,-0.0142,-0.0037};
+		double sq = sqrt(1.0+Ci[i]*Ci[i]);
+		aa_cs[i] = 1.0/sq;
+		aa_ca[i] = Ci[i]/sq;
+	}
+
+	for(i=0;i<18;i++)
+	{
+		win[0][i]    = win[1][i]    =
+			0.5*sin(M_PI/72.0 * (double)(2*(i+0) +1)) / cos(M_PI * (double)(2*(i+0) +19) / 72.0);
+		win[0][i+18] = win[3][i+18] =
+			0.5*sin(M_PI/72.0 * (double)(2*(i+18)+1)) / cos(M_PI * (double)(2*(i+18)+19) / 72.0);
+	}
+	for(i=0;i<6;i++)
+	{
+		win[1][i+18] = 0.5 / cos ( M_PI * (double) (2*(i+18)+19) / 72.0 );
+		win[3][i+12] = 0.5 / cos ( M_PI * (double) (2*(i+12)+19) / 72.0 );
+		win[1][i+24] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+13) ) / cos ( M_PI * (double) (2*(i+24)+19) / 72.0 );
+		win[1][i+30] = win[3][i] = 0.0;
+		win[3][i+6 ] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+1 ) ) / cos ( M_PI * (double) (2*(i+6 )+19) / 72.0 );
+	}
+
+	for(i=0;i<9;i++)
+	COS9[i] = cos( M_PI / 18.0 * (double) i);
+
+	for(i=0;i<9;i++)
+	tfcos36[i] = 0.5 / cos ( M_PI * (double) (i*2+1) / 36.0 );
+
+	for(i=0;i<3;i++)
+	tfcos12[i] = 0.5 / cos ( M_PI * (double) (i*2+1) / 12.0 );
+
+	COS6_1 = cos( M_PI / 6.0 * (double) 1);
+	COS6_2 = cos( M_PI / 6.0 * (double) 2);
+
+	cos9[0]  = cos(1.0*M_PI/9.0);
+	cos9[1]  = cos(5.0*M_PI/9.0);
+	cos9[2]  = cos(7.0*M_PI/9.0);
+	cos18[0] = cos(1.0*M_PI/18.0);
+	cos18[1] = cos(11.0*M_PI/18.0);
+	cos18[2] = cos(13.0*M_PI/18.0);
+
+	for(i=0;i<12;i++)
+	{
+		win[2][i] = 0.5 * sin( M_PI / 24.0 * (double) (2*i+1) ) / cos ( M_PI * (double) (2*i+7) / 24.0 );
+	}
+
+	for(i=0;i<16;i++)
+	{
+		double t = tan( (double) i * M_PI / 12.0 );
+		tan1_1[i] = t / (1.0+t);
+		tan2_1[i] = 1.0 / (1.0 + t);
+		tan1_2[i] = M_SQRT2 * t / (1.0+t);
+		tan2_2[i] = M_SQRT2 / (1.0 + t);
+
+		for(j=0;j<2;j++)
+		{
+			double base = pow(2.0,-0.25*(j+1.0));
+			double p1=1.0,p2=1.0;
+			if(i > 0)
+			{
+				if( i & 1 ) p1 = pow(base,(i+1.0)*0.5);
+				else p2 = pow(base,i*0.5);
+			}
+			pow1_1[j][i] = p1;
+			pow2_1[j][i] = p2;
+			pow1_2[j][i] = M_SQRT2 * p1;
+			pow2_2[j][i] = M_SQRT2 * p2;
+		}
+	}
+
+	for(j=0;j<4;j++)
+	{
+		const int len[4] = { 36,36,12,36 };
+		for(i=0;i<len[j];i+=2) win1[j][i] = + win[j][i];
+
+		for(i=1;i<len[j];i+=2) win1[j][i] = - win[j][i];
+	}
+
+	for(i=-256;i<118+4;i++)
+	gainpow2[i+256] = pow((double)2.0,-0.25 * (double) (i+210));
+
+	table(f, "static const real ALIGNED(32) ispow[8207]", ispow, 8207);
+	table(f, "static const real aa_ca[8]", aa_ca, 8);
+	table(f, "static const real aa_cs[8]", aa_cs, 8);
+	/* the dct36 variants take the windows as real*, but only read them */
+	table2(f, "static real ALIGNED(32) win[4][36]", win[0], 4, 36);
+	table2(f, "static real ALIGNED(32) win1[4][36]", win1[0], 4, 36);
+	fprintf(f, "\n/* dct36_3dnow wants to use these */");
+	table(f, "const real COS9[9]", COS9, 9);
+	table(f, "const real tfcos36[9]", tfcos36, 9);
+	scalar(f, "static const real COS6_1", COS6_1);
+	scalar(f, "static const real COS6_2", COS6_2);
+	table(f, "static const real tfcos12[3]", tfcos12, 3);
+	table(f, "static const real cos9[3]", cos9, 3);
+	table(f, "static const real cos18[3]", cos18, 3);
+	table(f, "static const real tan1_1[16]", tan1_1, 16);
+	table(f, "static const real tan2_1[16]", tan2_1, 16);
+	table(f, "static const real tan1_2[16]", tan1_2, 16);
+	table(f, "static const real tan2_2[16]", tan2_2, 16);
+	table2(f, "static const real pow1_1[2][16]", pow1_1[0], 2, 16);
+	table2(f, "static const real pow2_1[2][16]", pow2_1[0], 2, 16);
+	table2(f, "static const real pow1_2[2][16]", pow1_2[0], 2, 16);
+	table2(f, "static const real pow2_2[2][16]", pow2_2[0], 2, 16);
+	table(f, "static const real ALIGNED(32) gainpow2[256+118+4]", gainpow2, 256+118+4);
+	close_header(f);
+}
+
+/* prepare_decode_tables() */
+static void dct64(void)
+{
+	static double costab[5][16];
+	static const char *names[5] = { "cos64", "cos32", "cos16", "cos8", "cos4" };
+	int i,k,kr,divv;
+	FILE *f = open_header("dct64_float_tables.h", "dct64 cosine tables for floating-point decoders");
+
+	for(i=0;i<5;i++)
+	{
+		char decl[64];
+		kr=0x10>>i; divv=0x40>>i;
+		for(k=0;k<kr;k++)
+		costab[i][k] = 1.0 / (2.0 * cos(M_PI * ((double) k * 2.0 + 1.0) / (double) divv));
+		/* pnts[] hands them to the dct64 variants as real* */
+		snprintf(decl, sizeof(decl), "static real ALIGNED(32) %s[%i]", names[i], kr);
+		table(f, decl, costab[i], kr);
+	}
+	close_header(f);
+}
+
+static const struct
+{
+	const char *name;
+	void (*write)(void);
+} headers[] =
+{
+	{ "l12_float_tables.h", layer12 },
+	{ "l3_float_tables.h", layer3 },
+	{ "dct64_float_tables.h", dct64 }
+};
+
+int main(int argc, char **argv)
+{
+	size_t h;
+	int i;
+
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: calctables <directory> [header...]\n");
+		return 1;
+	}
+	dir = argv[1];
+	if(argc == 2)
+	{
+		for(h=0; h<sizeof(headers)/sizeof(headers[0]); h++)
+		headers[h].write();
+		return 0;
+	}
+	for(i=2; i<argc; i++)
+	{
+		for(h=0; h<sizeof(headers)/sizeof(headers[0]); h++)
+		if(!strcmp(argv[i], headers[h].name)) break;
+
+		if(h == sizeof(headers)/sizeof(headers[0]))
+		{
+			fprintf(stderr, "calctables: no such header: %s\n", argv[i]);
+			return 1;
+		}
+		headers[h].write();
+	}
+	return 0;
+}
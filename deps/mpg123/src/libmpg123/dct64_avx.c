@@ -0,0 +1,139 @@
+/*
+	dct64_avx.c: Discrete Cosine Tansform (DCT) for AVX2
+
+	copyright 1995-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+	initially written by Michael Hipp, vectorized from dct64.c
+*/
+
+/*
+	Each stage of dct64() folds blocks of 32, 16, 8, 4 and 2 values onto themselves:
+	the sums of value k and its mirror go to the first half of the block, the differences,
+	times the cosines, go mirrored to the second half. This does that for eight values at
+	a time, with the very same float operations (the differences of every other block are
+	taken the other way round, as dct64() does), so the output is bit identical to dct64().
+	The last additions and the scattered stores are as in dct64().
+*/
+
+#include "mpg123lib_intern.h"
+
+#include <immintrin.h>
+
+#define AVX_TARGET __attribute__((target("avx2")))
+
+/* v reversed: lane j is lane 7-j of v */
+#define REV8(v) _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))
+
+/*
+	One stage for blocks of 8, 4 or 2 within v, r being v with every block reversed.
+	Lanes in up get the differences the other way round (r - v), lanes in out the products.
+*/
+#define FOLD(v, r, up, out, cos) _mm256_blend_ps(_mm256_add_ps(v, r), _mm256_mul_ps( \
+	_mm256_blend_ps(_mm256_sub_ps(v, r), _mm256_sub_ps(r, v), up), cos), out)
+
+void AVX_TARGET dct64_avx(real *out0, real *out1, real *samples)
+{
+	ALIGNED(32) real bufs[32];
+	__m256 v0, v1, v2, v3, a0, a1, a2, a3, c;
+
+	{ /* 32 */
+		__m256 const r3 = REV8(_mm256_loadu_ps(samples + 24));
+		__m256 const r2 = REV8(_mm256_loadu_ps(samples + 16));
+		v0 = _mm256_loadu_ps(samples);
+		v1 = _mm256_loadu_ps(samples + 8);
+		a0 = _mm256_add_ps(v0, r3);
+		a1 = _mm256_add_ps(v1, r2);
+		a3 = REV8(_mm256_mul_ps(_mm256_sub_ps(v0, r3), _mm256_loadu_ps(pnts[0])));
+		a2 = REV8(_mm256_mul_ps(_mm256_sub_ps(v1, r2), _mm256_loadu_ps(pnts[0] + 8)));
+	}
+	{ /* 16 */
+		__m256 const r1 = REV8(a1), r3 = REV8(a3);
+		c = _mm256_loadu_ps(pnts[1]);
+		v0 = _mm256_add_ps(a0, r1);
+		v1 = REV8(_mm256_mul_ps(_mm256_sub_ps(a0, r1), c));
+		v2 = _mm256_add_ps(a2, r3);
+		v3 = REV8(_mm256_mul_ps(_mm256_sub_ps(r3, a2), c));
+	}
+	{ /* 8 */
+		__m128 const c16 = _mm_shuffle_ps(_mm_loadu_ps(pnts[2]), _mm_loadu_ps(pnts[2]), 0x1b);
+		c = _mm256_insertf128_ps(_mm256_castps128_ps256(c16), c16, 1);
+		a0 = FOLD(v0, REV8(v0), 0xf0, 0xf0, c);
+		a1 = FOLD(v1, REV8(v1), 0x00, 0xf0, c);
+		a2 = FOLD(v2, REV8(v2), 0xf0, 0xf0, c);
+		a3 = FOLD(v3, REV8(v3), 0x00, 0xf0, c);
+	}
+	/* 4 */
+	c = _mm256_setr_ps(0, 0, pnts[3][1], pnts[3][0], 0, 0, pnts[3][1], pnts[3][0]);
+	v0 = FOLD(a0, _mm256_permute_ps(a0, 0x1b), 0x0c, 0xcc, c);
+	v1 = FOLD(a1, _mm256_permute_ps(a1, 0x1b), 0x0c, 0xcc, c);
+	v2 = FOLD(a2, _mm256_permute_ps(a2, 0x1b), 0x0c, 0xcc, c);
+	v3 = FOLD(a3, _mm256_permute_ps(a3, 0x1b), 0x0c, 0xcc, c);
+	/* 2 */
+	c = _mm256_set1_ps(pnts[4][0]);
+	_mm256_storeu_ps(bufs,      FOLD(v0, _mm256_permute_ps(v0, 0xb1), 0x22, 0xaa, c));
+	_mm256_storeu_ps(bufs + 8,  FOLD(v1, _mm256_permute_ps(v1, 0xb1), 0x22, 0xaa, c));
+	_mm256_storeu_ps(bufs + 16, FOLD(v2, _mm256_permute_ps(v2, 0xb1), 0x22, 0xaa, c));
+	_mm256_storeu_ps(bufs + 24, FOLD(v3, _mm256_permute_ps(v3, 0xb1), 0x22, 0xaa, c));
+
+ {
+  register real *b1;
+  register int i;
+
+  for(b1=bufs,i=8;i;i--,b1+=4)
+    b1[2] += b1[3];
+
+  for(b1=bufs,i=4;i;i--,b1+=8)
+  {
+    b1[4] += b1[6];
+    b1[6] += b1[5];
+    b1[5] += b1[7];
+  }
+
+  for(b1=bufs,i=2;i;i--,b1+=16)
+  {
+    b1[8]  += b1[12];
+    b1[12] += b1[10];
+    b1[10] += b1[14];
+    b1[14] += b1[9];
+    b1[9]  += b1[13];
+    b1[13] += b1[11];
+    b1[11] += b1[15];
+  }
+ }
+
+
+  out0[0x10*16] = REAL_SCALE_DCT64(bufs[0]);
+  out0[0x10*15] = REAL_SCALE_DCT64(bufs[16+0]  + bufs[16+8]);
+  out0[0x10*14] = REAL_SCALE_DCT64(bufs[8]);
+  out0[0x10*13] = REAL_SCALE_DCT64(bufs[16+8]  + bufs[16+4]);
+  out0[0x10*12] = REAL_SCALE_DCT64(bufs[4]);
+  out0[0x10*11] = REAL_SCALE_DCT64(bufs[16+4]  + bufs[16+12]);
+  out0[0x10*10] = REAL_SCALE_DCT64(bufs[12]);
+  out0[0x10* 9] = REAL_SCALE_DCT64(bufs[16+12] + bufs[16+2]);
+  out0[0x10* 8] = REAL_SCALE_DCT64(bufs[2]);
+  out0[0x10* 7] = REAL_SCALE_DCT64(bufs[16+2]  + bufs[16+10]);
+  out0[0x10* 6] = REAL_SCALE_DCT64(bufs[10]);
+  out0[0x10* 5] = REAL_SCALE_DCT64(bufs[16+10] + bufs[16+6]);
+  out0[0x10* 4] = REAL_SCALE_DCT64(bufs[6]);
+  out0[0x10* 3] = REAL_SCALE_DCT64(bufs[16+6]  + bufs[16+14]);
+  out0[0x10* 2] = REAL_SCALE_DCT64(bufs[14]);
+  out0[0x10* 1] = REAL_SCALE_DCT64(bufs[16+14] + bufs[16+1]);
+  out0[0x10* 0] = REAL_SCALE_DCT64(bufs[1]);
+
+  out1[0x10* 0] = REAL_SCALE_DCT64(bufs[1]);
+  out1[0x10* 1] = REAL_SCALE_DCT64(bufs[16+1]  + bufs[16+9]);
+  out1[0x10* 2] = REAL_SCALE_DCT64(bufs[9]);
+  out1[0x10* 3] = REAL_SCALE_DCT64(bufs[16+9]  + bufs[16+5]);
+  out1[0x10* 4] = REAL_SCALE_DCT64(bufs[5]);
+  out1[0x10* 5] = REAL_SCALE_DCT64(bufs[16+5]  + bufs[16+13]);
+  out1[0x10* 6] = REAL_SCALE_DCT64(bufs[13]);
+  out1[0x10* 7] = REAL_SCALE_DCT64(bufs[16+13] + bufs[16+3]);
+  out1[0x10* 8] = REAL_SCALE_DCT64(bufs[3]);
+  out1[0x10* 9] = REAL_SCALE_DCT64(bufs[16+3]  + bufs[16+11]);
+  out1[0x10*10] = REAL_SCALE_DCT64(bufs[11]);
+  out1[0x10*11] = REAL_SCALE_DCT64(bufs[16+11] + bufs[16+7]);
+  out1[0x10*12] = REAL_SCALE_DCT64(bufs[7]);
+  out1[0x10*13] = REAL_SCALE_DCT64(bufs[16+7]  + bufs[16+15]);
+  out1[0x10*14] = REAL_SCALE_DCT64(bufs[15]);
+  out1[0x10*15] = REAL_SCALE_DCT64(bufs[16+15]);
+}
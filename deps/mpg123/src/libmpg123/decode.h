@@ -53,6 +53,8 @@ int synth_1to1_altivec    (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_altivec(real*, real*, mpg123_handle*);
 int synth_1to1_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_x86_64(real*, real*, mpg123_handle*);
+int synth_1to1_avx        (real*, int, mpg123_handle*, int);
+int synth_1to1_stereo_avx (real*, real*, mpg123_handle*);
 int synth_1to1_arm        (real*, int, mpg123_handle*, int);
 int synth_1to1_neon       (real*, int, mpg123_handle*, int);
 int synth_1to1_stereo_neon(real*, real*, mpg123_handle*);
@@ -80,6 +82,7 @@ int synth_4to1_m2s(real*, mpg123_handle*);
 #ifndef NO_NTOM
 /* NtoM is really just one implementation. */
 int synth_ntom (real *,int, mpg123_handle*, int);
+int synth_ntom_avx (real *,int, mpg123_handle*, int);
 int synth_ntom_mono (real *, mpg123_handle *);
 int synth_ntom_m2s (real *, mpg123_handle *);
 #endif
@@ -126,6 +129,8 @@ int synth_1to1_real_sse        (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_sse (real*, real*, mpg123_handle*);
 int synth_1to1_real_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_x86_64(real*, real*, mpg123_handle*);
+int synth_1to1_real_avx        (real*, int, mpg123_handle*, int);
+int synth_1to1_real_stereo_avx (real*, real*, mpg123_handle*);
 int synth_1to1_real_altivec    (real*, int, mpg123_handle*, int);
 int synth_1to1_real_stereo_altivec(real*, real*, mpg123_handle*);
 int synth_1to1_real_neon       (real*, int, mpg123_handle*, int);
@@ -144,6 +149,7 @@ int synth_4to1_real_m2s(real*, mpg123_handle*);
 #endif
 #ifndef NO_NTOM
 int synth_ntom_real            (real*, int, mpg123_handle*, int);
+int synth_ntom_real_avx        (real*, int, mpg123_handle*, int);
 int synth_ntom_real_mono       (real*, mpg123_handle*);
 int synth_ntom_real_m2s(real*, mpg123_handle*);
 #endif
@@ -157,6 +163,8 @@ int synth_1to1_s32_sse        (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_sse (real*, real*, mpg123_handle*);
 int synth_1to1_s32_x86_64     (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_x86_64(real*, real*, mpg123_handle*);
+int synth_1to1_s32_avx        (real*, int, mpg123_handle*, int);
+int synth_1to1_s32_stereo_avx (real*, real*, mpg123_handle*);
 int synth_1to1_s32_altivec    (real*, int, mpg123_handle*, int);
 int synth_1to1_s32_stereo_altivec(real*, real*, mpg123_handle*);
 int synth_1to1_s32_neon       (real*, int, mpg123_handle*, int);
@@ -175,6 +183,7 @@ int synth_4to1_s32_m2s(real*, mpg123_handle*);
 #endif
 #ifndef NO_NTOM
 int synth_ntom_s32            (real*, int, mpg123_handle*, int);
+int synth_ntom_s32_avx        (real*, int, mpg123_handle*, int);
 int synth_ntom_s32_mono       (real*, mpg123_handle*);
 int synth_ntom_s32_m2s(real*, mpg123_handle*);
 #endif
@@ -189,6 +198,7 @@ int synth_ntom_s32_m2s(real*, mpg123_handle*);
 void dct64        (real *,real *,real *);
 void dct64_i386   (real *,real *,real *);
 void dct64_altivec(real *,real *,real *);
+void dct64_avx    (real *,real *,real *);
 void dct64_i486(int*, int* , real*); /* Yeah, of no use outside of synth_i486.c .*/
 
 /* This is used by the layer 3 decoder, one generic function and 3DNow variants. */
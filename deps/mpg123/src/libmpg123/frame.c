@@ -345,6 +345,10 @@ int frame_buffers(mpg123_handle *fr)
 		/* sizeof(real) >= 4 ... yes, it could be 8, for example.
 		   We got it intialized to at least (512+32)*sizeof(real).*/
 		decwin_size += 512*sizeof(real);
+#endif
+#ifdef OPT_AVX
+		/* The AVX decoder is of the normal class, but uses the extended window of the float SSE decoders. */
+		if(fr->cpu_opts.type == avx) decwin_size += 512*sizeof(real);
 #endif
 		/* Hm, that's basically realloc() ... */
 		if(fr->rawdecwin != NULL && fr->rawdecwins != decwin_size)
@@ -373,7 +377,7 @@ int frame_buffers(mpg123_handle *fr)
 			fr->decwins = fr->decwin_mmx+512+32;
 #ifdef OPT_MULTI
 		}
-		else debug("no decwins/decwin_mmx for that class");
+		else { debug("no decwins/decwin_mmx for that class"); }
 #endif
 #endif
 	}
@@ -516,6 +520,8 @@ static void frame_fixed_reset(mpg123_handle *fr)
 	fr->abr_rate = 0;
 	fr->track_frames = 0;
 	fr->track_samples = -1;
+	fr->enc_delay = -1;
+	fr->enc_padding = -1;
 	fr->framesize=0; 
 	fr->mean_frames = 0;
 	fr->mean_framesize = 0;
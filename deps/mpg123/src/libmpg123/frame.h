@@ -276,6 +276,8 @@ struct mpg123_handle_struct
 	off_t end_os;
 	off_t fullend_os; /* gapless_frames translated to output samples */
 #endif
+	int enc_delay; /* encoder delay and padding from the LAME tag, -1 if there is none */
+	int enc_padding;
 	unsigned int crc; /* Well, I need a safe 16bit type, actually. But wider doesn't hurt. */
 	struct reader *rd; /* pointer to the reading functions */
 	struct reader_data rdat; /* reader data and state info */
@@ -14,7 +14,7 @@
 static off_t sample_adjust(mpg123_handle *mh, off_t x)
 {
 	off_t s;
-	if(mh->p.flags & MPG123_GAPLESS)
+	if(mh->p.flags & MPG123_GAPLESS && mh->gapless_frames > 0)
 	{
 		/* It's a bit tricky to do this computation for the padding samples.
 		   They are not there on the outside. */
@@ -38,7 +38,7 @@ static off_t sample_adjust(mpg123_handle *mh, off_t x)
 static off_t sample_unadjust(mpg123_handle *mh, off_t x)
 {
 	off_t s;
-	if(mh->p.flags & MPG123_GAPLESS)
+	if(mh->p.flags & MPG123_GAPLESS && mh->gapless_frames > 0)
 	{
 		s = x + mh->begin_os;
 		/* There is a hole; we don't create sample positions in there.
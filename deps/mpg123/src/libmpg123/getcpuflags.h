@@ -12,6 +12,8 @@
 
 /* standard level flags part 1 (ECX)*/
 #define FLAG_SSE3      0x00000001
+#define FLAG_OSXSAVE   0x08000000
+#define FLAG_AVX       0x10000000
 
 /* standard level flags part 2 (EDX) */
 #define FLAG2_MMX       0x00800000
@@ -22,6 +24,10 @@
 #define XFLAG_MMX      0x00800000
 #define XFLAG_3DNOW    0x80000000
 #define XFLAG_3DNOWEXT 0x40000000
+/* structured extended level 7 (EBX) */
+#define SFLAG_AVX2     0x00000020
+/* XCR0: the OS saves the SSE and AVX registers */
+#define XCR0_SSE_AVX   0x00000006
 
 struct cpuflags
 {
@@ -29,6 +35,8 @@ struct cpuflags
 	unsigned int std;
 	unsigned int std2;
 	unsigned int ext;
+	unsigned int sext;
+	unsigned int xcr0;
 };
 
 unsigned int getcpuflags(struct cpuflags* cf);
@@ -43,5 +51,7 @@ unsigned int getcpuflags(struct cpuflags* cf);
 #define cpu_sse(s) (FLAG2_SSE & s.std2)
 #define cpu_sse2(s) (FLAG2_SSE2 & s.std2)
 #define cpu_sse3(s) (FLAG_SSE3 & s.std)
+#define cpu_avx(s) ((FLAG_AVX & s.std) && (FLAG_OSXSAVE & s.std) && (s.xcr0 & XCR0_SSE_AVX) == XCR0_SSE_AVX)
+#define cpu_avx2(s) (cpu_avx(s) && (SFLAG_AVX2 & s.sext))
 
 #endif
@@ -24,6 +24,8 @@
 #define synth_1to1_stereo_altivec INT123_synth_1to1_stereo_altivec
 #define synth_1to1_x86_64 INT123_synth_1to1_x86_64
 #define synth_1to1_stereo_x86_64 INT123_synth_1to1_stereo_x86_64
+#define synth_1to1_avx INT123_synth_1to1_avx
+#define synth_1to1_stereo_avx INT123_synth_1to1_stereo_avx
 #define synth_1to1_arm INT123_synth_1to1_arm
 #define synth_1to1_neon INT123_synth_1to1_neon
 #define synth_1to1_stereo_neon INT123_synth_1to1_stereo_neon
@@ -41,6 +43,7 @@
 #define synth_4to1_mono INT123_synth_4to1_mono
 #define synth_4to1_m2s INT123_synth_4to1_m2s
 #define synth_ntom INT123_synth_ntom
+#define synth_ntom_avx INT123_synth_ntom_avx
 #define synth_ntom_mono INT123_synth_ntom_mono
 #define synth_ntom_m2s INT123_synth_ntom_m2s
 #define synth_1to1_8bit INT123_synth_1to1_8bit
@@ -67,6 +70,8 @@
 #define synth_1to1_real_stereo_sse INT123_synth_1to1_real_stereo_sse
 #define synth_1to1_real_x86_64 INT123_synth_1to1_real_x86_64
 #define synth_1to1_real_stereo_x86_64 INT123_synth_1to1_real_stereo_x86_64
+#define synth_1to1_real_avx INT123_synth_1to1_real_avx
+#define synth_1to1_real_stereo_avx INT123_synth_1to1_real_stereo_avx
 #define synth_1to1_real_altivec INT123_synth_1to1_real_altivec
 #define synth_1to1_real_stereo_altivec INT123_synth_1to1_real_stereo_altivec
 #define synth_1to1_real_neon INT123_synth_1to1_real_neon
@@ -82,6 +87,7 @@
 #define synth_4to1_real_mono INT123_synth_4to1_real_mono
 #define synth_4to1_real_m2s INT123_synth_4to1_real_m2s
 #define synth_ntom_real INT123_synth_ntom_real
+#define synth_ntom_real_avx INT123_synth_ntom_real_avx
 #define synth_ntom_real_mono INT123_synth_ntom_real_mono
 #define synth_ntom_real_m2s INT123_synth_ntom_real_m2s
 #define synth_1to1_s32 INT123_synth_1to1_s32
@@ -90,6 +96,8 @@
 #define synth_1to1_s32_stereo_sse INT123_synth_1to1_s32_stereo_sse
 #define synth_1to1_s32_x86_64 INT123_synth_1to1_s32_x86_64
 #define synth_1to1_s32_stereo_x86_64 INT123_synth_1to1_s32_stereo_x86_64
+#define synth_1to1_s32_avx INT123_synth_1to1_s32_avx
+#define synth_1to1_s32_stereo_avx INT123_synth_1to1_s32_stereo_avx
 #define synth_1to1_s32_altivec INT123_synth_1to1_s32_altivec
 #define synth_1to1_s32_stereo_altivec INT123_synth_1to1_s32_stereo_altivec
 #define synth_1to1_s32_neon INT123_synth_1to1_s32_neon
@@ -105,6 +113,7 @@
 #define synth_4to1_s32_mono INT123_synth_4to1_s32_mono
 #define synth_4to1_s32_m2s INT123_synth_4to1_s32_m2s
 #define synth_ntom_s32 INT123_synth_ntom_s32
+#define synth_ntom_s32_avx INT123_synth_ntom_s32_avx
 #define synth_ntom_s32_mono INT123_synth_ntom_s32_mono
 #define synth_ntom_s32_m2s INT123_synth_ntom_s32_m2s
 #define dct64 INT123_dct64
@@ -220,6 +229,7 @@
 #define dct64_real_sse INT123_dct64_real_sse
 #define dct64_x86_64 INT123_dct64_x86_64
 #define dct64_real_x86_64 INT123_dct64_real_x86_64
+#define dct64_avx INT123_dct64_avx
 #define dct64_neon INT123_dct64_neon
 #define dct64_real_neon INT123_dct64_real_neon
 #define do_equalizer_3dnow INT123_do_equalizer_3dnow
@@ -24,6 +24,8 @@ static int grp_9tab[1024 * 3] = { 0, }; /* used: 729 */
 
 #if defined(REAL_IS_FIXED) && defined(PRECALC_TABLES)
 #include "l12_integer_tables.h"
+#elif defined(PRECALC_TABLES)
+#include "l12_float_tables.h"
 #else
 static const double mulmul[27] =
 {
@@ -77,7 +79,7 @@ void init_layer12_stuff(mpg123_handle *fr, real* (*init_table)(mpg123_handle *fr
 
 real* init_layer12_table(mpg123_handle *fr, real *table, int m)
 {
-#if defined(REAL_IS_FIXED) && defined(PRECALC_TABLES)
+#ifdef PRECALC_TABLES
 	int i;
 	for(i=0;i<63;i++)
 	*table++ = layer12_table[m][i];
@@ -93,6 +95,20 @@ real* init_layer12_table(mpg123_handle *fr, real *table, int m)
 #ifdef OPT_MMXORSSE
 real* init_layer12_table_mmx(mpg123_handle *fr, real *table, int m)
 {
+#ifdef PRECALC_TABLES
+	/* Scaling by a power of two gives the same value in double and in real. */
+	int i;
+	if(!fr->p.down_sample)
+	{
+		for(i=0;i<63;i++)
+		*table++ = 16384 * layer12_table[m][i];
+	}
+	else
+	{
+		for(i=0;i<63;i++)
+		*table++ = layer12_table[m][i];
+	}
+#else
 	int i,j;
 	if(!fr->p.down_sample) 
 	{
@@ -104,6 +120,7 @@ real* init_layer12_table_mmx(mpg123_handle *fr, real *table, int m)
 		for(j=3,i=0;i<63;i++,j--)
 		*table++ = DOUBLE_TO_REAL(mulmul[m] * pow(2.0,(double) j / 3.0));
 	}
+#endif
 	return table;
 }
 #endif
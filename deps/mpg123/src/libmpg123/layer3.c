@@ -27,6 +27,9 @@
 #ifdef REAL_IS_FIXED
 #define NEW_DCT9
 #include "l3_integer_tables.h"
+#elif defined(PRECALC_TABLES)
+#define NEW_DCT9
+#include "l3_float_tables.h"
 #else
 /* static one-time calculated tables... or so */
 static real ispow[8207];
@@ -158,14 +161,20 @@ static unsigned int i_slen2[256]; /* MPEG 2.0 slen for intensity stereo */
 #ifdef OPT_MMXORSSE
 real init_layer3_gainpow2_mmx(mpg123_handle *fr, int i)
 {
+#ifdef PRECALC_TABLES
+	/* Scaling by a power of two gives the same value in double and in real. */
+	if(!fr->p.down_sample) return 16384 * gainpow2[i+256];
+	else return gainpow2[i+256];
+#else
 	if(!fr->p.down_sample) return DOUBLE_TO_REAL(16384.0 * pow((double)2.0,-0.25 * (double) (i+210) ));
 	else return DOUBLE_TO_REAL(pow((double)2.0,-0.25 * (double) (i+210)));
+#endif
 }
 #endif
 
 real init_layer3_gainpow2(mpg123_handle *fr, int i)
 {
-#if defined(REAL_IS_FIXED) && defined(PRECALC_TABLES)
+#ifdef PRECALC_TABLES
 	return gainpow2[i+256];
 #else
 	return DOUBLE_TO_REAL_SCALE_LAYER3(pow((double)2.0,-0.25 * (double) (i+210)),i+256);
@@ -178,7 +187,7 @@ void init_layer3(void)
 {
 	int i,j,k,l;
 
-#if !defined(REAL_IS_FIXED) || !defined(PRECALC_TABLES)
+#ifndef PRECALC_TABLES
 	for(i=0;i<8207;i++)
 	ispow[i] = DOUBLE_TO_REAL_POW43(pow((double)i,(double)4.0/3.0));
 
@@ -257,6 +266,7 @@ void init_layer3(void)
 	}
 #endif
 
+#if !defined(PRECALC_TABLES) || defined(REAL_IS_FIXED)
 	for(j=0;j<4;j++)
 	{
 		const int len[4] = { 36,36,12,36 };
@@ -264,6 +274,7 @@ void init_layer3(void)
 
 		for(i=1;i<len[j];i+=2) win1[j][i] = - win[j][i];
 	}
+#endif
 
 	for(j=0;j<9;j++)
 	{
@@ -1358,7 +1369,7 @@ static void III_antialias(real xr[SBLIMIT][SSLIMIT],struct gr_info_s *gr_info)
 		for(sb=sblim; sb; sb--,xr1+=10)
 		{
 			int ss;
-			real *cs=aa_cs,*ca=aa_ca;
+			const real *cs=aa_cs,*ca=aa_ca;
 			real *xr2 = xr1;
 
 			for(ss=7;ss>=0;ss--)
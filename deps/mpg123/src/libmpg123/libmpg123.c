@@ -368,6 +368,15 @@ int attribute_align_arg mpg123_getstate(mpg123_handle *mh, enum mpg123_state key
 			ret = MPG123_ERR;
 #endif
 		break;
+		case MPG123_ENC_DELAY:
+			theval = mh->enc_delay;
+		break;
+		case MPG123_ENC_PADDING:
+			theval = mh->enc_padding;
+		break;
+		case MPG123_DEC_DELAY:
+			theval = mh->lay == 3 ? GAPLESS_DELAY : -1;
+		break;
 		default:
 			mh->err = MPG123_BAD_KEY;
 			ret = MPG123_ERR;
@@ -1064,6 +1073,17 @@ off_t attribute_align_arg mpg123_tell_stream(mpg123_handle *mh)
 	return mh->rd->tell(mh);
 }
 
+/*
+	Decoding resumes at frame fnum. Put the synth buffer offset where decoding from the
+	start would have it there (it steps back by one for every 32 samples), as the
+	decoders that sum the window in buffer order round a bit differently for each offset.
+	Like this, seeking gives the very samples of decoding straight through.
+*/
+static void seek_synth_offset(mpg123_handle *mh, off_t fnum)
+{
+	mh->bo = (int)((1 - fnum*(spf(mh)/32)) & 0xf);
+}
+
 static int do_the_seek(mpg123_handle *mh)
 {
 	int b;
@@ -1088,6 +1108,7 @@ static int do_the_seek(mpg123_handle *mh)
 
 	/* OK, real seeking follows... clear buffers and go for it. */
 	frame_buffers_reset(mh);
+	seek_synth_offset(mh, fnum);
 #ifndef NO_NTOM
 	if(mh->down_sample == 3)
 	{
@@ -1203,6 +1224,12 @@ off_t attribute_align_arg mpg123_feedseek(mpg123_handle *mh, off_t sampleoff, in
 	*input_offset = feed_set_pos(mh, frame_index_find(mh, SEEKFRAME(mh), &pos));
 	mh->num = pos-1; /* The next read frame will have num = pos. */
 	if(*input_offset < 0) return MPG123_ERR;
+	/* Like do_the_seek(): nothing of the frames decoded before may leak into the new position. */
+	frame_buffers_reset(mh);
+	seek_synth_offset(mh, SEEKFRAME(mh));
+#ifndef NO_NTOM
+	if(mh->down_sample == 3) ntom_set_ntom(mh, SEEKFRAME(mh));
+#endif
 
 feedseekend:
 	return mpg123_tell(mh);
@@ -235,6 +235,14 @@ static inline long scale_rounded(long x, int shift)
 # if (defined SIZEOF_INT32_T) && (SIZEOF_INT32_T != 4)
 #  error "Bad 32bit types!!!"
 # endif
+/*
+  floating-point decoders use tables that calctables.c calculates at build time, too
+  (l3_float_tables.h, l12_float_tables.h, dct64_float_tables.h);
+  define RUNTIME_TABLES to calculate them in mpg123_init() and for each handle instead
+*/
+# ifndef RUNTIME_TABLES
+#  define PRECALC_TABLES
+# endif
 #endif
 
 #ifndef DOUBLE_TO_REAL
@@ -17,7 +17,7 @@
 	It SUCKS having to define these names that way, but compile-time intialization of string arrays is a bitch.
 	GCC doesn't see constant stuff when it's wiggling in front of it!
 	Anyhow: Have a script for that:
-names="generic generic_dither i386 i486 i586 i586_dither MMX 3DNow 3DNowExt AltiVec SSE x86-64"
+names="generic generic_dither i386 i486 i586 i586_dither MMX 3DNow 3DNowExt AltiVec SSE x86-64 ARM NEON AVX"
 for i in $names; do echo "##define dn_${i/-/_} \"$i\""; done
 echo -n "static const char* decname[] =
 {
@@ -42,14 +42,15 @@ echo "
 #define dn_x86_64 "x86-64"
 #define dn_ARM "ARM"
 #define dn_NEON "NEON"
+#define dn_AVX "AVX"
 static const char* decname[] =
 {
 	"auto"
-	, dn_generic, dn_generic_dither, dn_i386, dn_i486, dn_i586, dn_i586_dither, dn_MMX, dn_3DNow, dn_3DNowExt, dn_AltiVec, dn_SSE, dn_x86_64, dn_ARM, dn_NEON
+	, dn_generic, dn_generic_dither, dn_i386, dn_i486, dn_i586, dn_i586_dither, dn_MMX, dn_3DNow, dn_3DNowExt, dn_AltiVec, dn_SSE, dn_x86_64, dn_ARM, dn_NEON, dn_AVX
 	, "nodec"
 };
 
-#if (defined OPT_X86) && (defined OPT_MULTI)
+#if (defined OPT_X86 || defined OPT_AVX) && (defined OPT_MULTI)
 #include "getcpuflags.h"
 static struct cpuflags cpu_flags;
 #else
@@ -64,6 +65,7 @@ static struct cpuflags cpu_flags;
 #define cpu_sse(s)      1
 #define cpu_sse2(s)     1
 #define cpu_sse3(s)     1
+#define cpu_avx2(s)     1
 #endif
 
 /* Ugly macros to build conditional synth function array values. */
@@ -220,6 +222,12 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_ALTIVEC
 	else if(basic_synth == synth_1to1_altivec) type = altivec;
 #endif
+#ifdef OPT_AVX
+	else if(basic_synth == synth_1to1_avx) type = avx;
+#ifndef NO_NTOM
+	else if(basic_synth == synth_ntom_avx) type = avx;
+#endif
+#endif
 #ifdef OPT_X86_64
 	else if(basic_synth == synth_1to1_x86_64) type = x86_64;
 #endif
@@ -247,6 +255,12 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_SSE
 	else if(basic_synth == synth_1to1_real_sse) type = sse;
 #endif
+#ifdef OPT_AVX
+	else if(basic_synth == synth_1to1_real_avx) type = avx;
+#ifndef NO_NTOM
+	else if(basic_synth == synth_ntom_real_avx) type = avx;
+#endif
+#endif
 #ifdef OPT_X86_64
 	else if(basic_synth == synth_1to1_real_x86_64) type = x86_64;
 #endif
@@ -263,6 +277,12 @@ static int find_dectype(mpg123_handle *fr)
 #ifdef OPT_SSE
 	else if(basic_synth == synth_1to1_s32_sse) type = sse;
 #endif
+#ifdef OPT_AVX
+	else if(basic_synth == synth_1to1_s32_avx) type = avx;
+#ifndef NO_NTOM
+	else if(basic_synth == synth_ntom_s32_avx) type = avx;
+#endif
+#endif
 #ifdef OPT_X86_64
 	else if(basic_synth == synth_1to1_s32_x86_64) type = x86_64;
 #endif
@@ -464,6 +484,37 @@ int frame_cpu_opt(mpg123_handle *fr, const char* cpu)
 #endif
 
 	fr->cpu_opts.type = nodec;
+	/* AVX2 beats all the older x86 decoders, on ia32 as on x86-64. */
+#ifdef OPT_AVX
+	if(!done && (auto_choose || want_dec == avx) && cpu_avx2(cpu_flags))
+	{
+		chosen = "AVX2";
+		fr->cpu_opts.type = avx;
+#		ifndef NO_16BIT
+		fr->synths.plain[r_1to1][f_16] = synth_1to1_avx;
+		fr->synths.stereo[r_1to1][f_16] = synth_1to1_stereo_avx;
+#		ifndef NO_NTOM
+		fr->synths.plain[r_ntom][f_16] = synth_ntom_avx;
+#		endif
+#		endif
+#		ifndef NO_REAL
+		fr->synths.plain[r_1to1][f_real] = synth_1to1_real_avx;
+		fr->synths.stereo[r_1to1][f_real] = synth_1to1_real_stereo_avx;
+#		ifndef NO_NTOM
+		fr->synths.plain[r_ntom][f_real] = synth_ntom_real_avx;
+#		endif
+#		endif
+#		ifndef NO_32BIT
+		fr->synths.plain[r_1to1][f_32] = synth_1to1_s32_avx;
+		fr->synths.stereo[r_1to1][f_32] = synth_1to1_s32_stereo_avx;
+#		ifndef NO_NTOM
+		fr->synths.plain[r_ntom][f_32] = synth_ntom_s32_avx;
+#		endif
+#		endif
+		done = 1;
+	}
+#endif
+
 	/* covers any i386+ cpu; they actually differ only in the synth_1to1 function, mostly... */
 #ifdef OPT_X86
 
@@ -815,6 +866,9 @@ static const char *mpg123_supported_decoder_list[] =
 	#ifdef OPT_ALTIVEC
 	NULL,
 	#endif
+	#ifdef OPT_AVX
+	NULL,
+	#endif
 	#ifdef OPT_X86_64
 	NULL,
 	#endif
@@ -866,6 +920,9 @@ static const char *mpg123_decoder_list[] =
 	#ifdef OPT_ALTIVEC
 	dn_AltiVec,
 	#endif
+	#ifdef OPT_AVX
+	dn_AVX,
+	#endif
 	#ifdef OPT_X86_64
 	dn_x86_64,
 	#endif
@@ -891,8 +948,13 @@ void check_decoders(void )
 	return;
 #else
 	const char **d = mpg123_supported_decoder_list;
-#ifdef OPT_X86
+#if (defined OPT_X86 || defined OPT_AVX)
 	getcpuflags(&cpu_flags);
+#endif
+#ifdef OPT_AVX
+	if(cpu_avx2(cpu_flags)) *(d++) = decname[avx];
+#endif
+#ifdef OPT_X86
 	if(cpu_i586(cpu_flags))
 	{
 		/* not yet: if(cpu_sse2(cpu_flags)) printf(" SSE2");
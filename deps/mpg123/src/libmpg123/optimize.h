@@ -19,6 +19,7 @@
 	OPT_3DNOWEXT (AMD 3DNow! extended, generally Athlon, compatibles...)
 	OPT_ALTIVEC (Motorola/IBM PPC with AltiVec under MacOSX)
 	OPT_X86_64 (x86-64 / AMD64 / Intel 64)
+	OPT_AVX (x86 and x86-64 with AVX2, C intrinsics; checked at runtime in OPT_MULTI)
 
 	or you define OPT_MULTI and give a combination which makes sense (do not include i486, do not mix altivec and x86).
 
@@ -38,7 +39,7 @@ enum optdec
 	autodec=0, generic, generic_dither, idrei,
 	ivier, ifuenf, ifuenf_dither, mmx,
 	dreidnow, dreidnowext, altivec, sse, x86_64, arm, neon,
-	nodec
+	avx, nodec
 };
 enum optcla { nocla=0, normal, mmxsse };
 
@@ -68,7 +69,7 @@ enum optcla decclass(const enum optdec);
 #if (defined OPT_I486)  || (defined OPT_I586) || (defined OPT_I586_DITHER) \
  || (defined OPT_MMX)   || (defined OPT_SSE)  || (defined_OPT_ALTIVEC) \
  || (defined OPT_3DNOW) || (defined OPT_3DNOWEXT) || (defined OPT_X86_64) \
- || (defined OPT_NEON) || (defined OPT_GENERIC_DITHER)
+ || (defined OPT_NEON) || (defined OPT_GENERIC_DITHER) || (defined OPT_AVX)
 #error "Bad decoder choice together with fixed point math!"
 #endif
 #endif
@@ -179,6 +180,13 @@ extern const int costab_mmxsse[];
 #endif
 #endif
 
+/* The AVX decoder uses the normal float tables (class normal), with the window extended like for x86-64 float. */
+#ifdef OPT_AVX
+#ifndef OPT_MULTI
+#	define defopt avx
+#endif
+#endif
+
 #ifdef OPT_ARM
 #ifndef OPT_MULTI
 #	define defopt arm
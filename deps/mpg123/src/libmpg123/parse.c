@@ -362,6 +362,8 @@ static int check_lame_tag(mpg123_handle *fr)
 					fprintf(stderr, "Note: Encoder delay = %i; padding = %i\n",
 					        ((((int) fr->bsbuf[lame_offset]) << 4) | (((int) fr->bsbuf[lame_offset+1]) >> 4)),
 					        (((((int) fr->bsbuf[lame_offset+1]) << 8) | (((int) fr->bsbuf[lame_offset+2]))) & 0xfff) );
+					fr->enc_delay = (((int) fr->bsbuf[lame_offset]) << 4) | (((int) fr->bsbuf[lame_offset+1]) >> 4);
+					fr->enc_padding = ((((int) fr->bsbuf[lame_offset+1]) << 8) | (((int) fr->bsbuf[lame_offset+2]))) & 0xfff;
 					#ifdef GAPLESS
 					if(fr->p.flags & MPG123_GAPLESS)
 					{
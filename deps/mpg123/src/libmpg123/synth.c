@@ -802,10 +802,12 @@ int synth_1to1_stereo_neon(real *bandPtr_l,real *bandPtr_r, mpg123_handle *fr)
 
 /* These are all in one header, there's no flexibility to gain. */
 #define SYNTH_NAME       synth_ntom
+#define PLAIN_NAME       fr->synths.plain[r_ntom][f_16]
 #define MONO_NAME        synth_ntom_mono
 #define MONO2STEREO_NAME synth_ntom_m2s
 #include "synth_ntom.h"
 #undef SYNTH_NAME
+#undef PLAIN_NAME
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
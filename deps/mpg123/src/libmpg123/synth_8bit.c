@@ -129,10 +129,12 @@
 
 /* These are all in one header, there's no flexibility to gain. */
 #define SYNTH_NAME       synth_ntom_8bit
+#define PLAIN_NAME       fr->synths.plain[r_ntom][f_8]
 #define MONO_NAME        synth_ntom_8bit_mono
 #define MONO2STEREO_NAME synth_ntom_8bit_m2s
 #include "synth_ntom.h"
 #undef SYNTH_NAME
+#undef PLAIN_NAME
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
@@ -0,0 +1,372 @@
+/*
+	synth_avx.c: The synth functions for AVX2, producing signed short, float and signed 32bit.
+
+	copyright 1995-2013 by the mpg123 project - free software under the terms of the LGPL 2.1
+	see COPYING and AUTHORS files in distribution or http://mpg123.org
+	initially written by Michael Hipp, vectorized from synth.h
+*/
+
+/*
+	Each of the 32 output samples of a block is the sum of 16 products of window and DCT
+	output, as in synth.h. Here one vector holds the products of one sample (taps k and k+8
+	in one lane), and the horizontal sums of eight samples are taken together.
+	The window is extended like for the float SSE decoders (see make_decode_tables()), so that
+	the second half of the block reads it forward, too. The sums come out in a different order
+	than those of synth.h, so the output may differ from the generic decoder in the last bit.
+	The DCT is dct64_avx(), which is bit identical to dct64().
+	The NtoM synths take all 32 sums like that and pick (or repeat) them as synth_ntom.h does.
+*/
+
+#include "mpg123lib_intern.h"
+
+#include <immintrin.h>
+
+#define AVX_TARGET __attribute__((target("avx2")))
+
+#ifdef ACCURATE_ROUNDING
+#define AVX_TO_INT(x) _mm256_cvtps_epi32(x)
+#else
+#define AVX_TO_INT(x) _mm256_cvttps_epi32(x)
+#endif
+
+/* The part before the window: equalizer, next DCT buffer and the DCT itself. */
+static AVX_TARGET real *synth_dct_avx(real *bandPtr, int channel, mpg123_handle *fr, int *bo1)
+{
+	real **buf = fr->real_buffs[channel];
+
+	if(fr->have_eq_settings) do_equalizer(bandPtr,channel,fr->equalizer);
+
+	if(!channel)
+	{
+		fr->bo--;
+		fr->bo &= 0xf;
+	}
+
+	if(fr->bo & 0x1)
+	{
+		*bo1 = fr->bo;
+		dct64_avx(buf[1]+((fr->bo+1)&0xf),buf[0]+fr->bo,bandPtr);
+		return buf[0];
+	}
+	else
+	{
+		*bo1 = fr->bo+1;
+		dct64_avx(buf[0]+fr->bo,buf[1]+fr->bo+1,bandPtr);
+		return buf[1];
+	}
+}
+
+/* The 16 products of one sample, the odd ones negated by sign. */
+static inline AVX_TARGET __m256 synth_row_avx(const real *window, const real *b0, __m256 sign)
+{
+	__m256 const p0 = _mm256_mul_ps(_mm256_loadu_ps(window), _mm256_loadu_ps(b0));
+	__m256 const p1 = _mm256_mul_ps(_mm256_loadu_ps(window+8), _mm256_loadu_ps(b0+8));
+	return _mm256_xor_ps(_mm256_add_ps(p0, p1), sign);
+}
+
+/* The sums of eight rows of products, in the lanes of one vector. */
+static inline AVX_TARGET __m256 synth_hsum_avx(const __m256 *row)
+{
+	__m256 const a = _mm256_hadd_ps(_mm256_hadd_ps(row[0], row[1]), _mm256_hadd_ps(row[2], row[3]));
+	__m256 const b = _mm256_hadd_ps(_mm256_hadd_ps(row[4], row[5]), _mm256_hadd_ps(row[6], row[7]));
+	return _mm256_add_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31));
+}
+
+/*
+	The 32 samples of one channel into sum[0..3], in the scale of 16bit output.
+	Samples 0 to 15 are window[k] * b0[k] with alternating signs, and so is 16, as the odd
+	taps of its part of the window are zero. Samples 17 to 31 are the plain sums from the
+	mirrored window that make_decode_tables() appends after 512+32, with b0 going backwards.
+*/
+static AVX_TARGET void synth_sums_avx(const real *decwin, const real *b0, int bo1, __m256 *sum)
+{
+	__m256 const alt = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000, 0, 0x80000000, 0, 0x80000000));
+	__m256 const plain = _mm256_setzero_ps();
+	const real *window = decwin + 16 - bo1;
+	const real *mirror = decwin + 512 + 32 + 16 - bo1;
+	__m256 row[8];
+	int i, j;
+
+	for(i=0; i<2; i++)
+	{
+		for(j=0; j<8; j++)
+		row[j] = synth_row_avx(window + 0x20*(8*i+j), b0 + 0x10*(8*i+j), alt);
+		sum[i] = synth_hsum_avx(row);
+	}
+	row[0] = synth_row_avx(window + 0x200, b0 + 0x100, alt);
+	for(j=1; j<16; j++)
+	{
+		row[j&7] = synth_row_avx(mirror + 0x20*(j-1), b0 + 0xf0 - 0x10*(j-1), plain);
+		if((j&7) == 7) sum[2 + (j>>3)] = synth_hsum_avx(row);
+	}
+}
+
+/* Clipped to 16bit, in the low half of each 32bit lane; the clipped samples are counted. */
+static inline AVX_TARGET __m256i synth_short_avx(__m256 x, int *clip)
+{
+	__m256 const max = _mm256_set1_ps(32767.0f);
+	__m256 const min = _mm256_set1_ps(-32768.0f);
+	int over = _mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(x, max, _CMP_GT_OQ), _mm256_cmp_ps(x, min, _CMP_LT_OQ)));
+
+	for(; over; over &= over-1) (*clip)++;
+	return AVX_TO_INT(_mm256_min_ps(_mm256_max_ps(x, min), max));
+}
+
+/* Scaled and clipped to 32bit, as WRITE_S32_SAMPLE. */
+static inline AVX_TARGET __m256 synth_s32_avx(__m256 x, int *clip)
+{
+	__m256 const max = _mm256_set1_ps(2147483648.0f);
+	__m256 const min = _mm256_set1_ps(-2147483648.0f);
+	__m256 const tmp = _mm256_mul_ps(x, _mm256_set1_ps(S32_RESCALE));
+	__m256 const high = _mm256_cmp_ps(tmp, max, _CMP_GE_OQ);
+	int over = _mm256_movemask_ps(_mm256_or_ps(high, _mm256_cmp_ps(tmp, min, _CMP_LT_OQ)));
+
+	for(; over; over &= over-1) (*clip)++;
+	/* Too low converts to 0x80000000 anyway. */
+	return _mm256_blendv_ps(_mm256_castsi256_ps(AVX_TO_INT(tmp)), _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)), high);
+}
+
+/* Eight 32bit samples of one channel into the interleaved stereo output at out. */
+static inline AVX_TARGET void synth_store_channel_avx(float *out, __m256 x, int channel)
+{
+	__m256 const lo = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+	__m256 const hi = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7));
+
+	if(channel)
+	{
+		_mm256_storeu_ps(out,   _mm256_blend_ps(_mm256_loadu_ps(out),   lo, 0xaa));
+		_mm256_storeu_ps(out+8, _mm256_blend_ps(_mm256_loadu_ps(out+8), hi, 0xaa));
+	}
+	else
+	{
+		_mm256_storeu_ps(out,   _mm256_blend_ps(_mm256_loadu_ps(out),   lo, 0x55));
+		_mm256_storeu_ps(out+8, _mm256_blend_ps(_mm256_loadu_ps(out+8), hi, 0x55));
+	}
+}
+
+/* Eight 32bit samples of both channels, interleaved. */
+static inline AVX_TARGET void synth_store_stereo_avx(float *out, __m256 l, __m256 r)
+{
+	__m256 const lo = _mm256_unpacklo_ps(l, r);
+	__m256 const hi = _mm256_unpackhi_ps(l, r);
+
+	_mm256_storeu_ps(out,   _mm256_permute2f128_ps(lo, hi, 0x20));
+	_mm256_storeu_ps(out+8, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+#ifndef NO_16BIT
+int AVX_TARGET synth_1to1_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
+	__m256 sum[4];
+	int bo1, i;
+	int clip = 0;
+	real *b0 = synth_dct_avx(bandPtr, channel, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0, bo1, sum);
+	for(i=0; i<4; i++)
+	{
+		__m256i *out = (__m256i *) (samples + 0x10*i);
+		__m256i const x = synth_short_avx(sum[i], &clip);
+		if(channel)
+		_mm256_storeu_si256(out, _mm256_blend_epi16(_mm256_loadu_si256(out), _mm256_slli_epi32(x, 16), 0xaa));
+		else
+		_mm256_storeu_si256(out, _mm256_blend_epi16(_mm256_loadu_si256(out), x, 0x55));
+	}
+
+	if(final) fr->buffer.fill += 128;
+
+	return clip;
+}
+
+int AVX_TARGET synth_1to1_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	short *samples = (short *) (fr->buffer.data+fr->buffer.fill);
+	__m256 suml[4], sumr[4];
+	int bo1, i;
+	int clip = 0;
+	real *b0l = synth_dct_avx(bandPtr_l, 0, fr, &bo1);
+	real *b0r = synth_dct_avx(bandPtr_r, 1, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0l, bo1, suml);
+	synth_sums_avx(fr->decwin, b0r, bo1, sumr);
+	for(i=0; i<4; i++)
+	{
+		__m256i const l = synth_short_avx(suml[i], &clip);
+		__m256i const r = synth_short_avx(sumr[i], &clip);
+		_mm256_storeu_si256((__m256i *) (samples + 0x10*i),
+			_mm256_or_si256(_mm256_and_si256(l, _mm256_set1_epi32(0xffff)), _mm256_slli_epi32(r, 16)));
+	}
+
+	fr->buffer.fill += 128;
+
+	return clip;
+}
+#endif
+
+#ifndef NO_REAL
+int AVX_TARGET synth_1to1_real_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill);
+	__m256 const scale = _mm256_set1_ps((real)1./SHORT_SCALE);
+	__m256 sum[4];
+	int bo1, i;
+	real *b0 = synth_dct_avx(bandPtr, channel, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0, bo1, sum);
+	for(i=0; i<4; i++)
+	synth_store_channel_avx(samples + 0x10*i, _mm256_mul_ps(scale, sum[i]), channel);
+
+	if(final) fr->buffer.fill += 256;
+
+	return 0;
+}
+
+int AVX_TARGET synth_1to1_real_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill);
+	__m256 const scale = _mm256_set1_ps((real)1./SHORT_SCALE);
+	__m256 suml[4], sumr[4];
+	int bo1, i;
+	real *b0l = synth_dct_avx(bandPtr_l, 0, fr, &bo1);
+	real *b0r = synth_dct_avx(bandPtr_r, 1, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0l, bo1, suml);
+	synth_sums_avx(fr->decwin, b0r, bo1, sumr);
+	for(i=0; i<4; i++)
+	synth_store_stereo_avx(samples + 0x10*i, _mm256_mul_ps(scale, suml[i]), _mm256_mul_ps(scale, sumr[i]));
+
+	fr->buffer.fill += 256;
+
+	return 0;
+}
+#endif
+
+#ifndef NO_32BIT
+int AVX_TARGET synth_1to1_s32_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	float *samples = (float *) (fr->buffer.data+fr->buffer.fill);
+	__m256 sum[4];
+	int bo1, i;
+	int clip = 0;
+	real *b0 = synth_dct_avx(bandPtr, channel, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0, bo1, sum);
+	for(i=0; i<4; i++)
+	synth_store_channel_avx(samples + 0x10*i, synth_s32_avx(sum[i], &clip), channel);
+
+	if(final) fr->buffer.fill += 256;
+
+	return clip;
+}
+
+int AVX_TARGET synth_1to1_s32_stereo_avx(real *bandPtr_l, real *bandPtr_r, mpg123_handle *fr)
+{
+	float *samples = (float *) (fr->buffer.data+fr->buffer.fill);
+	__m256 suml[4], sumr[4];
+	int bo1, i;
+	int clip = 0;
+	real *b0l = synth_dct_avx(bandPtr_l, 0, fr, &bo1);
+	real *b0r = synth_dct_avx(bandPtr_r, 1, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0l, bo1, suml);
+	synth_sums_avx(fr->decwin, b0r, bo1, sumr);
+	for(i=0; i<4; i++)
+	{
+		__m256 const l = synth_s32_avx(suml[i], &clip);
+		__m256 const r = synth_s32_avx(sumr[i], &clip);
+		synth_store_stereo_avx(samples + 0x10*i, l, r);
+	}
+
+	fr->buffer.fill += 256;
+
+	return clip;
+}
+#endif
+
+#ifndef NO_NTOM
+/*
+	All 32 sums of the block, and the ntom value to start from.
+	Computing and converting the sums that NtoM skips is still cheaper than the scalar loop of
+	synth_ntom.h, down to the lowest rates that synth_ntom_set_step() allows. The clipped sums
+	are counted once, as for 1to1, not once for every time NtoM writes them.
+*/
+static AVX_TARGET unsigned long synth_ntom_sums_avx(real *bandPtr, int channel, mpg123_handle *fr, __m256 *sum)
+{
+	int bo1;
+	real *b0 = synth_dct_avx(bandPtr, channel, fr, &bo1);
+
+	synth_sums_avx(fr->decwin, b0, bo1, sum);
+
+	return channel ? fr->ntom_val[1] : (fr->ntom_val[1] = fr->ntom_val[0]);
+}
+
+#ifndef NO_16BIT
+int AVX_TARGET synth_ntom_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	short *samples = (short *) (fr->buffer.data+fr->buffer.fill) + channel;
+	__m256 sum[4];
+	int32_t val[32];
+	int clip = 0;
+	int i;
+	unsigned long ntom = synth_ntom_sums_avx(bandPtr, channel, fr, sum);
+
+	for(i=0; i<4; i++)
+	_mm256_storeu_si256((__m256i *) (val + 8*i), synth_short_avx(sum[i], &clip));
+	for(i=0; i<32; i++)
+	for(ntom += fr->ntom_step; ntom >= NTOM_MUL; ntom -= NTOM_MUL, samples += 2)
+	*samples = val[i];
+
+	fr->ntom_val[channel] = ntom;
+	if(final) fr->buffer.fill = (unsigned char *) (samples - channel) - fr->buffer.data;
+
+	return clip;
+}
+#endif
+
+#ifndef NO_REAL
+int AVX_TARGET synth_ntom_real_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	real *samples = (real *) (fr->buffer.data+fr->buffer.fill) + channel;
+	__m256 const scale = _mm256_set1_ps((real)1./SHORT_SCALE);
+	__m256 sum[4];
+	real val[32];
+	int i;
+	unsigned long ntom = synth_ntom_sums_avx(bandPtr, channel, fr, sum);
+
+	for(i=0; i<4; i++)
+	_mm256_storeu_ps(val + 8*i, _mm256_mul_ps(scale, sum[i]));
+	for(i=0; i<32; i++)
+	for(ntom += fr->ntom_step; ntom >= NTOM_MUL; ntom -= NTOM_MUL, samples += 2)
+	*samples = val[i];
+
+	fr->ntom_val[channel] = ntom;
+	if(final) fr->buffer.fill = (unsigned char *) (samples - channel) - fr->buffer.data;
+
+	return 0;
+}
+#endif
+
+#ifndef NO_32BIT
+int AVX_TARGET synth_ntom_s32_avx(real *bandPtr, int channel, mpg123_handle *fr, int final)
+{
+	int32_t *samples = (int32_t *) (fr->buffer.data+fr->buffer.fill) + channel;
+	__m256 sum[4];
+	int32_t val[32];
+	int clip = 0;
+	int i;
+	unsigned long ntom = synth_ntom_sums_avx(bandPtr, channel, fr, sum);
+
+	for(i=0; i<4; i++)
+	_mm256_storeu_si256((__m256i *) (val + 8*i), _mm256_castps_si256(synth_s32_avx(sum[i], &clip)));
+	for(i=0; i<32; i++)
+	for(ntom += fr->ntom_step; ntom >= NTOM_MUL; ntom -= NTOM_MUL, samples += 2)
+	*samples = val[i];
+
+	fr->ntom_val[channel] = ntom;
+	if(final) fr->buffer.fill = (unsigned char *) (samples - channel) - fr->buffer.data;
+
+	return clip;
+}
+#endif
+#endif
@@ -3,6 +3,7 @@
 
 	This header is used multiple times to create different variants of this function.
 	Hint: MONO_NAME, MONO2STEREO_NAME, SYNTH_NAME and SAMPLE_T as well as WRITE_SAMPLE do vary.
+	The mono functions call PLAIN_NAME, so that they wrap a vectorized ntom synth, too.
 
 	copyright 1995-2008 by the mpg123 project - free software under the terms of the LGPL 2.1
 	see COPYING and AUTHORS files in distribution or http://mpg123.org
@@ -28,7 +29,7 @@ int MONO_NAME(real *bandPtr, mpg123_handle *fr)
 	unsigned char *samples = fr->buffer.data;
 	fr->buffer.data = (unsigned char*) samples_tmp;
 	fr->buffer.fill = 0;
-	ret = SYNTH_NAME(bandPtr, 0, fr, 1);
+	ret = PLAIN_NAME(bandPtr, 0, fr, 1);
 	fr->buffer.data = samples;
 
 	samples += pnt;
@@ -51,7 +52,7 @@ int MONO2STEREO_NAME(real *bandPtr, mpg123_handle *fr)
 	size_t pnt1 = fr->buffer.fill;
 	unsigned char *samples = fr->buffer.data + pnt1;
 
-	ret = SYNTH_NAME(bandPtr, 0, fr, 1);
+	ret = PLAIN_NAME(bandPtr, 0, fr, 1);
 
 	for(i=0;i<((fr->buffer.fill-pnt1)/(2*sizeof(SAMPLE_T)));i++)
 	{
@@ -389,10 +389,12 @@ int synth_1to1_real_stereo_neon(real *bandPtr_l, real *bandPtr_r, mpg123_handle
 
 /* These are all in one header, there's no flexibility to gain. */
 #define SYNTH_NAME       synth_ntom_real
+#define PLAIN_NAME       fr->synths.plain[r_ntom][f_real]
 #define MONO_NAME        synth_ntom_real_mono
 #define MONO2STEREO_NAME synth_ntom_real_m2s
 #include "synth_ntom.h"
 #undef SYNTH_NAME
+#undef PLAIN_NAME
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
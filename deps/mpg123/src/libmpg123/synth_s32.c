@@ -396,10 +396,12 @@ int synth_1to1_s32_stereo_neon(real *bandPtr_l, real *bandPtr_r, mpg123_handle *
 
 /* These are all in one header, there's no flexibility to gain. */
 #define SYNTH_NAME       synth_ntom_s32
+#define PLAIN_NAME       fr->synths.plain[r_ntom][f_32]
 #define MONO_NAME        synth_ntom_s32_mono
 #define MONO2STEREO_NAME synth_ntom_s32_m2s
 #include "synth_ntom.h"
 #undef SYNTH_NAME
+#undef PLAIN_NAME
 #undef MONO_NAME
 #undef MONO2STEREO_NAME
 
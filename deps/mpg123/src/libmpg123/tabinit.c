@@ -10,7 +10,9 @@
 #include "debug.h"
 
 /* That altivec alignment part here should not hurt generic code, I hope */
-#ifdef OPT_ALTIVEC
+#if defined(PRECALC_TABLES) && !defined(REAL_IS_FIXED)
+#include "dct64_float_tables.h"
+#elif defined(OPT_ALTIVEC)
 static ALIGNED(16) real cos64[16];
 static ALIGNED(16) real cos32[8];
 static ALIGNED(16) real cos16[4];
@@ -75,7 +77,7 @@ static long intwinbase[] = {
 
 void prepare_decode_tables()
 {
-#if !defined(REAL_IS_FIXED) || !defined(PRECALC_TABLES)
+#ifndef PRECALC_TABLES
   int i,k,kr,divv;
   real *costab;
 
@@ -210,9 +212,9 @@ void make_decode_tables(mpg123_handle *fr)
 		scaleval = - scaleval;
 #endif
 	}
-#if defined(OPT_X86_64) || defined(OPT_ALTIVEC) || defined(OPT_SSE) || defined(OPT_ARM) || defined(OPT_NEON)
-	if(fr->cpu_opts.type == x86_64 || fr->cpu_opts.type == altivec || fr->cpu_opts.type == sse || fr->cpu_opts.type == arm || fr->cpu_opts.type == neon)
-	{ /* for float SSE / AltiVec / ARM decoder */
+#if defined(OPT_X86_64) || defined(OPT_ALTIVEC) || defined(OPT_SSE) || defined(OPT_ARM) || defined(OPT_NEON) || defined(OPT_AVX)
+	if(fr->cpu_opts.type == x86_64 || fr->cpu_opts.type == altivec || fr->cpu_opts.type == sse || fr->cpu_opts.type == arm || fr->cpu_opts.type == neon || fr->cpu_opts.type == avx)
+	{ /* for float SSE / AltiVec / ARM / AVX decoder */
 		for(i=512; i<512+32; i++)
 		{
 			fr->decwin[i] = (i&1) ? fr->decwin[i] : 0;
@@ -2,8 +2,32 @@ declare module 'lame' {
     import { WriteStream } from 'fs';
     import { DuplexOptions } from 'stream';
 
-    export interface DecoderOptions extends DuplexOptions {
-        readonly decoder: string;
+    export interface DecoderOptions extends Omit<DuplexOptions, 'encoding'> {
+        readonly decoder?: string;
+        readonly zeroCopy?: boolean;
+        readonly rate?: number;
+        readonly channels?: 1 | 2;
+        readonly encoding?: 's16' | 's32' | 'f32';
+        readonly typedArray?: boolean;
+        readonly gapless?: boolean;
+        readonly index?: FrameIndex | Buffer;
+        readonly preframes?: number;
+        readonly reuse?: boolean;
+    }
+
+    export interface FrameIndex {
+        readonly step: number;
+        readonly offsets: number[];
+        readonly frames?: number;
+        readonly spf?: number;
+        readonly sampleRate?: number;
+        readonly channels?: number;
+        readonly samples?: number;
+        readonly encoderDelay?: number | null;
+        readonly encoderPadding?: number | null;
+        readonly fileSize?: number;
+        readonly audioStart?: number;
+        readonly audioEnd?: number;
     }
 
     export interface EncoderOptions extends DuplexOptions {
@@ -12,6 +36,12 @@ declare module 'lame' {
         readonly bitDepth?: number;
         readonly channels?: number;
         readonly sampleRate?: number;
+        readonly scratch?: boolean | number;
+        readonly reuse?: boolean;
+        readonly planar?: boolean;
+        readonly gapless?: boolean;
+        readonly outSampleRate?: number;
+        readonly resampleQuality?: number;
     }
 
     /**
@@ -22,6 +52,32 @@ declare module 'lame' {
      */
     export function Decoder(opts?: DecoderOptions): WriteStream;
 
+    /**
+     * Serializes a frame index from `Decoder.scan()` into a sidecar file.
+     */
+    export function writeIndex(index: FrameIndex): Buffer;
+
+    /**
+     * Parses a sidecar file back into a frame index.
+     */
+    export function readIndex(sidecar: Buffer): FrameIndex;
+
+    export namespace Decoder {
+        /**
+         * Parses every frame of an MP3 file and calls back with its frame
+         * index, for the `index` option.
+         */
+        function scan(mp3: Buffer, opts: DecoderOptions | null,
+            callback: (err: Error | null, index?: FrameIndex) => void): void;
+        function scan(mp3: Buffer,
+            callback: (err: Error | null, index?: FrameIndex) => void): void;
+        /**
+         * The idle mpg123 handles of the Decoders with `reuse` set, keyed by
+         * their options.
+         */
+        const handles: HandlePool;
+    }
+
     /**
      * The `Encoder` accepts raw PCM data and outputs an MP3 file.
      * 
@@ -30,6 +86,120 @@ declare module 'lame' {
      */
     export function Encoder(opts?: EncoderOptions): WriteStream;
 
+    export interface HandlePoolStats {
+        readonly hits: number;
+        readonly misses: number;
+        readonly idle: number;
+        readonly max: number;
+        readonly idleTimeout: number;
+    }
+
+    export interface HandlePool {
+        /** The most idle handles kept, of all the configurations together. */
+        max: number;
+        /** Milliseconds after which an idle handle is freed, 0 for never. */
+        idleTimeout: number;
+        /** Frees all the idle handles. */
+        clear(): void;
+        stats(): HandlePoolStats;
+    }
+
+    export namespace Encoder {
+        /**
+         * The idle lame encoders of the Encoders with `reuse` set, keyed by
+         * their options.
+         */
+        const handles: HandlePool;
+    }
+
+    /**
+     * Encodes `count` streams of the same options side by side, a chunk of
+     * each at a time, as one pool job per `encode()`. Other PCM formats
+     * than 16-bit and 32-bit float throw.
+     */
+    export class EncoderGroup {
+        constructor(opts: EncoderOptions, count: number);
+        readonly count: number;
+        /** Encodes `chunks[i]` (or nothing for `null`) with the i'th encoder. */
+        encode(chunks: Array<Buffer | ArrayBufferView | null>,
+            callback: (err: Error | null, mp3s?: Buffer[]) => void): void;
+        /** Flushes and closes every encoder. */
+        end(callback: (err: Error | null, mp3s?: Buffer[],
+            tags?: Array<Buffer | null>) => void): void;
+    }
+
+    export interface ParallelEncoderOptions extends EncoderOptions {
+        readonly segments?: number;
+    }
+
+    /**
+     * Encodes a Buffer of PCM data into an MP3 file, split into segments that
+     * are encoded in parallel on the audio worker pool. With resampling there
+     * is only one segment.
+     *
+     * @param pcm Raw PCM data.
+     * @param opts Configurations.
+     * @param callback Called with the complete MP3 file.
+     */
+    export function encodeParallel(pcm: Buffer, opts: ParallelEncoderOptions,
+        callback: (err: Error | null, mp3?: Buffer) => void): void;
+
+    export interface ParallelDecoderOptions {
+        readonly decoder?: string;
+        readonly ranges?: number;
+        readonly preframes?: number;
+    }
+
+    /**
+     * Decodes a whole MP3 file into PCM data, split into ranges of frames
+     * that are decoded in parallel on the audio worker pool.
+     *
+     * @param mp3 A complete MP3 file.
+     * @param opts Configurations.
+     * @param callback Called with the PCM data and its format.
+     */
+    export function decodeParallel(mp3: Buffer, opts: ParallelDecoderOptions,
+        callback: (err: Error | null, pcm?: Buffer, format?: any) => void): void;
+
+    /**
+     * Returns the names of the mpg123 decoders that this build has and the
+     * CPU supports, fastest first.
+     */
+    export function decoders(): string[];
+
+    export interface PoolWorkerStats {
+        readonly queued: number;
+        readonly maxQueued: number;
+        readonly completed: number;
+        readonly busy: boolean;
+    }
+
+    export interface PoolStats {
+        readonly size: number;
+        readonly started: boolean;
+        readonly queued: number;
+        readonly pending: number;
+        /** The envs (main thread and Workers) the pool still keeps state for. */
+        readonly contexts: number;
+        readonly workers: PoolWorkerStats[];
+    }
+
+    /**
+     * Returns the queue depths of the audio worker pool.
+     */
+    export function poolStats(): PoolStats;
+
+    export interface TableCacheStats {
+        readonly tables: number;
+        readonly bytes: number;
+    }
+
+    /**
+     * Returns the number and total size of the read-only tables that the
+     * encoders of the same configuration share.
+     */
+    export function tableCacheStats(): TableCacheStats;
+
     /*
      * Channel Modes
      */
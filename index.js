@@ -11,6 +11,59 @@ exports.Decoder = require('./lib/decoder');
 
 exports.Encoder = require('./lib/encoder');
 
+/**
+ * The `EncoderGroup` encodes many streams of the same options side by side.
+ */
+
+exports.EncoderGroup = require('./lib/encodergroup');
+
+/**
+ * Encodes a Buffer of PCM data into an MP3 file on all of the audio workers.
+ */
+
+exports.encodeParallel = require('./lib/parallel').encode;
+
+/**
+ * Decodes a whole MP3 file into PCM data on all of the audio workers.
+ */
+
+exports.decodeParallel = require('./lib/parallel').decode;
+
+/**
+ * Serializes a frame index from `Decoder.scan()` into a sidecar file, and
+ * parses one back for the `index` option of a `Decoder`.
+ */
+
+exports.writeIndex = require('./lib/frameindex').serialize;
+exports.readIndex = require('./lib/frameindex').parse;
+
+/**
+ * Returns the queue depths of the audio worker pool that all encoding and
+ * decoding work runs on. Its size is set by the LAME_THREADPOOL_SIZE env var.
+ */
+
+exports.poolStats = function () {
+  return require('./lib/bindings').pool_stats();
+};
+
+/**
+ * Returns the number and total size in bytes of the read-only tables that the
+ * encoders of the same configuration share (see `Encoder#tableBytes`).
+ */
+
+exports.tableCacheStats = function () {
+  return require('./lib/bindings').table_cache_stats();
+};
+
+/**
+ * Returns the names of the mpg123 decoders that this build has and the CPU
+ * supports, fastest first. Pass one as the `decoder` option of a `Decoder`.
+ */
+
+exports.decoders = function () {
+  return require('./lib/bindings').mpg123_supported_decoders();
+};
+
 /*
  * Channel Modes
  */
@@ -3,8 +3,9 @@
  * Module dependencies.
  */
 
-var assert = require('assert');
 var binding = require('./bindings');
+var frameindex = require('./frameindex');
+var HandlePool = require('./handlepool');
 var inherits = require('util').inherits;
 var Transform = require('readable-stream/transform');
 var debug = require('debug')('lame:decoder');
@@ -21,22 +22,27 @@ module.exports = Decoder;
 
 var MPG123_OK = binding.MPG123_OK;
 var MPG123_DONE = binding.MPG123_DONE;
-var MPG123_NEW_ID3 = binding.MPG123_NEW_ID3;
 var MPG123_NEED_MORE = binding.MPG123_NEED_MORE;
-var MPG123_NEW_FORMAT = binding.MPG123_NEW_FORMAT;
+var MPG123_PREFRAMES = binding.MPG123_PREFRAMES;
+var MPG123_INDEX_SIZE = binding.MPG123_INDEX_SIZE;
+var SEEK_SET = binding.SEEK_SET;
 
 /**
- * One-time calls...
+ * The mpg123 output encodings for the "encoding" option.
  */
 
-binding.mpg123_init();
-process.once('exit', binding.mpg123_exit);
+var ENCODINGS = {
+  s16: binding.MPG123_ENC_SIGNED_16,
+  s32: binding.MPG123_ENC_SIGNED_32,
+  f32: binding.MPG123_ENC_FLOAT_32
+};
 
 /**
- * The recommended size of the "output" buffer when calling mpg123_read().
+ * One-time calls...
  */
 
-var safe_buffer = binding.mpg123_safe_buffer();
+binding.mpg123_init();
+process.once('exit', binding.mpg123_exit);
 
 /**
  * `Decoder` Stream class.
@@ -47,92 +53,411 @@ function Decoder (opts) {
   if (!(this instanceof Decoder)) {
     return new Decoder(opts);
   }
-  Transform.call(this, opts);
+  // "encoding" is the PCM encoding here, not the stream's string encoding
+  var stream = opts;
+  if (opts && null != opts.encoding) {
+    stream = {};
+    for (var key in opts) if ('encoding' != key) stream[key] = opts[key];
+  }
+  Transform.call(this, stream);
   var ret;
 
-  ret = binding.mpg123_new(opts ? opts.decoder : null);
-  if (Buffer.isBuffer(ret)) {
+  // "reuse" mode: the mpg123 handle comes from `Decoder.handles`, set up with
+  // the same options and opened for a new stream already, and goes back there
+  // after the end of the stream
+  var gapless = !(opts && false === opts.gapless);
+  this.mh = null;
+  this._handleKey = null;
+  if (opts && opts.reuse) {
+    this._handleKey = JSON.stringify([ opts.decoder || null, gapless,
+        opts.rate, opts.channels, opts.encoding || 's16',
+        opts.preframes || null, !!opts.zeroCopy ]);
+    this.mh = Decoder.handles.acquire(this._handleKey);
+  }
+
+  if (!this.mh) {
+    ret = binding.mpg123_new(opts ? opts.decoder : null);
+    if ('number' == typeof ret) {
+      throw new Error('mpg123_new() failed: ' + ret);
+    }
     this.mh = ret;
-  } else {
-    throw new Error('mpg123_new() failed: ' + ret);
+    if (!defaults) {
+      defaults = {
+        preframes: binding.mpg123_getparam(ret, MPG123_PREFRAMES),
+        indexSize: binding.mpg123_getparam(ret, MPG123_INDEX_SIZE)
+      };
+    }
+
+    // gapless decoding: with a LAME tag, the encoder delay and padding (and
+    // mpg123's own decoder delay) are cut off, so the output has exactly as
+    // many samples as went into the encoder. The tag's values are reported in
+    // the "format" event, and as `encoderDelay`, `encoderPadding` and `samples`
+    binding.mpg123_param(this.mh, gapless ? binding.MPG123_ADD_FLAGS :
+        binding.MPG123_REMOVE_FLAGS, binding.MPG123_GAPLESS, 0);
+
+    if (opts) outputFormat(this.mh, opts);
+
+    ret = binding.mpg123_open_feed(this.mh);
+    if (MPG123_OK != ret) {
+      throw new Error('mpg123_open_feed() failed: ' + ret);
+    }
   }
+  this.encoderDelay = null;
+  this.encoderPadding = null;
+  this.samples = null;
 
-  ret = binding.mpg123_open_feed(this.mh);
-  if (MPG123_OK != ret) {
-    throw new Error('mpg123_open_feed() failed: ' + ret);
+  // a frame index from `Decoder.scan()` or `decoder.index()`, or a sidecar
+  // file of one (see lib/frameindex.js), so that seek() goes straight to the
+  // right frame rather than only as far as mpg123 has parsed the stream itself
+  var index = opts && opts.index;
+  if (Buffer.isBuffer(index)) index = frameindex.parse(index);
+  this._indexed = !!index;
+  if (index) {
+    ret = binding.mpg123_set_index(this.mh, index.offsets, index.step);
+    if (MPG123_OK != ret) {
+      throw new Error('mpg123_set_index() failed: ' + ret);
+    }
+    // the length is known up front, no need to wait for the "format" event
+    if (null != index.samples && (gapless || null == index.encoderDelay)) {
+      this.encoderDelay = index.encoderDelay;
+      this.encoderPadding = index.encoderPadding;
+      this.samples = index.samples;
+    }
+  }
+  this.preframes = opts && opts.preframes ? opts.preframes : null;
+  this._preframes = this.preframes;
+  if (this.preframes) {
+    binding.mpg123_param(this.mh, MPG123_PREFRAMES, this.preframes, 0);
+  }
+
+  // "zeroCopy" mode: mpg123 synthesizes each frame directly into the output
+  // Buffers, rather than into its own frame buffer followed by a memcpy()
+  this.zeroCopy = !!(opts && opts.zeroCopy);
+
+  // "typedArray" mode: the PCM is pushed as Int16Array, Int32Array or
+  // Float32Array views (as fits the output format) over the decoded memory,
+  // instead of as Buffers
+  this.typedArray = !!(opts && opts.typedArray);
+  this._ArrayType = null;
+  if (this.typedArray) {
+    // readable-stream 1.0 has no `readableObjectMode`
+    this._readableState.objectMode = true;
+    this._readableState.highWaterMark = 16;
   }
   debug('created new Decoder instance');
 }
 inherits(Decoder, Transform);
 
 /**
- * Calls `mpg123_feed()` with the given "chunk", and then calls `mpg123_read()`
- * until MPG123_NEED_MORE is returned.
+ * The idle mpg123 handles of the Decoders with `reuse` set, by their options.
+ * Each keeps its frame and output buffers, some 80 KB of heap (see
+ * deps/mpg123/bench/reuse.c). There's no freeing an mpg123 handle other than
+ * by the garbage collector, so the ones that are let go are only dropped.
+ */
+
+Decoder.handles = new HandlePool(function (mh) {});
+
+/**
+ * The parameters that a Decoder may change on an mpg123 handle beyond its
+ * options, as a new handle has them, to put back before it's reused.
+ */
+
+var defaults = null;
+
+/**
+ * The TypedArray class for the samples of an output format.
  *
- * @param {Buffer} chunk The Buffer instance of PCM audio data to process
- * @param {String} encoding ignore...
- * @param {Function} done callback function when done processing
  * @api private
  */
 
-Decoder.prototype._transform = function (chunk, encoding, done) {
-  debug('_transform(): (%d bytes)', chunk.length);
-  var out, mh, self;
-  self = this;
-  mh = this.mh;
+function arrayType (format) {
+  if (format.float) return 64 == format.bitDepth ? Float64Array : Float32Array;
+  if (32 == format.bitDepth) return format.signed ? Int32Array : Uint32Array;
+  if (16 == format.bitDepth) return format.signed ? Int16Array : Uint16Array;
+  return format.signed ? Int8Array : Uint8Array;
+}
+
+/**
+ * Pushes a Buffer of decoded PCM, or a TypedArray view of it in "typedArray"
+ * mode. The Buffers from mpg123_feed_and_drain() are their own allocation and
+ * only ever cut at whole samples, so the view is aligned and doesn't copy.
+ *
+ * @api private
+ */
+
+Decoder.prototype._pushPCM = function (pcm) {
+  var Type = this._ArrayType;
+  if (!Type) return this.push(pcm);
+  var length = pcm.length / Type.BYTES_PER_ELEMENT;
+  if (pcm.byteOffset % Type.BYTES_PER_ELEMENT == 0) {
+    return this.push(new Type(pcm.buffer, pcm.byteOffset, length));
+  }
+  var copy = new Type(length);
+  new Uint8Array(copy.buffer).set(pcm);
+  return this.push(copy);
+};
 
-  binding.mpg123_feed(mh, chunk, chunk.length, afterFeed);
+/**
+ * Constrains the output format of the mpg123 handle to the "rate", "channels"
+ * and "encoding" options, any of which may be left out to keep what the MP3
+ * file has (or 16-bit for "encoding"). A "rate" other than the native one, or
+ * half or a quarter of it, decodes with libmpg123's NtoM synth, which
+ * resamples as part of the synthesis.
+ *
+ * @param {Object} mh The mpg123 handle
+ * @param {Object} opts The Decoder options
+ * @api private
+ */
 
-  function afterFeed (ret) {
-    // XXX: a hack to ensure that "chunk" doesn't get GC'd until
-    // after feed() is done. We could do this in C++-land to be "clean", but
-    // doing this saves sizeof(Persistent<Object>) from the req struct.
-    // It's also probably overkill...
-    chunk = chunk;
+function outputFormat (mh, opts) {
+  var rate = opts.rate;
+  var channels = opts.channels;
+  var encoding = opts.encoding;
+  if (null == rate && null == channels && null == encoding) return;
+  var ret;
 
-    debug('mpg123_feed() = %d', ret);
+  if (null != rate) {
+    if (!(rate > 0) || rate != (rate | 0)) {
+      throw new TypeError('"rate" must be a positive integer, got ' + rate);
+    }
+    ret = binding.mpg123_param(mh, binding.MPG123_FORCE_RATE, rate, 0);
     if (MPG123_OK != ret) {
-      return done(new Error('mpg123_feed() failed: ' + ret));
+      throw new Error('unsupported "rate": ' + rate);
     }
-    read();
   }
 
-  function read () {
-    out = new Buffer(safe_buffer);
-    binding.mpg123_read(mh, out, out.length, afterRead);
-    // XXX: the `afterRead` function below holds the reference to the "out"
-    // buffer while being filled by `mpg123_read()` on the thread pool.
+  var flags = 0;
+  if (1 == channels) {
+    flags = binding.MPG123_MONO_MIX;
+  } else if (2 == channels) {
+    flags = binding.MPG123_FORCE_STEREO;
+  } else if (null != channels) {
+    throw new TypeError('"channels" must be 1 or 2, got ' + channels);
   }
+  if (flags) binding.mpg123_param(mh, binding.MPG123_ADD_FLAGS, flags, 0);
 
-  function afterRead (ret, bytes, meta) {
-    debug('mpg123_read() = %d (bytes=%d) (meta=%d)', ret, bytes, meta);
-    if (meta & MPG123_NEW_ID3) {
-      debug('MPG123_NEW_ID3');
-      binding.mpg123_id3(mh, function (ret2, id3) {
-        if (ret2 == MPG123_OK) {
-          self.emit('id3v' + (id3.tag ? 1 : 2), id3);
-          handleRead(ret, bytes);
-        } else {
-          // error getting ID3 tag info (probably shouldn't happen)...
-          done(new Error('mpg123_id3() failed: ' + ret2));
-        }
-      });
-    } else {
-      handleRead(ret, bytes);
+  var enc = ENCODINGS[null == encoding ? 's16' : encoding];
+  if (!enc) {
+    throw new TypeError('"encoding" must be one of ' +
+        Object.keys(ENCODINGS).join(', ') + ', got ' + encoding);
+  }
+
+  // only the one encoding, at the forced rate or at all the regular ones
+  var rates = null != rate ? [ rate ] : binding.mpg123_rates();
+  binding.mpg123_format_none(mh);
+  for (var i = 0; i < rates.length; i++) {
+    ret = binding.mpg123_format(mh, rates[i],
+        binding.MPG123_MONO | binding.MPG123_STEREO, enc);
+    if (MPG123_OK != ret) {
+      throw new Error('mpg123_format() failed: ' + ret);
     }
   }
+}
 
-  function handleRead (ret, bytes) {
-    if (bytes > 0) {
-      // got decoded data
-      assert(out.length >= bytes);
-      if (out.length != bytes) {
-        debug('slicing output buffer from %d to %d', out.length, bytes);
-        out = out.slice(0, bytes);
-      }
+/**
+ * Seeks to the given sample offset (of the output, so after the gapless
+ * trimming) and returns the byte offset of the MP3 stream that has to be
+ * written next: the Decoder then outputs the PCM from that sample on. It needs
+ * the start of the stream (ID3v2 tag, LAME tag and the first audio frame) to
+ * have been written already, and no write to be in progress, so call it from
+ * a write callback. The PCM decoded before the seek still comes out first.
+ *
+ * With a frame index ("index" option), that's the byte offset of an indexed
+ * frame right before the sample, which libmpg123 decodes from and throws away
+ * up to the sample. Without one, it's as far as libmpg123 has parsed.
+ *
+ * @param {Number} sample The sample offset to seek to
+ * @return {Number} The byte offset of the MP3 stream to continue writing from
+ * @api public
+ */
+
+Decoder.prototype.seek = function (sample) {
+  var state = this._writableState;
+  if (state.writing || state.length > 0) {
+    throw new Error('seek() while a write is being decoded');
+  }
+  var mh = this.mh;
+
+  // enough frames before the sample to hold the largest main_data_begin (511
+  // bytes), plus the one frame that layer 3 needs for the overlap
+  if (!this.preframes) {
+    var index = binding.mpg123_index(mh);
+    var frames = 'number' == typeof index ? 0 : index.offsets.length - 1;
+    if (frames > 0) {
+      var frameSize = (index.offsets[frames] - index.offsets[0]) / (frames * index.step);
+      this.preframes = Math.max(4, Math.ceil(511 / frameSize) + 1);
+      binding.mpg123_param(mh, MPG123_PREFRAMES, this.preframes, 0);
+    }
+  }
+
+  var ret = binding.mpg123_feedseek(mh, sample, SEEK_SET);
+  if ('number' == typeof ret) {
+    var err = new Error(MPG123_NEED_MORE == ret ?
+        'seek() needs the start of the MP3 stream to have been written' :
+        'mpg123_feedseek() failed: ' + ret);
+    err.code = ret;
+    throw err;
+  }
+  debug('seek(%d): at sample %d, continue from byte %d', sample, ret[0], ret[1]);
+  return ret[1];
+};
+
+/**
+ * The frame index libmpg123 has built so far (or was given): the byte offset
+ * of every `step`th frame, as `{ step, offsets }`. It's plain JSON, to store
+ * and pass back as the "index" option of a later Decoder for the same file.
+ *
+ * @return {Object} The frame index
+ * @api public
+ */
+
+Decoder.prototype.index = function () {
+  var index = binding.mpg123_index(this.mh);
+  if ('number' == typeof index) {
+    throw new Error('mpg123_index() failed: ' + index);
+  }
+  return index;
+};
+
+/**
+ * Parses (but doesn't decode) every frame of the MP3 file in the thread pool,
+ * and calls back with its frame index, as `decoder.index()` has it, plus what
+ * goes into a sidecar file (see `lame.writeIndex()`): the number of `frames`,
+ * `spf` (samples per frame), `sampleRate`, `channels`, the (gapless) number of
+ * `samples`, `encoderDelay` and `encoderPadding` from the LAME tag, `fileSize`
+ * and the byte range of the audio between the ID3 tags, `audioStart` and
+ * `audioEnd`.
+ *
+ * @param {Buffer} mp3 The whole MP3 file
+ * @param {Object} opts The Decoder options ("decoder" only)
+ * @param {Function} fn The callback function, `fn(err, index)`
+ * @api public
+ */
+
+Decoder.scan = function (mp3, opts, fn) {
+  if ('function' == typeof opts) {
+    fn = opts;
+    opts = null;
+  }
+  var mh = binding.mpg123_new(opts ? opts.decoder : null);
+  if ('number' == typeof mh) {
+    return process.nextTick(function () {
+      fn(new Error('mpg123_new() failed: ' + mh));
+    });
+  }
+  var ret = binding.mpg123_open_feed(mh);
+  if (MPG123_OK != ret) {
+    return process.nextTick(function () {
+      fn(new Error('mpg123_open_feed() failed: ' + ret));
+    });
+  }
+  binding.mpg123_feed_and_scan(mh, mp3, mp3.length, function (ret, frames) {
+    if (ret != MPG123_NEED_MORE && ret != MPG123_DONE) {
+      return fn(new Error('mpg123_feed_and_scan() failed: ' + ret));
+    }
+    var index = binding.mpg123_index(mh);
+    var format = binding.mpg123_getformat(mh);
+    if ('number' == typeof index || 'number' == typeof format || frames < 1) {
+      return fn(new Error('no MPEG audio frames found'));
+    }
+    var spf = binding.mpg123_spf(mh);
+    var extent = frameindex.extent(mp3);
+    index.frames = frames;
+    index.spf = spf;
+    index.sampleRate = format.sampleRate;
+    index.channels = format.channels;
+    // with a LAME tag, the exact length after the gapless trimming
+    index.samples = null != format.samples ? format.samples : frames * spf;
+    index.encoderDelay = null != format.encoderDelay ? format.encoderDelay : null;
+    index.encoderPadding = null != format.encoderPadding ? format.encoderPadding : null;
+    index.fileSize = mp3.length;
+    index.audioStart = extent[0];
+    index.audioEnd = extent[1];
+    fn(null, index);
+  });
+};
+
+/**
+ * In "reuse" mode, the mpg123 handle is closed (which resets it for a new
+ * stream, but keeps its buffers), opened again and handed back to
+ * `Decoder.handles`. It's only left to the garbage collector if that fails.
+ *
+ * @param {Function} done callback function when done processing
+ * @api private
+ */
+
+Decoder.prototype._flush = function (done) {
+  var mh = this.mh;
+  if (!this._handleKey) return done();
+  this.mh = null;
+
+  // what seek() and the "index" option may have changed
+  if (this.preframes != this._preframes) {
+    binding.mpg123_param(mh, MPG123_PREFRAMES,
+        this._preframes || defaults.preframes, 0);
+  }
+  var ret = MPG123_OK;
+  if (this._indexed) {
+    ret = binding.mpg123_param(mh, MPG123_INDEX_SIZE, defaults.indexSize, 0);
+  }
+  if (MPG123_OK == ret) ret = binding.mpg123_open_feed(mh);
+  if (MPG123_OK == ret) {
+    Decoder.handles.release(this._handleKey, mh);
+  } else {
+    debug('not reusing the mpg123 handle: %d', ret);
+  }
+  done();
+};
+
+/**
+ * Calls `mpg123_feed_and_drain()` with the given "chunk", which feeds it to
+ * mpg123 and decodes until MPG123_NEED_MORE, all in one trip to the thread
+ * pool. Any "format" and "id3" events that happened along the way are emitted
+ * in between the PCM data they occured at.
+ *
+ * @param {Buffer} chunk The Buffer instance of MP3 data to process
+ * @param {String} encoding ignore...
+ * @param {Function} done callback function when done processing
+ * @api private
+ */
+
+Decoder.prototype._transform = function (chunk, encoding, done) {
+  debug('_transform(): (%d bytes)', chunk.length);
+  var self = this;
+  var mh = this.mh;
+
+  var frames = this.zeroCopy;
 
-      self.push(out);
+  binding.mpg123_feed_and_drain(mh, chunk, chunk.length, afterDrain, frames);
+
+  function afterDrain (ret, pcm, events) {
+    debug('mpg123_feed_and_drain() = %d (bytes=%d) (events=%d)',
+        ret, pcm ? pcm.length : 0, events.length);
+    var offset = 0;
+    for (var i = 0; i < events.length; i++) {
+      var e = events[i];
+      if (e.offset > offset) {
+        self._pushPCM(pcm.slice(offset, e.offset));
+        offset = e.offset;
+      }
+      if (e.format) {
+        debug('new format: %j', e.format);
+        if (self.typedArray) self._ArrayType = arrayType(e.format);
+        if (null != e.format.encoderDelay) {
+          self.encoderDelay = e.format.encoderDelay;
+          self.encoderPadding = e.format.encoderPadding;
+          self.samples = null != e.format.samples ? e.format.samples : null;
+        }
+        self.emit('format', e.format);
+      } else if (e.id3) {
+        debug('MPG123_NEW_ID3');
+        self.emit('id3v' + (e.id3.tag ? 1 : 2), e.id3);
+      }
     }
+    if (pcm && pcm.length > offset) {
+      self._pushPCM(offset > 0 ? pcm.slice(offset) : pcm);
+    }
+
     if (ret == MPG123_DONE) {
       debug('done');
       return done();
@@ -141,15 +466,10 @@ Decoder.prototype._transform = function (chunk, encoding, done) {
       debug('needs more!');
       return done();
     }
-    if (ret == MPG123_NEW_FORMAT) {
-      var format = binding.mpg123_getformat(mh);
-      debug('new format: %j', format);
-      self.emit('format', format);
-      return read();
-    }
     if (MPG123_OK != ret) {
-      return done(new Error('mpg123_read() failed: ' + ret));
+      return done(new Error('mpg123_feed_and_drain() failed: ' + ret));
     }
-    read();
+    // more PCM or events than fit in one call, keep draining
+    binding.mpg123_feed_and_drain(mh, null, 0, afterDrain, frames);
   }
 };
@@ -5,6 +5,7 @@
 
 var assert = require('assert');
 var binding = require('./bindings');
+var HandlePool = require('./handlepool');
 var inherits = require('util').inherits;
 var Transform = require('readable-stream/transform');
 var debug = require('debug')('lame:encoder');
@@ -27,6 +28,9 @@ var LAME_INTERNALERROR = binding.LAME_INTERNALERROR;
 var PCM_TYPE_SHORT_INT = binding.PCM_TYPE_SHORT_INT;
 var PCM_TYPE_FLOAT = binding.PCM_TYPE_FLOAT;
 var PCM_TYPE_DOUBLE = binding.PCM_TYPE_DOUBLE;
+var PCM_TYPE_S24LE = binding.PCM_TYPE_S24LE;
+var PCM_TYPE_S32 = binding.PCM_TYPE_S32;
+var PCM_TYPE_U8 = binding.PCM_TYPE_U8;
 
 /**
  * Messages for error codes returned from the lame C encoding functions.
@@ -60,6 +64,21 @@ var SHORT_BITS = binding.sizeof_short * 8;
 var FLOAT_BITS = binding.sizeof_float * 8;
 var DOUBLE_BITS = binding.sizeof_double * 8;
 
+/**
+ * Default size of the output "scratch" Buffer used when `scratch` is enabled.
+ */
+
+var SCRATCH_SIZE = 32 * 1024;
+
+/**
+ * The worst-case number of MP3 bytes for `num_samples` samples,
+ * as specified in lame.h.
+ */
+
+function estimateSize (num_samples) {
+  return Math.ceil(1.25 * num_samples) + 7200;
+}
+
 /**
  * The `Encoder` class is a Transform stream class.
  * Write raw PCM data, out comes an MP3 file.
@@ -72,11 +91,10 @@ function Encoder (opts) {
   if (!(this instanceof Encoder)) {
     return new Encoder(opts);
   }
+  // "planar" mode takes Arrays of per-channel Buffers, so it's object mode
+  if (opts && opts.planar) opts = Object.assign({}, opts, { objectMode: true });
   Transform.call(this, opts);
 
-  // lame malloc()s the "gfp" buffer
-  this.gfp = binding.lame_init();
-
   // set default options
   if (!opts) opts = {};
   if (null == opts.channels) opts.channels = 2;
@@ -90,20 +108,80 @@ function Encoder (opts) {
     this.inputType = PCM_TYPE_FLOAT;
   } else if (!opts.float && opts.bitDepth == SHORT_BITS) {
     this.inputType = PCM_TYPE_SHORT_INT;
+  } else if (!opts.float && opts.bitDepth == 24) {
+    this.inputType = PCM_TYPE_S24LE;
+  } else if (!opts.float && opts.bitDepth == INT_BITS) {
+    this.inputType = PCM_TYPE_S32;
+  } else if (!opts.float && opts.bitDepth == 8) {
+    this.inputType = PCM_TYPE_U8;
   } else {
     throw new Error('unsupported PCM format!');
   }
 
-  // copy over opts to the encoder instance
-  Object.keys(opts).forEach(function(key){
-    if (key[0] != '_' && Encoder.prototype.hasOwnProperty(key)) {
-      debug('setting opt %j', key);
-      this[key] = opts[key];
-    }
+  // "scratch" mode: MP3 output is written into one Buffer that's reused for
+  // every chunk, rather than into a new worst-case sized Buffer each time, and
+  // copied out
+  if (opts.scratch) {
+    this.scratchSize = 'number' == typeof opts.scratch ? opts.scratch : SCRATCH_SIZE;
+    this._scratch = null;
+  }
+
+  // "planar" mode: each chunk holds whole, separate channels, which go to
+  // lame as they are (no deinterleaving)
+  this.planar = !!opts.planar;
+
+  // "gapless" mode: the end of the stream is flushed with
+  // `lame_encode_flush()` rather than `lame_encode_flush_nogap()`, and the
+  // LAME tag frame is emitted as a "lametag" event
+  this.gapless = !!opts.gapless;
+
+  // "reuse" mode: the lame encoder comes from `Encoder.handles`, set up with
+  // the same options already, and goes back there after the end of the stream
+  var keys = Object.keys(opts).filter(function (key) {
+    return key[0] != '_' && Encoder.prototype.hasOwnProperty(key);
+  }).sort();
+  this.gfp = null;
+  if (opts.reuse) {
+    this._handleKey = JSON.stringify([ this.inputType ].concat(keys.map(function (key) {
+      return [ key, opts[key] ];
+    })));
+    this.gfp = Encoder.handles.acquire(this._handleKey);
+    this._reused = !!this.gfp;
+  }
+
+  // lame malloc()s the "gfp" buffer
+  if (!this.gfp) this.gfp = binding.lame_init();
+
+  // copy over opts to the encoder instance (a reused lame encoder has them)
+  keys.forEach(function(key){
+    if (this._reused && Object.getOwnPropertyDescriptor(Encoder.prototype, key).set) return;
+    debug('setting opt %j', key);
+    this[key] = opts[key];
   }, this);
+  this._configured = true;
 }
 inherits(Encoder, Transform);
 
+/**
+ * Expose the default output scratch Buffer size.
+ */
+
+Encoder.SCRATCH_SIZE = SCRATCH_SIZE;
+
+/**
+ * Expose the worst-case MP3 output size for a number of samples.
+ */
+
+Encoder.estimateSize = estimateSize;
+
+/**
+ * The idle lame encoders of the Encoders with `reuse` set, by their options.
+ */
+
+Encoder.handles = new HandlePool(function (gfp) {
+  binding.lame_close(gfp);
+});
+
 /**
  * Default PCM format: signed 16-bit little endian integer samples.
  */
@@ -119,9 +197,11 @@ Encoder.prototype.bitDepth = 16;
 Encoder.prototype._init = function () {
   debug('_init()');
 
-  var r = binding.lame_init_params(this.gfp);
-  if (LAME_OKAY !== r) {
-    throw new Error('error initializing params: ' + r);
+  if (!this._reused) {
+    var r = binding.lame_init_params(this.gfp);
+    if (LAME_OKAY !== r) {
+      throw new Error('error initializing params: ' + r);
+    }
   }
 
   // constant: number of 'bytes per sample'
@@ -129,7 +209,90 @@ Encoder.prototype._init = function () {
 };
 
 /**
- * Calls `lame_encode_buffer_interleaved()` on the given "chunk.
+ * Returns an output region of at least `size` bytes. In "scratch" mode this
+ * is the encoder's scratch Buffer (a bigger one replaces it if a chunk needs
+ * more), otherwise a fresh Buffer.
+ *
+ * @param {Number} size minimum number of bytes needed
+ * @return {Object} `buffer` and `offset` to encode into
+ * @api private
+ */
+
+Encoder.prototype._output = function (size) {
+  if (!this.scratchSize) {
+    return { buffer: new Buffer(size), offset: 0 };
+  }
+  if (!this._scratch || this._scratch.length < size) {
+    debug('allocating new %d byte output scratch Buffer', Math.max(size, this.scratchSize));
+    this._scratch = new Buffer(Math.max(size, this.scratchSize));
+  }
+  return { buffer: this._scratch, offset: 0 };
+};
+
+/**
+ * Pushes `bytes` encoded bytes from the `out` region returned by `_output()`.
+ *
+ * In "scratch" mode the scratch Buffer is encoded into again by the next
+ * chunk, so the bytes are copied out into a Buffer of just their size (a
+ * small one comes out of node's own Buffer pool): a copy of about a tenth of
+ * the PCM, in exchange for no worst-case sized allocation per chunk. A
+ * consumer that holds on to a chunk never keeps more than that alive.
+ *
+ * @api private
+ */
+
+Encoder.prototype._pushOutput = function (out, bytes) {
+  var buf = out.buffer.slice(out.offset, out.offset + bytes);
+  if (this.scratchSize) buf = Buffer.from(buf);
+  debug('writing %d MP3 bytes', bytes);
+  this.push(buf);
+};
+
+/**
+ * Splits a "planar" mode chunk into its channels: either an Array of one
+ * Buffer (or TypedArray) per channel, or one Buffer (or TypedArray) holding
+ * the channels one after the other. Every chunk must hold whole samples of
+ * equal length channels.
+ *
+ * @param {Array|Buffer|TypedArray} chunk
+ * @return {Object} `left`, `right` (`null` for mono), their offsets, and
+ *                  the number of `samples` per channel
+ * @api private
+ */
+
+Encoder.prototype._planes = function (chunk) {
+  var planes = { left: null, leftOffset: 0, right: null, rightOffset: 0 };
+  var length;
+  if (Array.isArray(chunk)) {
+    if (chunk.length != this.channels) {
+      throw new Error('expected ' + this.channels + ' channels, got ' + chunk.length);
+    }
+    planes.left = toBuffer(chunk[0]);
+    length = planes.left.length;
+    if (this.channels > 1) {
+      planes.right = toBuffer(chunk[1]);
+      if (planes.right.length != length) {
+        throw new Error('the channels must have the same length');
+      }
+    }
+  } else {
+    planes.left = toBuffer(chunk);
+    length = planes.left.length / this.channels;
+    if (this.channels > 1) {
+      planes.right = planes.left;
+      planes.rightOffset = length;
+    }
+  }
+  if (length % (this.bitDepth / 8) !== 0) {
+    throw new Error('planar chunks must hold whole samples');
+  }
+  planes.samples = length / (this.bitDepth / 8);
+  return planes;
+};
+
+/**
+ * Calls `lame_encode_buffer_interleaved()` on the given "chunk, or
+ * `lame_encode_buffer()` on its channels in "planar" mode.
  *
  * @api private
  */
@@ -138,11 +301,34 @@ Encoder.prototype._transform = function (chunk, encoding, done) {
   debug('_transform (%d bytes)', chunk.length);
 
   var self = this;
+  var out;
   if (!this._initCalled) {
     try { this._init(); } catch (e) { return done(e); }
     this._initCalled = true;
   }
 
+  if (this.planar) {
+    var planes;
+    try { planes = this._planes(chunk); } catch (e) { return done(e); }
+    out = this._output(estimateSize(planes.samples));
+    debug('encoding %d planar samples', planes.samples);
+    binding.lame_encode_buffer_planar(
+      this.gfp,
+      planes.left,
+      planes.leftOffset,
+      planes.right,
+      planes.rightOffset,
+      this.inputType,
+      this.channels,
+      planes.samples,
+      out.buffer,
+      out.offset,
+      estimateSize(planes.samples),
+      cb
+    );
+    return;
+  }
+
   // first handle any _remainder
   if (this._remainder) {
     debug('concating remainder');
@@ -160,10 +346,9 @@ Encoder.prototype._transform = function (chunk, encoding, done) {
   assert.equal(chunk.length % this.blockAlign, 0);
 
   var num_samples = chunk.length / this.blockAlign;
-    // TODO: Use better calculation logic from lame.h here
-  var estimated_size = 1.25 * num_samples + 7200;
-  var output = new Buffer(estimated_size);
-  debug('encoding %d byte chunk with %d byte output buffer (%d samples)', chunk.length, output.length, num_samples);
+  var estimated_size = estimateSize(num_samples);
+  out = this._output(estimated_size);
+  debug('encoding %d byte chunk with %d byte output buffer (%d samples)', chunk.length, estimated_size, num_samples);
 
 
   binding.lame_encode_buffer(
@@ -172,9 +357,9 @@ Encoder.prototype._transform = function (chunk, encoding, done) {
     this.inputType,
     this.channels,
     num_samples,
-    output,
-    0,
-    output.length,
+    out.buffer,
+    out.offset,
+    estimated_size,
     cb
   );
 
@@ -185,9 +370,7 @@ Encoder.prototype._transform = function (chunk, encoding, done) {
       err.code = bytesWritten;
       done(err);
     } else if (bytesWritten > 0) {
-      output = output.slice(0, bytesWritten);
-      debug('writing %d MP3 bytes', output.length);
-      self.push(output);
+      self._pushOutput(out, bytesWritten);
       done();
     } else { // bytesWritten == 0
       done();
@@ -196,7 +379,16 @@ Encoder.prototype._transform = function (chunk, encoding, done) {
 };
 
 /**
- * Calls `lame_encode_flush_nogap()` on the thread pool.
+ * Calls `lame_encode_flush_nogap()` on the thread pool, or in "gapless" mode
+ * `lame_encode_flush()`, which also encodes the PCM that is still buffered
+ * (padded to whole frames) and works out the padding.
+ *
+ * In "gapless" mode the encoder delay and padding stay readable as
+ * `encoderDelay` and `encoderPadding` after the encoder is closed, and with
+ * `writeVbrTag` set, the final LAME tag frame is emitted as a "lametag" event;
+ * it has the same size as the placeholder frame that the output started with,
+ * and overwriting that one with it is what lets a decoder trim the output to
+ * the exact input length.
  */
 
 Encoder.prototype._flush = function (done) {
@@ -204,36 +396,50 @@ Encoder.prototype._flush = function (done) {
 
   var self = this;
   var estimated_size = 7200; // value specified in lame.h
-  var output = new Buffer(estimated_size);
+  var out = this._output(estimated_size);
 
   if (!this._initCalled) {
     try { this._init(); } catch (e) { return done(e); }
     this._initCalled = true;
   }
 
-  binding.lame_encode_flush_nogap(
+  var flush = this.gapless ? 'lame_encode_flush' : 'lame_encode_flush_nogap';
+  binding[flush](
     this.gfp,
-    output,
-    0,
-    output.length,
+    out.buffer,
+    out.offset,
+    estimated_size,
     cb
   );
 
   function cb (bytesWritten) {
-    debug('after lame_encode_flush_nogap() (rtn: %d)', bytesWritten);
-
-    binding.lame_close(self.gfp);
+    debug('after %s() (rtn: %d)', flush, bytesWritten);
+
+    var tag = null;
+    if (self.gapless && bytesWritten >= 0) {
+      ['encoderDelay', 'encoderPadding'].forEach(function (prop) {
+        Object.defineProperty(self, prop, { enumerable: true, value: self[prop] });
+      });
+      tag = binding.lame_get_lametag_frame(self.gfp);
+    }
+    // in "reuse" mode the lame encoder is readied for the next stream of the
+    // same options (as if it was new), and handed back
+    if (self._handleKey && bytesWritten >= 0 &&
+        LAME_OKAY === binding.lame_reset_stream(self.gfp)) {
+      Encoder.handles.release(self._handleKey, self.gfp);
+    } else {
+      binding.lame_close(self.gfp);
+    }
     self.gfp = null;
+    self._scratch = null;
 
     if (bytesWritten < 0) {
       var err = new Error(ERRORS[bytesWritten]);
       err.code = bytesWritten;
       done(err);
-    } else if (bytesWritten > 0) {
-      output = output.slice(0, bytesWritten);
-      self.push(output);
-      done();
-    } else { // bytesWritten == 0
+    } else {
+      if (bytesWritten > 0) self._pushOutput(out, bytesWritten);
+      if (tag) self.emit('lametag', tag);
       done();
     }
   }
@@ -267,6 +473,9 @@ Object.keys(binding).forEach(function (key) {
   } else {
     desc.set = function (v) {
       debug('%s(%j)', key, v);
+      if (this._handleKey && this._configured) {
+        throw new Error('"' + prop + '" of an Encoder with "reuse" set can only be set in the constructor');
+      }
       var r = binding[key](this.gfp, v);
       if (LAME_OKAY !== r) {
         throw new Error('error setting prop "' + prop + '": ' + r);
@@ -278,17 +487,38 @@ Object.keys(binding).forEach(function (key) {
 });
 
 /**
- * The lame encoder only supports "signed" data types.
+ * The lame encoder only supports "signed" data types, except for 8-bit PCM,
+ * which is unsigned.
  */
 
 Object.defineProperty(Encoder.prototype, 'signed', {
   enumerable: true,
   configurable: true,
-  get: function () { return true; },
-  set: function (v) { if (!v) throw new Error('"signed" must be `true`'); }
+  get: function () { return this.inputType !== PCM_TYPE_U8; },
+  set: function (v) {
+    if (!v != (this.inputType === PCM_TYPE_U8)) {
+      throw new Error('"signed" must be `' + !v + '` for ' + this.bitDepth + '-bit PCM');
+    }
+  }
 });
 
 
+/**
+ * Returns a Buffer view of the Buffer or TypedArray `data` (no copy).
+ *
+ * @param {Buffer|TypedArray} data
+ * @return {Buffer}
+ * @api private
+ */
+
+function toBuffer (data) {
+  if (Buffer.isBuffer(data)) return data;
+  if (ArrayBuffer.isView(data)) {
+    return Buffer.from(data.buffer, data.byteOffset, data.byteLength);
+  }
+  throw new TypeError('expected a Buffer or TypedArray, got ' + typeof data);
+}
+
 /**
  * Converts a string_with_underscores to camelCase.
  *
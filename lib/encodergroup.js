@@ -0,0 +1,214 @@
+/**
+ * Module dependencies.
+ */
+
+var binding = require('./bindings');
+var Encoder = require('./encoder');
+var debug = require('debug')('lame:encodergroup');
+
+/**
+ * Module exports.
+ */
+
+module.exports = EncoderGroup;
+
+/**
+ * Constants.
+ */
+
+var PCM_TYPE_SHORT_INT = binding.PCM_TYPE_SHORT_INT;
+var PCM_TYPE_FLOAT = binding.PCM_TYPE_FLOAT;
+
+/**
+ * An `EncoderGroup` encodes `count` MP3 streams of the same options side by
+ * side, a chunk of each at a time, like a server of many voice streams
+ * would. Each `encode()` call hands all of the chunks to lame at once, which
+ * runs the polyphase filterbank and the FFT of the psychoacoustic model of
+ * the streams that have a frame to encode in the SIMD lanes of one core (8
+ * channels with AVX2, 4 with SSE2). The output of every stream is the same
+ * as a `gapless` `Encoder`'s. That doesn't make the encoding measurably faster; what
+ * it saves is one pool job per stream per chunk.
+ *
+ * `opts` are the same as for an `Encoder`, with 16-bit or 32-bit float
+ * (`float: true`) input, interleaved if stereo.
+ *
+ * @param {Object} opts PCM format info and encoder options
+ * @param {Number} count number of streams
+ * @api public
+ */
+
+function EncoderGroup (opts, count) {
+  if (!(this instanceof EncoderGroup)) {
+    return new EncoderGroup(opts, count);
+  }
+  if (!opts) opts = {};
+  if (!(count > 0)) throw new Error('"count" must be at least 1');
+
+  // the encoders of a group are set up together and only ever used together
+  opts = Object.assign({}, opts);
+  delete opts.reuse;
+  delete opts.planar;
+
+  this.encoders = [];
+  try {
+    for (var i = 0; i < count; i++) {
+      var encoder = new Encoder(opts);
+      this.encoders.push(encoder);
+      encoder._init();
+    }
+  } catch (e) {
+    this._close();
+    throw e;
+  }
+  var first = this.encoders[0];
+  if (first.inputType !== PCM_TYPE_SHORT_INT && first.inputType !== PCM_TYPE_FLOAT) {
+    this._close();
+    throw new Error('an EncoderGroup takes 16-bit or 32-bit float PCM');
+  }
+  this.count = count;
+  this.inputType = first.inputType;
+  this.channels = first.channels;
+  this.blockAlign = first.blockAlign;
+  this._pending = false;
+}
+
+/**
+ * Encodes `chunks[i]` (a Buffer or TypedArray of whole samples, or `null`
+ * for none) with the i'th encoder, for all of them at once. The `callback`
+ * is invoked with `(err, mp3s)`, an Array of the MP3 data of each stream.
+ *
+ * @param {Array} chunks one chunk of PCM per stream
+ * @param {Function} fn callback function
+ * @api public
+ */
+
+EncoderGroup.prototype.encode = function (chunks, fn) {
+  var self = this;
+  var err = this._check();
+  if (!err && chunks.length != this.count) {
+    err = new Error('expected ' + this.count + ' chunks, got ' + chunks.length);
+  }
+
+  var inputs = [], samples = [], offsets = [], sizes = [];
+  var total = 0;
+  for (var i = 0; !err && i < this.count; i++) {
+    var chunk = chunks[i] ? toBuffer(chunks[i]) : Buffer.alloc(0);
+    if (chunk.length % this.blockAlign !== 0) {
+      err = new Error('chunk ' + i + ' does not hold whole samples');
+      break;
+    }
+    inputs.push(chunk);
+    samples.push(chunk.length / this.blockAlign);
+    offsets.push(total);
+    sizes.push(Encoder.estimateSize(samples[i]));
+    total += sizes[i];
+  }
+  if (err) return process.nextTick(function () { fn(err); });
+
+  var output = Buffer.allocUnsafe(total);
+  debug('encoding %d chunks', this.count);
+  this._pending = true;
+  binding.lame_encode_buffer_group(
+    this.encoders.map(function (encoder) { return encoder.gfp; }),
+    inputs,
+    this.inputType,
+    this.channels,
+    samples,
+    output,
+    offsets,
+    sizes,
+    function (rtn, bytes) {
+      self._pending = false;
+      debug('after lame_encode_buffer_group() (rtn: %d)', rtn);
+      if (rtn < 0) {
+        var err = new Error('error encoding: ' + rtn);
+        err.code = rtn;
+        return fn(err);
+      }
+      fn(null, bytes.map(function (n, i) {
+        return output.slice(offsets[i], offsets[i] + n);
+      }));
+    }
+  );
+};
+
+/**
+ * Ends every stream: flushes what lame still buffers and closes the
+ * encoders. The `callback` is invoked with `(err, mp3s, tags)`, the last
+ * MP3 data of each stream, and its LAME tag frame (or `null`) to write over
+ * the start of its output, as with a `gapless` `Encoder`'s "lametag" event.
+ *
+ * @param {Function} fn callback function
+ * @api public
+ */
+
+EncoderGroup.prototype.end = function (fn) {
+  var self = this;
+  var err = this._check();
+  if (err) return process.nextTick(function () { fn(err); });
+
+  var mp3s = [], tags = [];
+  var left = this.count;
+  var failed = null;
+  this._pending = true;
+  this.encoders.forEach(function (encoder, i) {
+    var output = Buffer.allocUnsafe(7200); // value specified in lame.h
+    binding.lame_encode_flush(encoder.gfp, output, 0, output.length, function (rtn) {
+      if (rtn < 0) {
+        failed = failed || rtn;
+      } else {
+        mp3s[i] = output.slice(0, rtn);
+        tags[i] = binding.lame_get_lametag_frame(encoder.gfp);
+      }
+      if (--left) return;
+      self._pending = false;
+      self._close();
+      if (failed) {
+        var err = new Error('error flushing: ' + failed);
+        err.code = failed;
+        return fn(err);
+      }
+      fn(null, mp3s, tags);
+    });
+  });
+};
+
+/**
+ * Returns an Error if the group is busy or closed.
+ *
+ * @api private
+ */
+
+EncoderGroup.prototype._check = function () {
+  if (this._pending) return new Error('an EncoderGroup call is in progress');
+  if (!this.encoders) return new Error('the EncoderGroup has ended');
+  return null;
+};
+
+/**
+ * Frees the lame encoders.
+ *
+ * @api private
+ */
+
+EncoderGroup.prototype._close = function () {
+  (this.encoders || []).forEach(function (encoder) {
+    if (encoder.gfp) binding.lame_close(encoder.gfp);
+    encoder.gfp = null;
+  });
+  this.encoders = null;
+};
+
+/**
+ * Returns a Buffer view of the Buffer or TypedArray `data` (no copy).
+ *
+ * @api private
+ */
+
+function toBuffer (data) {
+  if (Buffer.isBuffer(data)) return data;
+  if (ArrayBuffer.isView(data)) {
+    return Buffer.from(data.buffer, data.byteOffset, data.byteLength);
+  }
+  throw new TypeError('expected a Buffer or TypedArray, got ' + typeof data);
+}
@@ -0,0 +1,162 @@
+
+/**
+ * The frame index sidecar file format: what `Decoder.scan()` finds out about
+ * an MP3 file, stored so that a `Decoder` can seek in it and knows its length
+ * straight away, without parsing the file again.
+ *
+ * It's a fixed 80-byte header followed by the frame offsets, all little-endian
+ * and every field at its natural alignment, so the file can as well be mapped
+ * into memory and used in place (by C code, say):
+ *
+ *    0  char[4]  magic "MPIX"
+ *    4  uint16   version (1)
+ *    6  uint16   header size (80), where the offsets start
+ *    8  uint32   sample rate
+ *   12  uint16   channels
+ *   14  uint16   samples per frame
+ *   16  uint32   step: the offsets are of every "step"th frame
+ *   20  uint32   number of offsets
+ *   24  uint64   number of frames
+ *   32  uint64   number of samples (gapless: without delay and padding)
+ *   40  int32    encoder delay from the LAME tag, or -1
+ *   44  int32    encoder padding from the LAME tag, or -1
+ *   48  uint64   file size
+ *   56  uint64   audio start: the end of the ID3v2 tag, if any
+ *   64  uint64   audio end: the start of the ID3v1 tag, if any
+ *   72  uint64   reserved (0)
+ *   80  uint64[] byte offsets of frame 0, step, 2 * step, ...
+ */
+
+/**
+ * Module exports.
+ */
+
+exports.serialize = serialize;
+exports.parse = parse;
+exports.extent = extent;
+
+/**
+ * Some constants.
+ */
+
+var MAGIC = 'MPIX';
+var VERSION = 1;
+var HEADER_SIZE = 80;
+
+/**
+ * The 64-bit fields are written and read as two 32-bit halves, which is exact
+ * up to 2^53 (and doesn't need BigInt).
+ *
+ * @api private
+ */
+
+function writeUInt64 (buf, value, offset) {
+  buf.writeUInt32LE(value % 0x100000000, offset);
+  buf.writeUInt32LE(Math.floor(value / 0x100000000), offset + 4);
+}
+
+function readUInt64 (buf, offset) {
+  return buf.readUInt32LE(offset + 4) * 0x100000000 + buf.readUInt32LE(offset);
+}
+
+/**
+ * Returns the byte range of the MPEG audio in an MP3 file, between the ID3v2
+ * tag at its start and the ID3v1 tag at its end (either may be missing), as
+ * `[ start, end ]`.
+ *
+ * @param {Buffer} mp3 The whole MP3 file
+ * @api public
+ */
+
+function extent (mp3) {
+  var start = 0;
+  var end = mp3.length;
+  // "ID3", version, revision, flags and a 28-bit "synchsafe" size
+  if (mp3.length >= 10 && 'ID3' == mp3.toString('latin1', 0, 3)) {
+    start = 10 + ((mp3[6] & 0x7f) << 21 | (mp3[7] & 0x7f) << 14 |
+        (mp3[8] & 0x7f) << 7 | (mp3[9] & 0x7f));
+    // a footer repeats the header
+    if (mp3[5] & 0x10) start += 10;
+    start = Math.min(start, mp3.length);
+  }
+  if (end - start >= 128 && 'TAG' == mp3.toString('latin1', end - 128, end - 125)) {
+    end -= 128;
+  }
+  return [ start, end ];
+}
+
+/**
+ * Serializes a frame index, as `Decoder.scan()` gives it, into a sidecar file.
+ *
+ * @param {Object} index The frame index
+ * @return {Buffer} The sidecar file
+ * @api public
+ */
+
+function serialize (index) {
+  var count = index.offsets.length;
+  var buf = Buffer.alloc(HEADER_SIZE + count * 8);
+  buf.write(MAGIC, 0, 'latin1');
+  buf.writeUInt16LE(VERSION, 4);
+  buf.writeUInt16LE(HEADER_SIZE, 6);
+  buf.writeUInt32LE(index.sampleRate || 0, 8);
+  buf.writeUInt16LE(index.channels || 0, 12);
+  buf.writeUInt16LE(index.spf || 0, 14);
+  buf.writeUInt32LE(index.step, 16);
+  buf.writeUInt32LE(count, 20);
+  writeUInt64(buf, index.frames || 0, 24);
+  writeUInt64(buf, index.samples || 0, 32);
+  buf.writeInt32LE(null == index.encoderDelay ? -1 : index.encoderDelay, 40);
+  buf.writeInt32LE(null == index.encoderPadding ? -1 : index.encoderPadding, 44);
+  writeUInt64(buf, index.fileSize || 0, 48);
+  writeUInt64(buf, index.audioStart || 0, 56);
+  writeUInt64(buf, index.audioEnd || 0, 64);
+  for (var i = 0; i < count; i++) {
+    writeUInt64(buf, index.offsets[i], HEADER_SIZE + i * 8);
+  }
+  return buf;
+}
+
+/**
+ * Parses a sidecar file back into a frame index, for the "index" option of a
+ * `Decoder`. Throws if it isn't one.
+ *
+ * @param {Buffer} buf The sidecar file
+ * @return {Object} The frame index
+ * @api public
+ */
+
+function parse (buf) {
+  if (buf.length < HEADER_SIZE || MAGIC != buf.toString('latin1', 0, 4)) {
+    throw new Error('not a frame index file');
+  }
+  var version = buf.readUInt16LE(4);
+  if (VERSION != version) {
+    throw new Error('unsupported frame index version: ' + version);
+  }
+  var headerSize = buf.readUInt16LE(6);
+  var count = buf.readUInt32LE(20);
+  if (headerSize < HEADER_SIZE || buf.length < headerSize + count * 8) {
+    throw new Error('truncated frame index file');
+  }
+  var offsets = new Array(count);
+  for (var i = 0; i < count; i++) {
+    offsets[i] = readUInt64(buf, headerSize + i * 8);
+  }
+  var delay = buf.readInt32LE(40);
+  var padding = buf.readInt32LE(44);
+  return {
+    step: buf.readUInt32LE(16),
+    offsets: offsets,
+    frames: readUInt64(buf, 24),
+    spf: buf.readUInt16LE(14),
+    sampleRate: buf.readUInt32LE(8),
+    channels: buf.readUInt16LE(12),
+    samples: readUInt64(buf, 32),
+    encoderDelay: delay < 0 ? null : delay,
+    encoderPadding: padding < 0 ? null : padding,
+    fileSize: readUInt64(buf, 48),
+    audioStart: readUInt64(buf, 56),
+    audioEnd: readUInt64(buf, 64)
+  };
+}
@@ -0,0 +1,169 @@
+
+/**
+ * Module dependencies.
+ */
+
+var debug = require('debug')('lame:handlepool');
+
+/**
+ * Module exports.
+ */
+
+module.exports = HandlePool;
+
+/**
+ * Default number of idle handles that a pool keeps.
+ */
+
+var MAX_IDLE = 16;
+
+/**
+ * Default number of milliseconds after which an idle handle is freed.
+ */
+
+var IDLE_TIMEOUT = 30000;
+
+/**
+ * A pool of idle native handles (`lame_global_flags`, `mpg123_handle`) that
+ * are set up and ready for another stream, keyed by the configuration that
+ * they were set up with. A stream that is done hands its handle back with
+ * `release()`, and the next stream of the same configuration gets it from
+ * `acquire()` instead of allocating and setting up a new one.
+ *
+ * At most `max` handles are kept idle (of all the configurations together);
+ * handles released past that are freed with the `close` function, and so are
+ * handles that have been idle for `idleTimeout` milliseconds (0 keeps them).
+ * Both may be changed at any time.
+ *
+ * @param {Function} close frees a handle
+ * @param {Object} opts `max` idle handles, `idleTimeout`
+ * @api private
+ */
+
+function HandlePool (close, opts) {
+  this.close = close;
+  this.max = opts && null != opts.max ? opts.max : MAX_IDLE;
+  this.idleTimeout = opts && null != opts.idleTimeout ? opts.idleTimeout : IDLE_TIMEOUT;
+  this.idle = Object.create(null);
+  this.size = 0;
+  this.hits = 0;
+  this.misses = 0;
+  this.timer = null;
+}
+
+/**
+ * Returns an idle handle of configuration `key`, or `null` if there is none
+ * (and a new one must be set up by the caller).
+ *
+ * @param {String} key
+ * @return {External} handle
+ * @api private
+ */
+
+HandlePool.prototype.acquire = function (key) {
+  var list = this.idle[key];
+  if (!list) {
+    this.misses++;
+    return null;
+  }
+  // the most recently released one, so that the others can time out
+  var handle = list.pop().handle;
+  if (!list.length) delete this.idle[key];
+  this.size--;
+  this.hits++;
+  debug('reusing a %j handle (%d idle)', key, this.size);
+  return handle;
+};
+
+/**
+ * Hands back `handle` of configuration `key`, ready for another stream.
+ *
+ * @param {String} key
+ * @param {External} handle
+ * @api private
+ */
+
+HandlePool.prototype.release = function (key, handle) {
+  if (this.size >= this.max) {
+    debug('closing a %j handle, %d are idle already', key, this.size);
+    this.close(handle);
+    return;
+  }
+  (this.idle[key] || (this.idle[key] = [])).push({ handle: handle, time: Date.now() });
+  this.size++;
+  if (this.idleTimeout > 0 && !this.timer) {
+    this.timer = setInterval(this.trim.bind(this), this.idleTimeout);
+    // idle handles don't keep the process running
+    if (this.timer.unref) this.timer.unref();
+  }
+};
+
+/**
+ * Frees the handles that have been idle for `idleTimeout` milliseconds or
+ * longer. Called by a timer every `idleTimeout` while there are idle handles.
+ *
+ * @api private
+ */
+
+HandlePool.prototype.trim = function () {
+  var before = Date.now() - this.idleTimeout;
+  var closed = 0;
+  for (var key in this.idle) {
+    var list = this.idle[key];
+    // released in order, so the ones that timed out are at the front
+    var n = 0;
+    while (n < list.length && list[n].time <= before) this.close(list[n++].handle);
+    if (n == list.length) delete this.idle[key];
+    else list.splice(0, n);
+    closed += n;
+  }
+  this.size -= closed;
+  if (closed) debug('closed %d handles idle for %dms (%d idle)', closed, this.idleTimeout, this.size);
+  if (!this.size || !(this.idleTimeout > 0)) this._stopTimer();
+};
+
+/**
+ * Stops the trim() timer.
+ *
+ * @api private
+ */
+
+HandlePool.prototype._stopTimer = function () {
+  if (this.timer) clearInterval(this.timer);
+  this.timer = null;
+};
+
+/**
+ * Frees all the idle handles.
+ *
+ * @api public
+ */
+
+HandlePool.prototype.clear = function () {
+  var idle = this.idle;
+  var close = this.close;
+  this.idle = Object.create(null);
+  this.size = 0;
+  this._stopTimer();
+  Object.keys(idle).forEach(function (key) {
+    idle[key].forEach(function (entry) { close(entry.handle); });
+  });
+};
+
+/**
+ * Returns the number of `hits` (handles reused) and `misses` (handles set up
+ * anew) so far, the number of `idle` handles, and the `max` and `idleTimeout`.
+ *
+ * @return {Object}
+ * @api public
+ */
+
+HandlePool.prototype.stats = function () {
+  return {
+    hits: this.hits,
+    misses: this.misses,
+    idle: this.size,
+    max: this.max,
+    idleTimeout: this.idleTimeout
+  };
+};
@@ -0,0 +1,498 @@
+/**
+ * Module dependencies.
+ */
+
+var binding = require('./bindings');
+var Encoder = require('./encoder');
+require('./decoder'); // mpg123_init()
+var debug = require('debug')('lame:parallel');
+
+/**
+ * Module exports.
+ */
+
+exports.encode = encode;
+exports.decode = decode;
+exports.frames = frames;
+
+/**
+ * Number of frames each segment encodes before the first frame it keeps, so
+ * that the MDCT overlap and the psychoacoustic model have warmed up by then.
+ */
+
+var PREROLL = 4;
+
+/**
+ * Number of frames of PCM each segment gets past the last frame it keeps,
+ * so that lame's lookahead sees the same input as a serial encode would.
+ */
+
+var TAIL = 2;
+
+/**
+ * Segments are never shorter than this many frames (about 5 seconds), so the
+ * pre-roll stays a small fraction of the work.
+ */
+
+var MIN_SEGMENT_FRAMES = 200;
+
+/**
+ * Number of frames fed to `lame_encode_buffer()` per call.
+ */
+
+var CHUNK_FRAMES = 256;
+
+/**
+ * Bytes of MP3 data fed to each decoder range at a time.
+ */
+
+var DECODE_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * The most bytes that the ID3v2 tag and Xing/LAME frame can be followed by
+ * before the first audio frame is complete (the largest MPEG frame is 2881
+ * bytes).
+ */
+
+var MAX_FRAME_SIZE = 2881;
+
+/**
+ * Some mpg123 constants.
+ */
+
+var MPG123_OK = binding.MPG123_OK;
+var MPG123_DONE = binding.MPG123_DONE;
+var MPG123_NEED_MORE = binding.MPG123_NEED_MORE;
+var MPG123_PREFRAMES = binding.MPG123_PREFRAMES;
+var SEEK_SET = binding.SEEK_SET;
+
+/**
+ * Bitrates and sample rates by MPEG version (index 1 is MPEG 1, 0 is MPEG 2
+ * and 2 is MPEG 2.5, like lame's own tables).
+ */
+
+var BITRATES = binding.lame_bitrates();
+var SAMPLERATES = binding.lame_samplerates();
+var VERSIONS = [ 2, -1, 0, 1 ];
+
+/**
+ * Encodes all of the PCM in `pcm` into a single MP3 file, spread over the
+ * audio worker pool.
+ *
+ * The input is cut into frame-aligned segments that are encoded at the same
+ * time, each by its own lame encoder. A segment starts encoding `PREROLL`
+ * frames early and stops using the bit reservoir right before the first
+ * frame it keeps, so that frame doesn't depend on anything before it. The
+ * kept frames of every segment are joined, and the Xing/LAME tag is rebuilt
+ * for the joined stream.
+ *
+ * When lame resamples, the input can't be cut at frame boundaries, so there
+ * is just one segment and no parallelism. How the encode scales with the
+ * pool size has only been measured on one core (`bench/encoder-parallel.js`).
+ *
+ * `opts` are the same as for an `Encoder`, plus:
+ *
+ *   - `segments`: number of segments (default: based on the pool size)
+ *
+ * @param {Buffer} pcm raw PCM data, in the format described by `opts`
+ * @param {Object} opts PCM format info and encoder options
+ * @param {Function} fn callback function, called with `(err, mp3)`
+ * @api public
+ */
+
+function encode (pcm, opts, fn) {
+  if ('function' == typeof opts) {
+    fn = opts;
+    opts = {};
+  }
+  if (!opts) opts = {};
+
+  // the segments' encoders are set up each for its own part of the input
+  // (with a reservoir barrier), so they aren't reused
+  if (opts.reuse) {
+    opts = Object.assign({}, opts);
+    delete opts.reuse;
+  }
+
+  // the first segment's encoder tells us the frame size of the output
+  var first;
+  try {
+    first = new Encoder(opts);
+    first._init();
+  } catch (e) {
+    if (first) binding.lame_close(first.gfp);
+    return process.nextTick(function () { fn(e); });
+  }
+  var writeVbrTag = !!first.writeVbrTag;
+
+  var blockAlign = first.blockAlign;
+  var total = Math.floor(pcm.length / blockAlign);
+  var frameSize = first.outSampleRate < 32000 ? 576 : 1152;
+  var numFrames = Math.ceil(total / frameSize);
+
+  // segments must start on a frame boundary of the *input*, so when lame has
+  // to resample there is only one segment
+  var count = opts.segments;
+  if (first.outSampleRate != first.sampleRate) {
+    count = 1;
+  } else if (!count) {
+    count = Math.min(Math.ceil(numFrames / MIN_SEGMENT_FRAMES), binding.pool_size * 4);
+  }
+  count = Math.max(1, Math.min(count, numFrames));
+  var per = Math.ceil(numFrames / count);
+  count = Math.max(1, Math.ceil(numFrames / per));
+  debug('encoding %d frames in %d segments of %d frames', numFrames, count, per);
+
+  var segments = [];
+  for (var i = 0; i < count; i++) {
+    var keepFrom = i * per;
+    var start = Math.max(0, keepFrom - PREROLL);
+    var last = i == count - 1;
+    var end = last ? total : Math.min(total, (keepFrom + per + TAIL) * frameSize);
+    segments.push({
+      index: i,
+      skip: keepFrom - start,
+      keep: last ? Infinity : per,
+      pcm: pcm.slice(start * frameSize * blockAlign, end * blockAlign),
+      encoder: i == 0 ? first : null,
+      output: null
+    });
+  }
+
+  // the encoders can only be closed once none of them is on a worker anymore
+  var pending = count;
+  var error = null;
+  segments.forEach(function (seg) {
+    encodeSegment(seg, opts, done);
+  });
+
+  function done (err) {
+    if (err && !error) error = err;
+    if (--pending > 0) return;
+    if (error) {
+      segments.forEach(close);
+      return fn(error);
+    }
+
+    // the last segment's encoder writes the tag, since only it knows the
+    // padding at the end of the stream
+    var tagEncoder = segments[count - 1].encoder;
+    var tag = null;
+    var mp3;
+    try {
+      mp3 = join(segments, writeVbrTag ? tagLength(tagEncoder) : 0);
+      if (writeVbrTag) {
+        if (binding.lame_rescan_lametag(tagEncoder.gfp, mp3) < 0) {
+          throw new Error('failed to rebuild the LAME tag');
+        }
+        tag = binding.lame_get_lametag_frame(tagEncoder.gfp);
+      }
+    } catch (e) {
+      error = e;
+    }
+    segments.forEach(close);
+    if (error) return fn(error);
+    fn(null, tag ? Buffer.concat([ tag, mp3 ]) : mp3);
+  }
+}
+
+/**
+ * Frees a segment's lame encoder.
+ *
+ * @api private
+ */
+
+function close (seg) {
+  if (seg.encoder && seg.encoder.gfp) {
+    binding.lame_close(seg.encoder.gfp);
+    seg.encoder.gfp = null;
+  }
+}
+
+/**
+ * Decodes a whole MP3 file in `mp3` into PCM, spread over the audio worker
+ * pool.
+ *
+ * One pass over the file parses (but doesn't decode) every frame, which
+ * builds libmpg123's frame index. The output is then split into ranges of
+ * whole frames that are decoded at the same time, each on its own
+ * `mpg123_handle`: a range handle reads the stream header (for the gapless
+ * info), gets the scanned frame index, and seeks to the first sample of its
+ * range with `mpg123_feedseek()`. libmpg123 itself decodes and throws away a
+ * few frames before that (MPG123_PREFRAMES), which refills the bit reservoir
+ * and the synthesis overlap, so every range starts on the exact sample the
+ * previous one ended on. The output is identical to decoding it serially.
+ *
+ * `opts`:
+ *
+ *   - `ranges`: number of ranges (default: based on the pool size)
+ *   - `preframes`: frames decoded before each range (default: enough for the
+ *     largest `main_data_begin` at the file's average frame size, at least 4)
+ *   - `decoder`: the mpg123 decoder to use
+ *
+ * @param {Buffer} mp3 a complete MP3 file
+ * @param {Object} opts options
+ * @param {Function} fn callback function, called with `(err, pcm, format)`
+ * @api public
+ */
+
+function decode (mp3, opts, fn) {
+  if ('function' == typeof opts) {
+    fn = opts;
+    opts = {};
+  }
+  if (!opts) opts = {};
+
+  var scan;
+  try {
+    scan = open(opts);
+  } catch (e) {
+    return process.nextTick(function () { fn(e); });
+  }
+
+  binding.mpg123_feed_and_scan(scan, mp3, mp3.length, function (ret, numFrames) {
+    if (ret != MPG123_NEED_MORE && ret != MPG123_DONE) {
+      return fn(new Error('mpg123_feed_and_scan() failed: ' + ret));
+    }
+    var format = binding.mpg123_getformat(scan);
+    var index = binding.mpg123_index(scan);
+    var spf = binding.mpg123_spf(scan);
+    if ('number' == typeof format || 'number' == typeof index || numFrames < 1) {
+      return fn(new Error('no MPEG audio frames found'));
+    }
+    var blockAlign = format.channels * binding.mpg123_encsize(format.raw_encoding);
+    var first = index.offsets.length > 0 ? index.offsets[0] : 0;
+
+    // enough frames before a range to hold the largest main_data_begin (511
+    // bytes), plus the one frame that layer 3 needs for the overlap
+    var preframes = opts.preframes;
+    if (!preframes && index.offsets.length > 1) {
+      var frameSize = (index.offsets[index.offsets.length - 1] - first) / ((index.offsets.length - 1) * index.step);
+      preframes = Math.max(4, Math.ceil(511 / frameSize) + 1);
+    }
+
+    var count = opts.ranges;
+    if (!count) {
+      count = Math.min(Math.ceil(numFrames / MIN_SEGMENT_FRAMES), binding.pool_size * 4);
+    }
+    count = Math.max(1, Math.min(count, Math.floor(numFrames / 8)));
+    var per = Math.ceil(numFrames / count);
+    count = Math.max(1, Math.ceil(numFrames / per));
+    debug('decoding %d frames in %d ranges of %d frames', numFrames, count, per);
+
+    var ranges = [];
+    for (var i = 0; i < count; i++) {
+      ranges.push({
+        index: i,
+        start: i * per * spf,
+        // the last range goes to the end of the stream
+        samples: i == count - 1 ? Infinity : per * spf,
+        output: null
+      });
+    }
+
+    var pending = count;
+    var error = null;
+    ranges.forEach(function (range) {
+      decodeRange(range, done);
+    });
+
+    function done (err) {
+      if (err && !error) error = err;
+      if (--pending > 0) return;
+      if (error) return fn(error);
+      fn(null, Buffer.concat(ranges.map(function (r) { return r.output; })), format);
+    }
+
+    function decodeRange (range, done) {
+      var mh;
+      try {
+        mh = open(opts);
+      } catch (e) {
+        return process.nextTick(function () { done(e); });
+      }
+      if (preframes) binding.mpg123_param(mh, MPG123_PREFRAMES, preframes, 0);
+      var need = range.samples * blockAlign;
+      var bufs = [];
+      var length = 0;
+      var offset = Math.min(mp3.length, first + MAX_FRAME_SIZE);
+
+      // the stream header: ID3v2 tag, LAME tag and the first audio frame
+      binding.mpg123_feed(mh, mp3, offset, function (ret) {
+        if (MPG123_OK != ret) return done(new Error('mpg123_feed() failed: ' + ret));
+        binding.mpg123_set_index(mh, index.offsets, index.step);
+        var seek = binding.mpg123_feedseek(mh, range.start, SEEK_SET);
+        if ('number' == typeof seek) {
+          return done(new Error('mpg123_feedseek() failed: ' + seek));
+        }
+        debug('range %d starts at sample %d, byte %d', range.index, seek[0], seek[1]);
+        offset = seek[1];
+        feed();
+      });
+
+      function feed () {
+        var end = Math.min(mp3.length, offset + DECODE_CHUNK_SIZE);
+        var chunk = mp3.slice(offset, end);
+        offset = end;
+        binding.mpg123_feed_and_drain(mh, chunk, chunk.length, afterDrain, false);
+      }
+
+      function afterDrain (ret, pcm) {
+        if (pcm) {
+          bufs.push(pcm);
+          length += pcm.length;
+        }
+        if (ret == MPG123_OK) {
+          return binding.mpg123_feed_and_drain(mh, null, 0, afterDrain, false);
+        }
+        if (ret != MPG123_NEED_MORE && ret != MPG123_DONE) {
+          return done(new Error('mpg123_feed_and_drain() failed: ' + ret));
+        }
+        if (length < need && ret != MPG123_DONE && offset < mp3.length) {
+          return feed();
+        }
+        var output = Buffer.concat(bufs, length);
+        range.output = length > need ? output.slice(0, need) : output;
+        debug('range %d done (%d bytes)', range.index, range.output.length);
+        done();
+      }
+    }
+  });
+}
+
+/**
+ * Creates a new `mpg123_handle` for feeding.
+ *
+ * @api private
+ */
+
+function open (opts) {
+  var mh = binding.mpg123_new(opts.decoder);
+  if ('number' == typeof mh) {
+    throw new Error('mpg123_new() failed: ' + mh);
+  }
+  var ret = binding.mpg123_open_feed(mh);
+  if (MPG123_OK != ret) {
+    throw new Error('mpg123_open_feed() failed: ' + ret);
+  }
+  return mh;
+}
+
+/**
+ * Encodes one segment, `CHUNK_FRAMES` at a time, and flushes it.
+ *
+ * @api private
+ */
+
+function encodeSegment (seg, opts, fn) {
+  var encoder = seg.encoder;
+  if (!encoder) {
+    try {
+      encoder = seg.encoder = new Encoder(opts);
+      // the frame before the first kept one leaves the reservoir empty
+      if (seg.skip > 0) encoder.reservoirBarrier = seg.skip - 1;
+      encoder._init();
+    } catch (e) {
+      return process.nextTick(function () { fn(e); });
+    }
+  }
+
+  var blockAlign = encoder.blockAlign;
+  var chunkSize = CHUNK_FRAMES * 1152;
+  var out = new Buffer(Encoder.estimateSize(chunkSize));
+  var bufs = [];
+  var offset = 0;
+
+  function collect (bytes) {
+    if (bytes < 0) {
+      var err = new Error('encoding segment ' + seg.index + ' failed: ' + bytes);
+      err.code = bytes;
+      fn(err);
+      return false;
+    }
+    if (bytes > 0) {
+      var b = new Buffer(bytes);
+      out.copy(b, 0, 0, bytes);
+      bufs.push(b);
+    }
+    return true;
+  }
+
+  (function next () {
+    var samples = Math.min(chunkSize, seg.pcm.length / blockAlign - offset);
+    if (samples <= 0) {
+      return binding.lame_encode_flush(encoder.gfp, out, 0, out.length, function (bytes) {
+        if (!collect(bytes)) return;
+        seg.output = Buffer.concat(bufs);
+        seg.pcm = null;
+        debug('segment %d done (%d bytes)', seg.index, seg.output.length);
+        fn();
+      });
+    }
+    var chunk = seg.pcm.slice(offset * blockAlign, (offset + samples) * blockAlign);
+    offset += samples;
+    binding.lame_encode_buffer(encoder.gfp, chunk, encoder.inputType,
+      encoder.channels, samples, out, 0, out.length, function (bytes) {
+        if (collect(bytes)) next();
+      });
+  })();
+}
+
+/**
+ * Returns the size of the placeholder tag frame that every segment's output
+ * starts with.
+ *
+ * @api private
+ */
+
+function tagLength (encoder) {
+  var tag = binding.lame_get_lametag_frame(encoder.gfp);
+  return tag ? tag.length : 0;
+}
+
+/**
+ * Concatenates the frames that each segment keeps.
+ *
+ * @api private
+ */
+
+function join (segments, tagBytes) {
+  var parts = segments.map(function (seg, i) {
+    var out = seg.output.slice(tagBytes);
+    var offsets = frames(out);
+    var from = seg.skip;
+    var to = seg.keep == Infinity ? offsets.length - 1 : from + seg.keep;
+    if (to >= offsets.length) {
+      throw new Error('segment ' + i + ' is ' + (to - offsets.length + 1) + ' frames short');
+    }
+    return out.slice(offsets[from], offsets[to]);
+  });
+  return Buffer.concat(parts);
+}
+
+/**
+ * Returns the byte offset of every MP3 frame in `buf`, plus the offset just
+ * past the last one.
+ *
+ * @param {Buffer} buf a stream of layer III frames (no tags)
+ * @return {Array} frame offsets
+ * @api private
+ */
+
+function frames (buf) {
+  var offsets = [];
+  var pos = 0;
+  while (pos + 4 <= buf.length) {
+    var version = VERSIONS[(buf[pos + 1] >> 3) & 3];
+    if (buf[pos] != 0xff || (buf[pos + 1] & 0xe6) != 0xe2 || version < 0) {
+      throw new Error('lost MP3 frame sync at byte ' + pos);
+    }
+    var kbps = BITRATES[version][buf[pos + 2] >> 4];
+    var rate = SAMPLERATES[version][(buf[pos + 2] >> 2) & 3];
+    if (!kbps || !rate) throw new Error('bad MP3 frame header at byte ' + pos);
+    offsets.push(pos);
+    pos += Math.floor((version == 1 ? 144000 : 72000) * kbps / rate) + ((buf[pos + 2] >> 1) & 1);
+  }
+  offsets.push(pos);
+  return offsets;
+}
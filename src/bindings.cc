@@ -14,25 +14,21 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <v8.h>
-#include <node.h>
-#include "nan.h"
-
-using namespace v8;
-using namespace node;
+#include <node_api.h>
+#include "node_pool.h"
 
 namespace nodelame {
 
-void InitLame(Handle<Object>);
-void InitMPG123(Handle<Object>);
-
-void Initialize(Handle<Object> target) {
-  Nan::HandleScope scope;
+void InitLame(napi_env, napi_value);
+void InitMPG123(napi_env, napi_value);
 
-  InitLame(target);
-  InitMPG123(target);
+napi_value Initialize(napi_env env, napi_value target) {
+  InitPool(env, target);
+  InitLame(env, target);
+  InitMPG123(env, target);
+  return target;
 }
 
 } // nodelame namespace
 
-NODE_MODULE(bindings, nodelame::Initialize);
+NAPI_MODULE(NODE_GYP_MODULE_NAME, nodelame::Initialize)
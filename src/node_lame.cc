@@ -14,16 +14,13 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <v8.h>
-#include <node.h>
-#include <node_buffer.h>
+#include <node_api.h>
+#include "node_napi.h"
 #include "node_pointer.h"
+#include "node_pool.h"
 #include "node_lame.h"
 #include "lame.h"
-#include "nan.h"
 
-using namespace v8;
-using namespace node;
 using namespace nodelame;
 
 namespace nodelame {
@@ -31,70 +28,138 @@ namespace nodelame {
 #define PASTE2(a, b) a##b
 #define PASTE(a, b) PASTE2(a, b)
 
-#define UNWRAP_GFP \
-  Nan::HandleScope scope; \
-  lame_global_flags *gfp = reinterpret_cast<lame_global_flags *>(UnwrapPointer(info[0]));
+#define UNWRAP_GFP(n) \
+  NAPI_ARGS(n); \
+  lame_global_flags *gfp = reinterpret_cast<lame_global_flags *>(UnwrapPointer(env, argv[0]));
 
-#define FN(type, v8type, fn) \
-NAN_METHOD(PASTE(node_lame_get_, fn)) { \
-  UNWRAP_GFP; \
+#define GET_FN(type, fn) \
+NAPI_METHOD(PASTE(node_lame_get_, fn)) { \
+  UNWRAP_GFP(1); \
   type output = PASTE(lame_get_, fn)(gfp); \
-  info.GetReturnValue().Set(Nan::New<Number>(output)); \
-} \
-NAN_METHOD(PASTE(node_lame_set_, fn)) { \
-  UNWRAP_GFP; \
-  type input = (type)info[1]->PASTE(v8type, Value)(); \
+  return NewNumber(env, output); \
+}
+
+#define FN(type, napitype, fn) \
+GET_FN(type, fn) \
+NAPI_METHOD(PASTE(node_lame_set_, fn)) { \
+  UNWRAP_GFP(2); \
+  type input = (type)PASTE(To, napitype)(env, argv[1]); \
   int output = PASTE(lame_set_, fn)(gfp, input); \
-  info.GetReturnValue().Set(Nan::New<Number>(output)); \
+  return NewNumber(env, output); \
 }
 
 /* get_lame_version() */
-NAN_METHOD(node_get_lame_version) {
-  info.GetReturnValue().Set(Nan::New<String>(get_lame_version()).ToLocalChecked());
+NAPI_METHOD(node_get_lame_version) {
+  return NewString(env, get_lame_version());
 }
 
 
 /* get_lame_os_bitness() */
-NAN_METHOD(node_get_lame_os_bitness) {
-  info.GetReturnValue().Set(Nan::New<String>(get_lame_os_bitness()).ToLocalChecked());
+NAPI_METHOD(node_get_lame_os_bitness) {
+  return NewString(env, get_lame_os_bitness());
 }
 
 
 /* lame_close() */
-NAN_METHOD(node_lame_close) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_close) {
+  UNWRAP_GFP(1);
   lame_close(gfp);
+  return NULL;
 }
 
 
 /* malloc()'s a `lame_t` struct and returns it to JS land */
-NAN_METHOD(node_lame_init) {
+NAPI_METHOD(node_lame_init) {
 
   lame_global_flags *gfp = lame_init();
-  if (gfp == NULL) return info.GetReturnValue().SetNull();
+  if (gfp == NULL) return Null(env);
+
+  return WrapPointer(env, gfp);
+}
+
+
+/* The "encode_req" pool.
+ * Every encode and flush call needs a request struct for the worker pool, so
+ * rather than new/delete one per call, finished requests are pushed onto a
+ * free list and handed out again. Each JS thread gets its own free list. */
+static thread_local encode_req *encode_req_pool = NULL;
+static thread_local int encode_req_pool_size = 0;
+
+encode_req *encode_req_acquire () {
+  encode_req *r = encode_req_pool;
+  if (r != NULL) {
+    encode_req_pool = r->next;
+    encode_req_pool_size--;
+  } else {
+    r = new encode_req;
+  }
+  r->next = NULL;
+  r->input = NULL;
+  r->input_right = NULL;
+  r->channels = 0;
+  r->num_samples = 0;
+  r->rtn = 0;
+  r->callback = NULL;
+  r->input_ref = NULL;
+  r->input_right_ref = NULL;
+  r->output_ref = NULL;
+  return r;
+}
+
+void encode_req_release (napi_env env, encode_req *r) {
+  Unpersist(env, &r->callback);
+  Unpersist(env, &r->input_ref);
+  Unpersist(env, &r->input_right_ref);
+  Unpersist(env, &r->output_ref);
+  if (encode_req_pool_size >= ENCODE_REQ_POOL_MAX) {
+    delete r;
+    return;
+  }
+  r->next = encode_req_pool;
+  encode_req_pool = r;
+  encode_req_pool_size++;
+}
+
 
-  Nan::MaybeLocal<v8::Object> wrapper = WrapPointer((char *)gfp);
-  info.GetReturnValue().Set(wrapper.ToLocalChecked());
+/* table_cache_stats()
+ * Returns the number and total size of the read-only tables that the encoders
+ * of the same configuration share */
+NAPI_METHOD(node_table_cache_stats) {
+  int tables = 0;
+  size_t bytes = 0;
+  lame_get_table_cache_stats(&tables, &bytes);
+
+  napi_value rtn;
+  napi_create_object(env, &rtn);
+  Set(env, rtn, "tables", NewInt32(env, tables));
+  Set(env, rtn, "bytes", NewNumber(env, (double)bytes));
+  return rtn;
+}
+
+
+/* returns the number of idle "encode_req" instances in the pool */
+NAPI_METHOD(node_encode_req_pool_size) {
+  return NewInt32(env, encode_req_pool_size);
 }
 
 
 /* lame_encode_buffer_interleaved()
  * The main encoding function */
-NAN_METHOD(node_lame_encode_buffer) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_encode_buffer) {
+  UNWRAP_GFP(9);
 
   // the input buffer
-  char *input = UnwrapPointer(info[1]);
-  pcm_type input_type = static_cast<pcm_type>(Nan::To<int32_t>(info[2]).FromMaybe(0));
-  int32_t channels = Nan::To<int32_t>(info[3]).FromMaybe(0);
-  int32_t num_samples = Nan::To<int32_t>(info[4]).FromMaybe(0);
+  char *input = UnwrapPointer(env, argv[1]);
+  pcm_type input_type = static_cast<pcm_type>(ToInt32(env, argv[2]));
+  int32_t channels = ToInt32(env, argv[3]);
+  int32_t num_samples = ToInt32(env, argv[4]);
 
   // the output buffer
-  int out_offset = Nan::To<int32_t>(info[6]).FromMaybe(0);
-  char *output = UnwrapPointer(info[5], out_offset);
-  int output_size = Nan::To<int32_t>(info[7]).FromMaybe(0);
+  int out_offset = ToInt32(env, argv[6]);
+  char *output = UnwrapPointer(env, argv[5], out_offset);
+  int output_size = ToInt32(env, argv[7]);
 
-  encode_req *request = new encode_req;
+  encode_req *request = encode_req_acquire();
   request->gfp = gfp;
   request->input = (unsigned char *)input;
   request->input_type = input_type;
@@ -102,23 +167,68 @@ NAN_METHOD(node_lame_encode_buffer) {
   request->num_samples = num_samples;
   request->output = (unsigned char *)output;
   request->output_size = output_size;
-  request->callback.Reset(info[8].As<Function>());
+  request->callback = Persist(env, argv[8]);
+  request->input_ref = Persist(env, argv[1]);
+  request->output_ref = Persist(env, argv[5]);
 
-  // set a circular pointer so we can get the "encode_req" back later
-  request->req.data = request;
-
-  uv_queue_work(uv_default_loop(), &request->req,
+  if (pool_queue(env, gfp, &request->work,
       node_lame_encode_buffer_async,
-      (uv_after_work_cb)node_lame_encode_buffer_after);
+      node_lame_encode_buffer_after,
+      node_lame_encode_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
 }
 
 
-/* encode a buffer on the thread pool. */
-void node_lame_encode_buffer_async (uv_work_t *req) {
-  encode_req *r = (encode_req *)req->data;
+/* lame_encode_buffer() / lame_encode_buffer_ieee_float() / _ieee_double()
+ * Encodes planar input: the left and right channels are separate buffers (or
+ * two regions of one), handed to lame as they are, with no deinterleaving.
+ * "right" is `null` for mono. */
+NAPI_METHOD(node_lame_encode_buffer_planar) {
+  UNWRAP_GFP(12);
 
+  // the input buffers
+  char *left = UnwrapPointer(env, argv[1], ToInt32(env, argv[2]));
+  char *right = UnwrapPointer(env, argv[3], ToInt32(env, argv[4]));
+  pcm_type input_type = static_cast<pcm_type>(ToInt32(env, argv[5]));
+  int32_t channels = ToInt32(env, argv[6]);
+  int32_t num_samples = ToInt32(env, argv[7]);
+
+  // the output buffer
+  int out_offset = ToInt32(env, argv[9]);
+  char *output = UnwrapPointer(env, argv[8], out_offset);
+  int output_size = ToInt32(env, argv[10]);
+
+  encode_req *request = encode_req_acquire();
+  request->gfp = gfp;
+  request->input = (unsigned char *)left;
+  request->input_right = (unsigned char *)right;
+  request->input_type = input_type;
+  request->channels = channels;
+  request->num_samples = num_samples;
+  request->output = (unsigned char *)output;
+  request->output_size = output_size;
+  request->callback = Persist(env, argv[11]);
+  request->input_ref = Persist(env, argv[1]);
+  if (right != NULL) request->input_right_ref = Persist(env, argv[3]);
+  request->output_ref = Persist(env, argv[8]);
+
+  if (pool_queue(env, gfp, &request->work,
+      node_lame_encode_buffer_async,
+      node_lame_encode_buffer_after,
+      node_lame_encode_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
+}
+
+
+/* encode a buffer on the worker pool. */
+void node_lame_encode_buffer_async (pool_work *req) {
+  encode_req *r = (encode_req *)req;
   if (r->input_type == PCM_TYPE_SHORT_INT) {
-    if (r->channels > 1) {
+    if (r->channels > 1 && r->input_right == NULL) {
       // encoding short int interleaved input buffer
       r->rtn = lame_encode_buffer_interleaved(
         r->gfp,
@@ -128,18 +238,18 @@ void node_lame_encode_buffer_async (uv_work_t *req) {
         r->output_size
       );
     } else {
-      // encoding short int input buffer
+      // encoding short int input buffer(s)
       r->rtn = lame_encode_buffer(
         r->gfp,
         (short int *)r->input,
-        NULL,
+        (short int *)r->input_right,
         r->num_samples,
         r->output,
         r->output_size
       );
     }
   } else if (r->input_type == PCM_TYPE_FLOAT) {
-    if (r->channels > 1) {
+    if (r->channels > 1 && r->input_right == NULL) {
       // encoding float interleaved input buffer
       r->rtn = lame_encode_buffer_interleaved_ieee_float(
         r->gfp,
@@ -149,18 +259,18 @@ void node_lame_encode_buffer_async (uv_work_t *req) {
         r->output_size
       );
     } else {
-      // encoding float input buffer
+      // encoding float input buffer(s)
       r->rtn = lame_encode_buffer_ieee_float(
         r->gfp,
         (float *)r->input,
-        NULL,
+        (float *)r->input_right,
         r->num_samples,
         r->output,
         r->output_size
       );
     }
   } else if (r->input_type == PCM_TYPE_DOUBLE) {
-    if (r->channels > 1) {
+    if (r->channels > 1 && r->input_right == NULL) {
       // encoding double interleaved input buffer
       r->rtn = lame_encode_buffer_interleaved_ieee_double(
         r->gfp,
@@ -170,11 +280,74 @@ void node_lame_encode_buffer_async (uv_work_t *req) {
         r->output_size
       );
     } else {
-      // encoding double input buffer
+      // encoding double input buffer(s)
       r->rtn = lame_encode_buffer_ieee_double(
         r->gfp,
         (double *)r->input,
-        NULL,
+        (double *)r->input_right,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    }
+  } else if (r->input_type == PCM_TYPE_S24LE) {
+    if (r->channels > 1 && r->input_right == NULL) {
+      // encoding 24-bit interleaved input buffer
+      r->rtn = lame_encode_buffer_interleaved_s24le(
+        r->gfp,
+        (unsigned char *)r->input,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    } else {
+      // encoding 24-bit input buffer(s)
+      r->rtn = lame_encode_buffer_s24le(
+        r->gfp,
+        (unsigned char *)r->input,
+        (unsigned char *)r->input_right,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    }
+  } else if (r->input_type == PCM_TYPE_S32) {
+    if (r->channels > 1 && r->input_right == NULL) {
+      // encoding 32-bit int interleaved input buffer
+      r->rtn = lame_encode_buffer_interleaved_int(
+        r->gfp,
+        (int *)r->input,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    } else {
+      // encoding 32-bit int input buffer(s)
+      r->rtn = lame_encode_buffer_int(
+        r->gfp,
+        (int *)r->input,
+        (int *)r->input_right,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    }
+  } else if (r->input_type == PCM_TYPE_U8) {
+    if (r->channels > 1 && r->input_right == NULL) {
+      // encoding unsigned 8-bit interleaved input buffer
+      r->rtn = lame_encode_buffer_interleaved_u8(
+        r->gfp,
+        (unsigned char *)r->input,
+        r->num_samples,
+        r->output,
+        r->output_size
+      );
+    } else {
+      // encoding unsigned 8-bit input buffer(s)
+      r->rtn = lame_encode_buffer_u8(
+        r->gfp,
+        (unsigned char *)r->input,
+        (unsigned char *)r->input_right,
         r->num_samples,
         r->output,
         r->output_size
@@ -183,53 +356,172 @@ void node_lame_encode_buffer_async (uv_work_t *req) {
   }
 }
 
-void node_lame_encode_buffer_after (uv_work_t *req) {
-  Nan::HandleScope scope;
+void node_lame_encode_buffer_after (napi_env env, pool_work *req) {
+  encode_req *r = (encode_req *)req;
+
+  napi_value argv[1];
+  argv[0] = NewInt32(env, r->rtn);
+
+  pool_callback(env, req, r->callback, 1, argv);
 
-  encode_req *r = (encode_req *)req->data;
+  // cleanup
+  encode_req_release(env, r);
+}
+
+void node_lame_encode_abandon (napi_env env, pool_work *req) {
+  encode_req *r = (encode_req *)req;
+  if (env != NULL) {
+    encode_req_release(env, r);
+  } else {
+    // the free list is the main thread's
+    delete r;
+  }
+}
 
-  Handle<Value> argv[1];
-  argv[0] = Nan::New<Integer>(r->rtn);
 
-  Nan::TryCatch try_catch;
+/* lame_encode_buffer_interleaved_group() / _ieee_float_group()
+ * Encodes a chunk for each of the encoders "gfps" at once: input[i] of
+ * num_samples[i] samples goes to gfps[i], whose MP3 goes to the "output"
+ * Buffer at out_offsets[i] (out_sizes[i] bytes at most). All of them run on
+ * the worker of the first, so they must only ever be used together. The
+ * callback gets the return code and an Array of the number of bytes of each. */
+NAPI_METHOD(node_lame_encode_buffer_group) {
+  NAPI_ARGS(9);
+
+  uint32_t count = 0;
+  napi_get_array_length(env, argv[0], &count);
+  if (count == 0) return NULL;
+
+  // lame only has group versions of these two
+  pcm_type input_type = static_cast<pcm_type>(ToInt32(env, argv[2]));
+  if (input_type != PCM_TYPE_SHORT_INT && input_type != PCM_TYPE_FLOAT) {
+    napi_throw_type_error(env, NULL, "a group of encoders takes 16-bit or 32-bit float PCM");
+    return NULL;
+  }
 
-  Nan::New(r->callback)->Call(Nan::GetCurrentContext()->Global(), 1, argv);
+  encode_group_req *request = new encode_group_req;
+  request->count = count;
+  request->gfp = new lame_t[count];
+  request->input = new const void *[count];
+  request->num_samples = new int[count];
+  request->output = new unsigned char *[count];
+  request->output_size = new int[count];
+  request->bytes = new int[count];
+  request->input_type = input_type;
+  request->channels = ToInt32(env, argv[3]);
+  request->rtn = 0;
+
+  char *output = UnwrapPointer(env, argv[5]);
+  for (uint32_t i = 0; i < count; i++) {
+    napi_value v;
+    napi_get_element(env, argv[0], i, &v);
+    request->gfp[i] = reinterpret_cast<lame_t>(UnwrapPointer(env, v));
+    napi_get_element(env, argv[1], i, &v);
+    request->input[i] = UnwrapPointer(env, v);
+    napi_get_element(env, argv[4], i, &v);
+    request->num_samples[i] = ToInt32(env, v);
+    napi_get_element(env, argv[6], i, &v);
+    request->output[i] = (unsigned char *)output + ToInt32(env, v);
+    napi_get_element(env, argv[7], i, &v);
+    request->output_size[i] = ToInt32(env, v);
+    request->bytes[i] = 0;
+  }
+  request->callback = Persist(env, argv[8]);
+  request->inputs_ref = Persist(env, argv[1]);
+  request->output_ref = Persist(env, argv[5]);
+
+  if (pool_queue(env, request->gfp[0], &request->work,
+      node_lame_encode_buffer_group_async,
+      node_lame_encode_buffer_group_after,
+      node_lame_encode_buffer_group_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
+}
+
+void node_lame_encode_buffer_group_async (pool_work *req) {
+  encode_group_req *r = (encode_group_req *)req;
+  if (r->input_type == PCM_TYPE_SHORT_INT) {
+    const short int *const *input = (const short int *const *)r->input;
+    if (r->channels > 1) {
+      r->rtn = lame_encode_buffer_interleaved_group(r->gfp, r->count, input,
+          r->num_samples, r->output, r->output_size, r->bytes);
+    } else {
+      r->rtn = lame_encode_buffer_group(r->gfp, r->count, input, input,
+          r->num_samples, r->output, r->output_size, r->bytes);
+    }
+  } else {
+    const float *const *input = (const float *const *)r->input;
+    if (r->channels > 1) {
+      r->rtn = lame_encode_buffer_interleaved_ieee_float_group(r->gfp, r->count, input,
+          r->num_samples, r->output, r->output_size, r->bytes);
+    } else {
+      r->rtn = lame_encode_buffer_ieee_float_group(r->gfp, r->count, input, input,
+          r->num_samples, r->output, r->output_size, r->bytes);
+    }
+  }
+}
+
+void node_lame_encode_buffer_group_after (napi_env env, pool_work *req) {
+  encode_group_req *r = (encode_group_req *)req;
+
+  napi_value argv[2];
+  argv[0] = NewInt32(env, r->rtn);
+  napi_create_array_with_length(env, r->count, &argv[1]);
+  for (int i = 0; i < r->count; i++) {
+    SetIndex(env, argv[1], i, NewInt32(env, r->bytes[i]));
+  }
+
+  pool_callback(env, req, r->callback, 2, argv);
 
   // cleanup
-  r->callback.Reset();
-  delete r;
+  node_lame_encode_buffer_group_abandon(env, req);
+}
 
-  if (try_catch.HasCaught()) {
-    FatalException(try_catch);
+void node_lame_encode_buffer_group_abandon (napi_env env, pool_work *req) {
+  encode_group_req *r = (encode_group_req *)req;
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->inputs_ref);
+    Unpersist(env, &r->output_ref);
   }
+  delete[] r->gfp;
+  delete[] r->input;
+  delete[] r->num_samples;
+  delete[] r->output;
+  delete[] r->output_size;
+  delete[] r->bytes;
+  delete r;
 }
 
 
 /* lame_encode_flush_nogap() */
-NAN_METHOD(node_lame_encode_flush_nogap) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_encode_flush_nogap) {
+  UNWRAP_GFP(5);
 
   // the output buffer
-  int out_offset = Nan::To<int32_t>(info[2]).FromMaybe(0);
-  char *output = UnwrapPointer(info[1], out_offset);
-  int output_size = Nan::To<int32_t>(info[3]).FromMaybe(0);
+  int out_offset = ToInt32(env, argv[2]);
+  char *output = UnwrapPointer(env, argv[1], out_offset);
+  int output_size = ToInt32(env, argv[3]);
 
-  encode_req *request = new encode_req;
+  encode_req *request = encode_req_acquire();
   request->gfp = gfp;
   request->output = (unsigned char *)output;
   request->output_size = output_size;
-  request->callback.Reset(info[4].As<Function>());
-
-  // set a circular pointer so we can get the "encode_req" back later
-  request->req.data = request;
+  request->callback = Persist(env, argv[4]);
+  request->output_ref = Persist(env, argv[1]);
 
-  uv_queue_work(uv_default_loop(), &request->req,
+  if (pool_queue(env, gfp, &request->work,
       node_lame_encode_flush_nogap_async,
-      (uv_after_work_cb)node_lame_encode_flush_nogap_after);
+      node_lame_encode_flush_nogap_after,
+      node_lame_encode_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
 }
 
-void node_lame_encode_flush_nogap_async (uv_work_t *req) {
-  encode_req *r = (encode_req *)req->data;
+void node_lame_encode_flush_nogap_async (pool_work *req) {
+  encode_req *r = (encode_req *)req;
   r->rtn = lame_encode_flush_nogap(
     r->gfp,
     r->output,
@@ -238,21 +530,98 @@ void node_lame_encode_flush_nogap_async (uv_work_t *req) {
 }
 
 
+/* lame_encode_flush()
+ * Unlike lame_encode_flush_nogap(), this also encodes the PCM still buffered
+ * inside lame (padded with silence), so it ends the stream. */
+NAPI_METHOD(node_lame_encode_flush) {
+  UNWRAP_GFP(5);
+
+  // the output buffer
+  int out_offset = ToInt32(env, argv[2]);
+  char *output = UnwrapPointer(env, argv[1], out_offset);
+  int output_size = ToInt32(env, argv[3]);
+
+  encode_req *request = encode_req_acquire();
+  request->gfp = gfp;
+  request->output = (unsigned char *)output;
+  request->output_size = output_size;
+  request->callback = Persist(env, argv[4]);
+  request->output_ref = Persist(env, argv[1]);
+
+  if (pool_queue(env, gfp, &request->work,
+      node_lame_encode_flush_async,
+      node_lame_encode_flush_after,
+      node_lame_encode_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
+}
+
+void node_lame_encode_flush_async (pool_work *req) {
+  encode_req *r = (encode_req *)req;
+  r->rtn = lame_encode_flush(
+    r->gfp,
+    r->output,
+    r->output_size
+  );
+}
+
+
+/**
+ * lame_get_lametag_frame()
+ * Must be called *after* lame_encode_flush(). Without a Buffer to write
+ * into, returns a new Buffer with the frame (or `null` if there is none).
+ */
+NAPI_METHOD(node_lame_get_lametag_frame) {
+  UNWRAP_GFP(2);
+
+  bool is_buffer = false;
+  napi_is_buffer(env, argv[1], &is_buffer);
+  if (is_buffer) {
+    unsigned char *buf = (unsigned char *)UnwrapPointer(env, argv[1]);
+    size_t buf_size = BufferLength(env, argv[1]);
+    size_t b = lame_get_lametag_frame(gfp, buf, buf_size);
+    return NewUint32(env, static_cast<uint32_t>(b));
+  }
+
+  size_t size = lame_get_lametag_frame(gfp, NULL, 0);
+  if (size == 0) return Null(env);
+
+  void *data;
+  napi_value rtn;
+  napi_create_buffer(env, size, &data, &rtn);
+  lame_get_lametag_frame(gfp, (unsigned char *)data, size);
+  return rtn;
+}
+
+
+/**
+ * lame_rescan_lametag()
+ * Points the LAME-tag of "gfp" at the joined audio frames in the Buffer.
+ */
+NAPI_METHOD(node_lame_rescan_lametag) {
+  UNWRAP_GFP(2);
+
+  unsigned char *buf = (unsigned char *)UnwrapPointer(env, argv[1]);
+  size_t buf_size = BufferLength(env, argv[1]);
+
+  return NewInt32(env, lame_rescan_lametag(gfp, buf, buf_size));
+}
+
+
 /**
  * lame_get_id3v1_tag()
  * Must be called *after* lame_encode_flush()
  * TODO: Make async
  */
-NAN_METHOD(node_lame_get_id3v1_tag) {
+NAPI_METHOD(node_lame_get_id3v1_tag) {
+  UNWRAP_GFP(2);
 
-  UNWRAP_GFP;
-
-  Local<Object> outbuf = info[1]->ToObject();
-  unsigned char *buf = (unsigned char *)Buffer::Data(outbuf);
-  size_t buf_size = (size_t)Buffer::Length(outbuf);
+  unsigned char *buf = (unsigned char *)UnwrapPointer(env, argv[1]);
+  size_t buf_size = BufferLength(env, argv[1]);
 
   size_t b = lame_get_id3v1_tag(gfp, buf, buf_size);
-  info.GetReturnValue().Set(Nan::New<Integer>(static_cast<uint32_t>(b)));
+  return NewUint32(env, static_cast<uint32_t>(b));
 }
 
 
@@ -261,78 +630,89 @@ NAN_METHOD(node_lame_get_id3v1_tag) {
  * Must be called *before* lame_init_params()
  * TODO: Make async
  */
-NAN_METHOD(node_lame_get_id3v2_tag) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_get_id3v2_tag) {
+  UNWRAP_GFP(2);
 
-  Local<Object> outbuf = info[1]->ToObject();
-  unsigned char *buf = (unsigned char *)Buffer::Data(outbuf);
-  size_t buf_size = (size_t)Buffer::Length(outbuf);
+  unsigned char *buf = (unsigned char *)UnwrapPointer(env, argv[1]);
+  size_t buf_size = BufferLength(env, argv[1]);
 
   size_t b = lame_get_id3v2_tag(gfp, buf, buf_size);
-  info.GetReturnValue().Set(Nan::New<Integer>(static_cast<uint32_t>(b)));
+  return NewUint32(env, static_cast<uint32_t>(b));
 }
 
 
 /* lame_init_params(gfp) */
-NAN_METHOD(node_lame_init_params) {
-  UNWRAP_GFP;
-  info.GetReturnValue().Set(Nan::New<Number>(lame_init_params(gfp)));
+NAPI_METHOD(node_lame_init_params) {
+  UNWRAP_GFP(1);
+  return NewNumber(env, lame_init_params(gfp));
+}
+
+
+/* lame_reset_stream(gfp)
+ * Readies a flushed encoder for another stream of the same settings */
+NAPI_METHOD(node_lame_reset_stream) {
+  UNWRAP_GFP(1);
+  return NewNumber(env, lame_reset_stream(gfp));
 }
 
 
 /* lame_print_internals() */
-NAN_METHOD(node_lame_print_internals) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_print_internals) {
+  UNWRAP_GFP(1);
   lame_print_internals(gfp);
+  return NULL;
 }
 
 
 /* lame_print_config() */
-NAN_METHOD(node_lame_print_config) {
-  UNWRAP_GFP;
+NAPI_METHOD(node_lame_print_config) {
+  UNWRAP_GFP(1);
   lame_print_config(gfp);
+  return NULL;
 }
 
 
 /* lame_get_bitrate() */
-NAN_METHOD(node_lame_bitrates) {
+NAPI_METHOD(node_lame_bitrates) {
   int v;
   int x = 3;
   int y = 16;
-  Local<Array> n;
-  Local<Array> ret = Nan::New<Array>();
+  napi_value n;
+  napi_value ret;
+  napi_create_array(env, &ret);
   for (int i = 0; i < x; i++) {
-    n = Nan::New<Array>();
+    napi_create_array(env, &n);
     for (int j = 0; j < y; j++) {
       v = lame_get_bitrate(i, j);
       if (v >= 0) {
-        Nan::Set(n, j, Nan::New<Integer>(v));
+        SetIndex(env, n, j, NewInt32(env, v));
       }
     }
-    Nan::Set(ret, i, n);
+    SetIndex(env, ret, i, n);
   }
-  info.GetReturnValue().Set(ret);
+  return ret;
 }
 
 
 /* lame_get_samplerate() */
-NAN_METHOD(node_lame_samplerates) {
+NAPI_METHOD(node_lame_samplerates) {
   int v;
   int x = 3;
   int y = 4;
-  Local<Array> n;
-  Local<Array> ret = Nan::New<Array>();
+  napi_value n;
+  napi_value ret;
+  napi_create_array(env, &ret);
   for (int i = 0; i < x; i++) {
-    n = Nan::New<Array>();
+    napi_create_array(env, &n);
     for (int j = 0; j < y; j++) {
       v = lame_get_samplerate(i, j);
       if (v >= 0) {
-        Nan::Set(n, j, Nan::New<Integer>(v));
+        SetIndex(env, n, j, NewInt32(env, v));
       }
     }
-    Nan::Set(ret, i, n);
+    SetIndex(env, ret, i, n);
   }
-  info.GetReturnValue().Set(ret);
+  return ret;
 }
 
 // define the node_lame_get/node_lame_set functions
@@ -343,6 +723,7 @@ FN(float, Number, scale);
 FN(float, Number, scale_left);
 FN(float, Number, scale_right);
 FN(int, Int32, out_samplerate);
+FN(int, Int32, resample_quality);
 FN(int, Int32, analysis);
 FN(int, Int32, bWriteVbrTag);
 FN(int, Int32, quality);
@@ -356,6 +737,7 @@ FN(int, Int32, error_protection);
 FN(int, Int32, extension);
 FN(int, Int32, strict_ISO);
 FN(int, Int32, disable_reservoir);
+FN(int, Int32, reservoir_barrier);
 FN(int, Int32, quant_comp);
 FN(int, Int32, quant_comp_short);
 FN(int, Int32, exp_nspsytune);
@@ -370,16 +752,17 @@ FN(int, Int32, lowpassfreq);
 FN(int, Int32, lowpasswidth);
 FN(int, Int32, highpassfreq);
 FN(int, Int32, highpasswidth);
+GET_FN(int, encoder_delay);
+GET_FN(int, encoder_padding);
+GET_FN(size_t, table_bytes);
 // ...
 
 
-void InitLame(Handle<Object> target) {
-  Nan::HandleScope scope;
+void InitLame(napi_env env, napi_value target) {
 
   /* sizeof's */
 #define SIZEOF(value) \
-  Nan::ForceSet(target, Nan::New<String>("sizeof_" #value).ToLocalChecked(), Nan::New<Integer>(static_cast<uint32_t>(sizeof(value))), \
-      static_cast<PropertyAttribute>(ReadOnly|DontDelete))
+  SetConstant(env, target, "sizeof_" #value, NewUint32(env, static_cast<uint32_t>(sizeof(value))))
   SIZEOF(short);
   SIZEOF(int);
   SIZEOF(float);
@@ -387,8 +770,7 @@ void InitLame(Handle<Object> target) {
 
 
 #define CONST_INT(value) \
-  Nan::ForceSet(target, Nan::New<String>(#value).ToLocalChecked(), Nan::New<Integer>(value), \
-      static_cast<PropertyAttribute>(ReadOnly|DontDelete));
+  SetConstant(env, target, #value, NewInt32(env, value));
 
   // vbr_mode_e
   CONST_INT(vbr_off);
@@ -420,26 +802,37 @@ void InitLame(Handle<Object> target) {
   CONST_INT(PCM_TYPE_SHORT_INT)
   CONST_INT(PCM_TYPE_FLOAT)
   CONST_INT(PCM_TYPE_DOUBLE)
+  CONST_INT(PCM_TYPE_S24LE)
+  CONST_INT(PCM_TYPE_S32)
+  CONST_INT(PCM_TYPE_U8)
 
   // Functions
-  Nan::SetMethod(target, "get_lame_version", node_get_lame_version);
-  Nan::SetMethod(target, "get_lame_os_bitness", node_get_lame_os_bitness);
-  Nan::SetMethod(target, "lame_close", node_lame_close);
-  Nan::SetMethod(target, "lame_encode_buffer", node_lame_encode_buffer);
-  Nan::SetMethod(target, "lame_encode_flush_nogap", node_lame_encode_flush_nogap);
-  Nan::SetMethod(target, "lame_get_id3v1_tag", node_lame_get_id3v1_tag);
-  Nan::SetMethod(target, "lame_get_id3v2_tag", node_lame_get_id3v2_tag);
-  Nan::SetMethod(target, "lame_init_params", node_lame_init_params);
-  Nan::SetMethod(target, "lame_print_config", node_lame_print_config);
-  Nan::SetMethod(target, "lame_print_internals", node_lame_print_internals);
-  Nan::SetMethod(target, "lame_init", node_lame_init);
-  Nan::SetMethod(target, "lame_bitrates", node_lame_bitrates);
-  Nan::SetMethod(target, "lame_samplerates", node_lame_samplerates);
+  SetMethod(env, target, "get_lame_version", node_get_lame_version);
+  SetMethod(env, target, "get_lame_os_bitness", node_get_lame_os_bitness);
+  SetMethod(env, target, "lame_close", node_lame_close);
+  SetMethod(env, target, "lame_encode_buffer", node_lame_encode_buffer);
+  SetMethod(env, target, "lame_encode_buffer_planar", node_lame_encode_buffer_planar);
+  SetMethod(env, target, "lame_encode_buffer_group", node_lame_encode_buffer_group);
+  SetMethod(env, target, "lame_encode_flush", node_lame_encode_flush);
+  SetMethod(env, target, "lame_encode_flush_nogap", node_lame_encode_flush_nogap);
+  SetMethod(env, target, "lame_get_id3v1_tag", node_lame_get_id3v1_tag);
+  SetMethod(env, target, "lame_get_id3v2_tag", node_lame_get_id3v2_tag);
+  SetMethod(env, target, "lame_get_lametag_frame", node_lame_get_lametag_frame);
+  SetMethod(env, target, "lame_rescan_lametag", node_lame_rescan_lametag);
+  SetMethod(env, target, "lame_init_params", node_lame_init_params);
+  SetMethod(env, target, "lame_reset_stream", node_lame_reset_stream);
+  SetMethod(env, target, "lame_print_config", node_lame_print_config);
+  SetMethod(env, target, "lame_print_internals", node_lame_print_internals);
+  SetMethod(env, target, "lame_init", node_lame_init);
+  SetMethod(env, target, "lame_bitrates", node_lame_bitrates);
+  SetMethod(env, target, "lame_samplerates", node_lame_samplerates);
+  SetMethod(env, target, "encode_req_pool_size", node_encode_req_pool_size);
+  SetMethod(env, target, "table_cache_stats", node_table_cache_stats);
 
   // Get/Set functions
 #define LAME_SET_METHOD(fn) \
-  Nan::SetMethod(target, "lame_get_" #fn, PASTE(node_lame_get_, fn)); \
-  Nan::SetMethod(target, "lame_set_" #fn, PASTE(node_lame_set_, fn));
+  SetMethod(env, target, "lame_get_" #fn, PASTE(node_lame_get_, fn)); \
+  SetMethod(env, target, "lame_set_" #fn, PASTE(node_lame_set_, fn));
 
   LAME_SET_METHOD(num_samples);
   LAME_SET_METHOD(in_samplerate);
@@ -448,6 +841,7 @@ void InitLame(Handle<Object> target) {
   LAME_SET_METHOD(scale_left);
   LAME_SET_METHOD(scale_right);
   LAME_SET_METHOD(out_samplerate);
+  LAME_SET_METHOD(resample_quality);
   LAME_SET_METHOD(analysis);
   LAME_SET_METHOD(bWriteVbrTag);
   LAME_SET_METHOD(quality);
@@ -461,6 +855,7 @@ void InitLame(Handle<Object> target) {
   LAME_SET_METHOD(extension);
   LAME_SET_METHOD(strict_ISO);
   LAME_SET_METHOD(disable_reservoir);
+  LAME_SET_METHOD(reservoir_barrier);
   LAME_SET_METHOD(quant_comp);
   LAME_SET_METHOD(quant_comp_short);
   LAME_SET_METHOD(exp_nspsytune);
@@ -475,14 +870,17 @@ void InitLame(Handle<Object> target) {
   LAME_SET_METHOD(lowpasswidth);
   LAME_SET_METHOD(highpassfreq);
   LAME_SET_METHOD(highpasswidth);
+  SetMethod(env, target, "lame_get_encoder_delay", node_lame_get_encoder_delay);
+  SetMethod(env, target, "lame_get_encoder_padding", node_lame_get_encoder_padding);
+  SetMethod(env, target, "lame_get_table_bytes", node_lame_get_table_bytes);
   // ...
 
   /*
-  Nan::SetMethod(target, "lame_get_decode_only", node_lame_get_decode_only);
-  Nan::SetMethod(target, "lame_set_decode_only", node_lame_set_decode_only);
-  Nan::SetMethod(target, "lame_get_framesize", node_lame_get_framesize);
-  Nan::SetMethod(target, "lame_get_frameNum", node_lame_get_frameNum);
-  Nan::SetMethod(target, "lame_get_version", node_lame_get_version);
+  SetMethod(env, target, "lame_get_decode_only", node_lame_get_decode_only);
+  SetMethod(env, target, "lame_set_decode_only", node_lame_set_decode_only);
+  SetMethod(env, target, "lame_get_framesize", node_lame_get_framesize);
+  SetMethod(env, target, "lame_get_frameNum", node_lame_get_frameNum);
+  SetMethod(env, target, "lame_get_version", node_lame_get_version);
   */
 
 }
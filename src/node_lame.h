@@ -1,5 +1,5 @@
-#include <v8.h>
-#include <node.h>
+#include <node_api.h>
+#include "node_pool.h"
 #include "lame.h"
 
 namespace nodelame {
@@ -8,27 +8,68 @@ namespace nodelame {
 typedef enum {
   PCM_TYPE_SHORT_INT,
   PCM_TYPE_FLOAT,
-  PCM_TYPE_DOUBLE
+  PCM_TYPE_DOUBLE,
+  PCM_TYPE_S24LE,     /* packed 3 byte little endian */
+  PCM_TYPE_S32,
+  PCM_TYPE_U8
 } pcm_type;
 
 /* struct that's used for async encoding */
 struct encode_req {
-  uv_work_t req;
+  pool_work work;
   lame_global_flags *gfp;
   unsigned char *input;
+  unsigned char *input_right; /* planar input: the right channel, else NULL */
   pcm_type input_type;
   int channels;
   int num_samples;
   unsigned char *output;
   int output_size;
   int rtn;
-  Nan::Persistent<v8::Function> callback;
+  napi_ref callback;
+  napi_ref input_ref;  /* keeps the Buffers alive while on the worker */
+  napi_ref input_right_ref;
+  napi_ref output_ref;
+  encode_req *next; /* free list link while the request sits in the pool */
 };
 
-void node_lame_encode_buffer_async (uv_work_t *);
-void node_lame_encode_buffer_after (uv_work_t *);
+/* struct that's used to encode a chunk for each of a group of encoders at
+ * once; the arrays have "count" entries */
+struct encode_group_req {
+  pool_work work;
+  int count;
+  lame_t *gfp;
+  const void **input;  /* interleaved, or mono */
+  int *num_samples;
+  unsigned char **output;
+  int *output_size;
+  int *bytes;          /* the number of MP3 bytes written to each output */
+  pcm_type input_type;
+  int channels;
+  int rtn;
+  napi_ref callback;
+  napi_ref inputs_ref; /* keeps the Array of input Buffers alive */
+  napi_ref output_ref;
+};
+
+/* maximum number of idle "encode_req" instances kept around for reuse */
+#define ENCODE_REQ_POOL_MAX 256
+
+encode_req *encode_req_acquire ();
+void encode_req_release (napi_env, encode_req *);
+
+void node_lame_encode_buffer_async (pool_work *);
+void node_lame_encode_buffer_after (napi_env, pool_work *);
+void node_lame_encode_abandon (napi_env, pool_work *);
+
+void node_lame_encode_buffer_group_async (pool_work *);
+void node_lame_encode_buffer_group_after (napi_env, pool_work *);
+void node_lame_encode_buffer_group_abandon (napi_env, pool_work *);
+
+void node_lame_encode_flush_async (pool_work *);
+#define node_lame_encode_flush_after node_lame_encode_buffer_after
 
-void node_lame_encode_flush_nogap_async (uv_work_t *);
+void node_lame_encode_flush_nogap_async (pool_work *);
 #define node_lame_encode_flush_nogap_after node_lame_encode_buffer_after
 
 } // nodelame namespace
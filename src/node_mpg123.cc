@@ -14,183 +14,360 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <v8.h>
-#include <node.h>
-#include <node_buffer.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <node_api.h>
+#include "node_napi.h"
 #include "node_pointer.h"
+#include "node_pool.h"
 #include "node_mpg123.h"
-#include "nan.h"
 
-using namespace v8;
-using namespace node;
-using namespace Nan;
+using namespace nodelame;
 
 namespace nodelame {
 
-#define UNWRAP_MH \
-  Nan::HandleScope scope; \
-  mpg123_handle *mh = reinterpret_cast<mpg123_handle *>(UnwrapPointer(info[0]));
+#define UNWRAP_MH(n) \
+  NAPI_ARGS(n); \
+  mpg123_handle *mh = reinterpret_cast<mpg123_handle *>(UnwrapPointer(env, argv[0]));
 
 /* not a macro because we're passing function calls in here */
 inline int min (int a, int b) {
   return a < b ? a : b;
 }
 
-NAN_METHOD(node_mpg123_init) {
-  info.GetReturnValue().Set(Nan::New<Integer>(mpg123_init()));
+NAPI_METHOD(node_mpg123_init) {
+  return NewInt32(env, mpg123_init());
 }
 
 
-NAN_METHOD(node_mpg123_exit) {
+NAPI_METHOD(node_mpg123_exit) {
   mpg123_exit();
+  return NULL;
 }
 
 
-NAN_METHOD(node_mpg123_new) {
+/* called when the JS wrapper of an "mpg123_handle" gets garbage collected */
+static void node_mpg123_delete (napi_env env, void *data, void *hint) {
+  mpg123_delete((mpg123_handle *)data);
+}
+
+
+NAPI_METHOD(node_mpg123_new) {
+  NAPI_ARGS(1);
+
+  // the decoder name, or the default one (the fastest this CPU supports)
+  char decoder[64];
+  size_t length;
+  bool named = napi_get_value_string_utf8(env, argv[0], decoder, sizeof(decoder), &length) == napi_ok;
 
-  // TODO: Accept an input decoder String
   int error = MPG123_OK;
-  mpg123_handle *mh = mpg123_new(NULL, &error);
+  mpg123_handle *mh = mpg123_new(named ? decoder : NULL, &error);
 
   if (error == MPG123_OK) {
-    info.GetReturnValue().Set(WrapPointer(mh).ToLocalChecked());
+    return WrapPointer(env, mh, node_mpg123_delete);
   } else {
-    info.GetReturnValue().Set(Nan::New<Integer>(error));
+    return NewInt32(env, error);
   }
 }
 
 
-NAN_METHOD(node_mpg123_current_decoder) {
-  UNWRAP_MH;
+NAPI_METHOD(node_mpg123_current_decoder) {
+  UNWRAP_MH(1);
   const char *decoder = mpg123_current_decoder(mh);
-  info.GetReturnValue().Set(Nan::New<String>(decoder).ToLocalChecked());
+  return NewString(env, decoder);
 }
 
 
-NAN_METHOD(node_mpg123_supported_decoders) {
+NAPI_METHOD(node_mpg123_supported_decoders) {
   const char **decoders = mpg123_supported_decoders();
-  int i = 0;
-  v8::Local<Array> rtn = Nan::New<Array>();
+  uint32_t i = 0;
+  napi_value rtn;
+  napi_create_array(env, &rtn);
   while (*decoders != NULL) {
-    Nan::Set(rtn, i++, Nan::New<String>(*decoders).ToLocalChecked());
+    SetIndex(env, rtn, i++, NewString(env, *decoders));
     decoders++;
   }
-  info.GetReturnValue().Set(rtn);
+  return rtn;
 }
 
 
-NAN_METHOD(node_mpg123_decoders) {
+NAPI_METHOD(node_mpg123_decoders) {
   const char **decoders = mpg123_decoders();
-  int i = 0;
-  v8::Local<Array> rtn = Nan::New<Array>();
+  uint32_t i = 0;
+  napi_value rtn;
+  napi_create_array(env, &rtn);
   while (*decoders != NULL) {
-    Nan::Set(rtn, i++, Nan::New<String>(*decoders).ToLocalChecked());
+    SetIndex(env, rtn, i++, NewString(env, *decoders));
     decoders++;
   }
-  info.GetReturnValue().Set(rtn);
+  return rtn;
 }
 
 
-NAN_METHOD(node_mpg123_open_feed) {
-  UNWRAP_MH;
+NAPI_METHOD(node_mpg123_open_feed) {
+  UNWRAP_MH(1);
   int ret = mpg123_open_feed(mh);
-  info.GetReturnValue().Set(Nan::New<Integer>(ret));
+  return NewInt32(env, ret);
+}
+
+
+/* the JS Object describing an output format, as emitted with "format" */
+static napi_value format_object (napi_env env, mpg123_handle *mh, long rate, int channels, int encoding) {
+  napi_value o;
+  napi_create_object(env, &o);
+  Set(env, o, "raw_encoding", NewNumber(env, encoding));
+  Set(env, o, "sampleRate", NewNumber(env, rate));
+  Set(env, o, "channels", NewNumber(env, channels));
+  Set(env, o, "signed", NewBoolean(env, encoding & MPG123_ENC_SIGNED));
+  Set(env, o, "float", NewBoolean(env, encoding & MPG123_ENC_FLOAT));
+  Set(env, o, "ulaw", NewBoolean(env, encoding & MPG123_ENC_ULAW_8));
+  Set(env, o, "alaw", NewBoolean(env, encoding & MPG123_ENC_ALAW_8));
+  if (encoding & MPG123_ENC_8)
+    Set(env, o, "bitDepth", NewInt32(env, 8));
+  else if (encoding & MPG123_ENC_16)
+    Set(env, o, "bitDepth", NewInt32(env, 16));
+  else if (encoding & MPG123_ENC_24)
+    Set(env, o, "bitDepth", NewInt32(env, 24));
+  else if (encoding & MPG123_ENC_32 || encoding & MPG123_ENC_FLOAT_32)
+    Set(env, o, "bitDepth", NewInt32(env, 32));
+  else if (encoding & MPG123_ENC_FLOAT_64)
+    Set(env, o, "bitDepth", NewInt32(env, 64));
+  // the synth decoder that mpg123 picked (or was told to use)
+  Set(env, o, "decoder", NewString(env, mpg123_current_decoder(mh)));
+  // the gapless info from the LAME tag, and the exact output length it gives
+  long delay = -1;
+  long padding = -1;
+  mpg123_getstate(mh, MPG123_ENC_DELAY, &delay, NULL);
+  mpg123_getstate(mh, MPG123_ENC_PADDING, &padding, NULL);
+  if (delay >= 0) {
+    Set(env, o, "encoderDelay", NewNumber(env, delay));
+    Set(env, o, "encoderPadding", NewNumber(env, padding));
+    off_t length = mpg123_length(mh);
+    if (length > 0) Set(env, o, "samples", NewNumber(env, (double)length));
+  }
+  return o;
 }
 
 
-NAN_METHOD(node_mpg123_getformat) {
-  UNWRAP_MH;
+NAPI_METHOD(node_mpg123_getformat) {
+  UNWRAP_MH(1);
   long rate;
   int channels;
   int encoding;
   int ret;
-  Local<Value> rtn;
   ret = mpg123_getformat(mh, &rate, &channels, &encoding);
   if (ret == MPG123_OK) {
-    Local<Object> o = Nan::New<Object>();
-    Nan::Set(o, Nan::New<String>("raw_encoding").ToLocalChecked(), Nan::New<Number>(encoding));
-    Nan::Set(o, Nan::New<String>("sampleRate").ToLocalChecked(), Nan::New<Number>(rate));
-    Nan::Set(o, Nan::New<String>("channels").ToLocalChecked(), Nan::New<Number>(channels));
-    Nan::Set(o, Nan::New<String>("signed").ToLocalChecked(), Nan::New<Boolean>(encoding & MPG123_ENC_SIGNED));
-    Nan::Set(o, Nan::New<String>("float").ToLocalChecked(), Nan::New<Boolean>(encoding & MPG123_ENC_FLOAT));
-    Nan::Set(o, Nan::New<String>("ulaw").ToLocalChecked(), Nan::New<Boolean>(encoding & MPG123_ENC_ULAW_8));
-    Nan::Set(o, Nan::New<String>("alaw").ToLocalChecked(), Nan::New<Boolean>(encoding & MPG123_ENC_ALAW_8));
-    if (encoding & MPG123_ENC_8)
-      Nan::Set(o, Nan::New<String>("bitDepth").ToLocalChecked(), Nan::New<Integer>(8));
-    else if (encoding & MPG123_ENC_16)
-      Nan::Set(o, Nan::New<String>("bitDepth").ToLocalChecked(), Nan::New<Integer>(16));
-    else if (encoding & MPG123_ENC_24)
-      Nan::Set(o, Nan::New<String>("bitDepth").ToLocalChecked(), Nan::New<Integer>(24));
-    else if (encoding & MPG123_ENC_32 || encoding & MPG123_ENC_FLOAT_32)
-      Nan::Set(o, Nan::New<String>("bitDepth").ToLocalChecked(), Nan::New<Integer>(32));
-    else if (encoding & MPG123_ENC_FLOAT_64)
-      Nan::Set(o, Nan::New<String>("bitDepth").ToLocalChecked(), Nan::New<Integer>(64));
-    rtn = o;
+    return format_object(env, mh, rate, channels, encoding);
   } else {
-    rtn = Nan::New<Integer>(ret);
+    return NewInt32(env, ret);
   }
-  info.GetReturnValue().Set(rtn);
 }
 
 
-NAN_METHOD(node_mpg123_safe_buffer) {
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_safe_buffer()));
+NAPI_METHOD(node_mpg123_safe_buffer) {
+  return NewNumber(env, mpg123_safe_buffer());
+}
+
+
+NAPI_METHOD(node_mpg123_outblock) {
+  UNWRAP_MH(1);
+  return NewNumber(env, mpg123_outblock(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_framepos) {
+  UNWRAP_MH(1);
+  return NewNumber(env, mpg123_framepos(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_tell) {
+  UNWRAP_MH(1);
+  return NewNumber(env, mpg123_tell(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_tellframe) {
+  UNWRAP_MH(1);
+  return NewNumber(env, mpg123_tellframe(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_tell_stream) {
+  UNWRAP_MH(1);
+  return NewNumber(env, mpg123_tell_stream(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_spf) {
+  UNWRAP_MH(1);
+  return NewInt32(env, mpg123_spf(mh));
+}
+
+
+NAPI_METHOD(node_mpg123_encsize) {
+  NAPI_ARGS(1);
+  return NewInt32(env, mpg123_encsize(ToInt32(env, argv[0])));
 }
 
 
-NAN_METHOD(node_mpg123_outblock) {
-  UNWRAP_MH;
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_outblock(mh)));
+NAPI_METHOD(node_mpg123_param) {
+  UNWRAP_MH(4);
+  int type = ToInt32(env, argv[1]);
+  long value = (long)ToNumber(env, argv[2]);
+  double fvalue = ToNumber(env, argv[3]);
+  return NewInt32(env, mpg123_param(mh, (enum mpg123_parms)type, value, fvalue));
 }
 
 
-NAN_METHOD(node_mpg123_framepos) {
-  UNWRAP_MH;
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_framepos(mh)));
+/* mpg123_getparam()
+ * Returns the integer value of the parameter, or the error code */
+NAPI_METHOD(node_mpg123_getparam) {
+  UNWRAP_MH(2);
+  long val = 0;
+  int ret = mpg123_getparam(mh, (enum mpg123_parms)ToInt32(env, argv[1]), &val, NULL);
+  if (ret != MPG123_OK) return NewInt32(env, ret);
+  return NewNumber(env, val);
 }
 
 
-NAN_METHOD(node_mpg123_tell) {
-  UNWRAP_MH;
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_tell(mh)));
+/* mpg123_getstate()
+ * Returns the integer value of the state, or the error code */
+NAPI_METHOD(node_mpg123_getstate) {
+  UNWRAP_MH(2);
+  long val = 0;
+  int ret = mpg123_getstate(mh, (enum mpg123_state)ToInt32(env, argv[1]), &val, NULL);
+  if (ret != MPG123_OK) return NewInt32(env, ret);
+  return NewNumber(env, val);
 }
 
 
-NAN_METHOD(node_mpg123_tellframe) {
-  UNWRAP_MH;
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_tellframe(mh)));
+NAPI_METHOD(node_mpg123_format_none) {
+  UNWRAP_MH(1);
+  return NewInt32(env, mpg123_format_none(mh));
 }
 
 
-NAN_METHOD(node_mpg123_tell_stream) {
-  UNWRAP_MH;
-  info.GetReturnValue().Set(Nan::New<Number>(mpg123_tell_stream(mh)));
+NAPI_METHOD(node_mpg123_format) {
+  UNWRAP_MH(4);
+  long rate = (long)ToNumber(env, argv[1]);
+  int channels = ToInt32(env, argv[2]);
+  int encodings = ToInt32(env, argv[3]);
+  return NewInt32(env, mpg123_format(mh, rate, channels, encodings));
 }
 
 
-NAN_METHOD(node_mpg123_feed) {
-  UNWRAP_MH;
+/* mpg123_rates()
+ * Returns the Array of the sample rates that libmpg123 decodes to without
+ * NtoM resampling */
+NAPI_METHOD(node_mpg123_rates) {
+  const long *list;
+  size_t number;
+  mpg123_rates(&list, &number);
+
+  napi_value rtn;
+  napi_create_array_with_length(env, number, &rtn);
+  for (size_t i = 0; i < number; i++) {
+    SetIndex(env, rtn, i, NewNumber(env, list[i]));
+  }
+  return rtn;
+}
+
+
+/* mpg123_feedseek()
+ * Returns `[ sample offset, input offset ]`, where the input offset is the
+ * byte position in the stream that feeding has to continue from, or the
+ * error code */
+NAPI_METHOD(node_mpg123_feedseek) {
+  UNWRAP_MH(3);
+  off_t sampleoff = (off_t)ToNumber(env, argv[1]);
+  int whence = ToInt32(env, argv[2]);
+  off_t input_offset = 0;
+
+  off_t ret = mpg123_feedseek(mh, sampleoff, whence, &input_offset);
+  if (ret < 0) return NewInt32(env, (int)ret);
+
+  napi_value rtn;
+  napi_create_array_with_length(env, 2, &rtn);
+  SetIndex(env, rtn, 0, NewNumber(env, (double)ret));
+  SetIndex(env, rtn, 1, NewNumber(env, (double)input_offset));
+  return rtn;
+}
+
+
+/* mpg123_index()
+ * Returns the frame index as `{ step, offsets }`: the byte offset of every
+ * "step"th frame, or the error code */
+NAPI_METHOD(node_mpg123_index) {
+  UNWRAP_MH(1);
+  off_t *offsets;
+  off_t step;
+  size_t fill;
+
+  int ret = mpg123_index(mh, &offsets, &step, &fill);
+  if (ret != MPG123_OK) return NewInt32(env, ret);
+
+  napi_value list;
+  napi_create_array_with_length(env, fill, &list);
+  for (size_t i = 0; i < fill; i++) {
+    SetIndex(env, list, (uint32_t)i, NewNumber(env, (double)offsets[i]));
+  }
+  napi_value rtn;
+  napi_create_object(env, &rtn);
+  Set(env, rtn, "step", NewNumber(env, (double)step));
+  Set(env, rtn, "offsets", list);
+  return rtn;
+}
+
+
+/* mpg123_set_index(mh, offsets, step) */
+NAPI_METHOD(node_mpg123_set_index) {
+  UNWRAP_MH(3);
+  uint32_t fill = 0;
+  napi_get_array_length(env, argv[1], &fill);
+  off_t step = (off_t)ToNumber(env, argv[2]);
+
+  off_t *offsets = (off_t *)malloc(sizeof(off_t) * (fill > 0 ? fill : 1));
+  if (offsets == NULL) return NewInt32(env, MPG123_OUT_OF_MEM);
+  for (uint32_t i = 0; i < fill; i++) {
+    napi_value v;
+    napi_get_element(env, argv[1], i, &v);
+    offsets[i] = (off_t)ToNumber(env, v);
+  }
+  // libmpg123 copies the offsets
+  int ret = mpg123_set_index(mh, offsets, step, fill);
+  free(offsets);
+  return NewInt32(env, ret);
+}
+
+
+NAPI_METHOD(node_mpg123_feed) {
+  UNWRAP_MH(4);
 
   // input buffer
-  char *input = UnwrapPointer(info[1]);
-  size_t size = Nan::To<int32_t>(info[2]).FromMaybe(0);
+  char *input = UnwrapPointer(env, argv[1]);
+  size_t size = ToInt32(env, argv[2]);
 
   feed_req *request = new feed_req;
   request->mh = mh;
   request->in = (const unsigned char *)input;
   request->size = size;
-  request->callback.Reset(info[3].As<Function>());
-
-  request->req.data = request;
+  request->callback = Persist(env, argv[3]);
+  request->mh_ref = Persist(env, argv[0]);
+  request->in_ref = Persist(env, argv[1]);
 
-  uv_queue_work(uv_default_loop(), &request->req,
+  if (pool_queue(env, mh, &request->work,
       node_mpg123_feed_async,
-      (uv_after_work_cb)node_mpg123_feed_after);
+      node_mpg123_feed_after,
+      node_mpg123_feed_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
 }
 
-void node_mpg123_feed_async (uv_work_t *req) {
-  feed_req *r = (feed_req *)req->data;
+void node_mpg123_feed_async (pool_work *req) {
+  feed_req *r = (feed_req *)req;
   r->rtn = mpg123_feed(
     r->mh,
     r->in,
@@ -198,49 +375,56 @@ void node_mpg123_feed_async (uv_work_t *req) {
   );
 }
 
-void node_mpg123_feed_after (uv_work_t *req) {
-  Nan::HandleScope scope;
-  feed_req *r = (feed_req *)req->data;
-
-  Handle<Value> argv[1];
-  argv[0] = Nan::New<Integer>(r->rtn);
+void node_mpg123_feed_after (napi_env env, pool_work *req) {
+  feed_req *r = (feed_req *)req;
 
-  Nan::TryCatch try_catch;
+  napi_value argv[1];
+  argv[0] = NewInt32(env, r->rtn);
 
-  Nan::New(r->callback)->Call(Nan::GetCurrentContext()->Global(), 1, argv);
+  pool_callback(env, req, r->callback, 1, argv);
 
   // cleanup
-  r->callback.Reset();
-  delete r;
+  node_mpg123_feed_abandon(env, req);
+}
 
-  if (try_catch.HasCaught()) {
-    FatalException(try_catch);
+void node_mpg123_feed_abandon (napi_env env, pool_work *req) {
+  feed_req *r = (feed_req *)req;
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->mh_ref);
+    Unpersist(env, &r->in_ref);
   }
+  delete r;
 }
 
 
-NAN_METHOD(node_mpg123_read) {
-  UNWRAP_MH;
+NAPI_METHOD(node_mpg123_read) {
+  UNWRAP_MH(4);
 
   // output buffer
-  char *output = UnwrapPointer(info[1]);
-  size_t size = Nan::To<int32_t>(info[2]).FromMaybe(0);
+  char *output = UnwrapPointer(env, argv[1]);
+  size_t size = ToInt32(env, argv[2]);
 
   read_req *request = new read_req;
   request->mh = mh;
   request->out = (unsigned char *)output;
   request->size = size;
   request->done = 0;
-  request->callback.Reset(info[3].As<Function>());
-  request->req.data = request;
+  request->callback = Persist(env, argv[3]);
+  request->mh_ref = Persist(env, argv[0]);
+  request->out_ref = Persist(env, argv[1]);
 
-  uv_queue_work(uv_default_loop(), &request->req,
+  if (pool_queue(env, mh, &request->work,
       node_mpg123_read_async,
-      (uv_after_work_cb)node_mpg123_read_after);
+      node_mpg123_read_after,
+      node_mpg123_read_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
 }
 
-void node_mpg123_read_async (uv_work_t *req) {
-  read_req *r = (read_req *)req->data;
+void node_mpg123_read_async (pool_work *req) {
+  read_req *r = (read_req *)req;
   r->rtn = mpg123_read(
     r->mh,
     r->out,
@@ -252,44 +436,124 @@ void node_mpg123_read_async (uv_work_t *req) {
   r->meta = mpg123_meta_check(r->mh);
 }
 
-void node_mpg123_read_after (uv_work_t *req) {
-  Nan::HandleScope scope;
-  read_req *r = (read_req *)req->data;
-
-  Handle<Value> argv[3];
-  argv[0] = Nan::New<Integer>(r->rtn);
-  argv[1] = Nan::New<Integer>(static_cast<uint32_t>(r->done));
-  argv[2] = Nan::New<Integer>(r->meta);
+void node_mpg123_read_after (napi_env env, pool_work *req) {
+  read_req *r = (read_req *)req;
 
-  Nan::TryCatch try_catch;
+  napi_value argv[3];
+  argv[0] = NewInt32(env, r->rtn);
+  argv[1] = NewUint32(env, static_cast<uint32_t>(r->done));
+  argv[2] = NewInt32(env, r->meta);
 
-  Nan::New(r->callback)->Call(Nan::GetCurrentContext()->Global(), 3, argv);
+  pool_callback(env, req, r->callback, 3, argv);
 
   // cleanup
-  r->callback.Reset();
+  node_mpg123_read_abandon(env, req);
+}
+
+void node_mpg123_read_abandon (napi_env env, pool_work *req) {
+  read_req *r = (read_req *)req;
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->mh_ref);
+    Unpersist(env, &r->out_ref);
+  }
   delete r;
+}
+
+
+/* the JS Object for the ID3 tags, as emitted with "id3v1" / "id3v2" */
+static napi_value id3_object (napi_env env, mpg123_id3v1 *v1, mpg123_id3v2 *v2) {
+  napi_value rtn;
+  if (v1 != NULL) {
+    /* got id3v1 tags */
+    napi_value o;
+    napi_create_object(env, &o);
+#define SET(prop) \
+    Set(env, o, #prop, NewString(env, v1->prop, min(sizeof(v1->prop), v1->prop == NULL ? 0 : strlen(v1->prop))));
+    SET(tag);
+    SET(title);
+    SET(artist);
+    SET(album);
+    SET(year);
+    if (v1->comment[28] == 0 && v1->comment[29] >= 1) {
+      /* ID3v1.1 */
+      Set(env, o, "comment", NewString(env, v1->comment, min(sizeof(v1->comment) - 2, v1->comment == NULL ? 0 : strlen(v1->comment))));
+      Set(env, o, "trackNumber", NewInt32(env, v1->comment[29]));
+    } else {
+      /* ID3v1 */
+      SET(comment);
+    }
+    Set(env, o, "genre", NewInt32(env, v1->genre));
+    rtn = o;
+#undef SET
+  } else if (v2 != NULL) {
+    /* got id3v2 tags */
+    mpg123_string *s;
+    mpg123_text *t;
+    napi_value o;
+    napi_value a;
+    napi_value text;
+    napi_create_object(env, &o);
+#define SET(prop) \
+    s = v2->prop; \
+    if (s != NULL) \
+      Set(env, o, #prop, NewString(env, s->p, mpg123_strlen(s, 1)));
+    SET(title)
+    SET(artist)
+    SET(album)
+    SET(year)
+    SET(genre)
+    SET(comment)
+#undef SET
 
-  if (try_catch.HasCaught()) {
-    FatalException(try_catch);
+#define SET_ARRAY(array, count) \
+    napi_create_array_with_length(env, v2->count, &a); \
+    for (size_t i = 0; i < v2->count; i++) { \
+      t = &v2->array[i]; \
+      napi_create_object(env, &text); \
+      SetIndex(env, a, i, text); \
+      Set(env, text, "lang", NewString(env, t->lang, min(sizeof(t->lang), strlen(t->lang)))); \
+      Set(env, text, "id", NewString(env, t->id, min(sizeof(t->id), strlen(t->id)))); \
+      s = &t->description; \
+      if (s != NULL) \
+        Set(env, text, "description", NewString(env, s->p, mpg123_strlen(s, 1))); \
+      s = &t->text; \
+      if (s != NULL) \
+        Set(env, text, "text", NewString(env, s->p, mpg123_strlen(s, 1))); \
+    } \
+    Set(env, o, #count, a);
+    SET_ARRAY(comment_list, comments)
+    SET_ARRAY(text, texts)
+    SET_ARRAY(extra, extras)
+#undef SET_ARRAY
+
+    rtn = o;
+  } else {
+    rtn = Null(env);
   }
+  return rtn;
 }
 
 
-NAN_METHOD(node_mpg123_id3) {
-  UNWRAP_MH;
+NAPI_METHOD(node_mpg123_id3) {
+  UNWRAP_MH(2);
 
   id3_req *request = new id3_req;
   request->mh = mh;
-  request->callback.Reset(info[1].As<Function>());
-  request->req.data = request;
+  request->callback = Persist(env, argv[1]);
+  request->mh_ref = Persist(env, argv[0]);
 
-  uv_queue_work(uv_default_loop(), &request->req,
+  if (pool_queue(env, mh, &request->work,
       node_mpg123_id3_async,
-      (uv_after_work_cb)node_mpg123_id3_after);
+      node_mpg123_id3_after,
+      node_mpg123_id3_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
 }
 
-void node_mpg123_id3_async (uv_work_t *req) {
-  id3_req *r = (id3_req *)req->data;
+void node_mpg123_id3_async (pool_work *req) {
+  id3_req *r = (id3_req *)req;
   r->rtn = mpg123_id3(
     r->mh,
     &r->v1,
@@ -297,107 +561,301 @@ void node_mpg123_id3_async (uv_work_t *req) {
   );
 }
 
-void node_mpg123_id3_after (uv_work_t *req) {
-  Nan::HandleScope scope;
-  id3_req *ireq = (id3_req *)req->data;
+void node_mpg123_id3_after (napi_env env, pool_work *req) {
+  id3_req *ireq = (id3_req *)req;
+
+  napi_value rtn = Undefined(env);
+  if (ireq->rtn == MPG123_OK) {
+    rtn = id3_object(env, ireq->v1, ireq->v2);
+  }
+
+  napi_value argv[2];
+  argv[0] = NewInt32(env, ireq->rtn);
+  argv[1] = rtn;
+
+  pool_callback(env, req, ireq->callback, 2, argv);
+
+  // cleanup
+  node_mpg123_id3_abandon(env, req);
+}
+
+void node_mpg123_id3_abandon (napi_env env, pool_work *req) {
+  id3_req *r = (id3_req *)req;
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->mh_ref);
+  }
+  delete r;
+}
+
 
-  mpg123_id3v1 *v1 = ireq->v1;
-  mpg123_id3v2 *v2 = ireq->v2;
-  int r = ireq->rtn;
-  Handle<Value> rtn;
+/* mpg123_feed() followed by mpg123_read() until MPG123_NEED_MORE, in a single
+ * trip to the worker pool. The PCM is decoded straight into one arena of
+ * DRAIN_MAX_FRAMES frames, allocated once and handed to JS as-is (never
+ * moved by a realloc()), and any NEW_FORMAT/NEW_ID3 events are collected
+ * along the way, with the PCM byte offset they happened at. When the arena
+ * or the events are full, JS calls back in to drain the rest.
+ *
+ * In "frames" mode the arena is swapped in as libmpg123's own frame buffer
+ * (mpg123_replace_buffer()) and mpg123_decode_frame() is used instead of
+ * mpg123_read(), so the synth writes its PCM directly into the Buffer that JS
+ * gets, skipping mpg123_read()'s memcpy() out of the internal frame buffer.
+ * Afterwards the handle is left pointing at a zero-sized buffer, so it must
+ * only be used in "frames" mode from then on. */
+NAPI_METHOD(node_mpg123_feed_and_drain) {
+  UNWRAP_MH(5);
 
-  if (r == MPG123_OK) {
-    if (v1 != NULL) {
-      /* got id3v1 tags */
-      Local<Object> o = Nan::New<Object>();
-#define SET(prop) \
-      Nan::Set(o, Nan::New<String>(#prop).ToLocalChecked(), Nan::New<String>(v1->prop, min(sizeof(v1->prop), v1->prop == NULL ? 0 : strlen(v1->prop))).ToLocalChecked());
-      SET(tag);
-      SET(title);
-      SET(artist);
-      SET(album);
-      SET(year);
-      if (v1->comment[28] == 0 && v1->comment[29] >= 1) {
-        /* ID3v1.1 */
-        Nan::Set(o, Nan::New<String>("comment").ToLocalChecked(), Nan::New<String>(v1->comment, min(sizeof(v1->comment) - 2, v1->comment == NULL ? 0 : strlen(v1->comment))).ToLocalChecked());
-        Nan::Set(o, Nan::New<String>("trackNumber").ToLocalChecked(), Nan::New<Integer>(v1->comment[29]));
-      } else {
-        /* ID3v1 */
-        SET(comment);
+  // input buffer
+  char *input = UnwrapPointer(env, argv[1]);
+  size_t size = ToInt32(env, argv[2]);
+
+  drain_req *request = new drain_req;
+  request->mh = mh;
+  request->in = (const unsigned char *)input;
+  request->size = size;
+  request->out = NULL;
+  request->out_size = 0;
+  request->out_length = 0;
+  request->frames = ToBoolean(env, argv[4]);
+  request->num_events = 0;
+  request->callback = Persist(env, argv[3]);
+  request->mh_ref = Persist(env, argv[0]);
+  request->in_ref = Persist(env, argv[1]);
+
+  if (pool_queue(env, mh, &request->work,
+      node_mpg123_feed_and_drain_async,
+      node_mpg123_feed_and_drain_after,
+      node_mpg123_feed_and_drain_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
+}
+
+void node_mpg123_feed_and_drain_async (pool_work *req) {
+  drain_req *r = (drain_req *)req;
+  mpg123_handle *mh = r->mh;
+
+  r->rtn = mpg123_feed(mh, r->in, r->size);
+  if (r->rtn != MPG123_OK) return;
+
+  for (;;) {
+    if (r->num_events > DRAIN_MAX_EVENTS - 2) {
+      // no room for more events, JS calls back in to drain the rest
+      r->rtn = MPG123_OK;
+      break;
+    }
+
+    // room for at least one more frame (the frame buffer must also fit any
+    // format that a NEW_FORMAT might switch to)
+    size_t outblock = mpg123_outblock(mh);
+    size_t block = r->frames ? mpg123_safe_buffer() : outblock;
+    if (r->out == NULL) {
+      // DRAIN_MAX_FRAMES frames, or as many as the input that's buffered
+      // makes (give or take VBR). Until the first frame, mpg123_outblock()
+      // is the safe size too: one such block, which holds several frames
+      // once the format is known.
+      size_t frames = DRAIN_MAX_FRAMES;
+      struct mpg123_frameinfo fi;
+      long fill;
+      if (outblock >= mpg123_safe_buffer()) {
+        frames = 1;
+      } else if (mpg123_info(mh, &fi) == MPG123_OK && fi.framesize > 4 &&
+          mpg123_getstate(mh, MPG123_BUFFERFILL, &fill, NULL) == MPG123_OK &&
+          (size_t)(fill / fi.framesize + 2) < frames) {
+        frames = fill / fi.framesize + 2;
       }
-      Nan::Set(o, Nan::New<String>("genre").ToLocalChecked(), Nan::New<Integer>(v1->genre));
-      rtn = o;
-#undef SET
-    } else if (v2 != NULL) {
-      /* got id3v2 tags */
-      mpg123_string *s;
-      mpg123_text *t;
-      Local<Object> o = Nan::New<Object>();
-      Local<Array> a;
-      Local<Object> text;
-#define SET(prop) \
-      s = v2->prop; \
-      if (s != NULL) \
-        Nan::Set(o, Nan::New<String>(#prop).ToLocalChecked(), Nan::New<String>(s->p, mpg123_strlen(s, 1)).ToLocalChecked());
-      SET(title)
-      SET(artist)
-      SET(album)
-      SET(year)
-      SET(genre)
-      SET(comment)
-#undef SET
+      r->out_size = outblock * (frames - 1) + block;
+      r->out = (unsigned char *)malloc(r->out_size);
+      if (r->out == NULL) {
+        r->rtn = MPG123_OUT_OF_MEM;
+        break;
+      }
+    }
+    if (r->out_size - r->out_length < block) {
+      // no room for more PCM, JS calls back in to drain the rest
+      r->rtn = MPG123_OK;
+      break;
+    }
 
-#define SET_ARRAY(array, count) \
-      a = Nan::New<Array>(v2->count); \
-      for (size_t i = 0; i < v2->count; i++) { \
-        t = &v2->array[i]; \
-        text = Nan::New<Object>(); \
-        Nan::Set(a, i, text); \
-        Nan::Set(text, Nan::New<String>("lang").ToLocalChecked(), Nan::New<String>(t->lang, min(sizeof(t->lang), strlen(t->lang))).ToLocalChecked()); \
-        Nan::Set(text, Nan::New<String>("id").ToLocalChecked(), Nan::New<String>(t->id, min(sizeof(t->id), strlen(t->id))).ToLocalChecked()); \
-        s = &t->description; \
-        if (s != NULL) \
-          Nan::Set(text, Nan::New<String>("description").ToLocalChecked(), Nan::New<String>(s->p, mpg123_strlen(s, 1)).ToLocalChecked()); \
-        s = &t->text; \
-        if (s != NULL) \
-          Nan::Set(text, Nan::New<String>("text").ToLocalChecked(), Nan::New<String>(s->p, mpg123_strlen(s, 1)).ToLocalChecked()); \
-      } \
-      Nan::Set(o, Nan::New<String>(#count).ToLocalChecked(), a);
-      SET_ARRAY(comment_list, comments)
-      SET_ARRAY(text, texts)
-      SET_ARRAY(extra, extras)
-#undef SET_ARRAY
+    size_t done = 0;
+    int ret;
+    if (r->frames) {
+      off_t num;
+      unsigned char *audio = NULL;
+      unsigned char *out = r->out + r->out_length;
+      mpg123_replace_buffer(mh, out, r->out_size - r->out_length);
+      ret = mpg123_decode_frame(mh, &num, &audio, &done);
+      // after a format change libmpg123 goes back to its own buffer
+      if (done > 0 && audio != out) memmove(out, audio, done);
+    } else {
+      ret = mpg123_read(mh, r->out + r->out_length,
+          r->out_size - r->out_length, &done);
+    }
 
-      rtn = o;
+    /* any new metadata? */
+    if (mpg123_meta_check(mh) & MPG123_NEW_ID3) {
+      drain_event *e = &r->events[r->num_events++];
+      e->offset = r->out_length;
+      e->type = MPG123_NEW_ID3;
+      mpg123_id3(mh, &e->v1, &e->v2);
+    }
+
+    r->out_length += done;
+
+    if (ret == MPG123_NEW_FORMAT) {
+      drain_event *e = &r->events[r->num_events++];
+      e->offset = r->out_length;
+      e->type = MPG123_NEW_FORMAT;
+      mpg123_getformat(mh, &e->rate, &e->channels, &e->encoding);
+    } else if (ret != MPG123_OK) {
+      // MPG123_NEED_MORE, MPG123_DONE, or an error
+      r->rtn = ret;
+      break;
+    }
+  }
+
+  if (r->frames) {
+    // the arena is about to be handed over to JS
+    static unsigned char detached[16];
+    mpg123_replace_buffer(mh, detached, 0);
+  }
+}
+
+/* Feeds the whole buffer and parses every frame in it with
+ * mpg123_framebyframe_next(), without decoding any of them. That fills in the
+ * handle's frame index, and its gapless info if there is a LAME tag. The
+ * callback gets the return code and the number of frames seen. */
+NAPI_METHOD(node_mpg123_feed_and_scan) {
+  UNWRAP_MH(4);
+
+  // input buffer
+  char *input = UnwrapPointer(env, argv[1]);
+  size_t size = (size_t)ToNumber(env, argv[2]);
+
+  scan_req *request = new scan_req;
+  request->mh = mh;
+  request->in = (const unsigned char *)input;
+  request->size = size;
+  request->frames = 0;
+  request->callback = Persist(env, argv[3]);
+  request->mh_ref = Persist(env, argv[0]);
+  request->in_ref = Persist(env, argv[1]);
+
+  if (pool_queue(env, mh, &request->work,
+      node_mpg123_feed_and_scan_async,
+      node_mpg123_feed_and_scan_after,
+      node_mpg123_feed_and_scan_abandon) != napi_ok) {
+    napi_throw_error(env, NULL, POOL_QUEUE_ERROR);
+  }
+  return NULL;
+}
+
+void node_mpg123_feed_and_scan_async (pool_work *req) {
+  scan_req *r = (scan_req *)req;
+  mpg123_handle *mh = r->mh;
+  size_t offset = 0;
+  int ret = MPG123_NEED_MORE;
+
+  // fed in chunks, so that libmpg123 never holds a copy of the whole file
+  while (ret == MPG123_NEED_MORE && offset < r->size) {
+    size_t n = r->size - offset;
+    if (n > SCAN_CHUNK_SIZE) n = SCAN_CHUNK_SIZE;
+    ret = mpg123_feed(mh, r->in + offset, n);
+    if (ret != MPG123_OK) break;
+    offset += n;
+
+    while ((ret = mpg123_framebyframe_next(mh)) == MPG123_OK ||
+        ret == MPG123_NEW_FORMAT) {
+      r->frames++;
+    }
+  }
+  r->rtn = ret;
+}
+
+void node_mpg123_feed_and_scan_after (napi_env env, pool_work *req) {
+  scan_req *r = (scan_req *)req;
+
+  napi_value argv[2];
+  argv[0] = NewInt32(env, r->rtn);
+  argv[1] = NewNumber(env, r->frames);
+
+  pool_callback(env, req, r->callback, 2, argv);
+
+  // cleanup
+  node_mpg123_feed_and_scan_abandon(env, req);
+}
+
+void node_mpg123_feed_and_scan_abandon (napi_env env, pool_work *req) {
+  scan_req *r = (scan_req *)req;
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->mh_ref);
+    Unpersist(env, &r->in_ref);
+  }
+  delete r;
+}
+
+
+static void node_mpg123_free_arena (napi_env env, void *data, void *hint) {
+  free(data);
+}
+
+void node_mpg123_feed_and_drain_after (napi_env env, pool_work *req) {
+  drain_req *r = (drain_req *)req;
+
+  napi_value pcm = Null(env);
+  if (r->out_length > 0) {
+    // the arena as it is, with the length that was decoded into it
+    if (napi_create_external_buffer(env, r->out_length, r->out,
+          node_mpg123_free_arena, NULL, &pcm) == napi_ok) {
+      r->out = NULL;
     } else {
-      rtn = Nan::Null();
+      napi_create_buffer_copy(env, r->out_length, r->out, NULL, &pcm);
     }
   }
 
-  Handle<Value> argv[2];
-  argv[0] = Nan::New<Integer>(ireq->rtn);
-  argv[1] = rtn;
+  napi_value events;
+  napi_create_array_with_length(env, r->num_events, &events);
+  for (int i = 0; i < r->num_events; i++) {
+    drain_event *e = &r->events[i];
+    napi_value o;
+    napi_create_object(env, &o);
+    Set(env, o, "offset", NewNumber(env, e->offset));
+    if (e->type == MPG123_NEW_FORMAT) {
+      Set(env, o, "format", format_object(env, r->mh, e->rate, e->channels, e->encoding));
+    } else {
+      Set(env, o, "id3", id3_object(env, e->v1, e->v2));
+    }
+    SetIndex(env, events, i, o);
+  }
 
-  Nan::TryCatch try_catch;
+  napi_value argv[3];
+  argv[0] = NewInt32(env, r->rtn);
+  argv[1] = pcm;
+  argv[2] = events;
 
-  Nan::New(ireq->callback)->Call(Nan::GetCurrentContext()->Global(), 2, argv);
+  pool_callback(env, req, r->callback, 3, argv);
 
   // cleanup
-  ireq->callback.Reset();
-  delete ireq;
+  node_mpg123_feed_and_drain_abandon(env, req);
+}
 
-  if (try_catch.HasCaught()) {
-    FatalException(try_catch);
+void node_mpg123_feed_and_drain_abandon (napi_env env, pool_work *req) {
+  drain_req *r = (drain_req *)req;
+  free(r->out);
+  if (env != NULL) {
+    Unpersist(env, &r->callback);
+    Unpersist(env, &r->mh_ref);
+    Unpersist(env, &r->in_ref);
   }
+  delete r;
 }
 
 
-void InitMPG123(Handle<Object> target) {
-  Nan::HandleScope scope;
+void InitMPG123(napi_env env, napi_value target) {
 
 #define CONST_INT(value) \
-  Nan::ForceSet(target, Nan::New<String>(#value).ToLocalChecked(), Nan::New<Integer>(value), \
-      static_cast<PropertyAttribute>(ReadOnly|DontDelete));
+  SetConstant(env, target, #value, NewInt32(env, value));
 
   // mpg123_errors
   CONST_INT(MPG123_DONE);  /**< Message: Track ended. Stop decoding. */
@@ -478,28 +936,94 @@ void InitMPG123(Handle<Object> target) {
   CONST_INT(MPG123_RIGHT);
   CONST_INT(MPG123_LR);
 
+  /* mpg123_parms */
+  CONST_INT(MPG123_VERBOSE);
+  CONST_INT(MPG123_FLAGS);
+  CONST_INT(MPG123_ADD_FLAGS);
+  CONST_INT(MPG123_FORCE_RATE);
+  CONST_INT(MPG123_DOWN_SAMPLE);
+  CONST_INT(MPG123_RVA);
+  CONST_INT(MPG123_DOWNSPEED);
+  CONST_INT(MPG123_UPSPEED);
+  CONST_INT(MPG123_START_FRAME);
+  CONST_INT(MPG123_DECODE_FRAMES);
+  CONST_INT(MPG123_ICY_INTERVAL);
+  CONST_INT(MPG123_OUTSCALE);
+  CONST_INT(MPG123_TIMEOUT);
+  CONST_INT(MPG123_REMOVE_FLAGS);
+  CONST_INT(MPG123_RESYNC_LIMIT);
+  CONST_INT(MPG123_INDEX_SIZE);
+  CONST_INT(MPG123_PREFRAMES);
+  CONST_INT(MPG123_FEEDPOOL);
+  CONST_INT(MPG123_FEEDBUFFER);
+
+  /* mpg123_param_flags */
+  CONST_INT(MPG123_FORCE_MONO);
+  CONST_INT(MPG123_MONO_LEFT);
+  CONST_INT(MPG123_MONO_RIGHT);
+  CONST_INT(MPG123_MONO_MIX);
+  CONST_INT(MPG123_FORCE_STEREO);
+  CONST_INT(MPG123_FORCE_8BIT);
+  CONST_INT(MPG123_QUIET);
+  CONST_INT(MPG123_GAPLESS);
+  CONST_INT(MPG123_NO_RESYNC);
+  CONST_INT(MPG123_SEEKBUFFER);
+  CONST_INT(MPG123_FUZZY);
+  CONST_INT(MPG123_FORCE_FLOAT);
+  CONST_INT(MPG123_PLAIN_ID3TEXT);
+  CONST_INT(MPG123_IGNORE_STREAMLENGTH);
+  CONST_INT(MPG123_SKIP_ID3V2);
+  CONST_INT(MPG123_IGNORE_INFOFRAME);
+  CONST_INT(MPG123_AUTO_RESAMPLE);
+
+  /* mpg123_state */
+  CONST_INT(MPG123_ACCURATE);
+  CONST_INT(MPG123_BUFFERFILL);
+  CONST_INT(MPG123_FRANKENSTEIN);
+  CONST_INT(MPG123_ENC_DELAY);
+  CONST_INT(MPG123_ENC_PADDING);
+  CONST_INT(MPG123_DEC_DELAY);
+
+  /* whence */
+  CONST_INT(SEEK_SET);
+  CONST_INT(SEEK_CUR);
+  CONST_INT(SEEK_END);
+
   CONST_INT(MPG123_ID3);
   CONST_INT(MPG123_NEW_ID3);
   CONST_INT(MPG123_ICY);
   CONST_INT(MPG123_NEW_ICY);
 
-  Nan::SetMethod(target, "mpg123_init", node_mpg123_init);
-  Nan::SetMethod(target, "mpg123_exit", node_mpg123_exit);
-  Nan::SetMethod(target, "mpg123_new", node_mpg123_new);
-  Nan::SetMethod(target, "mpg123_decoders", node_mpg123_decoders);
-  Nan::SetMethod(target, "mpg123_current_decoder", node_mpg123_current_decoder);
-  Nan::SetMethod(target, "mpg123_supported_decoders", node_mpg123_supported_decoders);
-  Nan::SetMethod(target, "mpg123_getformat", node_mpg123_getformat);
-  Nan::SetMethod(target, "mpg123_safe_buffer", node_mpg123_safe_buffer);
-  Nan::SetMethod(target, "mpg123_outblock", node_mpg123_outblock);
-  Nan::SetMethod(target, "mpg123_framepos", node_mpg123_framepos);
-  Nan::SetMethod(target, "mpg123_tell", node_mpg123_tell);
-  Nan::SetMethod(target, "mpg123_tellframe", node_mpg123_tellframe);
-  Nan::SetMethod(target, "mpg123_tell_stream", node_mpg123_tell_stream);
-  Nan::SetMethod(target, "mpg123_open_feed", node_mpg123_open_feed);
-  Nan::SetMethod(target, "mpg123_feed", node_mpg123_feed);
-  Nan::SetMethod(target, "mpg123_read", node_mpg123_read);
-  Nan::SetMethod(target, "mpg123_id3", node_mpg123_id3);
+  SetMethod(env, target, "mpg123_init", node_mpg123_init);
+  SetMethod(env, target, "mpg123_exit", node_mpg123_exit);
+  SetMethod(env, target, "mpg123_new", node_mpg123_new);
+  SetMethod(env, target, "mpg123_decoders", node_mpg123_decoders);
+  SetMethod(env, target, "mpg123_current_decoder", node_mpg123_current_decoder);
+  SetMethod(env, target, "mpg123_supported_decoders", node_mpg123_supported_decoders);
+  SetMethod(env, target, "mpg123_getformat", node_mpg123_getformat);
+  SetMethod(env, target, "mpg123_safe_buffer", node_mpg123_safe_buffer);
+  SetMethod(env, target, "mpg123_outblock", node_mpg123_outblock);
+  SetMethod(env, target, "mpg123_framepos", node_mpg123_framepos);
+  SetMethod(env, target, "mpg123_tell", node_mpg123_tell);
+  SetMethod(env, target, "mpg123_tellframe", node_mpg123_tellframe);
+  SetMethod(env, target, "mpg123_tell_stream", node_mpg123_tell_stream);
+  SetMethod(env, target, "mpg123_open_feed", node_mpg123_open_feed);
+  SetMethod(env, target, "mpg123_spf", node_mpg123_spf);
+  SetMethod(env, target, "mpg123_encsize", node_mpg123_encsize);
+  SetMethod(env, target, "mpg123_param", node_mpg123_param);
+  SetMethod(env, target, "mpg123_getparam", node_mpg123_getparam);
+  SetMethod(env, target, "mpg123_getstate", node_mpg123_getstate);
+  SetMethod(env, target, "mpg123_format_none", node_mpg123_format_none);
+  SetMethod(env, target, "mpg123_format", node_mpg123_format);
+  SetMethod(env, target, "mpg123_rates", node_mpg123_rates);
+  SetMethod(env, target, "mpg123_feedseek", node_mpg123_feedseek);
+  SetMethod(env, target, "mpg123_index", node_mpg123_index);
+  SetMethod(env, target, "mpg123_set_index", node_mpg123_set_index);
+  SetMethod(env, target, "mpg123_feed", node_mpg123_feed);
+  SetMethod(env, target, "mpg123_read", node_mpg123_read);
+  SetMethod(env, target, "mpg123_feed_and_drain", node_mpg123_feed_and_drain);
+  SetMethod(env, target, "mpg123_feed_and_scan", node_mpg123_feed_and_scan);
+  SetMethod(env, target, "mpg123_id3", node_mpg123_id3);
 }
 
 } // nodelame namespace
@@ -1,46 +1,113 @@
-#include <v8.h>
-#include <node.h>
+#include <node_api.h>
+#include "node_pool.h"
 #include "mpg123.h"
 
 namespace nodelame {
 
 /* structs used for async decoding */
 struct feed_req {
-  uv_work_t req;
+  pool_work work;
   mpg123_handle *mh;
   const unsigned char *in;
   size_t size;
   int rtn;
-  Nan::Persistent<v8::Function> callback;
+  napi_ref callback;
+  napi_ref mh_ref;  /* keeps the handle and Buffer alive while on the worker */
+  napi_ref in_ref;
 };
 
 struct read_req {
-  uv_work_t req;
+  pool_work work;
   mpg123_handle *mh;
   unsigned char *out;
   size_t size;
   size_t done;
   int rtn;
   int meta;
-  Nan::Persistent<v8::Function> callback;
+  napi_ref callback;
+  napi_ref mh_ref;
+  napi_ref out_ref;
 };
 
 struct id3_req {
-  uv_work_t req;
+  pool_work work;
   mpg123_handle *mh;
   mpg123_id3v1 *v1;
   mpg123_id3v2 *v2;
   int rtn;
-  Nan::Persistent<v8::Function> callback;
+  napi_ref callback;
+  napi_ref mh_ref;
 };
 
-void node_mpg123_feed_async (uv_work_t *);
-void node_mpg123_feed_after (uv_work_t *);
+/* something that happened part way through a "drain_req" */
+struct drain_event {
+  size_t offset;  /* byte offset into the PCM output it happened at */
+  int type;       /* MPG123_NEW_FORMAT or MPG123_NEW_ID3 */
+  long rate;
+  int channels;
+  int encoding;
+  mpg123_id3v1 *v1;
+  mpg123_id3v2 *v2;
+};
+
+/* maximum number of events collected by a single "drain_req" */
+#define DRAIN_MAX_EVENTS 8
+
+/* most frames of PCM a "drain_req" arena is sized for */
+#define DRAIN_MAX_FRAMES 32
+
+/* struct used for the fused feed + read-until-MPG123_NEED_MORE call */
+struct drain_req {
+  pool_work work;
+  mpg123_handle *mh;
+  const unsigned char *in;
+  size_t size;
+  unsigned char *out;  /* arena, handed over to JS as a Buffer */
+  size_t out_size;
+  size_t out_length;
+  bool frames;  /* synthesize straight into "out" with mpg123_decode_frame() */
+  int rtn;
+  drain_event events[DRAIN_MAX_EVENTS];
+  int num_events;
+  napi_ref callback;
+  napi_ref mh_ref;
+  napi_ref in_ref;
+};
+
+/* struct used to parse (but not decode) every frame of a whole buffer */
+struct scan_req {
+  pool_work work;
+  mpg123_handle *mh;
+  const unsigned char *in;
+  size_t size;
+  double frames;
+  int rtn;
+  napi_ref callback;
+  napi_ref mh_ref;
+  napi_ref in_ref;
+};
+
+/* bytes handed to mpg123_feed() at a time while scanning */
+#define SCAN_CHUNK_SIZE 65536
+
+void node_mpg123_feed_async (pool_work *);
+void node_mpg123_feed_after (napi_env, pool_work *);
+void node_mpg123_feed_abandon (napi_env, pool_work *);
+
+void node_mpg123_read_async (pool_work *);
+void node_mpg123_read_after (napi_env, pool_work *);
+void node_mpg123_read_abandon (napi_env, pool_work *);
+
+void node_mpg123_feed_and_drain_async (pool_work *);
+void node_mpg123_feed_and_drain_after (napi_env, pool_work *);
+void node_mpg123_feed_and_drain_abandon (napi_env, pool_work *);
 
-void node_mpg123_read_async (uv_work_t *);
-void node_mpg123_read_after (uv_work_t *);
+void node_mpg123_feed_and_scan_async (pool_work *);
+void node_mpg123_feed_and_scan_after (napi_env, pool_work *);
+void node_mpg123_feed_and_scan_abandon (napi_env, pool_work *);
 
-void node_mpg123_id3_async (uv_work_t *);
-void node_mpg123_id3_after (uv_work_t *);
+void node_mpg123_id3_async (pool_work *);
+void node_mpg123_id3_after (napi_env, pool_work *);
+void node_mpg123_id3_abandon (napi_env, pool_work *);
 
 } // nodelame namespace
@@ -0,0 +1,132 @@
+/*
+ * Small helpers to keep the N-API boilerplate out of the bindings.
+ */
+
+#ifndef NODE_LAME_NAPI_H
+#define NODE_LAME_NAPI_H
+
+#include <stdint.h>
+#include <string.h>
+#include <node_api.h>
+
+#define NAPI_METHOD(name) \
+  napi_value name (napi_env env, napi_callback_info info)
+
+/* declares "argv" holding the first "n" arguments (missing ones are `undefined`) */
+#define NAPI_ARGS(n) \
+  size_t argc = n; \
+  napi_value argv[n]; \
+  napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+
+namespace nodelame {
+
+inline static int32_t ToInt32 (napi_env env, napi_value value, int32_t def = 0) {
+  int32_t rtn;
+  if (napi_get_value_int32(env, value, &rtn) != napi_ok) return def;
+  return rtn;
+}
+
+inline static uint32_t ToUint32 (napi_env env, napi_value value, uint32_t def = 0) {
+  uint32_t rtn;
+  if (napi_get_value_uint32(env, value, &rtn) != napi_ok) return def;
+  return rtn;
+}
+
+inline static double ToNumber (napi_env env, napi_value value, double def = 0) {
+  double rtn;
+  if (napi_get_value_double(env, value, &rtn) != napi_ok) return def;
+  return rtn;
+}
+
+inline static bool ToBoolean (napi_env env, napi_value value) {
+  bool rtn;
+  if (napi_coerce_to_bool(env, value, &value) != napi_ok) return false;
+  napi_get_value_bool(env, value, &rtn);
+  return rtn;
+}
+
+inline static napi_value NewInt32 (napi_env env, int32_t value) {
+  napi_value rtn;
+  napi_create_int32(env, value, &rtn);
+  return rtn;
+}
+
+inline static napi_value NewUint32 (napi_env env, uint32_t value) {
+  napi_value rtn;
+  napi_create_uint32(env, value, &rtn);
+  return rtn;
+}
+
+inline static napi_value NewNumber (napi_env env, double value) {
+  napi_value rtn;
+  napi_create_double(env, value, &rtn);
+  return rtn;
+}
+
+inline static napi_value NewBoolean (napi_env env, bool value) {
+  napi_value rtn;
+  napi_get_boolean(env, value, &rtn);
+  return rtn;
+}
+
+inline static napi_value NewString (napi_env env, const char *value, size_t length = NAPI_AUTO_LENGTH) {
+  napi_value rtn;
+  napi_create_string_utf8(env, value, length, &rtn);
+  return rtn;
+}
+
+inline static napi_value Null (napi_env env) {
+  napi_value rtn;
+  napi_get_null(env, &rtn);
+  return rtn;
+}
+
+inline static napi_value Undefined (napi_env env) {
+  napi_value rtn;
+  napi_get_undefined(env, &rtn);
+  return rtn;
+}
+
+inline static void Set (napi_env env, napi_value object, const char *key, napi_value value) {
+  napi_set_named_property(env, object, key, value);
+}
+
+inline static void SetIndex (napi_env env, napi_value array, uint32_t index, napi_value value) {
+  napi_set_element(env, array, index, value);
+}
+
+inline static void SetMethod (napi_env env, napi_value target, const char *name, napi_callback fn) {
+  napi_value f;
+  napi_create_function(env, name, NAPI_AUTO_LENGTH, fn, NULL, &f);
+  napi_set_named_property(env, target, name, f);
+}
+
+/* defines a read-only, non-configurable property, like the old Nan::ForceSet() */
+inline static void SetConstant (napi_env env, napi_value target, const char *name, napi_value value) {
+  napi_property_descriptor desc = {
+    name, NULL, NULL, NULL, NULL, value, napi_enumerable, NULL
+  };
+  napi_define_properties(env, target, 1, &desc);
+}
+
+/* a strong reference to "value", or NULL for non-objects */
+inline static napi_ref Persist (napi_env env, napi_value value) {
+  napi_ref ref = NULL;
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+  if (type == napi_object || type == napi_function || type == napi_external) {
+    napi_create_reference(env, value, 1, &ref);
+  }
+  return ref;
+}
+
+inline static void Unpersist (napi_env env, napi_ref *ref) {
+  if (*ref != NULL) {
+    napi_delete_reference(env, *ref);
+    *ref = NULL;
+  }
+}
+
+} // nodelame namespace
+
+#endif
@@ -3,45 +3,55 @@
  * Helper functions for treating node Buffer instances as C "pointers".
  */
 
-#include "v8.h"
-#include "nan.h"
-#include "node_buffer.h"
+#ifndef NODE_LAME_POINTER_H
+#define NODE_LAME_POINTER_H
 
-/*
- * Called when the "pointer" is garbage collected.
- */
-
-inline static void wrap_pointer_cb(char *data, void *hint) {
-  //fprintf(stderr, "wrap_pointer_cb\n");
-}
+#include <stdint.h>
+#include <node_api.h>
 
 /*
- * Wraps "ptr" into a new SlowBuffer instance with size "length".
+ * Wraps "ptr" into a new `External` value. "finalize" is called when it gets
+ * garbage collected (may be NULL).
  */
 
-inline static Nan::MaybeLocal<v8::Object> WrapPointer(void *ptr, size_t length) {
-  void *user_data = NULL;
-  return Nan::NewBuffer((char *)ptr, length, wrap_pointer_cb, user_data);
+inline static napi_value WrapPointer(napi_env env, void *ptr, napi_finalize finalize = NULL) {
+  napi_value rtn;
+  if (napi_create_external(env, ptr, finalize, NULL, &rtn) != napi_ok) return NULL;
+  return rtn;
 }
 
 /*
- * Wraps "ptr" into a new SlowBuffer instance with length 0.
+ * Unwraps Buffer instance (or `External`) "buffer" to a C `char *` with the
+ * offset specified.
  */
 
-inline static Nan::MaybeLocal<v8::Object> WrapPointer(void *ptr) {
-  return WrapPointer((char *)ptr, 0);
+inline static char * UnwrapPointer(napi_env env, napi_value buffer, int64_t offset = 0) {
+  bool is_buffer = false;
+  void *data = NULL;
+  napi_is_buffer(env, buffer, &is_buffer);
+  if (is_buffer) {
+    napi_get_buffer_info(env, buffer, &data, NULL);
+    return (char *)data + offset;
+  }
+  napi_valuetype type;
+  napi_typeof(env, buffer, &type);
+  if (type == napi_external) {
+    napi_get_value_external(env, buffer, &data);
+    return (char *)data + offset;
+  }
+  return NULL;
 }
 
 /*
- * Unwraps Buffer instance "buffer" to a C `char *` with the offset specified.
+ * Returns the byte length of Buffer instance "buffer" (0 for non-Buffers).
  */
 
-inline static char * UnwrapPointer(v8::Handle<v8::Value> buffer, int64_t offset = 0) {
-  if (node::Buffer::HasInstance(buffer)) {
-    return node::Buffer::Data(buffer.As<v8::Object>()) + offset;
-  } else {
-    return NULL;
-  }
+inline static size_t BufferLength(napi_env env, napi_value buffer) {
+  bool is_buffer = false;
+  size_t length = 0;
+  napi_is_buffer(env, buffer, &is_buffer);
+  if (is_buffer) napi_get_buffer_info(env, buffer, NULL, &length);
+  return length;
 }
 
 /**
@@ -50,6 +60,8 @@ inline static char * UnwrapPointer(v8::Handle<v8::Value> buffer, int64_t offset
  */
 
 template <typename Type>
-inline static Type UnwrapPointer(v8::Handle<v8::Value> buffer) {
-  return reinterpret_cast<Type>(UnwrapPointer(buffer));
+inline static Type UnwrapPointer(napi_env env, napi_value buffer) {
+  return reinterpret_cast<Type>(UnwrapPointer(env, buffer));
 }
+
+#endif
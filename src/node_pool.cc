@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2011, Nathan Rajlich <nathan@tootallnate.net>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <uv.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "node_napi.h"
+#include "node_pool.h"
+
+namespace nodelame {
+
+/* one thread, and its queue of work */
+struct pool_worker {
+  std::mutex lock;
+  std::condition_variable cond;
+  pool_work *head;
+  pool_work *tail;
+  unsigned int queued;     /* waiting + running */
+  unsigned int max_queued; /* high-water mark of "queued" */
+  double completed;
+  bool busy;
+};
+
+/* per-env state: where finished work gets handed back to the main thread */
+struct pool_context {
+  napi_env env;
+  uv_async_t async;
+  napi_async_context async_context;
+  std::mutex lock;
+  pool_work *done_head;
+  pool_work *done_tail;
+  unsigned int in_flight;  /* queued on a worker, guarded by "lock" */
+  unsigned int pending;    /* waiting for "complete", main thread only */
+  bool closing;            /* the env is going away */
+  bool closed;             /* and "async" is closed: the last one out frees it */
+};
+
+/* intentionally never freed: the threads are still blocked on them at exit */
+static pool_worker *workers = NULL;
+static unsigned int pool_size = 0;
+static bool pool_started = false;
+static std::mutex pool_start_lock;
+/* the pool_contexts not yet freed, of all the envs */
+static std::atomic<unsigned int> pool_contexts(0);
+
+
+static void pool_context_free (pool_context *ctx) {
+  delete ctx;
+  pool_contexts--;
+}
+
+
+static void pool_worker_run (pool_worker *w) {
+  for (;;) {
+    pool_work *work;
+    {
+      std::unique_lock<std::mutex> l(w->lock);
+      while (w->head == NULL) w->cond.wait(l);
+      work = w->head;
+      w->head = work->next;
+      if (w->head == NULL) w->tail = NULL;
+      w->busy = true;
+    }
+
+    pool_context *ctx = work->context;
+    bool closing;
+    {
+      std::lock_guard<std::mutex> l(ctx->lock);
+      closing = ctx->closing;
+    }
+    if (!closing) work->execute(work);
+
+    {
+      std::lock_guard<std::mutex> l(w->lock);
+      w->busy = false;
+      w->queued--;
+      w->completed++;
+    }
+
+    // hand it back to the main thread of the env that queued it
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> l(ctx->lock);
+      if (!ctx->closing) {
+        work->next = NULL;
+        if (ctx->done_tail != NULL) {
+          ctx->done_tail->next = work;
+        } else {
+          ctx->done_head = work;
+        }
+        ctx->done_tail = work;
+        uv_async_send(&ctx->async);
+        continue;
+      }
+      last = --ctx->in_flight == 0 && ctx->closed;
+    }
+    // the env is gone, nothing left to call back into
+    work->abandon(NULL, work);
+    if (last) pool_context_free(ctx);
+  }
+}
+
+
+/* lazily spawn the worker threads on first use */
+static void pool_start () {
+  std::lock_guard<std::mutex> l(pool_start_lock);
+  if (pool_started) return;
+  for (unsigned int i = 0; i < pool_size; i++) {
+    std::thread(pool_worker_run, &workers[i]).detach();
+  }
+  pool_started = true;
+}
+
+
+/* sticky assignment of a handle to a worker (a hash of its address) */
+static unsigned int pool_assign (const void *handle) {
+  uint64_t h = (uint64_t)(uintptr_t)handle;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (unsigned int)(h % pool_size);
+}
+
+
+/* runs on the main thread whenever workers have finished something */
+static void pool_after (uv_async_t *async) {
+  pool_context *ctx = (pool_context *)async->data;
+  pool_work *work;
+  {
+    std::lock_guard<std::mutex> l(ctx->lock);
+    work = ctx->done_head;
+    ctx->done_head = ctx->done_tail = NULL;
+  }
+
+  napi_handle_scope scope;
+  napi_open_handle_scope(ctx->env, &scope);
+  while (work != NULL) {
+    pool_work *next = work->next;
+    {
+      std::lock_guard<std::mutex> l(ctx->lock);
+      ctx->in_flight--;
+    }
+    // may queue more work (and ref the async handle again)
+    if (--ctx->pending == 0) uv_unref((uv_handle_t *)&ctx->async);
+    work->complete(ctx->env, work);
+    work = next;
+  }
+  napi_close_handle_scope(ctx->env, scope);
+}
+
+
+static void pool_context_closed (uv_handle_t *handle) {
+  pool_context *ctx = (pool_context *)handle->data;
+  bool in_flight;
+  {
+    std::lock_guard<std::mutex> l(ctx->lock);
+    in_flight = ctx->in_flight > 0;
+    ctx->closed = true;
+  }
+  // workers still hold on to it otherwise, and the last of them frees it
+  if (!in_flight) pool_context_free(ctx);
+}
+
+
+static void pool_cleanup (void *arg) {
+  pool_context *ctx = (pool_context *)arg;
+  pool_work *work;
+  {
+    std::lock_guard<std::mutex> l(ctx->lock);
+    ctx->closing = true;
+    work = ctx->done_head;
+    ctx->done_head = ctx->done_tail = NULL;
+    for (pool_work *w = work; w != NULL; w = w->next) ctx->in_flight--;
+  }
+  // finished, but never handed back: free them here, where the env still is
+  while (work != NULL) {
+    pool_work *next = work->next;
+    work->abandon(ctx->env, work);
+    work = next;
+  }
+  napi_async_destroy(ctx->env, ctx->async_context);
+  uv_close((uv_handle_t *)&ctx->async, pool_context_closed);
+}
+
+
+napi_status pool_queue (napi_env env, const void *handle, pool_work *work,
+    pool_execute_cb execute, pool_complete_cb complete, pool_abandon_cb abandon) {
+  pool_context *ctx = NULL;
+  napi_status status = napi_get_instance_data(env, (void **)&ctx);
+  if (status == napi_ok && (ctx == NULL || ctx->closing)) status = napi_generic_failure;
+  if (status != napi_ok) {
+    abandon(env, work);
+    return status;
+  }
+
+  pool_start();
+
+  work->execute = execute;
+  work->complete = complete;
+  work->abandon = abandon;
+  work->context = ctx;
+  work->next = NULL;
+
+  if (ctx->pending++ == 0) uv_ref((uv_handle_t *)&ctx->async);
+  {
+    std::lock_guard<std::mutex> l(ctx->lock);
+    ctx->in_flight++;
+  }
+
+  pool_worker *w = &workers[pool_assign(handle)];
+  {
+    std::lock_guard<std::mutex> l(w->lock);
+    if (w->tail != NULL) {
+      w->tail->next = work;
+    } else {
+      w->head = work;
+    }
+    w->tail = work;
+    if (++w->queued > w->max_queued) w->max_queued = w->queued;
+  }
+  w->cond.notify_one();
+  return napi_ok;
+}
+
+
+void pool_callback (napi_env env, pool_work *work, napi_ref callback,
+    size_t argc, const napi_value *argv) {
+  napi_value fn;
+  napi_value global;
+  napi_value result;
+  napi_get_reference_value(env, callback, &fn);
+  napi_get_global(env, &global);
+
+  napi_status status = napi_make_callback(env, work->context->async_context,
+      global, fn, argc, argv, &result);
+
+  if (status == napi_pending_exception) {
+    napi_value err;
+    napi_get_and_clear_last_exception(env, &err);
+    napi_fatal_exception(env, err);
+  }
+}
+
+
+/* pool_stats()
+ * Returns the pool size, and the queue depth of each worker */
+NAPI_METHOD(node_pool_stats) {
+  pool_context *ctx;
+  napi_get_instance_data(env, (void **)&ctx);
+
+  napi_value rtn;
+  napi_value list;
+  napi_create_object(env, &rtn);
+  napi_create_array_with_length(env, pool_size, &list);
+
+  unsigned int queued = 0;
+  for (unsigned int i = 0; i < pool_size; i++) {
+    pool_worker *w = &workers[i];
+    napi_value o;
+    napi_create_object(env, &o);
+    std::lock_guard<std::mutex> l(w->lock);
+    Set(env, o, "queued", NewUint32(env, w->queued));
+    Set(env, o, "maxQueued", NewUint32(env, w->max_queued));
+    Set(env, o, "completed", NewNumber(env, w->completed));
+    Set(env, o, "busy", NewBoolean(env, w->busy));
+    SetIndex(env, list, i, o);
+    queued += w->queued;
+  }
+
+  Set(env, rtn, "size", NewUint32(env, pool_size));
+  Set(env, rtn, "started", NewBoolean(env, pool_started));
+  Set(env, rtn, "queued", NewUint32(env, queued));
+  Set(env, rtn, "pending", NewUint32(env, ctx->pending));
+  Set(env, rtn, "contexts", NewUint32(env, pool_contexts));
+  Set(env, rtn, "workers", list);
+  return rtn;
+}
+
+
+void InitPool (napi_env env, napi_value target) {
+  {
+    std::lock_guard<std::mutex> l(pool_start_lock);
+    if (pool_size == 0) {
+      const char *size = getenv("LAME_THREADPOOL_SIZE");
+      int n = size != NULL ? atoi(size) : 0;
+      if (n <= 0) n = (int)std::thread::hardware_concurrency();
+      if (n <= 0) n = 4;
+      if (n > POOL_MAX_SIZE) n = POOL_MAX_SIZE;
+      pool_size = (unsigned int)n;
+      workers = new pool_worker[pool_size]();
+    }
+  }
+
+  pool_context *ctx = new pool_context();
+  pool_contexts++;
+  ctx->env = env;
+  ctx->done_head = ctx->done_tail = NULL;
+  ctx->in_flight = 0;
+  ctx->pending = 0;
+  ctx->closing = false;
+  ctx->closed = false;
+
+  uv_loop_t *loop;
+  napi_get_uv_event_loop(env, &loop);
+  uv_async_init(loop, &ctx->async, pool_after);
+  ctx->async.data = ctx;
+  // only keeps the loop alive while there's work pending
+  uv_unref((uv_handle_t *)&ctx->async);
+
+  napi_async_init(env, NULL, NewString(env, "lame:pool"), &ctx->async_context);
+
+  napi_set_instance_data(env, ctx, NULL, NULL);
+  napi_add_env_cleanup_hook(env, pool_cleanup, ctx);
+
+  SetConstant(env, target, "pool_size", NewUint32(env, pool_size));
+  SetMethod(env, target, "pool_stats", node_pool_stats);
+}
+
+} // nodelame namespace
@@ -0,0 +1,62 @@
+/*
+ * The audio worker pool.
+ *
+ * A fixed set of threads, separate from libuv's shared threadpool, that run
+ * every encode/decode call. Each worker owns its own queue, and work for a
+ * given `lame_global_flags` / `mpg123_handle` is always queued on the same
+ * worker, so calls on one handle never run concurrently and its state stays
+ * hot in that core's cache.
+ *
+ * The pool size is read once from the LAME_THREADPOOL_SIZE environment
+ * variable when the module is loaded (default: number of cores). The threads
+ * are started on first use.
+ */
+
+#ifndef NODE_LAME_POOL_H
+#define NODE_LAME_POOL_H
+
+#include <node_api.h>
+
+namespace nodelame {
+
+struct pool_work;
+struct pool_context;
+
+/* runs on a worker thread */
+typedef void (*pool_execute_cb) (pool_work *);
+/* runs on the main thread once "execute" is done */
+typedef void (*pool_complete_cb) (napi_env, pool_work *);
+/* frees the request instead, without calling into JS, when its env closes
+ * before "complete" could run. "env" is NULL on a worker thread, where the
+ * napi_refs can't be deleted: they go with the env. */
+typedef void (*pool_abandon_cb) (napi_env, pool_work *);
+
+/* embed as the first member of an async request struct */
+struct pool_work {
+  pool_execute_cb execute;
+  pool_complete_cb complete;
+  pool_abandon_cb abandon;
+  pool_context *context;
+  pool_work *next;
+};
+
+/* the message of the Error thrown when pool_queue() fails */
+#define POOL_QUEUE_ERROR "could not queue work on the audio worker pool"
+
+/* the maximum number of workers */
+#define POOL_MAX_SIZE 128
+
+void InitPool (napi_env, napi_value);
+
+/* queue "work" on the worker that "handle" is assigned to. On failure
+ * "work" has been abandoned, and the binding throws POOL_QUEUE_ERROR. */
+napi_status pool_queue (napi_env, const void *handle, pool_work *work,
+    pool_execute_cb execute, pool_complete_cb complete, pool_abandon_cb abandon);
+
+/* call "callback" with the given arguments, from a pool_complete_cb */
+void pool_callback (napi_env, pool_work *work, napi_ref callback,
+    size_t argc, const napi_value *argv);
+
+} // nodelame namespace
+
+#endif
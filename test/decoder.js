@@ -44,6 +44,187 @@ describe('Decoder', function () {
       file.pipe(decoder);
     });
 
+    it('should report the mpg123 decoder in the "format" event', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      var decoder = new lame.Decoder();
+      decoder.on('format', function (format) {
+        assert.equal(lame.decoders()[0], format.decoder);
+        var generic = new lame.Decoder({ decoder: 'generic' });
+        generic.on('format', function (format) {
+          assert.equal('generic', format.decoder);
+          done();
+        });
+        generic.end(mp3);
+      });
+      decoder.end(mp3);
+    });
+
+    it('should emit "format" before any PCM data', function (done) {
+      var file = fs.createReadStream(filename);
+      var decoder = new lame.Decoder();
+      var format = null;
+      var bytes = 0;
+      decoder.on('format', function (f) {
+        assert.equal(0, bytes);
+        format = f;
+      });
+      decoder.on('data', function (b) {
+        assert(format);
+        bytes += b.length;
+      });
+      decoder.on('end', function () {
+        assert(bytes > 0);
+        assert.equal(0, bytes % (format.channels * format.bitDepth / 8));
+        done();
+      });
+      file.pipe(decoder);
+    });
+
+    it('should output the same PCM data in "zeroCopy" mode', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      decode({}, function (err, expected) {
+        if (err) return done(err);
+        decode({ zeroCopy: true }, function (err, actual) {
+          if (err) return done(err);
+          assert(actual.length > 0);
+          assert.deepEqual(actual, expected);
+          done();
+        });
+      });
+      function decode (opts, fn) {
+        var decoder = new lame.Decoder(opts);
+        var bufs = [];
+        decoder.on('data', function (b) { bufs.push(b); });
+        decoder.on('end', function () { fn(null, Buffer.concat(bufs)); });
+        decoder.on('error', fn);
+        for (var i = 0; i < mp3.length; i += 1000) {
+          decoder.write(mp3.slice(i, i + 1000));
+        }
+        decoder.end();
+      }
+    });
+
+    [ false, true ].forEach(function (zeroCopy) {
+      it('should hand over the PCM without copying it' + (zeroCopy ? ' in "zeroCopy" mode' : ''), function (done) {
+        // the Buffers are mpg123's own output, not allocated by node, so they
+        // don't count in "arrayBuffers" (a copy would)
+        if (null == process.memoryUsage().arrayBuffers) return done();
+        var mp3 = fs.readFileSync(filename);
+        var decoder = new lame.Decoder({ zeroCopy: zeroCopy });
+        var bufs = [];
+        var length = 0;
+        var before = process.memoryUsage().arrayBuffers;
+        decoder.on('data', function (b) {
+          bufs.push(b);
+          length += b.length;
+        });
+        decoder.on('end', function () {
+          var grown = process.memoryUsage().arrayBuffers - before;
+          assert(length > 1000000, length);
+          assert(grown < length / 10, grown + ' of ' + length + ' bytes copied');
+          done();
+        });
+        decoder.on('error', done);
+        decoder.end(mp3);
+      });
+    });
+
+    it('should decode with each of lame.decoders()', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      var decoders = lame.decoders();
+      var lengths = [];
+      assert.notEqual(-1, decoders.indexOf('generic'));
+      decoders.forEach(function (name) {
+        var decoder = new lame.Decoder({ decoder: name });
+        var bytes = 0;
+        decoder.on('data', function (b) { bytes += b.length; });
+        decoder.on('end', function () {
+          lengths.push(bytes);
+          if (lengths.length < decoders.length) return;
+          assert(lengths[0] > 0);
+          lengths.forEach(function (n) { assert.equal(lengths[0], n); });
+          done();
+        });
+        decoder.end(mp3);
+      });
+    });
+
+    it('should decode to the given "rate", "channels" and "encoding"', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      var cases = [
+        { rate: 48000, channels: 1, encoding: 's16', bitDepth: 16, float: false },
+        { rate: 16000, channels: 2, encoding: 's32', bitDepth: 32, float: false },
+        { rate: 44100, channels: 2, encoding: 'f32', bitDepth: 32, float: true }
+      ];
+      var frames = 0;
+      var native = new lame.Decoder();
+      var nativeFormat;
+      native.on('format', function (f) { nativeFormat = f; });
+      native.on('data', function (b) { frames += b.length; });
+      native.on('end', function () {
+        frames /= nativeFormat.channels * 2;
+        next(0);
+      });
+      native.end(mp3);
+
+      function next (i) {
+        if (i >= cases.length) return done();
+        var c = cases[i];
+        var decoder = new lame.Decoder({ rate: c.rate, channels: c.channels, encoding: c.encoding });
+        var format = null;
+        var bytes = 0;
+        decoder.on('format', function (f) { format = f; });
+        decoder.on('data', function (b) { bytes += b.length; });
+        decoder.on('end', function () {
+          assert.equal(c.rate, format.sampleRate);
+          assert.equal(c.channels, format.channels);
+          assert.equal(c.bitDepth, format.bitDepth);
+          assert.equal(c.float, format.float);
+          var expected = frames * c.rate / nativeFormat.sampleRate;
+          var actual = bytes / (c.channels * c.bitDepth / 8);
+          // NtoM rounds at the frame boundaries, so it's not exact
+          assert(Math.abs(actual - expected) < expected / 1000, actual + ' vs. ' + expected);
+          next(i + 1);
+        });
+        decoder.end(mp3);
+      }
+    });
+
+    it('should push Float32Array views of "f32" output in "typedArray" mode', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      var s16 = [];
+      var f32 = [];
+      var decoder = new lame.Decoder();
+      decoder.on('data', function (b) { s16.push(b); });
+      decoder.on('end', function () {
+        s16 = Buffer.concat(s16);
+        var floats = new lame.Decoder({ encoding: 'f32', typedArray: true });
+        floats.on('data', function (a) {
+          assert(a instanceof Float32Array);
+          f32.push(a);
+        });
+        floats.on('end', function () {
+          var n = 0;
+          f32.forEach(function (a) {
+            for (var i = 0; i < a.length; i++, n++) {
+              // the 16-bit output is the same sum, truncated
+              assert(Math.abs(a[i] * 32768 - s16.readInt16LE(2 * n)) <= 1);
+            }
+          });
+          assert.equal(s16.length / 2, n);
+          done();
+        });
+        floats.end(mp3);
+      });
+      decoder.end(mp3);
+    });
+
+    it('should throw on an unsupported "rate", "channels" or "encoding"', function () {
+      assert.throws(function () { new lame.Decoder({ rate: 200000 }); }, /rate/);
+      assert.throws(function () { new lame.Decoder({ channels: 3 }); }, /channels/);
+      assert.throws(function () { new lame.Decoder({ encoding: 'u8' }); }, /encoding/);
+    });
+
     it('should emit a single "finish" event', function (done) {
       var file = fs.createReadStream(filename);
       var output = fs.createWriteStream(outputName);
@@ -101,4 +282,255 @@ describe('Decoder', function () {
 
   });
 
+  describe('seek()', function () {
+    var filename = path.resolve(fixtures, 'pipershut_lo.mp3');
+    var mp3 = fs.readFileSync(filename);
+
+    function decodeAll (fn) {
+      var decoder = new lame.Decoder();
+      var bufs = [];
+      decoder.on('data', function (b) { bufs.push(b); });
+      decoder.on('error', fn);
+      decoder.on('end', function () { fn(null, Buffer.concat(bufs)); });
+      decoder.end(mp3);
+    }
+
+    // writes the start of the stream, seeks to "sample" and writes the rest
+    // from the byte offset seek() returns
+    function decodeFrom (opts, sample, fn) {
+      var decoder = new lame.Decoder(opts);
+      var bufs = [];
+      var inputOffset;
+      decoder.on('data', function (b) { bufs.push(b); });
+      decoder.on('error', fn);
+      decoder.on('end', function () {
+        fn(null, Buffer.concat(bufs), inputOffset);
+      });
+      var index = Buffer.isBuffer(opts.index) ? lame.readIndex(opts.index) : opts.index;
+      decoder.write(mp3.slice(0, index.offsets[0] + 2881), function () {
+        inputOffset = decoder.seek(sample);
+        decoder.end(mp3.slice(inputOffset));
+      });
+    }
+
+    it('should output the same PCM data from the sample on', function (done) {
+      decodeAll(function (err, expected) {
+        if (err) return done(err);
+        lame.Decoder.scan(mp3, function (err, index) {
+          if (err) return done(err);
+          assert(index.frames > 0);
+          // the index as stored in a sidecar file and loaded back
+          index = JSON.parse(JSON.stringify(index));
+          var sample = 20000;
+          var blockAlign = 4;
+          decodeFrom({ index: index }, sample, function (err, pcm, inputOffset) {
+            if (err) return done(err);
+            assert(inputOffset > index.offsets[0]);
+            assert(inputOffset < mp3.length / 2);
+            var tail = expected.slice(sample * blockAlign);
+            // the PCM of the frames written before the seek comes first
+            var head = pcm.length - tail.length;
+            assert(head >= 0 && head < sample * blockAlign, 'head: ' + head);
+            assert(expected.slice(0, head).equals(pcm.slice(0, head)));
+            assert(tail.equals(pcm.slice(head)));
+            done();
+          });
+        });
+      });
+    });
+
+    it('should seek and know the length with a sidecar file', function (done) {
+      decodeAll(function (err, expected) {
+        if (err) return done(err);
+        lame.Decoder.scan(mp3, function (err, index) {
+          if (err) return done(err);
+          assert.equal(1001, index.audioStart);
+          assert.equal(mp3.length - 128, index.audioEnd);
+          assert.equal(expected.length / 4, index.samples);
+          var sidecar = lame.writeIndex(index);
+          assert.deepEqual(index, lame.readIndex(sidecar));
+          var sample = 123456;
+          decodeFrom({ index: sidecar }, sample, function (err, pcm) {
+            if (err) return done(err);
+            var tail = expected.slice(sample * 4);
+            assert(tail.equals(pcm.slice(pcm.length - tail.length)));
+            done();
+          });
+        });
+      });
+    });
+
+    it('should report the gapless length of a sidecar file up front', function (done) {
+      var pcm = Buffer.alloc(44100 * 4 * 3);
+      lame.encodeParallel(pcm, {}, function (err, mp3) {
+        if (err) return done(err);
+        lame.Decoder.scan(mp3, function (err, index) {
+          if (err) return done(err);
+          var decoder = new lame.Decoder({ index: lame.writeIndex(index) });
+          assert.equal(576, decoder.encoderDelay);
+          assert(decoder.encoderPadding > 0);
+          assert.equal(pcm.length / 4, decoder.samples);
+          done();
+        });
+      });
+    });
+
+    it('should throw on a bad sidecar file', function () {
+      assert.throws(function () {
+        new lame.Decoder({ index: Buffer.from('not an index') });
+      }, /not a frame index file/);
+    });
+
+    it('should give back the index a full decode built', function (done) {
+      var decoder = new lame.Decoder();
+      decoder.on('finish', function () {
+        var index = decoder.index();
+        lame.Decoder.scan(mp3, function (err, scanned) {
+          if (err) return done(err);
+          assert.equal(scanned.step, index.step);
+          assert.deepEqual(scanned.offsets, index.offsets);
+          done();
+        });
+      });
+      decoder.resume();
+      decoder.end(mp3);
+    });
+
+    it('should throw before the start of the stream is written', function () {
+      var decoder = new lame.Decoder();
+      assert.throws(function () { decoder.seek(0); }, /start of the MP3 stream/);
+    });
+
+  });
+
+  describe('reuse', function () {
+    var filename = path.resolve(fixtures, 'pipershut_lo.mp3');
+    var mp3 = fs.readFileSync(filename);
+    // the whole file, the start of it, and a part that starts mid-stream
+    var streams = [ mp3, mp3.slice(0, 40000), mp3.slice(100000, 160000), mp3 ];
+
+    // decodes the streams one after the other, and calls `fn` with their PCM
+    function decodeStreams (opts, fn) {
+      var pcms = [];
+      (function next (i) {
+        if (i == streams.length) return fn(null, pcms);
+        var decoder = new lame.Decoder(opts);
+        var bufs = [];
+        decoder.on('data', function (b) { bufs.push(b); });
+        decoder.on('error', fn);
+        decoder.on('end', function () {
+          pcms.push(Buffer.concat(bufs));
+          next(i + 1);
+        });
+        decoder.end(streams[i]);
+      })(0);
+    }
+
+    after(function () {
+      lame.Decoder.handles.clear();
+    });
+
+    [ {}, { rate: 8000, channels: 1 }, { encoding: 'f32', zeroCopy: true } ].forEach(function (opts) {
+      it('should output the same PCM data as new decoders with ' + JSON.stringify(opts), function (done) {
+        var before = lame.Decoder.handles.stats();
+        decodeStreams(opts, function (err, expected) {
+          if (err) return done(err);
+          decodeStreams(Object.assign({ reuse: true }, opts), function (err, actual) {
+            if (err) return done(err);
+            var stats = lame.Decoder.handles.stats();
+            assert.equal(before.misses + 1, stats.misses);
+            assert.equal(before.hits + streams.length - 1, stats.hits);
+            assert.equal(before.idle + 1, stats.idle);
+            for (var i = 0; i < streams.length; i++) {
+              assert(expected[i].length > 0);
+              assert(expected[i].equals(actual[i]), 'stream ' + i + ' differs');
+            }
+            done();
+          });
+        });
+      });
+    });
+
+    it('should put back what seek() changed', function (done) {
+      lame.Decoder.scan(mp3, function (err, index) {
+        if (err) return done(err);
+        decodeStreams({ reuse: true, rate: 22050 }, function (err, expected) {
+          if (err) return done(err);
+          var decoder = new lame.Decoder({ reuse: true, rate: 22050, index: index });
+          decoder.resume();
+          decoder.on('end', function () {
+            assert.equal(null, decoder.mh);
+            decodeStreams({ reuse: true, rate: 22050 }, function (err, actual) {
+              if (err) return done(err);
+              for (var i = 0; i < streams.length; i++) {
+                assert(expected[i].equals(actual[i]), 'stream ' + i + ' differs');
+              }
+              done();
+            });
+          });
+          decoder.write(mp3.slice(0, index.offsets[0] + 2881), function () {
+            decoder.end(mp3.slice(decoder.seek(50000)));
+          });
+        });
+      });
+    });
+
+    it('should not reuse a decoder of other options', function (done) {
+      var before = lame.Decoder.handles.stats();
+      decodeStreams({ reuse: true, rate: 16000 }, function (err) {
+        if (err) return done(err);
+        decodeStreams({ reuse: true, rate: 16000, gapless: false }, function (err) {
+          if (err) return done(err);
+          var stats = lame.Decoder.handles.stats();
+          assert.equal(before.misses + 2, stats.misses);
+          assert.equal(before.idle + 2, stats.idle);
+          done();
+        });
+      });
+    });
+
+    it('should let go of handles idle for "idleTimeout"', function (done) {
+      var handles = lame.Decoder.handles;
+      var idleTimeout = handles.idleTimeout;
+      handles.clear();
+      handles.idleTimeout = 20;
+      decodeStreams({ reuse: true }, function (err) {
+        if (err) return done(err);
+        assert.equal(1, handles.stats().idle);
+        setTimeout(function () {
+          handles.idleTimeout = idleTimeout;
+          assert.equal(0, handles.stats().idle);
+          assert.equal(null, handles.timer);
+          done();
+        }, 100);
+      });
+    });
+
+  });
+
+  describe('decodeParallel()', function () {
+    var filename = path.resolve(fixtures, 'pipershut_lo.mp3');
+
+    it('should output the same PCM data as a serial Decoder', function (done) {
+      var mp3 = fs.readFileSync(filename);
+      var decoder = new lame.Decoder();
+      var bufs = [];
+      decoder.on('data', function (b) { bufs.push(b); });
+      decoder.on('error', done);
+      decoder.on('end', function () {
+        var expected = Buffer.concat(bufs);
+        lame.decodeParallel(mp3, { ranges: 4 }, function (err, pcm, format) {
+          if (err) return done(err);
+          assert.equal(11025, format.sampleRate);
+          assert.equal(2, format.channels);
+          assert.equal(expected.length, pcm.length);
+          assert(expected.equals(pcm));
+          done();
+        });
+      });
+      decoder.end(mp3);
+    });
+
+  });
+
 });
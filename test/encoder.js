@@ -0,0 +1,677 @@
+var lame = require('../');
+var assert = require('assert');
+
+/**
+ * Generates `seconds` worth of 16-bit stereo sine wave PCM data, at 44.1khz
+ * and 440hz unless another `rate` and `hz` are given.
+ */
+
+function sine (seconds, rate, hz) {
+  rate = rate || 44100;
+  hz = hz || 440;
+  var samples = Math.round(seconds * rate);
+  var buf = new Buffer(samples * 4);
+  for (var i = 0; i < samples; i++) {
+    var s = Math.round(Math.sin(2 * Math.PI * hz * i / rate) * 16000);
+    buf.writeInt16LE(s, i * 4);
+    buf.writeInt16LE(s, i * 4 + 2);
+  }
+  return buf;
+}
+
+/**
+ * Writes `pcm` to a new Encoder of `opts` (or to an Encoder) in `chunkSize`
+ * pieces, and calls `fn` with the Array of output Buffers and the Encoder.
+ */
+
+function encode (opts, pcm, chunkSize, fn) {
+  var encoder = opts instanceof lame.Encoder ? opts : new lame.Encoder(opts);
+  var bufs = [];
+  encoder.on('data', function (b) { bufs.push(b); });
+  encoder.on('end', function () { fn(null, bufs, encoder); });
+  encoder.on('error', fn);
+  for (var i = 0; i < pcm.length; i += chunkSize) {
+    encoder.write(pcm.slice(i, i + chunkSize));
+  }
+  encoder.end();
+}
+
+describe('Encoder', function () {
+
+  describe('scratch', function () {
+    var pcm = sine(3);
+
+    it('should output the same MP3 data as without a scratch Buffer', function (done) {
+      encode({}, pcm, 8192, function (err, expected) {
+        if (err) return done(err);
+        encode({ scratch: true }, pcm, 8192, function (err, actual) {
+          if (err) return done(err);
+          assert.deepEqual(Buffer.concat(actual), Buffer.concat(expected));
+          done();
+        });
+      });
+    });
+
+    it('should push Buffers that keep no more than node\'s pool alive', function (done) {
+      encode({ scratch: true }, pcm, 8192, function (err, bufs) {
+        if (err) return done(err);
+        assert(bufs.length > 1);
+        bufs.forEach(function (b) {
+          assert(b.buffer.byteLength <= Math.max(b.length, Buffer.poolSize));
+        });
+        done();
+      });
+    });
+
+    it('should keep its memory use bounded over a long encode', function (done) {
+      this.timeout(30000);
+      // a minute of audio, holding on to every 10th chunk of output
+      var encoder = new lame.Encoder({ scratch: true });
+      var input = sine(60);
+      var held = [];
+      var chunks = 0;
+      var scratch = null;
+      encoder.on('data', function (b) {
+        if (chunks++ % 10 === 0) held.push(b);
+        // the one scratch Buffer is encoded into over and over (and let go at the end)
+        if (!scratch) scratch = encoder._scratch;
+        if (encoder.gfp) assert.strictEqual(encoder._scratch, scratch);
+      });
+      encoder.on('end', function () {
+        assert(held.length > 10);
+        var pinned = held.map(function (b) { return b.buffer; }).filter(function (ab, i, all) {
+          return all.indexOf(ab) === i;
+        }).reduce(function (n, ab) { return n + ab.byteLength; }, 0);
+        assert(pinned <= held.length * Buffer.poolSize);
+        assert.equal(scratch.length, lame.Encoder.SCRATCH_SIZE);
+        done();
+      });
+      for (var i = 0; i < input.length; i += 16384) {
+        encoder.write(input.slice(i, i + 16384));
+      }
+      encoder.end();
+    });
+
+    it('should allocate a larger scratch Buffer for chunks bigger than `scratch`', function (done) {
+      encode({ scratch: 1024 }, pcm, 65536, function (err, bufs) {
+        if (err) return done(err);
+        assert(Buffer.concat(bufs).length > 0);
+        done();
+      });
+    });
+
+  });
+
+  describe('PCM formats', function () {
+    var pcm = sine(1);
+
+    /**
+     * Re-encodes each 16-bit sample of `pcm` with `fn(sample, buf, offset)`
+     * into `size` bytes.
+     */
+
+    function convert (size, fn) {
+      var out = new Buffer(pcm.length / 2 * size);
+      for (var i = 0; i < pcm.length / 2; i++) {
+        fn(pcm.readInt16LE(i * 2), out, i * size);
+      }
+      return out;
+    }
+
+    function encodes (opts, input, expected, done) {
+      encode(opts, input, 3000, function (err, actual) {
+        if (err) return done(err);
+        assert.deepEqual(Buffer.concat(actual), expected);
+        done();
+      });
+    }
+
+    it('should encode 24-bit PCM like the same 16-bit PCM', function (done) {
+      encode({}, pcm, 8192, function (err, expected) {
+        if (err) return done(err);
+        var s24 = convert(3, function (s, buf, offset) {
+          buf.writeIntLE(s * 256, offset, 3);
+        });
+        encodes({ bitDepth: 24 }, s24, Buffer.concat(expected), done);
+      });
+    });
+
+    it('should encode 32-bit PCM like the same 16-bit PCM', function (done) {
+      encode({}, pcm, 8192, function (err, expected) {
+        if (err) return done(err);
+        var s32 = convert(4, function (s, buf, offset) {
+          buf.writeInt32LE(s * 65536, offset);
+        });
+        encodes({ bitDepth: 32 }, s32, Buffer.concat(expected), done);
+      });
+    });
+
+    it('should encode unsigned 8-bit PCM like the same 16-bit PCM', function (done) {
+      var u8 = convert(1, function (s, buf, offset) {
+        buf[offset] = (s >> 8) + 128;
+      });
+      var s16 = new Buffer(u8.length * 2);
+      for (var i = 0; i < u8.length; i++) s16.writeInt16LE((u8[i] - 128) * 256, i * 2);
+      encode({}, s16, 8192, function (err, expected) {
+        if (err) return done(err);
+        encodes({ bitDepth: 8 }, u8, Buffer.concat(expected), done);
+      });
+    });
+
+    it('should only take unsigned 8-bit PCM', function () {
+      assert.throws(function () {
+        new lame.Encoder({ bitDepth: 8, signed: true });
+      }, /"signed" must be `false`/);
+      assert.equal(false, new lame.Encoder({ bitDepth: 8 }).signed);
+    });
+
+  });
+
+  describe('planar', function () {
+    var pcm = sine(3);
+    // a quieter right channel, so that swapped channels show
+    for (var i = 2; i < pcm.length; i += 4) {
+      pcm.writeInt16LE(pcm.readInt16LE(i) >> 1, i);
+    }
+
+    /**
+     * Splits each `frames` long piece of `pcm` into `[ left, right ]`
+     * Int16Arrays.
+     */
+
+    function planes (frames) {
+      var chunks = [];
+      for (var i = 0; i < pcm.length / 4; i += frames) {
+        var n = Math.min(frames, pcm.length / 4 - i);
+        var left = new Int16Array(n);
+        var right = new Int16Array(n);
+        for (var j = 0; j < n; j++) {
+          left[j] = pcm.readInt16LE((i + j) * 4);
+          right[j] = pcm.readInt16LE((i + j) * 4 + 2);
+        }
+        chunks.push([ left, right ]);
+      }
+      return chunks;
+    }
+
+    function encodePlanar (chunks, fn) {
+      var encoder = new lame.Encoder({ planar: true });
+      var bufs = [];
+      encoder.on('data', function (b) { bufs.push(b); });
+      encoder.on('end', function () { fn(null, Buffer.concat(bufs)); });
+      encoder.on('error', fn);
+      chunks.forEach(function (chunk) { encoder.write(chunk); });
+      encoder.end();
+    }
+
+    it('should output the same MP3 data as interleaved input', function (done) {
+      encode({}, pcm, 8192, function (err, expected) {
+        if (err) return done(err);
+        expected = Buffer.concat(expected);
+        var chunks = planes(2048);
+        encodePlanar(chunks, function (err, actual) {
+          if (err) return done(err);
+          assert.deepEqual(actual, expected);
+
+          // the same as one Buffer per chunk, the channels one after the other
+          encodePlanar(chunks.map(function (c) {
+            return Buffer.concat([ Buffer.from(c[0].buffer), Buffer.from(c[1].buffer) ]);
+          }), function (err, actual) {
+            if (err) return done(err);
+            assert.deepEqual(actual, expected);
+            done();
+          });
+        });
+      });
+    });
+
+    it('should reject channels of different lengths', function (done) {
+      var encoder = new lame.Encoder({ planar: true });
+      encoder.on('error', function (err) {
+        assert(/same length/.test(err.message));
+        done();
+      });
+      encoder.write([ new Int16Array(1152), new Int16Array(1000) ]);
+    });
+
+    it('should not modify the options passed in', function () {
+      var opts = { planar: true };
+      var encoder = new lame.Encoder(opts);
+      assert.deepEqual(opts, { planar: true });
+      assert(encoder._writableState.objectMode);
+      encoder.destroy();
+    });
+
+  });
+
+  describe('resampling', function () {
+    var pcm = sine(3, 48000);
+
+    // encodes `pcm` with a plain `gapless` Encoder (encodeParallel() falls
+    // back to one segment when resampling anyway), and calls `fn` with the
+    // MP3 file, its LAME tag frame in place
+    function encodeFile (opts, pcm, fn) {
+      var tag = null;
+      var encoder = new lame.Encoder(Object.assign({ gapless: true }, opts));
+      encoder.on('lametag', function (t) { tag = t; });
+      encode(encoder, pcm, 8192, function (err, bufs) {
+        if (err) return fn(err);
+        var mp3 = Buffer.concat(bufs);
+        tag.copy(mp3, 0);
+        fn(null, mp3);
+      });
+    }
+
+    [ 0, 1, 2, 3 ].forEach(function (quality) {
+      it('should resample 48khz to 44.1khz with resampleQuality ' + quality, function (done) {
+        var opts = { sampleRate: 48000, outSampleRate: 44100, resampleQuality: quality };
+        encodeFile(opts, pcm, function (err, mp3) {
+          if (err) return done(err);
+          var decoder = new lame.Decoder();
+          var length = 0;
+          decoder.on('format', function (format) {
+            assert.equal(format.sampleRate, 44100);
+          });
+          decoder.on('data', function (b) { length += b.length; });
+          decoder.on('end', function () {
+            // the LAME tag's encoder delay and padding account for the resampler
+            assert(Math.abs(length / 4 - 3 * 44100) <= 1, length / 4);
+            done();
+          });
+          decoder.on('error', done);
+          decoder.end(mp3);
+        });
+      });
+    });
+
+    // 320 kbps without a lowpass filter, so the resampler is what shapes the
+    // spectrum; the MP3 coding itself leaves noise at about -80 dB
+    function resampleTone (hz, quality, fn) {
+      var opts = { sampleRate: 48000, outSampleRate: 44100, resampleQuality: quality,
+        bitRate: 320, lowpassfreq: -1 };
+      encodeFile(opts, sine(2, 48000, hz), function (err, mp3) {
+        if (err) return fn(err);
+        var decoder = new lame.Decoder();
+        var bufs = [];
+        decoder.on('data', function (b) { bufs.push(b); });
+        decoder.on('end', function () { fn(null, fitTone(Buffer.concat(bufs), hz / 44100)); });
+        decoder.on('error', fn);
+        decoder.end(mp3);
+      });
+    }
+
+    // the gain of the tone of frequency `f` (cycles per sample) in the left
+    // channel of `pcm` relative to sine()'s, and everything else relative to
+    // the tone (THD+N), both in dB, leaving out 0.1 seconds at either end
+    function fitTone (pcm, f) {
+      var from = 4410, to = pcm.length / 4 - 4410, n = to - from;
+      var a = 0, b = 0, tone = 0, rest = 0, k, t;
+      for (k = from; k < to; k++) {
+        a += pcm.readInt16LE(k * 4) * Math.cos(2 * Math.PI * f * k);
+        b += pcm.readInt16LE(k * 4) * Math.sin(2 * Math.PI * f * k);
+      }
+      a *= 2 / n;
+      b *= 2 / n;
+      for (k = from; k < to; k++) {
+        t = a * Math.cos(2 * Math.PI * f * k) + b * Math.sin(2 * Math.PI * f * k);
+        tone += t * t;
+        rest += (pcm.readInt16LE(k * 4) - t) * (pcm.readInt16LE(k * 4) - t);
+      }
+      return {
+        gain: 10 * Math.log10(tone / n / (16000 * 16000 / 2)),
+        thdn: 10 * Math.log10(rest / tone)
+      };
+    }
+
+    [ 0, 1, 2, 3 ].forEach(function (quality) {
+      it('should keep the passband within about 0.5 dB with resampleQuality ' + quality, function (done) {
+        // 0.9 x the Nyquist frequency of 44.1khz
+        resampleTone(19845, quality, function (err, r) {
+          if (err) return done(err);
+          assert(Math.abs(r.gain) <= 0.6, 'gain ' + r.gain.toFixed(2) + ' dB');
+          done();
+        });
+      });
+
+      it('should not distort a 1khz tone with resampleQuality ' + quality, function (done) {
+        resampleTone(1000, quality, function (err, r) {
+          if (err) return done(err);
+          assert(Math.abs(r.gain) <= 0.1, 'gain ' + r.gain.toFixed(2) + ' dB');
+          assert(r.thdn <= -70, 'THD+N ' + r.thdn.toFixed(1) + ' dB');
+          done();
+        });
+      });
+    });
+
+    it('should use the original resampler by default', function () {
+      var encoder = new lame.Encoder({ sampleRate: 48000, outSampleRate: 44100 });
+      assert.equal(encoder.resampleQuality, 0);
+    });
+
+    it('should reject an unknown resampleQuality', function () {
+      assert.throws(function () {
+        new lame.Encoder({ resampleQuality: 4 });
+      }, /resampleQuality/);
+    });
+
+  });
+
+  describe('gapless', function () {
+    // not a whole number of frames
+    var pcm = sine(2.3456);
+
+    it('should decode to exactly the input length with the "lametag" frame', function (done) {
+      var tag = null;
+      var encoder = new lame.Encoder({ gapless: true });
+      var bufs = [];
+      encoder.on('lametag', function (t) { tag = t; });
+      encoder.on('data', function (b) { bufs.push(b); });
+      encoder.on('end', function () {
+        assert(tag);
+        assert.equal(576, encoder.encoderDelay);
+        assert(encoder.encoderPadding > 0);
+        // the tag goes in place of the placeholder frame at the start
+        var mp3 = Buffer.concat(bufs);
+        tag.copy(mp3, 0);
+        var decoder = new lame.Decoder();
+        var format = null;
+        var length = 0;
+        decoder.on('format', function (f) { format = f; });
+        decoder.on('data', function (b) { length += b.length; });
+        decoder.on('end', function () {
+          assert.equal(encoder.encoderDelay, format.encoderDelay);
+          assert.equal(encoder.encoderPadding, format.encoderPadding);
+          assert.equal(pcm.length / 4, format.samples);
+          assert.equal(pcm.length, length);
+          done();
+        });
+        decoder.on('error', done);
+        decoder.end(mp3);
+      });
+      encoder.on('error', done);
+      encoder.end(pcm);
+    });
+
+    it('should flush without a "lametag" frame by default', function (done) {
+      var encoder = new lame.Encoder();
+      var bufs = [];
+      encoder.on('lametag', function () { done(new Error('"lametag" emitted')); });
+      encoder.on('data', function (b) { bufs.push(b); });
+      encoder.on('end', function () {
+        var gapless = new lame.Encoder({ gapless: true });
+        var full = [];
+        gapless.on('data', function (b) { full.push(b); });
+        gapless.on('end', function () {
+          // the end of the stream that lame still buffers isn't encoded
+          assert(Buffer.concat(bufs).length < Buffer.concat(full).length);
+          assert(Buffer.concat(full).slice(0, 1000).equals(Buffer.concat(bufs).slice(0, 1000)));
+          done();
+        });
+        gapless.on('error', done);
+        gapless.end(pcm);
+      });
+      encoder.on('error', done);
+      encoder.end(pcm);
+    });
+
+    it('should not trim anything with `gapless: false`', function (done) {
+      lame.encodeParallel(pcm, {}, function (err, mp3) {
+        if (err) return done(err);
+        var decoder = new lame.Decoder({ gapless: false });
+        var length = 0;
+        decoder.on('data', function (b) { length += b.length; });
+        decoder.on('end', function () {
+          assert.equal(576, decoder.encoderDelay);
+          assert(length > pcm.length + 576 * 4);
+          done();
+        });
+        decoder.on('error', done);
+        decoder.end(mp3);
+      });
+    });
+
+  });
+
+  describe('shared tables', function () {
+
+    /**
+     * Writes a chunk of silence to a new Encoder, and calls `fn` with it once
+     * it has set up its tables.
+     */
+
+    function started (opts, fn) {
+      var encoder = new lame.Encoder(opts);
+      encoder.resume();
+      encoder.write(Buffer.alloc(4608), function () { fn(encoder); });
+    }
+
+    it('should report the bytes of the tables an encoder shares', function (done) {
+      started({ sampleRate: 48000, outSampleRate: 44100, resampleQuality: 2 }, function (a) {
+        assert(a.tableBytes > 10000);
+        var stats = lame.tableCacheStats();
+        assert(stats.tables >= 2);
+        assert(stats.bytes >= a.tableBytes);
+
+        // a second encoder of the same configuration builds nothing new
+        started({ sampleRate: 48000, outSampleRate: 44100, resampleQuality: 2 }, function (b) {
+          assert.equal(b.tableBytes, a.tableBytes);
+          assert.deepEqual(lame.tableCacheStats(), stats);
+          var left = 2;
+          [ a, b ].forEach(function (encoder) {
+            encoder.on('end', function () {
+              if (--left) return;
+              // and the last one out frees them
+              assert(lame.tableCacheStats().bytes < stats.bytes);
+              done();
+            });
+            encoder.end();
+          });
+        });
+      });
+    });
+
+  });
+
+  describe('reuse', function () {
+    var clips = [ sine(1.2), sine(0.7, 44100).slice(1000), sine(2.1) ];
+
+    // encodes the clips one after the other, and calls `fn` with their MP3
+    // files (with the "lametag" frame in place)
+    function encodeClips (opts, fn) {
+      var mp3s = [];
+      (function next (i) {
+        if (i == clips.length) return fn(null, mp3s);
+        var tag = null;
+        var encoder = new lame.Encoder(Object.assign({ gapless: true }, opts));
+        var bufs = [];
+        encoder.on('lametag', function (t) { tag = t; });
+        encoder.on('data', function (b) { bufs.push(b); });
+        encoder.on('end', function () {
+          var mp3 = Buffer.concat(bufs);
+          tag.copy(mp3, 0);
+          mp3s.push(mp3);
+          next(i + 1);
+        });
+        encoder.on('error', fn);
+        encoder.end(clips[i]);
+      })(0);
+    }
+
+    after(function () {
+      lame.Encoder.handles.clear();
+    });
+
+    [ { bitRate: 128 }, { VBR: 4, VBRQ: 2 }, { sampleRate: 48000, outSampleRate: 32000 } ].forEach(function (opts) {
+      it('should output the same MP3 files as new encoders with ' + JSON.stringify(opts), function (done) {
+        var before = lame.Encoder.handles.stats();
+        encodeClips(opts, function (err, expected) {
+          if (err) return done(err);
+          encodeClips(Object.assign({ reuse: true }, opts), function (err, actual) {
+            if (err) return done(err);
+            var stats = lame.Encoder.handles.stats();
+            assert.equal(before.misses + 1, stats.misses);
+            assert.equal(before.hits + clips.length - 1, stats.hits);
+            assert.equal(before.idle + 1, stats.idle);
+            for (var i = 0; i < clips.length; i++) {
+              assert(expected[i].equals(actual[i]), 'clip ' + i + ' differs');
+            }
+            done();
+          });
+        });
+      });
+    });
+
+    it('should not reuse an encoder of other options', function (done) {
+      var before = lame.Encoder.handles.stats();
+      encode({ reuse: true, bitRate: 160 }, clips[0], 4096, function (err) {
+        if (err) return done(err);
+        encode({ reuse: true, bitRate: 192 }, clips[0], 4096, function (err) {
+          if (err) return done(err);
+          var stats = lame.Encoder.handles.stats();
+          assert.equal(before.misses + 2, stats.misses);
+          assert.equal(before.hits, stats.hits);
+          assert.equal(before.idle + 2, stats.idle);
+          done();
+        });
+      });
+    });
+
+    it('should only take options in the constructor', function () {
+      var encoder = new lame.Encoder({ reuse: true });
+      assert.throws(function () {
+        encoder.bitRate = 192;
+      }, /only be set in the constructor/);
+    });
+
+  });
+
+  describe('encodeParallel()', function () {
+    var pcm = sine(12);
+
+    function decode (mp3, fn) {
+      var decoder = new lame.Decoder();
+      var bufs = [];
+      decoder.on('data', function (b) { bufs.push(b); });
+      decoder.on('end', function () { fn(null, Buffer.concat(bufs)); });
+      decoder.on('error', fn);
+      decoder.end(mp3);
+    }
+
+    it('should decode to exactly the input length', function (done) {
+      lame.encodeParallel(pcm, { segments: 4 }, function (err, mp3) {
+        if (err) return done(err);
+        assert.equal(mp3.slice(36, 40).toString(), 'Info');
+        decode(mp3, function (err, out) {
+          if (err) return done(err);
+          assert.equal(out.length, pcm.length);
+          done();
+        });
+      });
+    });
+
+    it('should output as many frames as a single segment', function (done) {
+      var frames = require('../lib/parallel').frames;
+      lame.encodeParallel(pcm, { segments: 1, writeVbrTag: false }, function (err, serial) {
+        if (err) return done(err);
+        lame.encodeParallel(pcm, { segments: 5, writeVbrTag: false }, function (err, mp3) {
+          if (err) return done(err);
+          assert.notEqual(mp3.slice(36, 40).toString(), 'Info');
+          assert.equal(frames(mp3).length, frames(serial).length);
+          done();
+        });
+      });
+    });
+
+  });
+
+  describe('EncoderGroup', function () {
+
+    // `seconds` of a tone of `hz` (with some noise) in the format of `opts`
+    function tone (opts, seconds, hz) {
+      var channels = opts.channels || 2, rate = opts.sampleRate;
+      var samples = Math.round(seconds * rate) * channels;
+      var buf = new Buffer(samples * (opts.float ? 4 : 2));
+      for (var i = 0; i < samples; i++) {
+        var s = Math.sin(2 * Math.PI * hz * Math.floor(i / channels) / rate) * 0.4 +
+          ((i * 7919) % 1000 - 500) / 20000;
+        if (opts.float) buf.writeFloatLE(s, i * 4);
+        else buf.writeInt16LE(Math.round(s * 32767), i * 2);
+      }
+      return buf;
+    }
+
+    [
+      { channels: 1, sampleRate: 16000, bitRate: 32, mode: lame.MONO },
+      { channels: 1, sampleRate: 8000, bitRate: 16, mode: lame.MONO, float: true, bitDepth: 32 },
+      { channels: 2, sampleRate: 44100, bitRate: 128 }
+    ].forEach(function (opts) {
+      it('should output the same MP3 files as Encoders with ' + JSON.stringify(opts), function (done) {
+        var count = 11;
+        var chunk = Math.round(opts.sampleRate / 50) * opts.channels * (opts.float ? 4 : 2);
+        var pcms = [];
+        for (var i = 0; i < count; i++) pcms.push(tone(opts, 0.5 + i * 0.1, 200 + 50 * i));
+
+        var group = new lame.EncoderGroup(opts, count);
+        var mp3s = pcms.map(function () { return []; });
+        (function next (offset) {
+          var chunks = pcms.map(function (pcm) { return pcm.slice(offset, offset + chunk); });
+          if (chunks.every(function (c) { return c.length === 0; })) {
+            return group.end(function (err, last, tags) {
+              if (err) return done(err);
+              compare(mp3s.map(function (bufs, i) {
+                var mp3 = Buffer.concat(bufs.concat(last[i]));
+                if (tags[i]) tags[i].copy(mp3, 0);
+                return mp3;
+              }));
+            });
+          }
+          group.encode(chunks, function (err, out) {
+            if (err) return done(err);
+            out.forEach(function (b, i) { mp3s[i].push(b); });
+            next(offset + chunk);
+          });
+        })(0);
+
+        function compare (actual) {
+          (function next (i) {
+            if (i == count) return done();
+            var tag = null;
+            var encoder = new lame.Encoder(Object.assign({ gapless: true }, opts));
+            var bufs = [];
+            encoder.on('lametag', function (t) { tag = t; });
+            encoder.on('data', function (b) { bufs.push(b); });
+            encoder.on('end', function () {
+              var mp3 = Buffer.concat(bufs);
+              if (tag) tag.copy(mp3, 0);
+              assert(mp3.equals(actual[i]), 'stream ' + i + ' differs');
+              next(i + 1);
+            });
+            encoder.on('error', done);
+            for (var offset = 0; offset < pcms[i].length; offset += chunk) {
+              encoder.write(pcms[i].slice(offset, offset + chunk));
+            }
+            encoder.end();
+          })(0);
+        }
+      });
+    });
+
+    it('should only take 16-bit or float PCM', function () {
+      [ { bitDepth: 24 }, { bitDepth: 8 }, { bitDepth: 64, float: true } ].forEach(function (opts) {
+        assert.throws(function () {
+          new lame.EncoderGroup(opts, 2);
+        }, /takes 16-bit or 32-bit float PCM/);
+      });
+    });
+
+    it('should only take whole samples', function (done) {
+      var group = new lame.EncoderGroup({ channels: 1, sampleRate: 16000, mode: lame.MONO }, 2);
+      group.encode([ new Buffer(4), new Buffer(3) ], function (err) {
+        assert(/whole samples/.test(err.message));
+        group.end(done);
+      });
+    });
+
+  });
+
+});
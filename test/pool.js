@@ -0,0 +1,67 @@
+var fs = require('fs');
+var path = require('path');
+var lame = require('../');
+var assert = require('assert');
+var fixtures = path.resolve(__dirname, 'fixtures');
+
+describe('poolStats()', function () {
+
+  it('should report one entry per worker', function () {
+    var stats = lame.poolStats();
+    assert(stats.size > 0);
+    assert.equal(stats.size, stats.workers.length);
+  });
+
+  it('should count completed work, and be idle afterwards', function (done) {
+    var before = lame.poolStats();
+    var total = function (stats) {
+      return stats.workers.reduce(function (t, w) { return t + w.completed; }, 0);
+    };
+    var decoder = new lame.Decoder();
+    decoder.on('end', function () {
+      var after = lame.poolStats();
+      assert(total(after) > total(before));
+      assert.equal(0, after.pending);
+      done();
+    });
+    fs.createReadStream(path.resolve(fixtures, 'pipershut_lo.mp3')).pipe(decoder);
+    decoder.resume();
+  });
+
+  it('should free the state of a Worker that exits with work pending', function (done) {
+    this.timeout(30000);
+    var Worker = require('worker_threads').Worker;
+    var contexts = lame.poolStats().contexts;
+    // each Worker queues a few seconds of encoding, and is terminated as
+    // soon as it's all queued
+    var script = [
+      'var lame = require(' + JSON.stringify(path.resolve(__dirname, '..')) + ');',
+      'var pcm = Buffer.alloc(44100 * 4);',
+      'for (var i = 0; i < 8; i++) {',
+      '  var encoder = new lame.Encoder();',
+      '  encoder.resume();',
+      '  for (var j = 0; j < 5; j++) encoder.write(pcm);',
+      '}',
+      'require("worker_threads").parentPort.postMessage(lame.poolStats().pending);'
+    ].join('\n');
+    var left = 4;
+    for (var i = 0; i < 4; i++) {
+      var worker = new Worker(script, { eval: true });
+      worker.on('message', function (pending) {
+        assert(pending > 0);
+        this.terminate();
+      });
+      worker.on('error', done);
+      worker.on('exit', function () {
+        if (--left) return;
+        // the workers of the pool let go of the last of them as they finish
+        (function wait () {
+          if (lame.poolStats().contexts > contexts) return setTimeout(wait, 20);
+          assert.equal(lame.poolStats().pending, 0);
+          done();
+        })();
+      });
+    }
+  });
+
+});